@@ -0,0 +1,420 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEASYNC__H__
+#define __ISBRIDGEASYNC__H__
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISZmqTcpBridge.h"
+#include "ISBridgeConsumer.h"
+#include "ISBridgeWakeup.h"
+
+/**
+ * Event loop the coroutine API runs on, supplied by the embedding application
+ *
+ * cISBridgeAsync and cISBridgeService call these only from the executor's own thread,
+ * including from inside the callbacks they registered, and every callback must run on
+ * that thread. Callbacks are never run from inside the call that registers them.
+ */
+class iISBridgeExecutor
+{
+public:
+    virtual ~iISBridgeExecutor() {}
+
+    /**
+     * Run a task soon
+     * @param task the task
+     */
+    virtual void Post(std::function<void()> task) = 0;
+
+    /**
+     * Run a task once a delay has passed
+     * @param delayMs milliseconds, 0 for the next loop iteration
+     * @param task the task
+     */
+    virtual void PostAfter(int delayMs, std::function<void()> task) = 0;
+
+    /**
+     * Run a task once a delay in nanoseconds has passed, for the bridge's sub-millisecond
+     * batch and merge deadlines. The default rounds up to PostAfter()'s milliseconds.
+     * @param delayNs nanoseconds, 0 for the next loop iteration
+     * @param task the task
+     */
+    virtual void PostAfterNs(int64_t delayNs, std::function<void()> task)
+    {
+        PostAfter(static_cast<int>((delayNs + 999999) / 1000000), std::move(task));
+    }
+
+    /**
+     * Call onReadable whenever a descriptor is readable (level triggered), until Unwatch()
+     * @param fd the descriptor; watching it again replaces the callback
+     * @param onReadable the callback
+     */
+    virtual void Watch(is_socket_t fd, std::function<void()> onReadable) = 0;
+
+    /**
+     * Stop watching a descriptor
+     * @param fd the descriptor
+     */
+    virtual void Unwatch(is_socket_t fd) = 0;
+};
+
+/**
+ * Minimal poll() based iISBridgeExecutor for applications without an event loop of
+ * their own, or to run a bridge on a thread of the caller's choosing
+ */
+class cISBridgePollExecutor : public iISBridgeExecutor
+{
+public:
+    cISBridgePollExecutor();
+
+    void Post(std::function<void()> task) override;
+    void PostAfter(int delayMs, std::function<void()> task) override;
+    void PostAfterNs(int64_t delayNs, std::function<void()> task) override;
+    void Watch(is_socket_t fd, std::function<void()> onReadable) override;
+    void Unwatch(is_socket_t fd) override;
+
+    /**
+     * Wait for at most one round of events and run what is due. Timers are waited for
+     * to the nanosecond where ppoll() is available.
+     * @param timeoutMs longest wait in milliseconds, -1 to wait until something happens
+     * @return number of callbacks and tasks run
+     */
+    int RunOnce(int timeoutMs);
+
+    /**
+     * Run until Stop()
+     */
+    void Run();
+
+    /**
+     * Make Run() return. Safe from any thread.
+     */
+    void Stop();
+
+private:
+    cISBridgePollExecutor(const cISBridgePollExecutor&) = delete;
+    cISBridgePollExecutor& operator=(const cISBridgePollExecutor&) = delete;
+
+    cISBridgeWakeup m_wakeup;           // Stop() and Post() from other threads
+    std::atomic<bool> m_stopping;
+    std::atomic<std::thread::id> m_loopThread;
+    std::mutex m_postedMutex;           // Post() may come from any thread
+    std::vector<std::function<void()>> m_posted;
+    std::multimap<uint64_t, std::function<void()>> m_timers;    // By due bridgeClockNs()
+    std::map<is_socket_t, std::function<void()>> m_watches;
+
+    // RunOnce() working storage, kept so a warmed-up loop does not allocate
+    std::vector<pollfd> m_pollFds;
+    std::vector<std::function<void()>> m_running;
+};
+
+/**
+ * Drives an open cISZmqTcpBridge from an executor
+ *
+ * Watches the ZMQ receive, wakeup and TCP shard descriptors and arms the bridge's merge,
+ * batch, pacing and accept retry deadlines, calling ServiceZmq() and ServiceTcp() as
+ * they come due. This is the bridge's one forwarding loop: cISBridgeAsync runs it for
+ * the whole bridge on the application's executor, and Start() runs one for ZMQ and one
+ * per TCP shard, each on a cISBridgePollExecutor of its own thread. Everything here
+ * runs on the executor's thread.
+ */
+class cISBridgeService
+{
+public:
+    /**
+     * What a service covers: kServiceAll, kServiceZmq or a TCP shard index
+     */
+    static const int kServiceAll = -2;  // ZMQ and every TCP shard, from one thread
+    static const int kServiceZmq = -1;  // The ZMQ sockets and wakeup only
+
+    /**
+     * Constructor
+     * @param bridge the bridge, opened before Open(); outlives this object
+     * @param executor the executor; outlives this object
+     * @param part what to service: kServiceAll, kServiceZmq or a TCP shard index. A
+     * part of the bridge must be serviced on its own thread, and the ZMQ part publishes
+     * what the shards' clients send.
+     */
+    cISBridgeService(cISZmqTcpBridge& bridge, iISBridgeExecutor& executor, int part = kServiceAll);
+    ~cISBridgeService();
+
+    /**
+     * Start servicing the bridge
+     * @param onServiced called after each service, e.g. to hand on what it received; may be empty
+     * @return 0 if success, -1 if a ZMQ socket has no descriptor
+     */
+    int Open(std::function<void()> onServiced = std::function<void()>());
+
+    /**
+     * Stop servicing. Timers and tasks still in the executor do nothing.
+     */
+    void Close();
+
+    /**
+     * Service everything this covers now, whether signalled or not, e.g. each round of
+     * a busy-polling loop
+     */
+    void ServiceAll();
+
+    /**
+     * Service interval for a TCP shard whose reactor has no pollable descriptor
+     */
+    static const int kFallbackPollMs = 10;
+
+private:
+    cISBridgeService(const cISBridgeService&) = delete;
+    cISBridgeService& operator=(const cISBridgeService&) = delete;
+
+    bool ServicesZmq() const { return m_part == kServiceAll || m_part == kServiceZmq; }
+    bool ServicesShard(int shard) const { return m_part == kServiceAll || m_part == shard; }
+
+    void WatchFd(is_socket_t fd, std::function<void()> onReadable);
+    void ServiceZmq();
+    void ServiceTcp(int shard);
+
+    /**
+     * Service a shard after kFallbackPollMs, then arm again, until Close()
+     */
+    void ArmTcpPoll(int shard);
+
+    /**
+     * Arm a timer for the bridge's next ZMQ deadline, if any
+     */
+    void ArmServiceTimer();
+
+    /**
+     * Arm a timer for a shard's accept retry, if one is pending
+     */
+    void ArmTcpTimer(int shard);
+
+    cISZmqTcpBridge& m_bridge;
+    iISBridgeExecutor& m_executor;
+    int m_part;
+    std::function<void()> m_onServiced;
+    bool m_open;
+    bool m_zmqServicePosted;
+    uint64_t m_serviceTimerDueNs;       // Earliest armed ZMQ deadline timer, 0 for none
+    std::vector<uint64_t> m_tcpTimerDueNs;  // Per shard, as m_serviceTimerDueNs
+    std::vector<is_socket_t> m_watchedFds;
+
+    // Timers and posted tasks hold a weak reference; Close() replaces it so tasks left
+    // in the executor from an earlier Open() do nothing
+    std::shared_ptr<bool> m_alive;
+};
+
+class cISBridgeAsync;
+
+/**
+ * Awaitable returned by cISBridgeAsync::Receive()
+ */
+class cISBridgeReceiveAwaiter
+{
+public:
+    explicit cISBridgeReceiveAwaiter(cISBridgeAsync& owner) : m_owner(owner) {}
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+    cISBridgeBufferRef await_resume() { return std::move(m_message); }
+
+private:
+    friend class cISBridgeAsync;
+
+    cISBridgeAsync& m_owner;
+    std::coroutine_handle<> m_handle;
+    cISBridgeBufferRef m_message;
+};
+
+/**
+ * Awaitable returned by cISBridgeAsync::Send()
+ */
+class cISBridgeSendAwaiter
+{
+public:
+    cISBridgeSendAwaiter(cISBridgeAsync& owner, const uint8_t* data, size_t size, eISBridgeZmqLane lane)
+        : m_owner(owner), m_data(data), m_size(size), m_lane(lane), m_result(-1) {}
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+    int await_resume() { return m_result; }
+
+private:
+    friend class cISBridgeAsync;
+
+    cISBridgeAsync& m_owner;
+    const uint8_t* m_data;
+    size_t m_size;
+    eISBridgeZmqLane m_lane;
+    int m_result;
+    std::coroutine_handle<> m_handle;
+};
+
+/**
+ * Fire-and-forget coroutine type, for callers that have none of their own
+ *
+ * Starts running when called and frees itself when it finishes. An exception escaping
+ * the coroutine terminates the process.
+ */
+struct sISBridgeTask
+{
+    struct promise_type
+    {
+        sISBridgeTask get_return_object() { return sISBridgeTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/**
+ * Coroutine interface to a cISZmqTcpBridge, driven by a caller-supplied executor
+ *
+ * Open() opens the bridge without a forwarding thread (see cISZmqTcpBridge::Open()) and
+ * services it from the executor with a cISBridgeService, so the bridge runs inside the
+ * application's event loop with no threads of its own (libzmq keeps its I/O thread).
+ * Attach() instead serves a bridge that is already running, e.g. started with Start();
+ * forwarding then stays on the bridge's thread and only the awaitables run on the
+ * executor.
+ *
+ *     sISBridgeTask pump(cISBridgeAsync& bridge)
+ *     {
+ *         while (cISBridgeBufferRef message = co_await bridge.Receive())
+ *         {
+ *             co_await bridge.Send(message->Data(), message->Size());
+ *         }
+ *     }
+ *
+ * Every call, and every coroutine awaiting, must be on the executor's thread. Received
+ * messages share their buffers with TCP clients and stay valid after Close() until
+ * released.
+ */
+class cISBridgeAsync
+{
+public:
+    /**
+     * Constructor
+     * @param bridge the bridge; outlives this object
+     * @param executor the executor; outlives this object
+     * @param receiveCapacity received messages buffered for Receive(); new ones are dropped when full
+     */
+    cISBridgeAsync(cISZmqTcpBridge& bridge, iISBridgeExecutor& executor, size_t receiveCapacity = 4096);
+    ~cISBridgeAsync();
+
+    /**
+     * Open the bridge and service it from the executor
+     * @param zmqRecvEndpoints ZMQ endpoints to receive data from, at least one
+     * @param zmqSendEndpoint ZMQ endpoint to send data to
+     * @param tcpPort TCP port for SDK clients to connect to
+     * @param sharedContext ZMQ context to create sockets on, or NULL for a private context
+     * @return 0 if success, -1 if the bridge failed to open or this is already open
+     */
+    int Open(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext = NULL);
+
+    /**
+     * Serve Receive() and Send() for a bridge that is already running
+     * @return 0 if success, -1 if already open
+     */
+    int Attach();
+
+    /**
+     * Stop serving: pending Receive() calls complete with an empty reference and pending
+     * Send() calls with -1. Stops the bridge if Open() opened it.
+     */
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+
+    /**
+     * Next message forwarded from ZMQ, as TCP clients get it
+     * @return awaitable producing the message, or an empty reference once closed
+     */
+    cISBridgeReceiveAwaiter Receive() { return cISBridgeReceiveAwaiter(*this); }
+
+    /**
+     * Publish a message to ZMQ as if a TCP client had sent it (see
+     * cISZmqTcpBridge::Inject()). Waits while the send queue is full; sends complete
+     * in call order.
+     * @param data the message; must stay valid until the send completes
+     * @param size number of bytes
+     * @param lane queue to use with zmqControlLane
+     * @return awaitable producing 0 once queued, -1 if closed or the bridge stopped
+     */
+    cISBridgeSendAwaiter Send(const uint8_t* data, size_t size, eISBridgeZmqLane lane = BRIDGE_ZMQ_LANE_BULK)
+    {
+        return cISBridgeSendAwaiter(*this, data, size, lane);
+    }
+
+    /**
+     * @return occupancy and drop counters of the received message buffer
+     */
+    sISBridgeMpscQueueStats GetReceiveStats() const { return m_received.GetStats(); }
+
+    /**
+     * Retry interval of a Send() waiting for space in the bridge's send queue
+     */
+    static const int kSendRetryMs = 1;
+
+private:
+    cISBridgeAsync(const cISBridgeAsync&) = delete;
+    cISBridgeAsync& operator=(const cISBridgeAsync&) = delete;
+
+    friend class cISBridgeReceiveAwaiter;
+    friend class cISBridgeSendAwaiter;
+
+    /**
+     * Hand received messages to waiting Receive() calls, and watch the buffer's
+     * descriptor only while some are waiting
+     */
+    void DeliverReceived();
+
+    /**
+     * @return true if the send completed, with its result set
+     */
+    bool TrySend(cISBridgeSendAwaiter& sender);
+    void RetrySenders();
+
+    /**
+     * Resume a coroutine from the executor rather than from inside the caller
+     */
+    void Resume(std::coroutine_handle<> handle);
+
+    cISZmqTcpBridge& m_bridge;
+    iISBridgeExecutor& m_executor;
+    cISBridgeService m_service;
+    cISBridgeConsumerQueue m_received;
+    bool m_open;
+    bool m_hosting;                     // Open() opened the bridge, so m_service runs it
+    bool m_watchingReceived;
+    bool m_sendRetryArmed;
+    std::deque<cISBridgeReceiveAwaiter*> m_receivers;
+    std::deque<cISBridgeSendAwaiter*> m_senders;
+
+    // Timers and posted tasks hold a weak reference; Close() replaces it so tasks left
+    // in the executor from an earlier Open() do nothing
+    std::shared_ptr<bool> m_alive;
+};
+
+#endif // __ISBRIDGEASYNC__H__
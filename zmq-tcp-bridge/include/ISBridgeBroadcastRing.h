@@ -0,0 +1,97 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEBROADCASTRING__H__
+#define __ISBRIDGEBROADCASTRING__H__
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+
+/**
+ * Broadcast ring statistics
+ */
+struct sISBridgeBroadcastRingStats
+{
+    size_t capacity = 0;
+    uint64_t published = 0;
+    uint64_t dropped = 0;               // Not published because the slowest reader was a full ring behind
+};
+
+/**
+ * Single-producer ring that every reader sees in full
+ *
+ * Each slot holds one buffer reference and a count of readers still to take it. A reader
+ * copies the reference (sharing the buffer, not the bytes) and the last one to do so
+ * releases the slot's reference, so a buffer is freed as soon as every reader has it and
+ * never waits for its slot to be reused. Readers only touch their own cursor and never
+ * block the producer or each other. The producer never overwrites a slot that a reader
+ * has not taken: messages that do not fit are dropped for everyone and counted, which
+ * only happens when a reader has stalled for a whole ring.
+ */
+class cISBridgeBroadcastRing
+{
+public:
+    /**
+     * Constructor
+     * @param capacity slots, rounded up to a power of two
+     * @param readerCount number of readers, each identified by an index below it
+     */
+    cISBridgeBroadcastRing(size_t capacity, int readerCount);
+
+    /**
+     * Publish messages to every reader. Producer thread only.
+     * @param messages the messages, in order
+     * @param count number of messages
+     * @return number published; the rest were dropped
+     */
+    int Publish(const cISBridgeBufferRef* messages, int count);
+
+    /**
+     * Take the next messages for one reader. Each reader index is used by one thread.
+     * @param reader reader index
+     * @param messages receives up to maxCount messages
+     * @param maxCount capacity of messages
+     * @return number taken, 0 when the reader is up to date
+     */
+    int Read(int reader, cISBridgeBufferRef* messages, int maxCount);
+
+    sISBridgeBroadcastRingStats GetStats() const;
+
+private:
+    cISBridgeBroadcastRing(const cISBridgeBroadcastRing&) = delete;
+    cISBridgeBroadcastRing& operator=(const cISBridgeBroadcastRing&) = delete;
+
+    struct sSlot
+    {
+        cISBridgeBufferRef buffer;
+        std::atomic<int> pending;       // Readers still to take the buffer
+    };
+
+    struct alignas(64) sCursor
+    {
+        std::atomic<uint64_t> next;     // Next position the reader takes
+    };
+
+    std::unique_ptr<sSlot[]> m_slots;
+    size_t m_mask;
+    int m_readerCount;
+    std::unique_ptr<sCursor[]> m_cursors;
+    alignas(64) std::atomic<uint64_t> m_head;   // Positions below this are published
+    std::atomic<uint64_t> m_published;
+    std::atomic<uint64_t> m_dropped;
+};
+
+#endif // __ISBRIDGEBROADCASTRING__H__
@@ -0,0 +1,334 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEBUFFER__H__
+#define __ISBRIDGEBUFFER__H__
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+class cISBridgeBufferPool;
+
+/**
+ * Reference counted message buffer
+ *
+ * One buffer holds one forwarded message. Fan-out to several TCP clients shares the
+ * same buffer by reference; the memory is released when the last reference drops.
+ * Buffers normally come from a cISBridgeBufferPool and go back to it on release.
+ * A buffer can also wrap memory owned by something else (e.g. a received zmq_msg_t
+ * constructed in Storage()); the release hook then frees it before the buffer is
+ * recycled. Use cISBridgeBufferRef rather than calling AddRef()/Release() directly.
+ */
+class cISBridgeBuffer
+{
+public:
+    typedef void (*release_hook_t)(cISBridgeBuffer* buffer);
+
+    /**
+     * Bytes of inline storage available through Storage()
+     */
+    static const size_t kStorageSize = 64;
+
+    /**
+     * Allocate a buffer from the heap with a reference count of one
+     * @param capacity number of bytes the buffer can hold
+     * @return the buffer, or NULL if allocation failed
+     */
+    static cISBridgeBuffer* Create(size_t capacity);
+
+    void AddRef() { m_refCount.fetch_add(1, std::memory_order_relaxed); }
+
+    void Release()
+    {
+        if (m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Destroy();
+        }
+    }
+
+    /**
+     * @return true if another reference exists, so the contents must not be modified
+     */
+    bool IsShared() const { return m_refCount.load(std::memory_order_acquire) > 1; }
+
+    uint8_t* Data() { return m_data; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_capacity; }
+
+    /**
+     * Set the number of valid bytes, clamped to Capacity()
+     */
+    void SetSize(size_t size) { m_size = (size < m_capacity) ? size : m_capacity; }
+
+    /**
+     * Inline, suitably aligned storage for an object that owns external data
+     */
+    void* Storage() { return m_storage; }
+
+    /**
+     * Point the buffer at memory it does not own
+     * @param data the external data
+     * @param size number of valid bytes
+     */
+    void SetExternal(uint8_t* data, size_t size)
+    {
+        m_data = data;
+        m_size = size;
+        m_capacity = size;
+    }
+
+    /**
+     * Set a function run when the last reference drops, before the buffer is recycled
+     */
+    void SetReleaseHook(release_hook_t hook) { m_releaseHook = hook; }
+
+    /**
+     * Record what packet the buffer holds, as identified by the packet framer
+     * @param protocol eISBridgeProtocol value, 0 if unknown
+     * @param type protocol specific packet type (ISB packet type)
+     * @param id protocol specific packet identifier (ISB data ID, UBX class/id, RTCM3 message number)
+     */
+    void SetPacketInfo(uint8_t protocol, uint8_t type, uint16_t id)
+    {
+        m_protocol = protocol;
+        m_packetType = type;
+        m_packetId = id;
+    }
+
+    uint8_t Protocol() const { return m_protocol; }
+    uint8_t PacketType() const { return m_packetType; }
+    uint16_t PacketId() const { return m_packetId; }
+
+    /**
+     * Stamp the time the message entered the bridge, for latency histograms
+     * @param ns bridgeClockNs() value, 0 for none
+     */
+    void SetTimestamp(uint64_t ns) { m_timestampNs = ns; }
+    uint64_t Timestamp() const { return m_timestampNs; }
+
+    /**
+     * Tag the message as sampled for tracing
+     * @param id cISBridgeTraceRing record ID, 0 for none
+     */
+    void SetTraceId(uint64_t id) { m_traceId = id; }
+    uint64_t TraceId() const { return m_traceId; }
+
+private:
+    cISBridgeBuffer(cISBridgeBufferPool* pool, uint8_t* data, size_t capacity);
+    ~cISBridgeBuffer() {}
+    cISBridgeBuffer(const cISBridgeBuffer&) = delete;
+    cISBridgeBuffer& operator=(const cISBridgeBuffer&) = delete;
+
+    void Reset(uint8_t* data, size_t capacity);
+    void Destroy();
+
+    std::atomic<int> m_refCount;
+    size_t m_size;
+    size_t m_capacity;
+    uint8_t* m_data;
+    cISBridgeBufferPool* m_pool;    // NULL for heap buffers
+    release_hook_t m_releaseHook;
+    uint8_t m_protocol;
+    uint8_t m_packetType;
+    uint16_t m_packetId;
+    uint64_t m_timestampNs;
+    uint64_t m_traceId;
+    alignas(16) uint8_t m_storage[kStorageSize];
+
+    friend class cISBridgeBufferPool;
+};
+
+/**
+ * Owning handle to a cISBridgeBuffer (intrusive smart pointer)
+ */
+class cISBridgeBufferRef
+{
+public:
+    cISBridgeBufferRef() : m_buffer(NULL) {}
+
+    /**
+     * Adopt a buffer without adding a reference (e.g. straight from Create())
+     */
+    explicit cISBridgeBufferRef(cISBridgeBuffer* buffer) : m_buffer(buffer) {}
+
+    cISBridgeBufferRef(const cISBridgeBufferRef& other) : m_buffer(other.m_buffer)
+    {
+        if (m_buffer)
+        {
+            m_buffer->AddRef();
+        }
+    }
+
+    cISBridgeBufferRef(cISBridgeBufferRef&& other) noexcept : m_buffer(other.m_buffer) { other.m_buffer = NULL; }
+
+    ~cISBridgeBufferRef() { Reset(); }
+
+    cISBridgeBufferRef& operator=(const cISBridgeBufferRef& other)
+    {
+        if (this != &other)
+        {
+            cISBridgeBufferRef tmp(other);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    cISBridgeBufferRef& operator=(cISBridgeBufferRef&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_buffer = other.m_buffer;
+            other.m_buffer = NULL;
+        }
+        return *this;
+    }
+
+    void Reset()
+    {
+        if (m_buffer)
+        {
+            m_buffer->Release();
+            m_buffer = NULL;
+        }
+    }
+
+    /**
+     * Give up ownership without releasing; the caller now owns one reference
+     */
+    cISBridgeBuffer* Detach()
+    {
+        cISBridgeBuffer* buffer = m_buffer;
+        m_buffer = NULL;
+        return buffer;
+    }
+
+    void Swap(cISBridgeBufferRef& other)
+    {
+        cISBridgeBuffer* tmp = m_buffer;
+        m_buffer = other.m_buffer;
+        other.m_buffer = tmp;
+    }
+
+    cISBridgeBuffer* Get() const { return m_buffer; }
+    cISBridgeBuffer* operator->() const { return m_buffer; }
+    explicit operator bool() const { return m_buffer != NULL; }
+
+private:
+    cISBridgeBuffer* m_buffer;
+};
+
+/**
+ * Buffer pool counters
+ */
+struct sISBridgeBufferPoolStats
+{
+    size_t blockSize = 0;
+    size_t blockCount = 0;
+    size_t blocksInUse = 0;
+    uint64_t acquired = 0;              // Buffers handed out, pooled or not
+    uint64_t heapAllocations = 0;       // Acquisitions that fell back to the heap (pool empty or request too large)
+};
+
+/**
+ * Fixed-size buffer pool
+ *
+ * All blocks are carved out of one arena allocated up front, so steady-state traffic
+ * never touches the heap. Acquire() and the release path are lock free (tagged-index
+ * Treiber stack) and may run on any thread, including libzmq I/O threads via
+ * zmq_msg_init_data() free callbacks. Requests larger than the block size, or made
+ * while the pool is empty, fall back to the heap and are counted in heapAllocations.
+ * A pool destroyed directly must outlive every buffer it hands out. When buffers can
+ * outlive the owner (they reach libzmq, consumers or application code), allocate the
+ * pool with new and let go of it with Retire() instead, e.g. through
+ * sISBridgeBufferPoolRetire; it is then freed when its last buffer comes back.
+ */
+class cISBridgeBufferPool
+{
+public:
+    /**
+     * Constructor
+     * @param blockSize data bytes per block, 0 for header-only blocks used with SetExternal()
+     * @param blockCount number of blocks in the arena
+     */
+    cISBridgeBufferPool(size_t blockSize, size_t blockCount);
+
+    ~cISBridgeBufferPool();
+
+    /**
+     * Get a buffer with a reference count of one
+     * @param size bytes needed
+     * @return the buffer, empty only if the heap fallback also failed
+     */
+    cISBridgeBufferRef Acquire(size_t size);
+
+    /**
+     * Get a buffer that views part of another buffer without copying. The view keeps
+     * the parent alive until the view is released.
+     * @param parent the buffer to view
+     * @param offset first byte of the view within parent
+     * @param size number of bytes in the view
+     * @return the view, empty if the range is invalid or allocation failed
+     */
+    cISBridgeBufferRef Slice(const cISBridgeBufferRef& parent, size_t offset, size_t size);
+
+    /**
+     * Give up the owner's hold on a pool allocated with new. The pool deletes itself as
+     * soon as no buffer it handed out is in use, which may be right away. Must not be
+     * used by the owner afterwards.
+     */
+    void Retire();
+
+    size_t BlockSize() const { return m_blockSize; }
+
+    sISBridgeBufferPoolStats GetStats() const;
+
+private:
+    cISBridgeBufferPool(const cISBridgeBufferPool&) = delete;
+    cISBridgeBufferPool& operator=(const cISBridgeBufferPool&) = delete;
+
+    static const uint32_t kNil = 0xFFFFFFFF;
+
+    cISBridgeBuffer* Block(uint32_t index) { return reinterpret_cast<cISBridgeBuffer*>(m_arena.get() + index * m_stride); }
+    uint32_t Pop();
+    void Push(uint32_t index);
+    void Return(cISBridgeBuffer* buffer);
+    static void ReleaseSliceParent(cISBridgeBuffer* buffer);
+
+    size_t m_blockSize;
+    size_t m_blockCount;
+    size_t m_stride;
+    std::unique_ptr<uint8_t[]> m_arena;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint64_t> m_head;       // Free list head: ABA tag (high 32 bits) | block index (low 32 bits)
+    std::atomic<size_t> m_inUse;
+    std::atomic<size_t> m_holds;        // Blocks in use, plus one until Retire()
+    std::atomic<uint64_t> m_acquired;
+    std::atomic<uint64_t> m_heapAllocations;
+
+    friend class cISBridgeBuffer;
+};
+
+/**
+ * unique_ptr deleter that retires a pool rather than deleting it, see
+ * cISBridgeBufferPool::Retire()
+ */
+struct sISBridgeBufferPoolRetire
+{
+    void operator()(cISBridgeBufferPool* pool) const { pool->Retire(); }
+};
+
+#endif // __ISBRIDGEBUFFER__H__
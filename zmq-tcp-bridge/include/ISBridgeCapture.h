@@ -0,0 +1,259 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGECAPTURE__H__
+#define __ISBRIDGECAPTURE__H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeRecordRing.h"
+
+/**
+ * What a capture record holds
+ */
+typedef enum
+{
+    BRIDGE_CAPTURE_ZMQ_TO_TCP = 0,          // Message received on the SUB socket
+    BRIDGE_CAPTURE_TCP_TO_ZMQ = 1,          // Bytes read from a TCP client
+    BRIDGE_CAPTURE_CLIENT_CONNECT = 2,      // TCP client accepted, no payload
+    BRIDGE_CAPTURE_CLIENT_DISCONNECT = 3,   // TCP client gone, no payload
+} eISBridgeCaptureDirection;
+
+#define BRIDGE_CAPTURE_MAGIC            "ISBCAP01"
+#define BRIDGE_CAPTURE_VERSION          1
+
+/**
+ * Header at the start of every capture segment file
+ */
+struct sISBridgeCaptureFileHeader
+{
+    char magic[8];                  // BRIDGE_CAPTURE_MAGIC, not NUL terminated
+    uint32_t version;               // BRIDGE_CAPTURE_VERSION
+    uint32_t headerSize;            // sizeof(sISBridgeCaptureFileHeader); records start here
+    uint32_t segmentIndex;          // 0 for <path>.000, 1 for <path>.001, ...
+    uint32_t reserved;
+    uint64_t startClockNs;          // bridgeClockNs() when the capture was opened
+    uint64_t startWallNs;           // Wall clock (ns since the Unix epoch) at startClockNs
+};
+
+/**
+ * Header in front of every record. Records are padded to 8 bytes; a zero length marks
+ * the end of the data in a segment that was not closed cleanly.
+ */
+struct sISBridgeCaptureRecordHeader
+{
+    uint32_t length;                // Header plus payload bytes, excluding padding
+    uint8_t direction;              // eISBridgeCaptureDirection
+    uint8_t reserved[3];
+    uint32_t clientId;              // TCP connection number, 0 for ZMQ → TCP and cISZmqTcpBridge::Inject()
+    uint32_t reserved2;
+    uint64_t timestampNs;           // bridgeClockNs(), never decreasing within a capture
+};
+
+/**
+ * One record returned by cISBridgeCaptureReader
+ */
+struct sISBridgeCaptureRecord
+{
+    eISBridgeCaptureDirection direction;
+    uint32_t clientId;
+    uint64_t timestampNs;
+    const uint8_t* data;            // Points into the mapped segment
+    size_t size;
+};
+
+/**
+ * Capture writer counters
+ */
+struct sISBridgeCaptureStats
+{
+    uint64_t records = 0;
+    uint64_t bytes = 0;             // Payload bytes written
+    uint64_t droppedRecords = 0;    // Ring full, record too large or write failure
+    uint64_t droppedBytes = 0;
+    uint64_t segments = 0;          // Segment files started
+};
+
+/**
+ * Append-only capture of bridge traffic
+ *
+ * Forwarding threads hand each message to Record(), which copies it into a lock-free
+ * ring and returns; it never blocks and never touches the file. A background thread
+ * drains the rings in timestamp order into memory-mapped segment files <path>.000,
+ * <path>.001, ..., each preallocated to the segment size and trimmed to its used
+ * length when closed. When a ring is full the record is dropped and counted, so a slow
+ * disk costs capture completeness rather than forwarding latency.
+ *
+ * ZMQ → TCP records and all other records come from separate rings, so the ZMQ thread
+ * and the TCP reactor thread may record concurrently. Each ring has one producer.
+ */
+class cISBridgeCaptureWriter
+{
+public:
+    /** Default size of each segment file */
+    static const size_t kDefaultSegmentBytes = 64 * 1024 * 1024;
+
+    /** Default size of each producer ring */
+    static const size_t kDefaultRingBytes = 4 * 1024 * 1024;
+
+    cISBridgeCaptureWriter();
+    ~cISBridgeCaptureWriter();
+
+    /**
+     * Create the first segment and start the writer thread
+     * @param path segment files are named path.000, path.001, ...
+     * @param segmentBytes size of each segment file
+     * @param ringBytes size of each producer ring; bounds the largest message captured
+     * @return 0 if success, otherwise an error code
+     */
+    int Open(const std::string& path, size_t segmentBytes = kDefaultSegmentBytes, size_t ringBytes = kDefaultRingBytes);
+
+    /**
+     * Write out everything recorded so far, stop the writer thread and close the
+     * last segment. Producers must have stopped calling Record().
+     */
+    void Close();
+
+    bool IsOpen() const { return m_thread != nullptr; }
+
+    /**
+     * Queue one record for the writer thread. Does not block. Call ZMQ → TCP records
+     * from one thread and all other records from one (possibly different) thread.
+     * @param direction what the record holds
+     * @param clientId TCP connection number, 0 for ZMQ → TCP
+     * @param data payload, may be NULL for connect / disconnect
+     * @param size payload bytes
+     * @param timestampNs bridgeClockNs() when the data was received
+     */
+    void Record(eISBridgeCaptureDirection direction, uint32_t clientId, const uint8_t* data, size_t size, uint64_t timestampNs);
+
+    /**
+     * @return counters since Open(). Safe from any thread.
+     */
+    sISBridgeCaptureStats GetStats() const;
+
+    /**
+     * @return file name of one segment
+     */
+    static std::string SegmentPath(const std::string& path, uint32_t index);
+
+private:
+    cISBridgeCaptureWriter(const cISBridgeCaptureWriter&) = delete;
+    cISBridgeCaptureWriter& operator=(const cISBridgeCaptureWriter&) = delete;
+
+    enum { kRingZmq = 0, kRingTcp = 1, kRingCount = 2 };
+
+    void WriterThread();
+
+    /**
+     * Move every queued record to the segment, oldest first
+     * @return number of records written
+     */
+    int Drain();
+
+    /**
+     * Append one record, starting a new segment when it does not fit
+     * @return 0 if success, -1 if the segment could not be written
+     */
+    int Append(const sISBridgeCaptureRecordHeader& header, const uint8_t* payload, size_t size);
+
+    int OpenSegment(uint32_t index);
+    void CloseSegment();
+
+    std::string m_path;
+    size_t m_segmentBytes;
+    std::unique_ptr<cISBridgeRecordRing> m_rings[kRingCount];
+    std::unique_ptr<std::thread> m_thread;
+    std::atomic<bool> m_running;
+
+    // Current segment, only touched by the writer thread
+    int m_fd;
+    uint8_t* m_map;
+    size_t m_used;
+    uint32_t m_segmentIndex;
+    uint64_t m_lastTimestampNs;
+    uint64_t m_startClockNs;
+    uint64_t m_startWallNs;
+    bool m_failed;
+
+    struct sCounters
+    {
+        std::atomic<uint64_t> records = { 0 };
+        std::atomic<uint64_t> bytes = { 0 };
+        std::atomic<uint64_t> droppedRecords = { 0 };
+        std::atomic<uint64_t> droppedBytes = { 0 };
+        std::atomic<uint64_t> segments = { 0 };
+    };
+    sCounters m_counters;
+};
+
+/**
+ * Sequential reader for capture files written by cISBridgeCaptureWriter
+ *
+ * Maps every segment read-only at Open(). Record data points into the mappings and
+ * stays valid until Close().
+ */
+class cISBridgeCaptureReader
+{
+public:
+    cISBridgeCaptureReader();
+    ~cISBridgeCaptureReader();
+
+    /**
+     * Map path.000, path.001, ... until the next segment is missing
+     * @param path the path given to cISBridgeCaptureWriter::Open()
+     * @return 0 if success, otherwise an error code
+     */
+    int Open(const std::string& path);
+
+    void Close();
+
+    /**
+     * Read the next record
+     * @param record receives the record
+     * @return false at the end of the capture
+     */
+    bool Next(sISBridgeCaptureRecord& record);
+
+    /**
+     * Start over from the first record
+     */
+    void Rewind();
+
+    /**
+     * @return header of the first segment
+     */
+    const sISBridgeCaptureFileHeader& Header() const { return m_header; }
+
+private:
+    cISBridgeCaptureReader(const cISBridgeCaptureReader&) = delete;
+    cISBridgeCaptureReader& operator=(const cISBridgeCaptureReader&) = delete;
+
+    struct sSegment
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    std::vector<sSegment> m_segments;
+    sISBridgeCaptureFileHeader m_header;
+    size_t m_segment;
+    size_t m_offset;
+};
+
+#endif // __ISBRIDGECAPTURE__H__
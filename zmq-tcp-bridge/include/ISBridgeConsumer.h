@@ -0,0 +1,89 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGECONSUMER__H__
+#define __ISBRIDGECONSUMER__H__
+
+#include <atomic>
+#include <stddef.h>
+#include "ISBridgeBuffer.h"
+#include "ISBridgeMpscQueue.h"
+#include "ISBridgeWakeup.h"
+
+/**
+ * In-process receiver of ZMQ → TCP messages, registered with
+ * cISZmqTcpBridge::AddConsumer()
+ *
+ * Sees exactly what TCP clients are sent (after framing, when enabled), without the
+ * TCP loopback: messages are shared by reference, never copied. Called on the thread
+ * forwarding ZMQ → TCP, so it must return quickly and must not call AddConsumer() or
+ * RemoveConsumer().
+ */
+class iISBridgeConsumer
+{
+public:
+    virtual ~iISBridgeConsumer() {}
+
+    /**
+     * Messages forwarded from ZMQ, in order
+     * @param messages the messages; copy a reference to keep one past the call, for as
+     *        long as needed, also after the bridge has stopped
+     * @param count number of messages
+     */
+    virtual void OnBridgeMessages(const cISBridgeBufferRef* messages, int count) = 0;
+};
+
+/**
+ * Consumer that hands messages to a reader thread through a bounded lock-free queue
+ *
+ * The forwarding thread only pushes references, so a slow reader never delays TCP
+ * clients; when the queue is full, new messages are dropped and counted. One thread
+ * reads with Pop(), blocking on Fd() when it runs dry. Messages still queued when the
+ * bridge stops stay valid and are released with the queue.
+ */
+class cISBridgeConsumerQueue : public iISBridgeConsumer
+{
+public:
+    /**
+     * Constructor
+     * @param capacity maximum queued messages, rounded up to a power of two
+     */
+    explicit cISBridgeConsumerQueue(size_t capacity = 4096);
+
+    /**
+     * Take the oldest message. Reader thread only.
+     * @param buffer receives the message
+     * @return false if none is queued
+     */
+    bool Pop(cISBridgeBufferRef& buffer);
+
+    /**
+     * @return descriptor readable once messages are queued; call Pop() until it
+     * returns false before waiting on it again
+     */
+    int Fd() const { return m_wakeup.Fd(); }
+
+    /**
+     * @return occupancy and drop counters
+     */
+    sISBridgeMpscQueueStats GetStats() const { return m_queue.GetStats(); }
+
+    void OnBridgeMessages(const cISBridgeBufferRef* messages, int count) override;
+
+private:
+    cISBridgeMpscQueue m_queue;
+    cISBridgeWakeup m_wakeup;
+    std::atomic<bool> m_signalled;      // Set by the first push after the reader ran dry
+};
+
+#endif // __ISBRIDGECONSUMER__H__
@@ -0,0 +1,141 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEDIDFILTER__H__
+#define __ISBRIDGEDIDFILTER__H__
+
+#include <atomic>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+#include "ISBridgePacketFramer.h"
+
+/**
+ * Plain set of InertialSense data IDs, used for subscription snapshots
+ */
+struct sISBridgeDidSet
+{
+    static const int kWordCount = 4;    // 256 data IDs, one bit each
+
+    bool all = true;                    // Every DID wanted (some client does not filter)
+    bool rmc = false;                   // Client streams through DID_RMC; only set by cISBridgeDidFilter::Export()
+    uint64_t words[kWordCount] = {};
+
+    bool Contains(uint8_t did) const { return all || (words[did >> 6] & (1ULL << (did & 63))) != 0; }
+
+    bool operator==(const sISBridgeDidSet& other) const
+    {
+        if (rmc != other.rmc)
+        {
+            return false;
+        }
+        if (all || other.all)
+        {
+            return all == other.all;
+        }
+        for (int i = 0; i < kWordCount; i++)
+        {
+            if (words[i] != other.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const sISBridgeDidSet& other) const { return !(*this == other); }
+};
+
+// Data ID of the realtime message controller (DID_RMC in the SDK's data_sets.h), whose
+// rmc_t starts with a u64 of stream enable bits
+#define BRIDGE_ISB_DID_RMC      9
+
+/**
+ * Per-client data ID subscription
+ *
+ * Tracks which ISB data IDs a TCP client has asked for by watching the commands it sends
+ * to the device. A get-data command (DID from its p_data_get_t payload) with a nonzero
+ * period subscribes to that DID and activates the filter; stop-DID-broadcast removes it.
+ * A client that has not asked for a DID this way is inactive and receives everything, so
+ * clients that never request data (or speak NMEA/RTCM3 only) behave exactly as without
+ * filtering.
+ *
+ * Stop-all-broadcasts clears the set and makes the filter inactive again, because SDK
+ * clients send it first and then enable streams either by get-data or through DID_RMC.
+ * RMC bits do not map onto data IDs, so a client that sets nonzero RMC bits stays
+ * unfiltered until it stops all broadcasts.
+ *
+ * Only ISB DATA packets are filtered; ACK/NACK, other ISB types and NMEA, RTCM3 and UBX
+ * traffic always pass. Updated by the reactor thread and read by the ZMQ-to-TCP thread,
+ * so the bits are atomics and Accepts() costs one relaxed load.
+ */
+class cISBridgeDidFilter
+{
+public:
+    cISBridgeDidFilter();
+
+    /**
+     * Update the subscription from a packet the client sent
+     * @param packet a framed packet from the client
+     * @return true if the subscription changed
+     */
+    bool ApplyCommand(const sISBridgePacket& packet);
+
+    /**
+     * @return true if a packet should be forwarded to this client
+     */
+    bool Accepts(const cISBridgeBuffer& buffer) const
+    {
+        if (!m_active.load(std::memory_order_relaxed) ||
+            buffer.Protocol() != BRIDGE_PROTOCOL_ISB ||
+            buffer.PacketType() != BRIDGE_ISB_PKT_TYPE_DATA)
+        {
+            return true;
+        }
+        uint8_t did = static_cast<uint8_t>(buffer.PacketId());
+        return (m_words[did >> 6].load(std::memory_order_relaxed) & (1ULL << (did & 63))) != 0;
+    }
+
+    /**
+     * @return true while only subscribed data IDs are forwarded to the client
+     */
+    bool IsActive() const { return m_active.load(std::memory_order_relaxed); }
+
+    /**
+     * Add this client's wanted data IDs to a set
+     * @param set the union being built; set.all must be false
+     */
+    void MergeInto(sISBridgeDidSet& set) const;
+
+    /**
+     * Copy the subscription, e.g. to hand the client over to another process
+     * @param set receives the wanted data IDs; all is set while the client is inactive,
+     *        rmc while it streams through DID_RMC
+     */
+    void Export(sISBridgeDidSet& set) const;
+
+    /**
+     * Replace the subscription with one from Export(), including whether the client
+     * streams through DID_RMC, so its next get-data does not start filtering either
+     */
+    void Import(const sISBridgeDidSet& set);
+
+private:
+    void Add(uint8_t did);
+    void Remove(uint8_t did);
+    void Clear();
+
+    std::atomic<bool> m_active;
+    std::atomic<bool> m_rmc;            // Client enabled RMC streams; written by ApplyCommand() and Import()
+    std::atomic<uint64_t> m_words[sISBridgeDidSet::kWordCount];
+};
+
+#endif // __ISBRIDGEDIDFILTER__H__
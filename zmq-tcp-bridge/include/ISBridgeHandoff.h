@@ -0,0 +1,113 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEHANDOFF__H__
+#define __ISBRIDGEHANDOFF__H__
+
+#include <string>
+#include <vector>
+#include "ISBridgeTcpReactor.h"
+
+/**
+ * Sockets a bridge hands to the process replacing it
+ */
+struct sISBridgeHandoffState
+{
+    std::vector<is_socket_t> listenSockets;             // One per TCP shard
+    std::vector<sISBridgeTcpHandoffClient> clients;
+
+    /**
+     * Close every socket still held
+     */
+    void Close();
+};
+
+/**
+ * Hand-off of live sockets between bridge processes (Linux only)
+ *
+ * The running bridge listens on a Unix socket path. A new bridge connects to it, the
+ * running one stops forwarding and sends its listening and client sockets with their
+ * subscriptions as SCM_RIGHTS ancillary data over a SOCK_SEQPACKET connection. Once the
+ * new bridge has adopted them all it acknowledges, and only then does the old one close
+ * its copies and exit; without an acknowledgement it resumes serving the same sockets.
+ * The kernel keeps every connection open throughout, so SDK clients see a pause in data
+ * instead of a disconnect.
+ */
+
+/**
+ * Listen for a bridge that wants to take over, replacing any stale socket at path
+ * @param path Unix socket path
+ * @return the listening socket, -1 on error
+ */
+int bridgeHandoffListen(const std::string& path);
+
+/**
+ * Wait for a bridge to connect to the hand-off socket
+ * @param listenSocket socket from bridgeHandoffListen()
+ * @param timeoutMs longest wait
+ * @return the connection, -1 on timeout or error
+ */
+int bridgeHandoffAccept(int listenSocket, int timeoutMs);
+
+/**
+ * Close a socket from bridgeHandoffListen(), bridgeHandoffAccept() or bridgeHandoffConnect()
+ * @param socket the socket
+ * @param path Unix socket path to remove as well, empty to leave it (e.g. after a
+ *        hand-off it belongs to the new bridge)
+ */
+void bridgeHandoffClose(int socket, const std::string& path = std::string());
+
+/**
+ * Connect to the bridge listening at path to take over from it
+ * @param path Unix socket path
+ * @return the connected socket, -1 if no bridge is listening there
+ */
+int bridgeHandoffConnect(const std::string& path);
+
+/**
+ * Send the sockets to the new bridge. The caller still owns and closes its copies.
+ * @param socket connection accepted from the listening socket
+ * @param state the sockets
+ * @return 0 if success, -1 on error
+ */
+int bridgeHandoffSend(int socket, const sISBridgeHandoffState& state);
+
+/**
+ * Wait for the new bridge to acknowledge the sockets sent with bridgeHandoffSend()
+ * @param socket connection accepted from the listening socket
+ * @param state the sockets that were sent
+ * @param timeoutMs longest wait
+ * @return 0 once acknowledged, -1 on timeout, error or if the new bridge hung up
+ */
+int bridgeHandoffWaitAcknowledge(int socket, const sISBridgeHandoffState& state, int timeoutMs);
+
+/**
+ * Receive the sockets from the old bridge
+ * @param socket connection from bridgeHandoffConnect()
+ * @param state receives the sockets, which the caller then owns
+ * @param timeoutMs longest wait for each message
+ * @return 0 if success, -1 on error or timeout (nothing is left open)
+ */
+int bridgeHandoffReceive(int socket, sISBridgeHandoffState& state, int timeoutMs);
+
+/**
+ * Tell the old bridge that every socket received has been adopted, so it may close its
+ * copies. Send only once the sockets are served; until then the old bridge can resume.
+ * @param socket connection from bridgeHandoffConnect()
+ * @param listenCount number of listening sockets received
+ * @param clientCount number of client sockets received
+ * @return 0 if success, -1 if the old bridge is gone (it may have resumed)
+ */
+int bridgeHandoffAcknowledge(int socket, size_t listenCount, size_t clientCount);
+
+#endif // __ISBRIDGEHANDOFF__H__
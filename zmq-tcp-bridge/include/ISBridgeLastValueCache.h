@@ -0,0 +1,104 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGELASTVALUECACHE__H__
+#define __ISBRIDGELASTVALUECACHE__H__
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+#include "ISBridgeDidFilter.h"
+
+/**
+ * Last-value cache statistics
+ */
+struct sISBridgeLastValueCacheStats
+{
+    size_t entries = 0;                 // Data IDs currently cached
+    size_t bytes = 0;                   // Buffer capacity held by the cache
+    uint64_t updates = 0;               // Packets stored
+    uint64_t rejected = 0;              // Packets not stored because the byte budget was full
+    uint64_t snapshots = 0;             // Snapshots handed to new clients
+    uint64_t snapshotMessages = 0;      // Packets sent in those snapshots
+};
+
+/**
+ * Most recent ISB data packet per data ID
+ *
+ * Fed from the ZMQ → TCP path with framed packets. A newly accepted client is sent a
+ * snapshot of every cached packet before it joins the live stream, so slow messages
+ * such as DEV_INFO, flash config or RTK status are available immediately instead of at
+ * their next publication.
+ *
+ * Memory is bounded by the byte budget: a packet that would take the cache over it is
+ * not stored. Each data ID keeps its own buffer and overwrites it in place once no
+ * client queue still references it, so the steady state does not allocate.
+ */
+class cISBridgeLastValueCache
+{
+public:
+    /** Default byte budget */
+    static const size_t kDefaultMaxBytes = 256 * 1024;
+
+    cISBridgeLastValueCache();
+
+    /**
+     * Choose what to cache and drop every cached packet
+     * @param dids data IDs to cache; dids.all caches every ID
+     * @param maxBytes byte budget for all cached packets
+     */
+    void Configure(const sISBridgeDidSet& dids, size_t maxBytes);
+
+    /**
+     * Drop every cached packet
+     */
+    void Clear();
+
+    /**
+     * Remember a packet if it is ISB data for a cached data ID. Call before the packet
+     * is broadcast, so a concurrent snapshot is never older than the live stream.
+     * @param packet framed packet (see cISBridgeBuffer::SetPacketInfo())
+     */
+    void Update(const cISBridgeBuffer& packet);
+
+    /**
+     * Append a reference to every cached packet, in data ID order
+     * @param out receives the packets
+     * @return number of packets appended
+     */
+    int Snapshot(std::vector<cISBridgeBufferRef>& out);
+
+    sISBridgeLastValueCacheStats GetStats() const;
+
+private:
+    cISBridgeLastValueCache(const cISBridgeLastValueCache&) = delete;
+    cISBridgeLastValueCache& operator=(const cISBridgeLastValueCache&) = delete;
+
+    static const int kDidCount = 256;
+
+    mutable std::mutex m_mutex;         // Update() runs on the ZMQ thread, Snapshot() on the reactor thread
+    sISBridgeDidSet m_dids;
+    size_t m_maxBytes;
+    size_t m_bytes;
+    size_t m_entries;
+    cISBridgeBufferRef m_values[kDidCount];
+    uint64_t m_updates;
+    uint64_t m_rejected;
+    uint64_t m_snapshots;
+    uint64_t m_snapshotMessages;
+};
+
+#endif // __ISBRIDGELASTVALUECACHE__H__
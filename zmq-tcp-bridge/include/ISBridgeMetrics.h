@@ -0,0 +1,148 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEMETRICS__H__
+#define __ISBRIDGEMETRICS__H__
+
+#include <atomic>
+#include <bit>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Add to a statistics counter. Relaxed: counters are only summed for reporting and
+ * never order other memory, so recording is one uncontended locked add.
+ */
+inline void bridgeCounterAdd(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+/**
+ * Monotonic clock in nanoseconds, used for latency stamps
+ */
+uint64_t bridgeClockNs();
+
+/**
+ * Latency histogram snapshot
+ */
+struct sISBridgeHistogramStats
+{
+    uint64_t count = 0;
+    uint64_t sumNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t p50Ns = 0;
+    uint64_t p90Ns = 0;
+    uint64_t p99Ns = 0;
+    uint64_t p999Ns = 0;
+};
+
+/**
+ * Lock-free HDR-style histogram
+ *
+ * Log-linear buckets: values below 16 are exact, above that each power of two is split
+ * into 16 linear sub-buckets, so any recorded value is reported within 6.25% over the
+ * full 64-bit range. Record() is a bucket index computed from the leading zero count and
+ * two relaxed atomic adds, cheap enough to leave on in production. Any thread may record
+ * and snapshot concurrently.
+ */
+class cISBridgeHistogram
+{
+public:
+    static const int kSubBucketBits = 4;
+    static const int kSubBucketCount = 1 << kSubBucketBits;
+    static const int kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    cISBridgeHistogram();
+
+    /**
+     * Record one value
+     * @param value the value, in nanoseconds for latencies
+     */
+    void Record(uint64_t value)
+    {
+        m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /**
+     * Add this histogram's counts to another, e.g. to aggregate routes
+     */
+    void MergeInto(cISBridgeHistogram& other) const;
+
+    /**
+     * @return count, sum, max and percentiles (bucket upper bounds)
+     */
+    sISBridgeHistogramStats Stats() const;
+
+    /**
+     * Clear all counts
+     */
+    void Reset();
+
+    static int BucketIndex(uint64_t value)
+    {
+        if (value < static_cast<uint64_t>(kSubBucketCount))
+        {
+            return static_cast<int>(value);
+        }
+        int shift = (static_cast<int>(std::bit_width(value)) - 1) - kSubBucketBits;
+        return (shift + 1) * kSubBucketCount + static_cast<int>((value >> shift) & (kSubBucketCount - 1));
+    }
+
+    /**
+     * @return largest value that falls in a bucket
+     */
+    static uint64_t BucketUpperBound(int index);
+
+private:
+    cISBridgeHistogram(const cISBridgeHistogram&) = delete;
+    cISBridgeHistogram& operator=(const cISBridgeHistogram&) = delete;
+
+    std::atomic<uint64_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+/**
+ * Format a histogram as a Prometheus summary (seconds)
+ * @param name metric name without suffix
+ * @param labels label text without braces (e.g. route="8000"), may be empty
+ * @param stats the histogram snapshot
+ * @param out text is appended here
+ */
+void bridgeFormatPrometheusSummary(const char* name, const std::string& labels, const sISBridgeHistogramStats& stats, std::string& out);
+
+/**
+ * Format one Prometheus sample
+ * @param name metric name
+ * @param labels label text without braces, may be empty
+ * @param value the sample value
+ * @param out text is appended here
+ */
+void bridgeFormatPrometheusSample(const char* name, const std::string& labels, uint64_t value, std::string& out);
+
+/**
+ * Escape a Prometheus label value: backslash, double quote and newline
+ * @param value the raw value, e.g. a ZMQ endpoint
+ * @return text safe to place between the label's quotes
+ */
+std::string bridgePrometheusLabelValue(const std::string& value);
+
+#endif // __ISBRIDGEMETRICS__H__
@@ -0,0 +1,84 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEMETRICSSERVER__H__
+#define __ISBRIDGEMETRICSSERVER__H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "ISBridgeWakeup.h"
+
+/**
+ * Minimal HTTP endpoint serving Prometheus text
+ *
+ * Listens on a local TCP port and answers every request with the text produced by the
+ * render callback, so the bridge can be scraped without another dependency. Requests
+ * are handled one at a time on the server's own thread and never touch the forwarding
+ * threads; the callback only reads lock-free counters.
+ */
+class cISBridgeMetricsServer
+{
+public:
+    typedef std::function<std::string()> render_t;
+
+    cISBridgeMetricsServer();
+    ~cISBridgeMetricsServer();
+
+    /**
+     * Start serving
+     * @param port TCP port to listen on
+     * @param render produces the response body for each scrape
+     * @param bindAddress address to bind; loopback by default so metrics stay local
+     * @return 0 if success, otherwise an error code
+     */
+    int Start(int port, render_t render, const std::string& bindAddress = "127.0.0.1");
+
+    /**
+     * Stop serving and join the server thread
+     */
+    void Stop();
+
+    bool IsRunning() const { return bridgeSocketValid(m_listenSocket); }
+
+    /**
+     * @return the port being served, also when Start() was given 0, or -1 if not running
+     */
+    int Port() const;
+
+    /**
+     * Longest time a connection may take to send its request
+     */
+    static const int kRequestTimeoutMs = 1000;
+
+private:
+    cISBridgeMetricsServer(const cISBridgeMetricsServer&) = delete;
+    cISBridgeMetricsServer& operator=(const cISBridgeMetricsServer&) = delete;
+
+    void ServerThread();
+
+    /**
+     * Read the request head and write the response, then close the connection
+     */
+    void HandleConnection(is_socket_t socket);
+
+    is_socket_t m_listenSocket;
+    render_t m_render;
+    cISBridgeWakeup m_wakeup;
+    std::atomic<bool> m_running;
+    std::unique_ptr<std::thread> m_thread;
+};
+
+#endif // __ISBRIDGEMETRICSSERVER__H__
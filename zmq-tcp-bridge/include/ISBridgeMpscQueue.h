@@ -0,0 +1,105 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEMPSCQUEUE__H__
+#define __ISBRIDGEMPSCQUEUE__H__
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+
+/**
+ * MPSC queue occupancy and counters
+ */
+struct sISBridgeMpscQueueStats
+{
+    size_t capacity = 0;
+    size_t queued = 0;                  // Messages waiting for the consumer
+    size_t highWatermark = 0;           // Largest queued seen by the consumer
+    uint64_t pushed = 0;
+    uint64_t dropped = 0;               // Pushes refused because the queue was full
+};
+
+/**
+ * Bounded lock-free multi-producer / single-consumer queue of buffers
+ *
+ * Each slot carries a sequence number (Vyukov's bounded queue): producers claim a slot
+ * with one compare-and-swap on the tail and publish it with a release store, so
+ * producers never wait on each other or on the consumer. A full queue refuses the push
+ * and the producer drops the message.
+ *
+ * Push() may be called from any thread; Pop() from one thread only.
+ */
+class cISBridgeMpscQueue
+{
+public:
+    /**
+     * Constructor
+     * @param capacity maximum queued messages, rounded up to a power of two
+     */
+    explicit cISBridgeMpscQueue(size_t capacity);
+
+    ~cISBridgeMpscQueue();
+
+    /**
+     * Append a message. Does not block.
+     * @param buffer the message; moved into the queue on success
+     * @return false if the queue is full
+     */
+    bool Push(cISBridgeBufferRef& buffer);
+
+    /**
+     * Remove the oldest message. Consumer thread only.
+     * @param buffer receives the message
+     * @return false if the queue is empty
+     */
+    bool Pop(cISBridgeBufferRef& buffer);
+
+    /**
+     * Release every queued message. Consumer thread only, or with producers stopped.
+     */
+    void Clear();
+
+    /**
+     * @return approximate number of queued messages
+     */
+    size_t Size() const;
+
+    /**
+     * @return counters. Safe from any thread.
+     */
+    sISBridgeMpscQueueStats GetStats() const;
+
+private:
+    cISBridgeMpscQueue(const cISBridgeMpscQueue&) = delete;
+    cISBridgeMpscQueue& operator=(const cISBridgeMpscQueue&) = delete;
+
+    struct sCell
+    {
+        std::atomic<uint64_t> sequence;     // Position the slot is ready for: pos when free, pos + 1 when full
+        cISBridgeBuffer* buffer;            // Reference owned by the queue
+    };
+
+    size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<sCell[]> m_cells;
+
+    alignas(64) std::atomic<uint64_t> m_tail;       // Next position to claim, shared by producers
+    std::atomic<uint64_t> m_dropped;
+    alignas(64) std::atomic<uint64_t> m_head;       // Next position to read, written by the consumer
+    std::atomic<size_t> m_highWatermark;
+};
+
+#endif // __ISBRIDGEMPSCQUEUE__H__
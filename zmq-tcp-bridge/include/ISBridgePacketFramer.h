@@ -0,0 +1,214 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEPACKETFRAMER__H__
+#define __ISBRIDGEPACKETFRAMER__H__
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Protocols recognized by cISBridgePacketFramer. Stored in cISBridgeBuffer::Protocol().
+ */
+enum eISBridgeProtocol
+{
+    BRIDGE_PROTOCOL_UNKNOWN = 0,
+    BRIDGE_PROTOCOL_ISB,        // InertialSense binary
+    BRIDGE_PROTOCOL_NMEA,
+    BRIDGE_PROTOCOL_RTCM3,
+    BRIDGE_PROTOCOL_UBX,        // u-blox binary
+    BRIDGE_PROTOCOL_COUNT
+};
+
+// InertialSense binary framing, as defined by ISComm.h in the SDK:
+// [0xEF 0x49][flags][data ID][payload size u16][payload][Fletcher-16 checksum u16]
+#define BRIDGE_ISB_PREAMBLE0            0xEF
+#define BRIDGE_ISB_PREAMBLE1            0x49
+#define BRIDGE_ISB_HEADER_SIZE          6
+#define BRIDGE_ISB_PKT_TYPE_MASK        0x0F
+
+// ISB packet types (low nibble of the flags byte)
+#define BRIDGE_ISB_PKT_TYPE_ACK                     1
+#define BRIDGE_ISB_PKT_TYPE_NACK                    2
+#define BRIDGE_ISB_PKT_TYPE_GET_DATA                3
+#define BRIDGE_ISB_PKT_TYPE_DATA                    4
+#define BRIDGE_ISB_PKT_TYPE_SET_DATA                5
+#define BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_ALL     6
+#define BRIDGE_ISB_PKT_TYPE_STOP_DID_BROADCAST      7
+#define BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_PORT    8
+
+// ISB flags (high nibble of the flags byte)
+#define BRIDGE_ISB_FLAGS_PAYLOAD_W_OFFSET           0x20    // Payload starts with a u16 offset into the data set
+
+/**
+ * One complete, checksum-validated packet found by the framer
+ */
+struct sISBridgePacket
+{
+    eISBridgeProtocol protocol;
+    uint8_t type;               // ISB packet type, otherwise 0
+    uint16_t id;                // ISB data ID, UBX (class << 8 | id), RTCM3 message number, otherwise 0
+    const uint8_t* data;        // First byte of the packet (the sync byte)
+    size_t size;                // Whole packet including header and checksum
+};
+
+/**
+ * Framer statistics snapshot
+ */
+struct sISBridgeFramerStats
+{
+    uint64_t packets[BRIDGE_PROTOCOL_COUNT] = {};   // Valid packets, indexed by eISBridgeProtocol
+    uint64_t checksumErrors = 0;
+    uint64_t oversizeFrames = 0;
+    uint64_t discardedBytes = 0;                    // Bytes outside any valid frame
+};
+
+/**
+ * Framer counters. Atomic so another thread may read them while the framer runs.
+ */
+struct sISBridgeFramerCounters
+{
+    std::atomic<uint64_t> packets[BRIDGE_PROTOCOL_COUNT] = {};
+    std::atomic<uint64_t> checksumErrors = { 0 };
+    std::atomic<uint64_t> oversizeFrames = { 0 };
+    std::atomic<uint64_t> discardedBytes = { 0 };
+
+    sISBridgeFramerStats Snapshot() const
+    {
+        sISBridgeFramerStats stats;
+        for (int i = 0; i < BRIDGE_PROTOCOL_COUNT; i++)
+        {
+            stats.packets[i] = packets[i].load(std::memory_order_relaxed);
+        }
+        stats.checksumErrors = checksumErrors.load(std::memory_order_relaxed);
+        stats.oversizeFrames = oversizeFrames.load(std::memory_order_relaxed);
+        stats.discardedBytes = discardedBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+/**
+ * Streaming packet framer
+ *
+ * Splits an arbitrary byte stream (TCP reads, ZMQ messages) into whole packets of the
+ * InertialSense binary (ISB), NMEA 0183, RTCM3 and u-blox UBX protocols. Candidate frame
+ * starts are located with a vectorized scan for the four sync bytes (SSE2 on x86, NEON
+ * on AArch64, scalar elsewhere), then each frame's length and checksum are validated in
+ * a single pass. A frame split across Feed() calls keeps a running checksum, so each byte
+ * is summed once however the frame arrives. Corrupt frames and bytes between frames are
+ * dropped and counted; after a bad frame the scan resumes one byte past its sync byte so
+ * a real packet hidden inside garbage is still found.
+ *
+ * Packets that lie entirely within the chunk passed to Feed() are reported by pointer
+ * into that chunk, so the caller can forward them without copying. Packets split across
+ * calls are reassembled in an internal buffer and reported from there.
+ */
+class cISBridgePacketFramer
+{
+public:
+    typedef std::function<void(const sISBridgePacket& packet)> packet_handler_t;
+
+    /**
+     * Largest frame accepted. Covers ISB (2 KB payloads), RTCM3 (1029 bytes) and
+     * typical UBX/NMEA traffic; larger frames are discarded as oversize.
+     */
+    static const size_t kMaxFrameSize = 8192;
+
+    /**
+     * Constructor
+     * @param counters where statistics are accumulated, may be NULL
+     */
+    explicit cISBridgePacketFramer(sISBridgeFramerCounters* counters = NULL);
+
+    /**
+     * Process the next chunk of the stream
+     * @param data the bytes
+     * @param size number of bytes
+     * @param handler called once per complete packet, in stream order
+     */
+    void Feed(const uint8_t* data, size_t size, const packet_handler_t& handler);
+
+    /**
+     * Discard any partially received frame
+     */
+    void Reset() { m_pending.clear(); m_checksum = sRunningChecksum(); }
+
+    /**
+     * @return number of bytes held waiting for the rest of a frame
+     */
+    size_t PendingBytes() const { return m_pending.size(); }
+
+    /**
+     * Find the first byte in data that can start a supported frame
+     * @return its offset, or size if there is none
+     */
+    static size_t FindSync(const uint8_t* data, size_t size);
+
+    /**
+     * Try to parse one frame starting at data[0]
+     * @param data bytes starting at a sync byte
+     * @param size number of bytes available
+     * @param packet receives the packet when complete and valid
+     * @param counters receives checksum/oversize errors, may be NULL
+     * @param frameLength if not NULL, receives the full frame length once the header
+     *        has been seen, otherwise 0 (always 0 for NMEA, which ends at a newline)
+     * @return frame length when a valid packet is complete, 0 if more bytes are needed,
+     *         -1 if data[0] does not start a valid frame
+     */
+    static int ParseFrame(const uint8_t* data, size_t size, sISBridgePacket& packet, sISBridgeFramerCounters* counters, size_t* frameLength = NULL);
+
+    /**
+     * Longest NMEA sentence accepted, including "$" and the line ending
+     */
+    static const size_t kMaxNmeaSize = 1024;
+
+private:
+    /**
+     * Checksum progress through one frame, carried while the frame is incomplete
+     */
+    struct sRunningChecksum
+    {
+        size_t covered = 0;     // Frame bytes already folded into sum
+        uint32_t sum = 0;       // Fletcher A | B << 8, CRC-24Q, or NMEA XOR
+        size_t star = 0;        // NMEA: offset of "*", 0 until seen
+    };
+
+    /**
+     * ParseFrame() resuming from, and updating, running
+     */
+    static int ParseFrame(const uint8_t* data, size_t size, sISBridgePacket& packet, sISBridgeFramerCounters* counters, size_t* frameLength, sRunningChecksum& running);
+
+    /**
+     * Scan a contiguous region, reporting packets and returning the offset of an
+     * incomplete frame at the end (size if none)
+     */
+    size_t Scan(const uint8_t* data, size_t size, const packet_handler_t& handler);
+
+    void Discard(size_t bytes);
+
+    /**
+     * Append bytes from data to m_pending until the pending frame is complete or data
+     * runs out
+     * @return number of bytes taken from data
+     */
+    size_t FillPending(const uint8_t* data, size_t size);
+
+    sISBridgeFramerCounters* m_counters;
+    std::vector<uint8_t> m_pending;         // Start of a frame that continues in the next chunk
+    sRunningChecksum m_checksum;            // Checksum over m_pending so far
+};
+
+#endif // __ISBRIDGEPACKETFRAMER__H__
@@ -0,0 +1,84 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGERATELIMITER__H__
+#define __ISBRIDGERATELIMITER__H__
+
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+
+/**
+ * Maximum forwarding rate per InertialSense data ID
+ */
+struct sISBridgeRateLimits
+{
+    static const int kDidCount = 256;
+
+    float maxHz[kDidCount] = {};        // 0 = not limited
+
+    bool Empty() const
+    {
+        for (int i = 0; i < kDidCount; i++)
+        {
+            if (maxHz[i] > 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Per-client decimation of ISB data packets
+ *
+ * Lets through at most maxHz packets per second of each limited data ID, judged by the
+ * packets' receive timestamps so a replay is decimated exactly like the live stream.
+ * Each accepted packet advances the next due time by one interval rather than resetting
+ * it, so the average rate is the limit even when the source rate is not a multiple of
+ * it; a packet up to a quarter interval early is accepted to absorb source jitter.
+ * Everything other than ISB data passes. Not thread safe; the owner serializes access.
+ */
+class cISBridgeRateLimiter
+{
+public:
+    cISBridgeRateLimiter();
+
+    void SetLimits(const sISBridgeRateLimits& limits);
+
+    /**
+     * @return true if any data ID is limited
+     */
+    bool Active() const { return m_active; }
+
+    /**
+     * Decide whether a packet is forwarded, and count it if it is
+     * @param buffer the packet
+     * @param nowNs bridgeClockNs(), used when the packet has no timestamp
+     * @return true to forward
+     */
+    bool Accept(const cISBridgeBuffer& buffer, uint64_t nowNs);
+
+    /**
+     * @return packets withheld so far
+     */
+    uint64_t Suppressed() const { return m_suppressed; }
+
+private:
+    bool m_active;
+    uint64_t m_suppressed;
+    uint64_t m_intervalNs[sISBridgeRateLimits::kDidCount];
+    uint64_t m_nextNs[sISBridgeRateLimits::kDidCount];
+};
+
+#endif // __ISBRIDGERATELIMITER__H__
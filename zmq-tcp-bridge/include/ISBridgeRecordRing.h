@@ -0,0 +1,98 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGERECORDRING__H__
+#define __ISBRIDGERECORDRING__H__
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer / single-consumer ring of variable-size records
+ *
+ * Records are stored contiguously with a small length prefix, so the consumer reads
+ * them in place without copying. A record that does not fit before the end of the ring
+ * is preceded by a wrap marker and written at the start. Write() never blocks: when the
+ * ring is full it fails and the producer decides what to drop.
+ *
+ * Exactly one thread may call Write() and exactly one (possibly different) thread may
+ * call Peek() / Pop().
+ */
+class cISBridgeRecordRing
+{
+public:
+    /**
+     * Constructor
+     * @param capacity ring size in bytes, rounded up to a power of two
+     */
+    explicit cISBridgeRecordRing(size_t capacity);
+
+    /**
+     * Append one record made of two parts (e.g. a header and a payload)
+     * @param first first part
+     * @param firstSize bytes in first
+     * @param second second part, may be NULL
+     * @param secondSize bytes in second
+     * @return false if the ring does not have room for the record
+     */
+    bool Write(const void* first, size_t firstSize, const void* second = NULL, size_t secondSize = 0);
+
+    /**
+     * Look at the oldest record without removing it
+     * @param size receives the record size
+     * @return the record, or NULL if the ring is empty
+     */
+    const uint8_t* Peek(size_t& size);
+
+    /**
+     * Remove the record returned by the last Peek()
+     */
+    void Pop();
+
+    /**
+     * @return true if there is nothing to read
+     */
+    bool Empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+    size_t Capacity() const { return m_capacity; }
+
+    /**
+     * @return largest record Write() can ever accept
+     */
+    size_t MaxRecordSize() const { return m_capacity / 2 - kPrefixSize; }
+
+private:
+    cISBridgeRecordRing(const cISBridgeRecordRing&) = delete;
+    cISBridgeRecordRing& operator=(const cISBridgeRecordRing&) = delete;
+
+    static const size_t kPrefixSize = 8;            // Record length, keeps payloads 8-byte aligned
+    static const uint32_t kWrapMarker = 0xFFFFFFFF;
+
+    static size_t Align(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+    size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<uint8_t[]> m_data;
+
+    // Producer and consumer positions on their own cache lines. Positions count bytes
+    // and only ever grow; masking maps them into the ring.
+    alignas(64) std::atomic<uint64_t> m_tail;   // Written by the producer
+    uint64_t m_cachedHead;                      // Producer's last view of m_head
+    alignas(64) std::atomic<uint64_t> m_head;   // Written by the consumer
+    uint64_t m_cachedTail;                      // Consumer's last view of m_tail
+    size_t m_peekSize;                          // Bytes the pending Pop() releases
+};
+
+#endif // __ISBRIDGERECORDRING__H__
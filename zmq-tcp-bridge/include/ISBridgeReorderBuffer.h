@@ -0,0 +1,154 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEREORDERBUFFER__H__
+#define __ISBRIDGEREORDERBUFFER__H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+
+/**
+ * One merged source, as seen by the reorder buffer
+ */
+struct sISBridgeReorderSourceStats
+{
+    uint64_t messages = 0;              // Timestamped packets received
+    uint64_t watermarkNs = 0;           // Newest publisher timestamp received, 0 before the first
+    uint64_t lateMessages = 0;          // Arrived behind packets already released; forwarded out of order
+};
+
+/**
+ * Reorder buffer totals
+ */
+struct sISBridgeReorderStats
+{
+    size_t held = 0;                    // Packets waiting in the window
+    uint64_t watermarkReleases = 0;     // Released once every source had passed them
+    uint64_t deadlineReleases = 0;      // Released because they, or a newer packet, had waited the whole window
+};
+
+/**
+ * Merges packets from several publishers into publisher timestamp order
+ *
+ * Each source is assumed to publish in timestamp order, so its watermark (newest
+ * timestamp received) bounds what it can still send. A held packet is released as soon
+ * as every source's watermark has reached it, and at the latest one window after it
+ * arrived, together with every held packet older than it. The window therefore bounds
+ * the latency the merge adds: a slow or stalled source delays the others by at most the
+ * window, never more. A packet older than one already released is late: it is forwarded
+ * at once, out of order, and counted.
+ *
+ * Times are nanoseconds; publisher timestamps only need to be comparable with each other
+ * and arrival times with nowNs. Only the owning thread calls Push() and Release();
+ * statistics may be read from any thread.
+ */
+class cISBridgeReorderBuffer
+{
+public:
+    typedef std::function<void(cISBridgeBufferRef& buffer)> release_handler_t;
+
+    cISBridgeReorderBuffer();
+
+    /**
+     * Set up for a number of sources, drop anything held and reset statistics
+     * @param sourceCount number of sources
+     * @param windowNs longest time a packet is held
+     * @param capacity most packets held; the oldest is released early when full
+     */
+    void Configure(int sourceCount, uint64_t windowNs, size_t capacity);
+
+    /**
+     * Add a packet
+     * @param source source index
+     * @param publisherNs the publisher's timestamp
+     * @param arrivalNs when the packet was received
+     * @param buffer the packet
+     * @param handler receives packets released by this call (late or capacity)
+     */
+    void Push(int source, uint64_t publisherNs, uint64_t arrivalNs, const cISBridgeBufferRef& buffer, const release_handler_t& handler);
+
+    /**
+     * Release every packet that is due, in timestamp order
+     * @param nowNs current time, same clock as arrivalNs
+     * @param handler receives the packets
+     * @return number of packets released
+     */
+    int Release(uint64_t nowNs, const release_handler_t& handler);
+
+    /**
+     * Drop everything held. Statistics are kept until the next Configure().
+     */
+    void Clear();
+
+    /**
+     * @return when Release() next has something to do by deadline, 0 if nothing is held
+     */
+    uint64_t NextDeadlineNs() const;
+
+    sISBridgeReorderStats GetStats() const;
+
+    sISBridgeReorderSourceStats GetSourceStats(int source) const;
+
+    int SourceCount() const { return m_sourceCount; }
+
+private:
+    struct sEntry
+    {
+        uint64_t publisherNs;
+        uint64_t seq;                   // Push order, breaks timestamp ties
+        cISBridgeBufferRef buffer;
+
+        // Heap order: earliest timestamp on top
+        bool operator<(const sEntry& other) const
+        {
+            return (publisherNs != other.publisherNs) ? publisherNs > other.publisherNs : seq > other.seq;
+        }
+    };
+
+    struct sArrival
+    {
+        uint64_t arrivalNs;
+        uint64_t publisherNs;
+    };
+
+    struct sSource
+    {
+        std::atomic<uint64_t> messages = { 0 };
+        std::atomic<uint64_t> watermarkNs = { 0 };
+        std::atomic<uint64_t> lateMessages = { 0 };
+    };
+
+    void ReleaseTop(const release_handler_t& handler, bool byDeadline);
+
+    int m_sourceCount;
+    uint64_t m_windowNs;
+    size_t m_capacity;
+    std::unique_ptr<sSource[]> m_sources;
+    std::vector<sEntry> m_heap;
+    std::vector<sArrival> m_arrivals;   // Ring in arrival order, for deadlines
+    size_t m_arrivalHead;
+    size_t m_arrivalCount;
+    uint64_t m_seq;
+    uint64_t m_releasedNs;              // Newest timestamp released
+    uint64_t m_deadlineNs;              // Held packets up to this timestamp are overdue
+    std::atomic<size_t> m_held;
+    std::atomic<uint64_t> m_watermarkReleases;
+    std::atomic<uint64_t> m_deadlineReleases;
+};
+
+#endif // __ISBRIDGEREORDERBUFFER__H__
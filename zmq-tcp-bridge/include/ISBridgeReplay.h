@@ -0,0 +1,126 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEREPLAY__H__
+#define __ISBRIDGEREPLAY__H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ISBridgeCapture.h"
+#include "ISBridgeTcpReactor.h"
+
+/**
+ * Replay options. Set with SetOptions() before Start().
+ */
+struct sISBridgeReplayOptions
+{
+    /** Playback rate relative to capture time: 1 is real time, 10 is ten times faster, 0 is as fast as clients read */
+    double speed = 1.0;
+
+    /** TCP clients that must be connected before the first record is sent */
+    int waitClients = 1;
+
+    /** Per-client send queue bounds */
+    sISBridgeSendQueueLimits clientQueue;
+};
+
+/**
+ * Serves the ZMQ → TCP side of a capture to TCP clients
+ *
+ * Records are sent in capture order, referenced straight from the mapped capture
+ * without copying, and spaced by their recorded timestamps divided by the speed.
+ * Replays are deterministic: every client connected when playback starts receives
+ * exactly the captured byte stream. A client that falls behind pauses the replay clock
+ * instead of having data dropped, so replay timing slips rather than its content.
+ */
+class cISBridgeReplay
+{
+public:
+    cISBridgeReplay();
+    ~cISBridgeReplay();
+
+    /**
+     * Map the capture, listen for clients and start playback once enough connect
+     * @param capturePath the path given to cISBridgeCaptureWriter::Open()
+     * @param tcpPort TCP port for SDK clients to connect to
+     * @return 0 if success, otherwise an error code
+     */
+    int Start(const std::string& capturePath, int tcpPort);
+
+    /**
+     * Stop playback and disconnect all clients
+     * @return 0 if success
+     */
+    int Stop();
+
+    void SetOptions(const sISBridgeReplayOptions& options) { m_options = options; }
+
+    /**
+     * @return true until every record has been written to every client, or Stop()
+     */
+    bool IsRunning() const { return m_running && !m_finished; }
+
+    /**
+     * @return the TCP port clients connect to, e.g. after Start() with port 0; -1 if not started
+     */
+    int Port() const { return m_tcpReactor ? m_tcpReactor->Port() : -1; }
+
+    /**
+     * @return one line with progress and connected clients
+     */
+    std::string GetStatus();
+
+private:
+    cISBridgeReplay(const cISBridgeReplay&) = delete;
+    cISBridgeReplay& operator=(const cISBridgeReplay&) = delete;
+
+    static const int kMaxBatch = 64;
+
+    void ReplayThread();
+    void ReactorThread();
+
+    /**
+     * Advance to the next ZMQ → TCP record
+     * @return false at the end of the capture
+     */
+    bool NextRecord(sISBridgeCaptureRecord& record);
+
+    /**
+     * Wait until every client queue can take a batch without dropping
+     * @return nanoseconds spent waiting
+     */
+    uint64_t WaitForRoom(size_t messages, size_t bytes);
+
+    /**
+     * Wait until every client queue is empty
+     */
+    void WaitForDrain();
+
+    sISBridgeReplayOptions m_options;
+    cISBridgeCaptureReader m_reader;
+    std::unique_ptr<cISBridgeBufferPool> m_pool;    // Header-only handles wrapping mapped records
+    std::unique_ptr<cISBridgeTcpReactor> m_tcpReactor;
+    std::unique_ptr<std::thread> m_replayThread;
+    std::unique_ptr<std::thread> m_reactorThread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_finished;
+    std::atomic<uint64_t> m_recordsSent;
+    std::atomic<uint64_t> m_bytesSent;
+    std::vector<cISBridgeBufferRef> m_batch;
+    std::vector<sISBridgeTcpClientStats> m_clientStats;
+};
+
+#endif // __ISBRIDGEREPLAY__H__
@@ -0,0 +1,49 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGERUNTIME__H__
+#define __ISBRIDGERUNTIME__H__
+
+/**
+ * Scheduling profile for one bridge thread
+ */
+struct sISBridgeThreadProfile
+{
+    /** CPU to pin the thread to, -1 to leave placement to the scheduler */
+    int cpu = -1;
+
+    /** SCHED_FIFO priority (1-99), 0 for the default time-sharing scheduler */
+    int fifoPriority = 0;
+};
+
+/**
+ * Name the calling thread and apply a scheduling profile to it. Pinning and SCHED_FIFO
+ * are Linux only; SCHED_FIFO needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance. Anything
+ * that cannot be applied is logged and the thread keeps its default settings.
+ * @param profile the profile
+ * @param name thread name, at most 15 characters are kept
+ * @return 0 if fully applied, -1 otherwise
+ */
+int bridgeApplyThreadProfile(const sISBridgeThreadProfile& profile, const char* name);
+
+/**
+ * Ask the kernel to busy-poll the device queue for up to usec microseconds on blocking
+ * receives and epoll waits on this socket (SO_BUSY_POLL, Linux only). Values above
+ * net.core.busy_read need CAP_NET_ADMIN.
+ * @param fd the socket
+ * @param usec busy-poll time, 0 to disable
+ * @return 0 if success, -1 if unsupported or refused
+ */
+int bridgeSetBusyPoll(int fd, int usec);
+
+#endif // __ISBRIDGERUNTIME__H__
@@ -0,0 +1,162 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGESENDQUEUE__H__
+#define __ISBRIDGESENDQUEUE__H__
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeSocket.h"
+#include "ISBridgeBuffer.h"
+#include "ISBridgeMetrics.h"
+#include "ISBridgeTrace.h"
+
+/**
+ * What a client send queue does when a new message does not fit
+ */
+enum eISBridgeDropPolicy
+{
+    BRIDGE_DROP_OLDEST = 0,     // Discard queued messages, oldest first, to make room
+    BRIDGE_DROP_NEWEST,         // Discard the message being queued
+    BRIDGE_DROP_DISCONNECT,     // Disconnect the client
+};
+
+/**
+ * Bounds for one client send queue
+ */
+struct sISBridgeSendQueueLimits
+{
+    /** Maximum queued messages */
+    size_t maxMessages = 4096;
+
+    /** Maximum queued (unsent) bytes */
+    size_t maxBytes = 4 * 1024 * 1024;
+
+    /** Action taken when either limit would be exceeded */
+    eISBridgeDropPolicy dropPolicy = BRIDGE_DROP_OLDEST;
+
+    /**
+     * Replace a queued, not yet written ISB data packet with a newer one of the same data
+     * ID instead of queuing both, so a backed-up client gets the latest value of each ID
+     * rather than a stale backlog. Requires packet info (ZMQ → TCP framing).
+     */
+    bool conflate = false;
+};
+
+/**
+ * Send queue accounting for one client
+ */
+struct sISBridgeSendQueueStats
+{
+    size_t queuedMessages = 0;
+    size_t queuedBytes = 0;
+    size_t highWatermarkBytes = 0;      // Largest queuedBytes seen
+    size_t highWatermarkMessages = 0;   // Largest queuedMessages seen
+    uint64_t droppedMessages = 0;
+    uint64_t droppedBytes = 0;
+    uint64_t sentMessages = 0;          // Messages completely written
+    uint64_t sentBytes = 0;
+    uint64_t conflatedMessages = 0;     // Replaced by a newer packet of the same data ID before being written
+};
+
+/**
+ * Bounded FIFO of messages waiting to be written to one TCP client
+ *
+ * Messages are held by reference so one buffer can sit in many client queues. Whole
+ * messages are dropped, never fragments, so the byte stream a client sees stays
+ * packet aligned even under load. A message that has been partially written, or handed
+ * to an asynchronous write with Pin(), is never dropped or conflated. Not thread safe;
+ * the owner serializes access.
+ */
+class cISBridgeSendQueue
+{
+public:
+    cISBridgeSendQueue();
+
+    /**
+     * Set bounds and allocate storage. Clears the queue.
+     */
+    void SetLimits(const sISBridgeSendQueueLimits& limits);
+
+    const sISBridgeSendQueueLimits& Limits() const { return m_limits; }
+
+    /**
+     * Turn conflation on or off without clearing the queue
+     */
+    void SetConflate(bool conflate) { m_limits.conflate = conflate; }
+
+    /**
+     * Queue a message, applying the drop policy if it does not fit
+     * @param buffer the message
+     * @return false if the policy is BRIDGE_DROP_DISCONNECT and the limits were exceeded
+     */
+    bool Push(const cISBridgeBufferRef& buffer);
+
+    bool Empty() const { return m_count == 0; }
+
+    /**
+     * Describe queued data from the head, accounting for a partially written head message
+     * @param iov receives up to maxIov buffers
+     * @param maxIov capacity of iov
+     * @return number of entries filled
+     */
+    int Peek(iovec* iov, int maxIov) const;
+
+    /**
+     * Remove bytes that were written from the head
+     * @param bytes number of bytes written
+     * @param latency if not NULL, records the time from each completed message's
+     *        Timestamp() to nowNs
+     * @param nowNs bridgeClockNs() at write completion, used with latency and trace
+     * @param trace if not NULL, stamps the write stages of completed sampled messages
+     * @return number of messages completely written
+     */
+    size_t Consume(size_t bytes, cISBridgeHistogram* latency = NULL, uint64_t nowNs = 0, cISBridgeTraceRing* trace = NULL);
+
+    /**
+     * Protect messages from the drop policy while an asynchronous write references them
+     * @param messages number of messages from the head; Consume() releases them as they
+     *        complete and Pin(0) releases the rest
+     */
+    void Pin(size_t messages) { m_pinned = messages; }
+
+    /**
+     * Drop everything
+     */
+    void Clear();
+
+    const sISBridgeSendQueueStats& Stats() const { return m_stats; }
+
+private:
+    size_t Index(size_t i) const { return (m_head + i) % m_ring.size(); }
+    bool Fits(size_t size) const { return m_count < m_ring.size() && m_stats.queuedBytes + size <= m_limits.maxBytes; }
+    bool DropOldest();
+
+    /**
+     * Overwrite the queued packet with the same data ID as buffer, if one can be replaced
+     * @return true if buffer took its place
+     */
+    bool Conflate(const cISBridgeBufferRef& buffer);
+
+    sISBridgeSendQueueLimits m_limits;
+    std::vector<cISBridgeBufferRef> m_ring;
+    size_t m_head;
+    size_t m_count;
+    size_t m_headOffset;        // Bytes of the head message already written
+    size_t m_pinned;            // Messages from the head in an asynchronous write
+    size_t m_didSlot[256];      // Ring slot of the last queued packet of each data ID, checked before use
+    sISBridgeSendQueueStats m_stats;
+};
+
+#endif // __ISBRIDGESENDQUEUE__H__
@@ -0,0 +1,149 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGESOCKET__H__
+#define __ISBRIDGESOCKET__H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ISTcpServer.h"
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <BaseTsd.h>
+
+#if defined(_MSC_VER)
+typedef SSIZE_T ssize_t;
+#endif
+
+/**
+ * POSIX scatter/gather shapes, so the send path is written once. bridgeSocketSendmsg()
+ * maps them onto WSASend().
+ */
+struct iovec
+{
+    void* iov_base;
+    size_t iov_len;
+};
+
+struct msghdr
+{
+    void* msg_name;
+    int msg_namelen;
+    iovec* msg_iov;
+    size_t msg_iovlen;
+    void* msg_control;
+    size_t msg_controllen;
+    int msg_flags;
+};
+
+#ifndef SHUT_RDWR
+#define SHUT_RDWR SD_BOTH
+#endif
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * Socket calls that differ between POSIX and Winsock
+ *
+ * The TCP reactor, wakeup and metrics server use these instead of the raw calls so the
+ * bridge builds on Windows, where readiness comes from WSAPoll() (the poll() fallback of
+ * the reactor) and the wakeup is a loopback socket pair.
+ */
+
+/**
+ * @return false for the invalid socket value (-1, INVALID_SOCKET on Windows)
+ */
+inline bool bridgeSocketValid(is_socket_t socket)
+{
+    return socket != static_cast<is_socket_t>(-1);
+}
+
+/**
+ * Initialize the socket library (WSAStartup on Windows, nothing elsewhere). Safe to call
+ * repeatedly.
+ * @return 0 if success, otherwise -1
+ */
+int bridgeSocketStartup();
+
+/**
+ * Close a socket
+ */
+int bridgeSocketClose(is_socket_t socket);
+
+/**
+ * Switch a socket between blocking and non-blocking mode
+ * @return 0 if success, otherwise -1
+ */
+int bridgeSocketSetNonBlocking(is_socket_t socket, bool nonBlocking);
+
+/**
+ * Keep a socket from leaking into child processes (FD_CLOEXEC; Winsock handles are not
+ * inherited by default)
+ */
+void bridgeSocketSetCloseOnExec(is_socket_t socket);
+
+/**
+ * Gathered send of msg->msg_iov
+ * @return bytes sent, -1 on error (see bridgeSocketError())
+ */
+ssize_t bridgeSocketSendmsg(is_socket_t socket, const msghdr* msg, int flags);
+
+/**
+ * @return bytes received, 0 on orderly shutdown, -1 on error (see bridgeSocketError())
+ */
+ssize_t bridgeSocketRecv(is_socket_t socket, void* data, size_t size, int flags);
+
+/**
+ * poll(), or WSAPoll() on Windows
+ */
+int bridgeSocketPoll(pollfd* fds, size_t count, int timeoutMs);
+
+/**
+ * @return error of the last failed socket call on this thread (errno or WSAGetLastError())
+ */
+int bridgeSocketError();
+
+/**
+ * @return true if error means the call would have blocked
+ */
+bool bridgeSocketWouldBlock(int error);
+
+/**
+ * @return true if error means the call was interrupted and should be retried
+ */
+bool bridgeSocketInterrupted(int error);
+
+/**
+ * @return true if error means accept() found a connection the peer had already reset
+ */
+bool bridgeSocketAcceptAborted(int error);
+
+/**
+ * @return true if error means the process or system ran out of file descriptors
+ */
+bool bridgeSocketOutOfDescriptors(int error);
+
+#endif // __ISBRIDGESOCKET__H__
@@ -0,0 +1,586 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGETCPREACTOR__H__
+#define __ISBRIDGETCPREACTOR__H__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#include "ISTcpServer.h"
+#include "ISBridgeSocket.h"
+#include "ISBridgeWakeup.h"
+#include "ISBridgeBuffer.h"
+#include "ISBridgeSendQueue.h"
+#include "ISBridgeDidFilter.h"
+#include "ISBridgeRateLimiter.h"
+#include "ISBridgeMetrics.h"
+#include "ISBridgeUring.h"
+#include "ISBridgeTxScheduler.h"
+
+class cISBridgeTcpReactor;
+
+/**
+ * How the reactor performs socket I/O
+ */
+enum eISBridgeTcpBackend
+{
+    BRIDGE_TCP_BACKEND_EPOLL = 0,       // Readiness with epoll (poll()/WSAPoll() off Linux) and non-blocking send/recv
+    BRIDGE_TCP_BACKEND_IO_URING,        // Completion-based io_uring: multishot accept and recv, linked sends
+};
+
+/**
+ * Callbacks from cISBridgeTcpReactor. Mirrors iISTcpServerDelegate so bridge code
+ * written against cISTcpServer keeps the same shape.
+ * All callbacks run on the thread calling cISBridgeTcpReactor::Run().
+ */
+class iISBridgeTcpReactorDelegate
+{
+public:
+    virtual ~iISBridgeTcpReactorDelegate() {}
+
+protected:
+    /**
+     * A client connection was accepted
+     * @param reactor the reactor that accepted the client
+     * @param socket the client socket
+     */
+    virtual void OnClientConnected(cISBridgeTcpReactor* reactor, is_socket_t socket) { (void)reactor; (void)socket; }
+
+    /**
+     * Accepting a client failed, e.g. for lack of file descriptors or because it could
+     * not be registered. Not called for connections the peer reset before they were accepted.
+     * @param reactor the reactor that was accepting
+     */
+    virtual void OnClientConnectFailed(cISBridgeTcpReactor* reactor) { (void)reactor; }
+
+    /**
+     * A client is about to join the broadcast. Messages appended to initial are queued
+     * for it ahead of any Broadcast() data. Called with the client list locked: must not
+     * call back into the reactor.
+     * @param reactor the reactor that accepted the client
+     * @param socket the client socket
+     * @param initial receives messages to send first
+     */
+    virtual void OnClientAccepting(cISBridgeTcpReactor* reactor, is_socket_t socket, std::vector<cISBridgeBufferRef>& initial)
+    {
+        (void)reactor;
+        (void)socket;
+        (void)initial;
+    }
+
+    /**
+     * Data was read from a client
+     * @param reactor the reactor receiving data
+     * @param socket the client socket
+     * @param data the data received
+     * @param dataLength the number of bytes received
+     */
+    virtual void OnClientDataReceived(cISBridgeTcpReactor* reactor, is_socket_t socket, uint8_t* data, int dataLength)
+    {
+        (void)reactor;
+        (void)socket;
+        (void)data;
+        (void)dataLength;
+    }
+
+    /**
+     * A client disconnected or was dropped. The socket is closed after this returns.
+     * @param reactor the reactor that owned the client
+     * @param socket the client socket
+     */
+    virtual void OnClientDisconnected(cISBridgeTcpReactor* reactor, is_socket_t socket) { (void)reactor; (void)socket; }
+
+    friend class cISBridgeTcpReactor;
+};
+
+/**
+ * Per-client statistics snapshot
+ */
+struct sISBridgeTcpClientStats
+{
+    is_socket_t socket;
+    sISBridgeSendQueueStats queue;      // Includes messages/bytes written and drops
+    uint64_t bytesRead = 0;
+    uint64_t writeBlocks = 0;           // Writes that hit EAGAIN
+    uint64_t rateSuppressed = 0;        // ISB data packets withheld by the client's rate limits
+    sISBridgeTxStats tx;                // Transmit scheduler mode and socket measurements
+};
+
+/**
+ * Reactor totals since Open(), including clients that have since disconnected
+ */
+struct sISBridgeTcpReactorStats
+{
+    uint64_t accepts = 0;
+    uint64_t disconnects = 0;
+    uint64_t reads = 0;
+    uint64_t bytesRead = 0;
+    uint64_t writeCalls = 0;
+    uint64_t messagesWritten = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t writeBlocks = 0;           // Writes that hit EAGAIN
+    uint64_t droppedMessages = 0;       // Dropped by client queue policies or still queued when a client went away
+    uint64_t rateSuppressed = 0;        // Withheld by client rate limits
+    uint64_t conflatedMessages = 0;     // Replaced in a client queue by a newer packet of the same data ID
+    uint64_t txModeSwitches = 0;        // Transmit scheduler changes between immediate and coalescing
+    uint64_t txDeadlineFlushes = 0;     // Coalesced data written because its flush deadline passed
+};
+
+/**
+ * A client connection handed from one process to another
+ */
+struct sISBridgeTcpHandoffClient
+{
+    is_socket_t socket = -1;
+    sISBridgeDidSet filter;             // Subscription, see cISBridgeDidFilter::Export()
+};
+
+/**
+ * Event-driven TCP server for the bridge
+ *
+ * Owns the listening socket and all client sockets. On Linux an edge-triggered epoll
+ * instance dispatches accepts, reads, writability and disconnects the moment the kernel
+ * reports them; other platforms fall back to poll(), or WSAPoll() on Windows. Reads are
+ * delivered to the delegate from Run().
+ *
+ * Outgoing data is fanned out into a bounded send queue per client and written without
+ * blocking. Whatever a client cannot take immediately stays in its queue and is flushed
+ * from Run() when the socket becomes writable, so one congested client never delays the
+ * others. When a queue fills, its drop policy decides what is discarded.
+ *
+ * With BRIDGE_TCP_BACKEND_IO_URING, accepts and reads are multishot io_uring requests
+ * that stay armed for the life of the socket and read into registered, kernel-selected
+ * buffers, and each client's backlog goes out as a chain of linked sendmsg() requests.
+ * Broadcast() queues every client's chain and enters the kernel once, instead of making
+ * one sendmsg() call per client. Open() falls back to epoll when io_uring is unavailable.
+ */
+class cISBridgeTcpReactor
+{
+public:
+    /**
+     * Constructor
+     * @param delegate receives client callbacks, may be NULL
+     */
+    explicit cISBridgeTcpReactor(iISBridgeTcpReactorDelegate* delegate = NULL);
+
+    ~cISBridgeTcpReactor();
+
+    /**
+     * Open the listening socket
+     * @param ipAddress address to bind, empty for any
+     * @param port TCP port to listen on
+     * @return 0 if success, otherwise an error code
+     */
+    int Open(const std::string& ipAddress, int port);
+
+    /**
+     * Serve an already bound and listening socket, e.g. one handed over by another
+     * process. The reactor takes ownership of it, also on failure.
+     * @param listenSocket the listening socket
+     * @return 0 if success, otherwise an error code
+     */
+    int Open(is_socket_t listenSocket);
+
+    /**
+     * Close the listening socket and all clients
+     * @return 0 if success
+     */
+    int Close();
+
+    /**
+     * Take over a connected client handed over from another process, with the
+     * subscription it had there. Call before Run() starts or from the Run() thread.
+     * @param socket the client socket; the reactor takes ownership of it
+     * @param filter the client's subscription from cISBridgeDidFilter::Export()
+     * @return 0 if success, -1 if it could not be registered (the socket is closed)
+     */
+    int AdoptClient(is_socket_t socket, const sISBridgeDidSet& filter);
+
+    /**
+     * Duplicate the listening and client sockets for another process and pause. Nothing
+     * is read or written until Resume(); io_uring requests are cancelled so the ring
+     * stops reading sockets the other process now serves. Every client keeps its queue,
+     * subscription, rate limits and transmit state. Follow with Close() once the other
+     * process has taken over; the connections stay up as long as its duplicates are
+     * open, and data not yet written to a client is discarded. Run() must not be running.
+     * @param listenSocket receives the duplicate of the listening socket
+     * @param clients receives a duplicate of each client socket and its subscription
+     * @return 0 if success, -1 if not open or a socket could not be duplicated
+     */
+    int HandOff(is_socket_t& listenSocket, std::vector<sISBridgeTcpHandoffClient>& clients);
+
+    /**
+     * Serve the listening and client sockets again after HandOff(), when the other
+     * process did not take over. The caller closes the duplicates. Run() must not be
+     * running.
+     * @return 0 if success, -1 if not open or io_uring requests could not be rearmed
+     */
+    int Resume();
+
+    bool IsOpen() const { return m_listenSocket >= 0; }
+
+    /**
+     * Set send queue bounds and drop policy for clients accepted from now on
+     */
+    void SetClientQueueLimits(const sISBridgeSendQueueLimits& limits) { m_queueLimits = limits; }
+
+    /**
+     * Set per data ID rate limits for clients accepted from now on
+     */
+    void SetClientRateLimits(const sISBridgeRateLimits& limits) { m_rateLimits = limits; }
+
+    /**
+     * Replace one connected client's rate limits
+     * @param socket the client socket
+     * @param limits the new limits; the client's cadence restarts
+     * @return 0 if success, -1 if the client is unknown
+     */
+    int SetClientRateLimits(is_socket_t socket, const sISBridgeRateLimits& limits);
+
+    /**
+     * Turn conflation on or off for one connected client
+     * @param socket the client socket
+     * @param conflate see sISBridgeSendQueueLimits::conflate
+     * @return 0 if success, -1 if the client is unknown
+     */
+    int SetClientConflate(is_socket_t socket, bool conflate);
+
+    /**
+     * Set adaptive transmit scheduling for clients accepted from now on. Set before
+     * Open(), which creates the timer that flushes coalesced data at its deadline.
+     */
+    void SetTxOptions(const sISBridgeTxOptions& options) { m_txOptions = options; }
+
+    /**
+     * Select the I/O backend used by the next Open()
+     */
+    void SetBackend(eISBridgeTcpBackend backend) { m_backend = backend; }
+
+    /**
+     * @return the backend in use; BRIDGE_TCP_BACKEND_EPOLL if io_uring was requested
+     * but is not supported
+     */
+    eISBridgeTcpBackend Backend() const { return m_uring ? BRIDGE_TCP_BACKEND_IO_URING : BRIDGE_TCP_BACKEND_EPOLL; }
+
+    /**
+     * Set SO_BUSY_POLL on clients accepted from now on
+     * @param usec busy-poll time in microseconds, 0 to leave the socket default
+     */
+    void SetBusyPoll(int usec) { m_busyPollUs = usec; }
+
+    /**
+     * Set SO_REUSEPORT on the listening socket of the next Open(), so several reactors can
+     * listen on the same port and the kernel spreads new connections across them
+     */
+    void SetReusePort(bool reusePort) { m_reusePort = reusePort; }
+
+    /**
+     * Stamp write completions of sampled messages into a trace ring. Set before Open().
+     * @param trace the ring, owned by the caller, or NULL for none
+     */
+    void SetTraceRing(cISBridgeTraceRing* trace) { m_trace = trace; }
+
+    /**
+     * @return the port the listening socket is bound to, -1 if not open
+     */
+    int Port() const;
+
+    /**
+     * Wait for socket events and dispatch them to the delegate
+     * @param timeoutMs maximum time to wait, -1 to wait until an event or Wakeup()
+     * @return number of events handled, -1 on error
+     */
+    int Run(int timeoutMs);
+
+    /**
+     * Interrupt a Run() call blocked on another thread
+     */
+    void Wakeup();
+
+    /**
+     * Queue messages for every connected client and write as much as each socket
+     * accepts without blocking. Messages are shared by reference, not copied.
+     * Packets a client's data ID filter or rate limits reject are skipped for that client.
+     * Safe to call from any thread. The client list is only locked to take a snapshot,
+     * so writes to slow sockets never hold up Run() accepting or reading clients.
+     * @param messages the messages, in order
+     * @param count number of messages
+     * @return number of clients the messages were queued for
+     */
+    int Broadcast(const cISBridgeBufferRef* messages, int count);
+
+    /**
+     * Get a client's data ID subscription. Only call from delegate callbacks; the
+     * pointer is valid until the client disconnects.
+     * @param socket the client socket
+     * @return the filter, or NULL if the client is unknown
+     */
+    cISBridgeDidFilter* ClientFilter(is_socket_t socket);
+
+    /**
+     * Union of the data IDs wanted by all clients. set.all is true when any client
+     * is unfiltered or no client is connected.
+     * @param set receives the union
+     */
+    void GetSubscriptions(sISBridgeDidSet& set);
+
+    /**
+     * Union of the data IDs wanted by the clients of several reactors. Reactors without
+     * clients are skipped; set.all is true when any client is unfiltered or no reactor
+     * has a client.
+     * @param reactors the reactors, e.g. one per TCP shard
+     * @param count number of reactors
+     * @param set receives the union
+     */
+    static void GetSubscriptions(cISBridgeTcpReactor* const* reactors, size_t count, sISBridgeDidSet& set);
+
+    /**
+     * Copy data into a buffer and Broadcast() it
+     * @param data the data to write
+     * @param dataLength the number of bytes to write
+     * @return number of clients the data was queued for
+     */
+    int Write(const void* data, int dataLength);
+
+    /**
+     * @return number of connected clients
+     */
+    int ClientCount();
+
+    /**
+     * Snapshot per-client queue statistics
+     * @param stats receives one entry per connected client
+     */
+    void GetClientStats(std::vector<sISBridgeTcpClientStats>& stats);
+
+    /**
+     * @return reactor totals. Lock-free; safe from any thread.
+     */
+    sISBridgeTcpReactorStats GetStats() const;
+
+    /**
+     * Time from each message's Timestamp() to the write that completed it
+     */
+    const cISBridgeHistogram& WriteLatency() const { return m_writeLatency; }
+
+    /**
+     * @return pollable descriptor that becomes readable when Run() has work (the epoll
+     * descriptor or io_uring instance on Linux), or -1 when the poll() fallback is in use
+     */
+    int Fd() const { return m_uring ? m_uring->Fd() : m_pollFd; }
+
+    /**
+     * @return milliseconds until Run() must be called to retry accepting after running
+     * out of descriptors, which Fd() does not report; -1 if no retry is pending
+     */
+    int TimeoutMs() const { return AcceptRetryTimeout(-1); }
+
+    /**
+     * Bytes read from a client per recv() call
+     */
+    static const int kReadBufferSize = 8192;
+
+    /**
+     * Queued messages handed to one sendmsg() call
+     */
+    static const int kMaxWriteIov = 64;
+
+    /**
+     * Linked sendmsg() requests per client in flight with io_uring, each of up to
+     * kMaxWriteIov messages
+     */
+    static const int kUringLinkedSends = 4;
+
+    /**
+     * Registered receive buffers (kReadBufferSize each) shared by all io_uring clients
+     */
+    static const int kUringReadBuffers = 256;
+
+private:
+    cISBridgeTcpReactor(const cISBridgeTcpReactor&) = delete;
+    cISBridgeTcpReactor& operator=(const cISBridgeTcpReactor&) = delete;
+
+    struct sUringState
+    {
+        msghdr msg[kUringLinkedSends];
+        iovec iov[kMaxWriteIov * kUringLinkedSends];
+        int sendsInFlight = 0;              // Under sClient::mutex
+        bool sendBlocked = false;           // New data arrived while sends were in flight
+        bool recvArmed = false;             // Run() thread only
+    };
+
+    struct sClient
+    {
+        is_socket_t socket;
+        std::mutex mutex;                   // Serializes queue access and writes
+        cISBridgeSendQueue queue;
+        std::atomic<bool> writeBlocked;     // Last write hit EAGAIN, wait for writability
+        bool shutdown;                      // Dropped or closed; under mutex, checked before every write
+        cISBridgeDidFilter filter;          // Updated on the Run() thread, read by Broadcast()
+        cISBridgeRateLimiter rates;         // Under mutex
+        std::atomic<uint64_t> bytesRead;    // Only written by the Run() thread
+        uint64_t writeBlocks;
+        cISBridgeTxScheduler tx;            // Under mutex
+        std::unique_ptr<sUringState> uring; // io_uring backend only
+    };
+
+    struct sCounters
+    {
+        std::atomic<uint64_t> accepts = { 0 };
+        std::atomic<uint64_t> disconnects = { 0 };
+        std::atomic<uint64_t> reads = { 0 };
+        std::atomic<uint64_t> bytesRead = { 0 };
+        std::atomic<uint64_t> writeCalls = { 0 };
+        std::atomic<uint64_t> messagesWritten = { 0 };
+        std::atomic<uint64_t> bytesWritten = { 0 };
+        std::atomic<uint64_t> writeBlocks = { 0 };
+        std::atomic<uint64_t> droppedMessages = { 0 };
+        std::atomic<uint64_t> rateSuppressed = { 0 };
+        std::atomic<uint64_t> conflatedMessages = { 0 };
+        std::atomic<uint64_t> txModeSwitches = { 0 };
+        std::atomic<uint64_t> txDeadlineFlushes = { 0 };
+    };
+
+    void AcceptClients();
+
+    /**
+     * Out of file descriptors: give up the reserve descriptor to accept the oldest
+     * pending connection and close it, so the peer is reset instead of waiting in the
+     * backlog where an edge-triggered listener would not report it again
+     * @return 1 if a connection was reset, 0 if none was waiting, -1 without a reserve descriptor
+     */
+    int ShedConnection();
+
+    /**
+     * @return timeoutMs shortened to the pending accept retry, if any
+     */
+    int AcceptRetryTimeout(int timeoutMs) const;
+
+    /**
+     * Set up the listening socket and the event backend
+     */
+    int Attach(is_socket_t listenSocket);
+
+    /**
+     * Configure an accepted socket, register it and notify the delegate
+     * @param handoff subscription of a client handed over from another process, which
+     *        skips the delegate's initial messages; NULL for a new connection
+     * @return false if the client could not be registered (the socket is closed)
+     */
+    bool AddClient(is_socket_t socket, const sISBridgeDidSet* handoff = NULL);
+
+    void ReadClient(is_socket_t socket);
+    void FlushClient(is_socket_t socket);
+    void CloseClient(is_socket_t socket);
+
+    /**
+     * Write queued data until the queue is empty or the socket would block.
+     * Caller holds client.mutex.
+     */
+    void FlushLocked(sClient& client);
+
+    /**
+     * Mark a client dropped and shut the socket down so Run() observes the hangup and
+     * closes it; closing here could race with an event for the same descriptor.
+     * Caller holds client.mutex.
+     */
+    void ShutdownLocked(sClient& client);
+
+    /**
+     * Empty a client's queue, counting every message still in it as dropped. Caller
+     * holds client.mutex.
+     */
+    void DiscardQueueLocked(sClient& client);
+
+    /**
+     * Copy the client list, so clients can be written without holding m_clientsMutex.
+     * A client closed meanwhile stays valid and is marked shutdown.
+     * @param clients receives the clients; its capacity is reused
+     */
+    void SnapshotClients(std::vector<std::shared_ptr<sClient>>& clients);
+
+    /**
+     * Make sure the flush timer fires no later than dueNs
+     */
+    void ArmTxTimer(uint64_t dueNs);
+
+    /**
+     * Flush timer expired: write coalesced data whose deadline has passed and rearm for
+     * the next one. Run() thread only.
+     */
+    void FlushDueClients();
+
+    /**
+     * io_uring backend: reap and dispatch completions
+     */
+    int RunUring(int timeoutMs);
+
+    void HandleCompletion(const sISBridgeUringCompletion& completion);
+
+    /**
+     * io_uring backend: queue the client's backlog as linked sends unless a chain is
+     * already in flight. Caller holds client.mutex; requests go out with the next Submit().
+     */
+    void SendLocked(sClient& client);
+
+    /**
+     * Find a connected or closing client. Run() thread only.
+     */
+    sClient* FindClient(is_socket_t socket);
+
+    /**
+     * Close a disconnected client once no io_uring request references it. Run() thread only.
+     */
+    void ReleaseClosing(is_socket_t socket);
+
+    iISBridgeTcpReactorDelegate* m_delegate;
+    is_socket_t m_listenSocket;
+    int m_pollFd;                       // epoll instance (Linux only)
+    int m_reserveFd;                    // Spare descriptor for ShedConnection() (POSIX only)
+    uint64_t m_acceptRetryNs;           // When to retry accepting after a hard failure, 0 if none
+    cISBridgeWakeup m_wakeup;
+    sISBridgeSendQueueLimits m_queueLimits;
+    sISBridgeRateLimits m_rateLimits;
+    eISBridgeTcpBackend m_backend;
+    std::unique_ptr<cISBridgeUring> m_uring;
+    std::atomic<int> m_uringPending;    // io_uring requests not yet finally completed
+    bool m_paused;                      // Between HandOff() and Resume() or Close(); io_uring requests are not rearmed
+    std::map<is_socket_t, std::shared_ptr<sClient>> m_closing; // Disconnected, requests still in flight; Run() thread only
+    int m_busyPollUs;
+    bool m_busyPollWarned;              // SO_BUSY_POLL failure logged once
+    bool m_reusePort;
+    cISBridgeTraceRing* m_trace;
+    sISBridgeTxOptions m_txOptions;
+    int m_txTimer;                      // timerfd for coalescing deadlines (Linux, adaptive only)
+    std::mutex m_txTimerMutex;
+    uint64_t m_txTimerDueNs;            // Armed expiry, 0 when disarmed; under m_txTimerMutex
+    std::mutex m_clientsMutex;          // Protects m_clients; only the Run() thread erases
+    std::map<is_socket_t, std::shared_ptr<sClient>> m_clients;
+    std::mutex m_broadcastMutex;        // Keeps Broadcast() calls in order
+    std::vector<std::shared_ptr<sClient>> m_broadcastClients;  // Broadcast() snapshot, under m_broadcastMutex
+    std::vector<std::shared_ptr<sClient>> m_dueClients;        // FlushDueClients() snapshot, Run() thread only
+#if !defined(__linux__)
+    std::vector<pollfd> m_pollFds;      // poll() set, rebuilt in place by Run()
+#endif
+    sCounters m_counters;
+    cISBridgeHistogram m_writeLatency;
+    std::vector<cISBridgeBufferRef> m_initial;     // OnClientAccepting() messages, Run() thread only
+    uint8_t m_readBuffer[kReadBufferSize];
+};
+
+#endif // __ISBRIDGETCPREACTOR__H__
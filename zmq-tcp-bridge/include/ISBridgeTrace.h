@@ -0,0 +1,166 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGETRACE__H__
+#define __ISBRIDGETRACE__H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeBuffer.h"
+
+/*
+ * Static tracepoints (USDT), provider "isbridge"
+ *
+ * With <sys/sdt.h> (systemtap-sdt-dev / systemtap-sdt-devel) at build time each probe is
+ * a single nop plus an ELF note, so it costs nothing until perf or bpftrace attaches, e.g.
+ *   bpftrace -e 'usdt:./zmq_tcp_bridge:isbridge:tcp_write { @[arg1] = count(); }'
+ * Without the header, or with BRIDGE_NO_USDT defined, the probes compile to nothing.
+ * Arguments must be integers or pointers that are already at hand: they are evaluated
+ * even while no tracer is attached.
+ */
+#if defined(__linux__) && !defined(BRIDGE_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BRIDGE_HAVE_USDT 1
+#endif
+#endif
+
+#if defined(BRIDGE_HAVE_USDT)
+#define BRIDGE_TRACE1(probe, a)             DTRACE_PROBE1(isbridge, probe, a)
+#define BRIDGE_TRACE2(probe, a, b)          DTRACE_PROBE2(isbridge, probe, a, b)
+#define BRIDGE_TRACE3(probe, a, b, c)       DTRACE_PROBE3(isbridge, probe, a, b, c)
+#else
+#define BRIDGE_TRACE1(probe, a)             do {} while (0)
+#define BRIDGE_TRACE2(probe, a, b)          do {} while (0)
+#define BRIDGE_TRACE3(probe, a, b, c)       do {} while (0)
+#endif
+
+/**
+ * Forwarding stages stamped in a sampled trace record
+ */
+enum eISBridgeTraceStage
+{
+    // ZMQ → TCP
+    BRIDGE_TRACE_ZMQ_RECEIVED = 0,  // Received from the SUB socket
+    BRIDGE_TRACE_BATCHED,           // Framed, merged and added to the fan-out batch
+    BRIDGE_TRACE_FANOUT,            // Batch handed to the TCP fan-out, after in-process consumers
+    BRIDGE_TRACE_TCP_FIRST_WRITE,   // First client write completed
+    BRIDGE_TRACE_TCP_LAST_WRITE,    // Latest client write completed so far
+
+    // TCP → ZMQ
+    BRIDGE_TRACE_ZMQ_QUEUED,        // Read from a client and queued for the send socket
+    BRIDGE_TRACE_ZMQ_PUBLISHED,     // Handed to libzmq
+
+    BRIDGE_TRACE_STAGE_COUNT
+};
+
+/**
+ * One sampled message. Stage times are bridgeClockNs() values, 0 for stages not reached.
+ */
+struct sISBridgeTraceRecord
+{
+    uint64_t id = 0;                // Sample number, increasing
+    bool tcpToZmq = false;
+    uint32_t size = 0;
+    uint8_t protocol = 0;           // As in cISBridgeBuffer::SetPacketInfo()
+    uint8_t type = 0;
+    uint16_t packetId = 0;
+    uint64_t stageNs[BRIDGE_TRACE_STAGE_COUNT] = {};
+};
+
+/**
+ * Lock-free ring of sampled per-message trace records
+ *
+ * The thread that samples a message claims the next slot with one atomic add and tags
+ * the buffer with the record's ID; whichever thread handles a later stage stamps the
+ * record through that ID. A stamp for a record that has since been overwritten is
+ * ignored. Snapshot() reads every slot like a seqlock and skips records being
+ * rewritten, so it can run from any thread while forwarding goes on. Nothing here
+ * allocates or locks after construction.
+ */
+class cISBridgeTraceRing
+{
+public:
+    /**
+     * Constructor
+     * @param capacity records kept, rounded up to a power of two
+     * @param sampleEvery trace one of every sampleEvery messages
+     */
+    cISBridgeTraceRing(size_t capacity, int sampleEvery);
+
+    /**
+     * @return true if the calling thread should trace the next message. Any thread.
+     */
+    bool Sample()
+    {
+        return m_sampleCounter.fetch_add(1, std::memory_order_relaxed) % m_sampleEvery == 0;
+    }
+
+    /**
+     * Start a record for a message
+     * @param tcpToZmq direction
+     * @param buffer the message; its size and packet info are recorded and its trace ID set
+     * @return the record ID
+     */
+    uint64_t Begin(bool tcpToZmq, cISBridgeBuffer& buffer);
+
+    /**
+     * Stamp a stage of a record. BRIDGE_TRACE_TCP_FIRST_WRITE keeps the earliest and
+     * BRIDGE_TRACE_TCP_LAST_WRITE the latest stamp; other stages keep the last one.
+     * @param id record ID from Begin()
+     * @param stage the stage
+     * @param ns bridgeClockNs() value
+     */
+    void Stamp(uint64_t id, eISBridgeTraceStage stage, uint64_t ns);
+
+    /**
+     * Copy the records currently held, oldest first
+     * @param records receives the records
+     */
+    void Snapshot(std::vector<sISBridgeTraceRecord>& records) const;
+
+    /**
+     * Format records as one JSON object per line
+     * @param records the records
+     * @param out receives the text
+     */
+    static void FormatJson(const std::vector<sISBridgeTraceRecord>& records, std::string& out);
+
+    /**
+     * @return name of a stage, as used by FormatJson()
+     */
+    static const char* StageName(eISBridgeTraceStage stage);
+
+private:
+    cISBridgeTraceRing(const cISBridgeTraceRing&) = delete;
+    cISBridgeTraceRing& operator=(const cISBridgeTraceRing&) = delete;
+
+    struct sSlot
+    {
+        std::atomic<uint64_t> id;       // 0 while the slot is being rewritten
+        std::atomic<uint64_t> info;     // Direction, size and packet info, packed
+        std::atomic<uint64_t> stageNs[BRIDGE_TRACE_STAGE_COUNT];
+    };
+
+    std::unique_ptr<sSlot[]> m_slots;
+    size_t m_mask;
+    uint64_t m_sampleEvery;
+    std::atomic<uint64_t> m_sampleCounter;
+    std::atomic<uint64_t> m_next;       // Last record ID handed out
+};
+
+#endif // __ISBRIDGETRACE__H__
@@ -0,0 +1,138 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGETXSCHEDULER__H__
+#define __ISBRIDGETXSCHEDULER__H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * How a client's queued data is handed to the kernel
+ */
+enum eISBridgeTxMode
+{
+    BRIDGE_TX_IMMEDIATE = 0,            // Written on every Broadcast(), pushed out at once (TCP_NODELAY)
+    BRIDGE_TX_COALESCE,                 // Held until flushBytes are queued or flushUs has passed, written with MSG_MORE between calls
+};
+
+/**
+ * Adaptive transmit scheduling for TCP clients
+ */
+struct sISBridgeTxOptions
+{
+    bool adaptive = false;              // Off: every client stays BRIDGE_TX_IMMEDIATE with the kernel's send buffer sizing
+    int coalesceRate = 2000;            // Messages per second from which a client is treated as bulk
+    int flushUs = 2000;                 // Longest a coalescing client's data is held
+    int flushBytes = 16384;             // Queued bytes that flush a coalescing client at once
+    int sampleMs = 100;                 // How often each client's rate and TCP_INFO are sampled
+    int minSndbuf = 16384;              // SO_SNDBUF sizing bounds; maxSndbuf 0 leaves SO_SNDBUF to the kernel
+    int maxSndbuf = 4 * 1024 * 1024;
+};
+
+/**
+ * Per-client transmit scheduler state snapshot
+ */
+struct sISBridgeTxStats
+{
+    eISBridgeTxMode mode = BRIDGE_TX_IMMEDIATE;
+    uint64_t modeSwitches = 0;
+    double messageRate = 0.0;           // Messages per second over the last sample
+    uint32_t rttUs = 0;                 // Smoothed RTT from TCP_INFO
+    uint32_t notSentBytes = 0;          // Bytes in the socket not yet sent (SIOCOUTQNSD)
+    int sndbuf = 0;                     // SO_SNDBUF requested by the scheduler, 0 if left to the kernel
+};
+
+/**
+ * Chooses, per TCP client, between writing immediately and coalescing
+ *
+ * Every sampleMs the scheduler measures the client's message and byte rate and reads
+ * TCP_INFO and the socket's unsent byte count. A client becomes bulk when it receives
+ * coalesceRate messages per second or more, or when the kernel already holds unsent data
+ * for it (congestion or receive window limited), so holding data back adds no latency
+ * it would not already see. It returns to immediate writes once the rate falls below half
+ * of coalesceRate with nothing left unsent, so clients near the threshold do not flap.
+ *
+ * A coalescing client's data is written when flushBytes are queued or flushUs after the
+ * first held message, whichever comes first, in as few sendmsg() calls as possible with
+ * MSG_MORE set on all but the last. TCP_NODELAY stays on in both modes: Nagle's algorithm
+ * would hold the tail until an ACK and make the deadline unbounded.
+ *
+ * SO_SNDBUF is sized to twice the client's bandwidth-delay product (byte rate times RTT
+ * plus flushUs), within minSndbuf..maxSndbuf. Low-rate clients get a small kernel buffer,
+ * so a backlog stays in the bridge queue where the drop policy and conflation apply
+ * instead of aging in the kernel.
+ *
+ * Linux only; elsewhere every client stays BRIDGE_TX_IMMEDIATE. Not thread safe; the
+ * owner serializes access.
+ */
+class cISBridgeTxScheduler
+{
+public:
+    cISBridgeTxScheduler();
+
+    void SetOptions(const sISBridgeTxOptions& options);
+
+    eISBridgeTxMode Mode() const { return m_stats.mode; }
+
+    /**
+     * Account messages just queued for the client
+     * @param messages number of messages
+     * @param bytes their total size
+     * @param queuedBytes bytes now waiting in the client's queue
+     * @param nowNs current bridgeClockNs()
+     * @return true to write now, false to hold the data until DeadlineNs()
+     */
+    bool OnQueued(int messages, size_t bytes, size_t queuedBytes, uint64_t nowNs);
+
+    /**
+     * The client's queue is being written; nothing is held any more
+     */
+    void OnFlushed() { m_deadlineNs = 0; }
+
+    /**
+     * @return when held data must be written, 0 if nothing is held
+     */
+    uint64_t DeadlineNs() const { return m_deadlineNs; }
+
+    /**
+     * @return true if Sample() is due
+     */
+    bool SampleDue(uint64_t nowNs) const { return m_options.adaptive && nowNs >= m_nextSampleNs; }
+
+    /**
+     * Measure the client and its socket, pick the mode and resize SO_SNDBUF
+     * @param socket the client socket
+     * @param writeBlocked the client's last write hit EAGAIN
+     * @param nowNs current bridgeClockNs()
+     */
+    void Sample(int socket, bool writeBlocked, uint64_t nowNs);
+
+    /**
+     * @return flags for a sendmsg() call, MSG_MORE when coalescing and more data follows
+     */
+    int SendFlags(bool more) const;
+
+    const sISBridgeTxStats& Stats() const { return m_stats; }
+
+private:
+    sISBridgeTxOptions m_options;
+    sISBridgeTxStats m_stats;
+    uint64_t m_deadlineNs;
+    uint64_t m_nextSampleNs;
+    uint64_t m_lastSampleNs;
+    uint64_t m_messages;                // Since the last sample
+    uint64_t m_bytes;
+};
+
+#endif // __ISBRIDGETXSCHEDULER__H__
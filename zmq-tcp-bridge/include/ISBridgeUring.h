@@ -0,0 +1,186 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEURING__H__
+#define __ISBRIDGEURING__H__
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include "ISBridgeSocket.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+/**
+ * One reaped io_uring completion
+ */
+struct sISBridgeUringCompletion
+{
+    uint64_t userData = 0;
+    int result = 0;                 // Bytes, descriptor or -errno
+    bool more = false;              // Multishot request stays armed
+    bool hasBuffer = false;         // A provided receive buffer was used
+    uint16_t bufferId = 0;
+};
+
+/**
+ * Minimal io_uring instance used by the TCP reactor's io_uring backend
+ *
+ * Talks to the kernel ABI directly (no liburing dependency). Submission is serialized
+ * by an internal mutex so any thread may queue requests; completions must be reaped by
+ * a single thread. Receive buffers come from one registered provided-buffer ring that
+ * multishot receives pick from.
+ *
+ * Open() fails on kernels without multishot receive (Linux 6.0) or where io_uring is
+ * disabled, and on platforms without io_uring; callers fall back to epoll.
+ */
+class cISBridgeUring
+{
+public:
+    cISBridgeUring();
+    ~cISBridgeUring();
+
+    /**
+     * Create the ring and register the receive buffer ring
+     * @param entries submission queue entries (power of two); the completion queue is 4x
+     * @param bufferCount number of receive buffers (power of two)
+     * @param bufferSize bytes per receive buffer
+     * @return 0 if success, otherwise -1 with errno set
+     */
+    int Open(unsigned entries, unsigned bufferCount, unsigned bufferSize);
+
+    void Close();
+
+    bool IsOpen() const { return m_fd >= 0; }
+
+    /**
+     * @return ring descriptor, readable while completions are waiting
+     */
+    int Fd() const { return m_fd; }
+
+    /**
+     * Queue a multishot accept. Accepted sockets are close-on-exec.
+     */
+    int PrepAccept(int fd, uint64_t userData);
+
+    /**
+     * Queue a multishot receive into the provided buffers
+     */
+    int PrepRecv(int fd, uint64_t userData);
+
+    /**
+     * Queue a chain of linked sendmsg() calls. Each waits for the one before it and is
+     * cancelled if that one fails or, with MSG_WAITALL, comes up short. All or none
+     * are queued.
+     * @param msgs the messages; must stay valid until their completions are reaped
+     * @param count number of messages
+     * @param flags MSG_* flags for every call
+     * @return 0 if queued, -1 if the submission queue has no room
+     */
+    int PrepSendmsgChain(int fd, const msghdr* msgs, int count, int flags, uint64_t userData);
+
+    /**
+     * Queue a multishot readability poll
+     */
+    int PrepPoll(int fd, uint64_t userData);
+
+    /**
+     * Queue cancellation of every outstanding request
+     */
+    int PrepCancelAll(uint64_t userData);
+
+    /**
+     * Hand queued requests to the kernel
+     * @return number submitted, -1 on error
+     */
+    int Submit();
+
+    /**
+     * Wait for at least one completion
+     * @param timeoutMs maximum time to wait, -1 forever, 0 to only flush deferred work
+     * @return 0 if success or timeout, -1 on error
+     */
+    int Wait(int timeoutMs);
+
+    /**
+     * Pop the next completion
+     * @return false if none is waiting
+     */
+    bool Next(sISBridgeUringCompletion& completion);
+
+    /**
+     * @return a provided receive buffer named by a completion
+     */
+    uint8_t* Buffer(uint16_t bufferId) const { return m_buffers + static_cast<size_t>(bufferId) * m_bufferSize; }
+
+    /**
+     * Return a receive buffer to the kernel once its data has been consumed
+     */
+    void RecycleBuffer(uint16_t bufferId);
+
+private:
+    cISBridgeUring(const cISBridgeUring&) = delete;
+    cISBridgeUring& operator=(const cISBridgeUring&) = delete;
+
+    /**
+     * Next free submission entry, zeroed; submits queued entries first if full.
+     * Caller holds m_submitMutex.
+     */
+    io_uring_sqe* GetSqe();
+
+    /**
+     * Free submission entries after submitting queued ones if needed. Caller holds m_submitMutex.
+     */
+    unsigned SqSpace();
+
+    /**
+     * Publish queued entries and enter the kernel. Caller holds m_submitMutex.
+     */
+    int SubmitLocked();
+
+    int m_fd;
+    std::mutex m_submitMutex;
+
+    // Submission queue
+    void* m_sqRing;
+    size_t m_sqRingSize;
+    io_uring_sqe* m_sqes;
+    size_t m_sqesSize;
+    unsigned* m_sqHead;
+    unsigned* m_sqTail;
+    unsigned* m_sqFlags;
+    unsigned m_sqMask;
+    unsigned m_sqEntries;
+    unsigned m_sqLocalTail;         // Entries prepared, published to m_sqTail by Submit()
+
+    // Completion queue
+    void* m_cqRing;
+    size_t m_cqRingSize;
+    unsigned* m_cqHead;
+    unsigned* m_cqTail;
+    unsigned m_cqMask;
+    io_uring_cqe* m_cqes;
+
+    // Provided receive buffers
+    io_uring_buf* m_bufRing;        // Entry 0's reserved field doubles as the ring tail
+    size_t m_bufRingSize;
+    uint8_t* m_buffers;
+    size_t m_buffersSize;
+    unsigned m_bufferSize;
+    unsigned m_bufferCount;
+    uint16_t m_bufTail;
+};
+
+#endif // __ISBRIDGEURING__H__
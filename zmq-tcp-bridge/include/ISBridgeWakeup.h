@@ -0,0 +1,70 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISBRIDGEWAKEUP__H__
+#define __ISBRIDGEWAKEUP__H__
+
+#include "ISBridgeSocket.h"
+
+/**
+ * Pollable wakeup signal
+ *
+ * Wraps a Linux eventfd (a non-blocking pipe on other POSIX platforms, a connected
+ * loopback socket pair on Windows, where zmq_poll() only accepts sockets) so a
+ * thread blocked in zmq_poll()/epoll_wait() can be woken from another thread,
+ * e.g. by Stop(). The descriptor returned by Fd() becomes readable after
+ * Signal() and stays readable until Drain() is called.
+ */
+class cISBridgeWakeup
+{
+public:
+    cISBridgeWakeup();
+    ~cISBridgeWakeup();
+
+    /**
+     * Create the underlying descriptor(s)
+     * @return 0 if success, otherwise -1
+     */
+    int Open();
+
+    /**
+     * Close the underlying descriptor(s)
+     */
+    void Close();
+
+    /**
+     * Make Fd() readable. Safe to call from any thread, including signal handlers.
+     */
+    void Signal();
+
+    /**
+     * Consume all pending signals so Fd() is no longer readable
+     */
+    void Drain();
+
+    /**
+     * @return descriptor to poll for readability, or -1 if not open
+     */
+    is_socket_t Fd() const { return m_readFd; }
+
+    bool IsOpen() const { return bridgeSocketValid(m_readFd); }
+
+private:
+    cISBridgeWakeup(const cISBridgeWakeup&) = delete;
+    cISBridgeWakeup& operator=(const cISBridgeWakeup&) = delete;
+
+    is_socket_t m_readFd;
+    is_socket_t m_writeFd;
+};
+
+#endif // __ISBRIDGEWAKEUP__H__
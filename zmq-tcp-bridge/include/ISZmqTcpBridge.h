@@ -18,13 +18,298 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <vector>
+#include <unordered_map>
 #include "ISTcpServer.h"
+#include "ISBridgeWakeup.h"
+#include "ISBridgeTcpReactor.h"
+#include "ISBridgePacketFramer.h"
+#include "ISBridgeMetrics.h"
+#include "ISBridgeCapture.h"
+#include "ISBridgeLastValueCache.h"
+#include "ISBridgeMpscQueue.h"
+#include "ISBridgeRuntime.h"
+#include "ISBridgeConsumer.h"
+#include "ISBridgeReorderBuffer.h"
+#include "ISBridgeBroadcastRing.h"
+#include "ISBridgeHandoff.h"
+#include "ISBridgeTrace.h"
 
 // Forward declarations to avoid including headers
 namespace zmq {
     class context_t;
     class socket_t;
 }
+class cISBridgePollExecutor;
+class cISBridgeService;
+
+/**
+ * TCP → ZMQ send lanes
+ */
+enum eISBridgeZmqLane
+{
+    BRIDGE_ZMQ_LANE_BULK = 0,       // Data, corrections, firmware; paced by bulkBytesPerTick
+    BRIDGE_ZMQ_LANE_CONTROL,        // Commands; published ahead of bulk
+};
+
+/**
+ * Tuning options for cISZmqTcpBridge. Set with SetOptions() before Start().
+ */
+struct sISZmqTcpBridgeOptions
+{
+    /** Maximum ZMQ messages combined into one vectored write per TCP client */
+    int maxBatchMessages = 64;
+
+    /**
+     * ZMQ messages after which a ServiceZmq() call or ZMQ thread pass stops receiving.
+     * Each SUB socket gives up to maxBatchMessages per round, and queued TCP → ZMQ
+     * messages are published between rounds, so a publisher that never lets the bridge
+     * drain cannot hold up client commands. What is left waits for the next pass, which
+     * ZmqTimeoutMs() asks for right away.
+     */
+    int zmqRecvBudget = 1024;
+
+    /**
+     * Maximum time (microseconds) to hold a partial batch waiting for more messages. 0
+     * flushes as soon as the SUB socket is drained. The hold never blocks forwarding:
+     * commands are published and other sockets serviced meanwhile. cISBridgeService waits
+     * for it to the nanosecond with cISBridgePollExecutor on Linux; elsewhere, and for
+     * bridges serviced on ZmqTimeoutMs(), holds are rounded up to whole milliseconds.
+     */
+    int maxBatchHoldUs = 0;
+
+    /** Per-client send queue bounds and drop policy (drop-oldest, drop-newest or disconnect). clientQueue.conflate implies ZMQ → TCP framing. */
+    sISBridgeSendQueueLimits clientQueue;
+
+    /**
+     * Maximum rate of each ISB data ID sent to every TCP client, for clients such as GUIs
+     * and loggers that only need a fraction of the device rate. Override per client with
+     * SetClientRateLimits(). Any limit implies ZMQ → TCP framing.
+     */
+    sISBridgeRateLimits clientRateLimits;
+
+    /** Data bytes per pooled buffer for TCP → ZMQ messages. Matches the TCP read size so every read fits. */
+    size_t poolBlockSize = cISBridgeTcpReactor::kReadBufferSize;
+
+    /** Pooled data buffers for TCP → ZMQ messages */
+    size_t poolBlockCount = 1024;
+
+    /** TCP → ZMQ messages waiting for the thread that owns the ZMQ send socket; when full, new messages are dropped */
+    size_t zmqSendQueueCapacity = 4096;
+
+    /** Pooled handles wrapping received ZMQ → TCP messages; bounds messages in flight across all client queues before heap fallback */
+    size_t poolMessageCount = 16384;
+
+    /** Split ZMQ → TCP messages into whole ISB/NMEA/RTCM3/UBX packets and drop corrupt frames before fan-out */
+    bool frameZmqToTcp = false;
+
+    /** Reassemble each TCP client's stream into whole packets and publish one ZMQ message per packet */
+    bool frameTcpToZmq = false;
+
+    /**
+     * Publish TCP → ZMQ control packets (ISB commands, NMEA) from their own queue ahead of
+     * bulk traffic such as RTCM3 corrections or firmware images, so a command is never
+     * stuck behind a large upload. Implies TCP → ZMQ framing.
+     */
+    bool zmqControlLane = false;
+
+    /** Packets larger than this are bulk whatever their type */
+    size_t controlMaxBytes = 512;
+
+    /** Control packets waiting to be published; when full, new ones are dropped */
+    size_t zmqControlQueueCapacity = 256;
+
+    /**
+     * Bulk bytes published per bulkTickUs, 0 for no pacing. Bulk left over waits in the
+     * send queue for the next tick while control packets keep going out, which bounds how
+     * long a control packet can wait behind bulk to about one tick's budget.
+     */
+    size_t bulkBytesPerTick = 0;
+
+    /** Bulk pacing interval in microseconds */
+    int bulkTickUs = 1000;
+
+    /**
+     * Forward ISB data packets to each TCP client only for the data IDs it requested with
+     * get-data commands. Implies ZMQ → TCP framing. Clients that have not requested a
+     * broadcast with get-data, or that enabled RMC streams, receive everything.
+     */
+    bool filterByDid = false;
+
+    /**
+     * Topic prefix the publisher tags ISB data with, empty if untagged. When set, messages
+     * are multipart [topic][packet] with topic = prefix + one DID byte, and the SUB socket
+     * subscribes only to the union of DIDs wanted by all clients (everything while any
+     * client is unfiltered). Requires filterByDid.
+     */
+    std::string zmqDidTopicPrefix;
+
+    /** Topics always subscribed while DID topics are pushed down, for untagged traffic such as NMEA or RTCM3 */
+    std::vector<std::string> zmqPassTopics;
+
+    /**
+     * Keep the latest ISB data packet of each data ID in lastValueDids and send them to
+     * every new TCP client before live data, so slow messages (DEV_INFO, flash config,
+     * RTK status) arrive immediately. Implies ZMQ → TCP framing.
+     */
+    bool lastValueCache = false;
+
+    /** Data IDs the last-value cache keeps; all (the default) keeps every ID */
+    sISBridgeDidSet lastValueDids;
+
+    /** Byte budget of the last-value cache */
+    size_t lastValueMaxBytes = cISBridgeLastValueCache::kDefaultMaxBytes;
+
+    /**
+     * Append every message in both directions, plus client connects and disconnects, to
+     * memory-mapped segment files <capturePath>.000, .001, ... Empty disables capture.
+     * Recording never blocks forwarding; records are dropped and counted if the capture
+     * writer falls behind.
+     */
+    std::string capturePath;
+
+    /** Size of each capture segment file */
+    size_t captureSegmentBytes = cISBridgeCaptureWriter::kDefaultSegmentBytes;
+
+    /** Scheduling of the ZMQ-to-TCP thread started by Start(), which also publishes TCP → ZMQ messages */
+    sISBridgeThreadProfile zmqThread;
+
+    /** Scheduling of the TCP reactor thread started by Start() */
+    sISBridgeThreadProfile tcpThread;
+
+    /**
+     * Spin on ZMQ and TCP readiness instead of blocking, and set SO_BUSY_POLL on TCP
+     * client sockets. Each forwarding thread then keeps a core fully busy in exchange
+     * for the lowest tail latency; pin them to isolated cores with zmqThread/tcpThread.
+     */
+    bool busyPoll = false;
+
+    /** SO_BUSY_POLL time in microseconds with busyPoll */
+    int busyPollUs = 50;
+
+    /**
+     * TCP socket I/O backend. BRIDGE_TCP_BACKEND_IO_URING batches every client's writes
+     * into one kernel entry per broadcast and falls back to epoll when the kernel does
+     * not support it (Linux 6.0 or later is needed).
+     */
+    eISBridgeTcpBackend tcpBackend = BRIDGE_TCP_BACKEND_EPOLL;
+
+    /**
+     * Per-client transmit scheduling. With tx.adaptive, bulk clients have their writes
+     * coalesced up to tx.flushUs and SO_SNDBUF sized to their bandwidth-delay product,
+     * while low-rate clients keep immediate writes (see cISBridgeTxScheduler).
+     */
+    sISBridgeTxOptions tx;
+
+    /** Capture ring per direction; bounds the largest message captured and how far the writer may lag */
+    size_t captureRingBytes = cISBridgeCaptureWriter::kDefaultRingBytes;
+
+    /**
+     * Publishers send their own timestamp as an 8-byte little-endian nanosecond frame
+     * just before the packet: [timestamp][packet], or [topic][timestamp][packet] with
+     * DID topics. Messages without it are forwarded as usual.
+     */
+    bool zmqTimestampFrame = false;
+
+    /**
+     * With several ZMQ receive endpoints and zmqTimestampFrame, the longest time
+     * (microseconds) a packet is held to merge the endpoints into publisher timestamp
+     * order. Publisher clocks must be synchronized to well within the window. 0 forwards
+     * in arrival order.
+     */
+    int mergeWindowUs = 0;
+
+    /** Most packets the merge holds; the oldest is released early when full */
+    size_t mergeMaxMessages = 4096;
+
+    /**
+     * TCP reactor shards started by Start(). Each shard is a thread with its own reactor
+     * listening on the TCP port with SO_REUSEPORT, so the kernel spreads connections
+     * across them and client writes run in parallel. ZMQ → TCP batches reach the shards
+     * through a shared broadcast ring. Shard i is pinned to tcpThread.cpu + i when
+     * tcpThread pins. Hosted bridges (Open()) always use one.
+     */
+    int tcpShards = 1;
+
+    /** Broadcast ring slots with several shards; messages are dropped for a shard this far behind */
+    size_t shardRingMessages = 16384;
+
+    /**
+     * Unix socket path of a running bridge to take over from (Start() only). Once this
+     * bridge's ZMQ sockets have connected, the running one hands over its listening and
+     * client sockets (see HandOff()), so SDK clients stay connected across a restart.
+     * Starts normally when no bridge is listening there.
+     */
+    std::string handoffPath;
+
+    /** Longest wait (ms) for the ZMQ sockets to connect before taking over anyway, for each hand-off message and for the acknowledgement */
+    int handoffTimeoutMs = 2000;
+
+    /** ZMQ_RECONNECT_IVL: delay (ms) before reconnecting to a ZMQ peer that went away */
+    int zmqReconnectIvlMs = 10;
+
+    /** ZMQ_RECONNECT_IVL_MAX: the reconnect delay doubles up to this (ms); 0 keeps it fixed */
+    int zmqReconnectIvlMaxMs = 1000;
+
+    /**
+     * Trace one of every traceSampleEvery messages in either direction: stamp each
+     * forwarding stage it passes into a ring of traceRecords records, read with
+     * GetTraceRecords(). 0 disables sampling; the static tracepoints are always there.
+     */
+    int traceSampleEvery = 0;
+
+    /** Sampled trace records kept; older ones are overwritten */
+    size_t traceRecords = 4096;
+};
+
+/**
+ * One ZMQ receive endpoint
+ */
+struct sISBridgeZmqSourceStats
+{
+    std::string endpoint;
+    uint64_t messages = 0;              // Messages received from this endpoint
+    uint64_t bytes = 0;
+    sISBridgeReorderSourceStats merge;  // Watermark and late packets, when merging
+};
+
+/**
+ * Bridge statistics snapshot. Counters are totals since Open().
+ */
+struct sISZmqTcpBridgeStats
+{
+    bool running = false;
+    int tcpPort = 0;                        // Port bound, also when Start() was given 0
+    eISBridgeTcpBackend tcpBackend = BRIDGE_TCP_BACKEND_EPOLL;   // Backend in use, after any fallback
+    int tcpShards = 0;
+
+    // ZMQ → TCP
+    uint64_t zmqRxMessages = 0;             // Messages received on the SUB socket
+    uint64_t zmqRxBytes = 0;
+    std::vector<sISBridgeZmqSourceStats> zmqSources;
+    sISBridgeReorderStats merge;            // Packets held and released by the multi-endpoint merge
+    sISBridgeHistogramStats latency;        // ZMQ receive to TCP write completion, per client
+    sISBridgeBroadcastRingStats shardRing;  // Hand-off to the TCP shards, when there are several
+
+    // TCP → ZMQ
+    uint64_t zmqTxMessages = 0;             // Messages published
+    uint64_t zmqTxBytes = 0;
+    uint64_t zmqTxEagain = 0;               // Non-blocking sends refused with EAGAIN
+    uint64_t zmqTxErrors = 0;               // Other send failures, including pool exhaustion
+    sISBridgeMpscQueueStats zmqSendQueue;   // Messages waiting to be published; drops when full
+    sISBridgeMpscQueueStats zmqControlQueue; // Control packets waiting, with zmqControlLane
+    uint64_t zmqBulkDeferred = 0;           // Drains that left bulk queued for the next pacing tick
+    sISBridgeHistogramStats controlLatency; // Control packet queued to published, with zmqControlLane
+
+    sISBridgeTcpReactorStats tcp;           // Accepts (reconnects), reads, writes and queue drops
+    std::vector<sISBridgeTcpClientStats> clients;
+    sISBridgeBufferPoolStats dataPool;
+    sISBridgeBufferPoolStats messagePool;
+    sISBridgeFramerStats zmqFramer;
+    sISBridgeFramerStats tcpFramer;
+    sISBridgeCaptureStats capture;
+    sISBridgeLastValueCacheStats lastValueCache;
+};
 
 /**
  * ZMQ-to-TCP Bridge
@@ -33,7 +318,7 @@ namespace zmq {
  * It allows the original InertialSense SDK to communicate via TCP without needing ZMQ support.
  * 
  * Architecture:
- * - ZMQ Publisher (external) ←→ ZMQ SUB/PUB sockets ←→ Bridge ←→ TCP Server ←→ SDK Client
+ * - ZMQ Publisher (external) ←→ ZMQ SUB/PUB sockets ←→ Bridge ←→ TCP Reactor ←→ SDK Client
  * 
  * The bridge implements full bidirectional communication:
  * - ZMQ → TCP: Data from ZMQ publishers is forwarded to connected TCP clients
@@ -58,20 +343,149 @@ public:
     virtual ~cISZmqTcpBridge();
 
     /**
-     * Start the bridge
+     * Start the bridge: open it as Open() does, with options.tcpShards TCP shards, then
+     * start one thread for ZMQ and one per shard. Each runs a cISBridgePollExecutor with
+     * a cISBridgeService for its part of the bridge, the same ServiceZmq() / ServiceTcp()
+     * path cISBridgeAsync runs for the whole bridge on an application's executor.
      * @param zmqRecvEndpoint ZMQ endpoint to receive data from (e.g., "tcp://127.0.0.1:7115")
      * @param zmqSendEndpoint ZMQ endpoint to send data to (e.g., "tcp://127.0.0.1:7116")
-     * @param tcpPort TCP port for SDK clients to connect to
+     * @param tcpPort TCP port for SDK clients to connect to, 0 for any free port
+     *        (GetStats() reports the one bound)
      * @return 0 if success, otherwise an error code
      */
     int Start(const std::string& zmqRecvEndpoint, const std::string& zmqSendEndpoint, int tcpPort);
 
+    /**
+     * Start the bridge with several ZMQ endpoints to receive from, all forwarded to the
+     * same TCP clients. With zmqTimestampFrame and mergeWindowUs set, their packets are
+     * merged in publisher timestamp order; otherwise in arrival order.
+     * @param zmqRecvEndpoints ZMQ endpoints to receive data from, at least one
+     * @param zmqSendEndpoint ZMQ endpoint to send data to
+     * @param tcpPort TCP port for SDK clients to connect to
+     * @return 0 if success, otherwise an error code
+     */
+    int Start(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort);
+
+    /**
+     * Open the bridge sockets without starting forwarding threads. The caller drives
+     * forwarding with ServiceZmq() and ServiceTcp() when ZmqRecvHandle() / WakeupFd() /
+     * TcpFd() are readable, e.g. from cISZmqTcpBridgeHost. All three must be serviced
+     * from the same thread, which owns the ZMQ sockets. Stop() closes it.
+     * @param zmqRecvEndpoint ZMQ endpoint to receive data from
+     * @param zmqSendEndpoint ZMQ endpoint to send data to
+     * @param tcpPort TCP port for SDK clients to connect to
+     * @param sharedContext ZMQ context to create sockets on, or NULL for a private context.
+     *        Stop() does not close a shared context. Close it before destroying the
+     *        bridge: messages libzmq still queues reference the bridge's buffers.
+     * @return 0 if success, otherwise an error code
+     */
+    int Open(const std::string& zmqRecvEndpoint, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext = NULL);
+
+    /**
+     * Open() with several ZMQ receive endpoints. The caller polls every ZmqRecvHandle()
+     * and, while merging, calls ServiceZmq() at least every ZmqTimeoutMs().
+     */
+    int Open(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext = NULL);
+
+    /**
+     * Publish queued TCP → ZMQ messages and forward every message pending on the ZMQ SUB
+     * socket to TCP clients. Does not block.
+     * @return number of ZMQ messages received, empty ones included
+     */
+    int ServiceZmq();
+
+    /**
+     * Dispatch pending TCP accepts, reads, writes and disconnects, then publish what the
+     * clients sent. Does not block. With Start(), the ZMQ thread publishes instead.
+     * @param shard TCP shard index
+     * @return number of events handled, -1 on error
+     */
+    int ServiceTcp(int shard = 0);
+
+    /**
+     * @param source receive endpoint index
+     * @return libzmq handle of that endpoint's SUB socket, for zmq_poll() items, or NULL if not open
+     */
+    void* ZmqRecvHandle(int source = 0) const;
+
+    /**
+     * @param source receive endpoint index
+     * @return ZMQ_FD of that endpoint's SUB socket, for event loops that only take file
+     * descriptors, or -1 if not open. It is edge triggered: ServiceZmq() must run until
+     * ZMQ_EVENTS no longer reports ZMQ_POLLIN (see cISBridgeAsync).
+     */
+    is_socket_t ZmqRecvFd(int source = 0) const;
+
+    /**
+     * @return number of ZMQ receive endpoints
+     */
+    int ZmqRecvHandleCount() const { return static_cast<int>(m_zmqSources.size()); }
+
+    /**
+     * @return milliseconds until ServiceZmq() must run to release merged packets, paced
+     * bulk or a held batch, rounded up; -1 if nothing is waiting on a deadline
+     */
+    int ZmqTimeoutMs() const;
+
+    /**
+     * @return ZmqTimeoutMs() in nanoseconds, not rounded; -1 if nothing is waiting on a deadline
+     */
+    int64_t ZmqTimeoutNs() const;
+
+    /**
+     * @return number of TCP shards, 0 if not open
+     */
+    int TcpShardCount() const { return static_cast<int>(m_tcpShards.size()); }
+
+    /**
+     * @param shard TCP shard index
+     * @return descriptor readable when ServiceTcp() has work, or -1 if it must be called periodically
+     */
+    int TcpFd(int shard = 0) const;
+
+    /**
+     * @param shard TCP shard index
+     * @return milliseconds until ServiceTcp() must run to retry accepting after running
+     * out of descriptors, which no descriptor reports; -1 if no retry is pending
+     */
+    int TcpTimeoutMs(int shard = 0) const;
+
+    /**
+     * @return descriptor readable when ServiceZmq() has queued sends or subscription
+     * changes to apply, or -1 if not open
+     */
+    is_socket_t WakeupFd() const;
+
     /**
      * Stop the bridge
      * @return 0 if success, otherwise an error code
      */
     int Stop();
 
+    /**
+     * Hand the TCP listening and client sockets to a bridge taking over (see
+     * sISZmqTcpBridgeOptions::handoffPath) and stop. Forwarding stops first; anything
+     * clients send from then on waits in the kernel for the new bridge. The sockets are
+     * closed, and data still queued for clients discarded, only once the new bridge
+     * acknowledges that it serves them all. Without the acknowledgement (within
+     * handoffTimeoutMs), forwarding resumes with the same clients, each with its queue,
+     * framer, rate limits and transmit state. Bridges started with Start() only.
+     * @param socket connection accepted from bridgeHandoffListen()
+     * @return 0 if handed over and stopped, -1 if still running
+     */
+    int HandOff(int socket);
+
+    /**
+     * Set tuning options. Only takes effect on the next Start().
+     * @param options the options to use
+     */
+    void SetOptions(const sISZmqTcpBridgeOptions& options) { m_options = options; }
+
+    /**
+     * @return the current tuning options
+     */
+    const sISZmqTcpBridgeOptions& GetOptions() const { return m_options; }
+
     /**
      * Check if bridge is running
      * @return true if running, false otherwise
@@ -80,51 +494,493 @@ public:
 
     /**
      * Get bridge status information
-     * @return status string
+     * @return one line with state, clients and traffic totals
      */
     std::string GetStatus() const;
 
+    /**
+     * Snapshot every counter, histogram and per-client statistic. Recording is lock-free;
+     * the snapshot holds off Stop() and briefly takes the client list lock for per-client
+     * entries. Safe to call from any thread, also while the bridge starts or stops.
+     * @param stats receives the snapshot
+     */
+    void GetStats(sISZmqTcpBridgeStats& stats) const;
+
+    /**
+     * Format statistics in the Prometheus text exposition format, one sample per route
+     * labelled with its TCP port
+     * @param routes snapshots from GetStats()
+     * @param out text is appended here
+     */
+    static void FormatPrometheus(const std::vector<sISZmqTcpBridgeStats>& routes, std::string& out);
+
+    /**
+     * Snapshot per-client send queue depth, high watermarks and drop counts
+     * @param stats receives one entry per connected TCP client
+     */
+    void GetClientStats(std::vector<sISBridgeTcpClientStats>& stats) const;
+
+    /**
+     * Snapshot buffer pool usage. heapAllocations stays flat in steady state; growth
+     * means a pool is undersized for the traffic.
+     * @param dataPool receives TCP → ZMQ data pool counters
+     * @param messagePool receives ZMQ → TCP message handle pool counters
+     */
+    void GetBufferPoolStats(sISBridgeBufferPoolStats& dataPool, sISBridgeBufferPoolStats& messagePool) const;
+
+    /**
+     * Snapshot packet framer counters. Stay zero for a direction with framing disabled.
+     * @param zmqToTcp receives ZMQ → TCP framer counters
+     * @param tcpToZmq receives TCP → ZMQ framer counters, summed over all clients
+     */
+    void GetFramerStats(sISBridgeFramerStats& zmqToTcp, sISBridgeFramerStats& tcpToZmq) const;
+
+    /**
+     * Copy the sampled trace records, oldest first. Safe while running; the records of
+     * the last run stay available after Stop() until the next start.
+     * @param records receives the records
+     * @return 0 if success, -1 if sampling is off (traceSampleEvery)
+     */
+    int GetTraceRecords(std::vector<sISBridgeTraceRecord>& records) const;
+
+    /**
+     * Register an in-process consumer of ZMQ → TCP messages. It receives every batch
+     * forwarded to TCP clients from then on, sharing the same buffers, alongside any
+     * TCP clients. With the last-value cache enabled, the cached snapshot is delivered
+     * first, on the calling thread. May be called before Start() or while running.
+     * Message references may be kept past Stop() and the bridge's destruction; the
+     * buffers stay valid until released.
+     * @param consumer the consumer; must stay valid until RemoveConsumer() or the
+     *        bridge is destroyed
+     * @return 0 if success, -1 if already registered
+     */
+    int AddConsumer(iISBridgeConsumer* consumer);
+
+    /**
+     * Unregister a consumer. Once this returns it receives no further calls.
+     * @param consumer the consumer
+     * @return 0 if success, -1 if not registered
+     */
+    int RemoveConsumer(iISBridgeConsumer* consumer);
+
+    /**
+     * Publish data to ZMQ as if a TCP client had sent it, without a TCP connection.
+     * The data is copied and queued for the thread owning the ZMQ send socket; each call
+     * becomes one ZMQ message, so pass whole packets (TCP → ZMQ framing is not applied).
+     * Safe from any thread, including while another thread calls Stop(): a call either
+     * sees the bridge stopped and fails, or completes before Stop() releases the queue.
+     * @param data the data
+     * @param size number of bytes
+     * @param lane queue to use; BRIDGE_ZMQ_LANE_CONTROL only differs with zmqControlLane
+     * @return 0 if queued, -1 if not running or the send queue is full
+     */
+    int Inject(const uint8_t* data, size_t size, eISBridgeZmqLane lane = BRIDGE_ZMQ_LANE_BULK);
+
+    /**
+     * Replace one TCP client's rate limits. Only ISB data packets are limited, so
+     * ZMQ → TCP framing must be on (frameZmqToTcp or an option implying it).
+     * @param socket the client, as in sISZmqTcpBridgeStats::clients
+     * @param limits the new limits
+     * @return 0 if success, -1 if not running or the client is unknown
+     */
+    int SetClientRateLimits(is_socket_t socket, const sISBridgeRateLimits& limits);
+
+    /**
+     * Turn conflation on or off for one TCP client. Same framing requirement as
+     * SetClientRateLimits().
+     * @param socket the client, as in sISZmqTcpBridgeStats::clients
+     * @param conflate see sISBridgeSendQueueLimits::conflate
+     * @return 0 if success, -1 if not running or the client is unknown
+     */
+    int SetClientConflate(is_socket_t socket, bool conflate);
+
+    /**
+     * Write data to every TCP client, e.g. a reply from an OnClientDataReceived()
+     * override. The data is copied once and queued on each shard like ZMQ → TCP
+     * messages, subject to each client's data ID filter and rate limits, but not
+     * ordered with messages still on their way from ZMQ. Safe to call from any thread,
+     * including the delegate methods.
+     * @param data the data to write
+     * @param dataLength the number of bytes to write
+     * @return number of clients the data was queued for, -1 if not running
+     */
+    int WriteTcpClients(const uint8_t* data, int dataLength);
+
 protected:
+    // iISTcpServerDelegate. Clients are served by cISBridgeTcpReactor rather than
+    // cISTcpServer, so server is always NULL: write to clients with WriteTcpClients()
+    // and count them with GetClientStats(). Each reactor shard dispatches through an
+    // adapter (sTcpShard::delegate) on its own thread. OnClientConnecting() is called
+    // just before OnClientConnected(), and OnClientConnectFailed() when the shard fails
+    // to accept or register a client. Overrides must call the base class to keep
+    // forwarding working.
+
+    /**
+     * Delegate method called when a TCP client connects
+     * @param server NULL, see above
+     * @param socket the client socket
+     */
+    void OnClientConnected(cISTcpServer* server, is_socket_t socket) override;
+
     /**
      * Delegate method called when TCP client data is received
      * Forwards the data to ZMQ send socket for TCP → ZMQ communication
-     * @param server the TCP server receiving data
+     * @param server NULL, see above
      * @param socket the client socket
      * @param data the data received
      * @param dataLength the number of bytes received
      */
     void OnClientDataReceived(cISTcpServer* server, is_socket_t socket, uint8_t* data, int dataLength) override;
 
+    /**
+     * Delegate method called when a TCP client disconnects
+     * @param server NULL, see above
+     * @param socket the client socket
+     */
+    void OnClientDisconnected(cISTcpServer* server, is_socket_t socket) override;
+
 private:
     cISZmqTcpBridge(const cISZmqTcpBridge&) = delete;
     cISZmqTcpBridge& operator=(const cISZmqTcpBridge&) = delete;
 
     /**
      * Thread function for forwarding ZMQ → TCP
+     * Runs m_zmqExecutor, whose service calls ServiceZmq(), until Stop() or HandOff().
      */
     void ZmqToTcpForwardingThread();
 
+    /**
+     * Run a forwarding thread's executor until Stop() or HandOff(). With busyPoll, spin
+     * with zero-timeout rounds and service everything on each one.
+     */
+    void RunForwarding(cISBridgePollExecutor& executor, cISBridgeService& service);
+
+    /**
+     * Apply subscription changes, publish queued TCP → ZMQ messages and forward every
+     * message pending on the SUB sockets. Run by ServiceZmq().
+     * @return number of messages received
+     */
+    int ForwardZmq();
+
+    /**
+     * Receive messages queued on one SUB socket into the batch, which is written with
+     * one writev() per client every maxBatchMessages
+     * @param source receive endpoint index
+     * @param maxMessages most messages to receive
+     * @return number of messages received
+     */
+    int DrainZmqRecvSocket(size_t source, int maxMessages);
+
+    /**
+     * Receive from every SUB socket in turn, a batch each, publishing queued TCP → ZMQ
+     * messages in between, until they are drained or zmqRecvBudget is used up. Then
+     * forward merged packets that are due and flush the batch unless it is held.
+     * @return number of messages received
+     */
+    int DrainZmqRecvSockets();
+
+    /**
+     * Move merged packets that are due to the batch
+     */
+    void ReleaseMerged();
+
+    /**
+     * Queue the pending batch for all TCP clients and clear it
+     */
+    void FlushBatch();
+
+    /**
+     * Add a received ZMQ message to the batch, split into packets when framing is enabled
+     * @param source receive endpoint index
+     * @param publisherNs the message's publisher timestamp, 0 if it has none
+     * @param buffer the received message
+     */
+    void BatchMessage(size_t source, uint64_t publisherNs, cISBridgeBufferRef& buffer);
+
+    /**
+     * Hand a packet to the merge, or straight to the batch when it cannot be merged
+     */
+    void ForwardPacket(size_t source, uint64_t publisherNs, cISBridgeBufferRef& buffer);
+
+    /**
+     * Append a packet to the batch, flushing it when full
+     */
+    void AppendBatch(cISBridgeBufferRef& buffer);
+
+    /**
+     * Copy bytes into a pooled buffer and queue them for the ZMQ send socket. Does not
+     * block; safe from any thread.
+     * @param data the bytes
+     * @param size number of bytes
+     * @param lane the queue, when zmqControlLane is on
+     * @return 0 if queued, -1 if dropped
+     */
+    int QueueToZmq(const uint8_t* data, size_t size, eISBridgeZmqLane lane = BRIDGE_ZMQ_LANE_BULK);
+
+    /**
+     * Publish queued messages, control first. Only called from the thread that owns the
+     * sockets.
+     * @param paced false to ignore the bulk byte budget, e.g. for the final drain
+     * @return number of messages taken off the queues
+     */
+    int DrainZmqSendQueue(bool paced = true);
+
+    /**
+     * Publish every queued control packet
+     * @return number of messages taken off the queue
+     */
+    int DrainZmqControlQueue();
+
+    /**
+     * @return true if a TCP → ZMQ packet belongs in the control lane
+     */
+    static bool IsControlPacket(const sISBridgePacket& packet, size_t maxBytes);
+
+    /**
+     * Publish one message on the ZMQ send socket
+     * @param buffer the message; ownership passes to libzmq on success
+     * @return 0 if sent, -1 if dropped
+     */
+    int SendToZmq(cISBridgeBufferRef& buffer);
+
+    /**
+     * Note that a client subscription may have changed and wake the thread owning the
+     * sockets to push the new union down to the SUB socket
+     */
+    void MarkSubscriptionsDirty();
+
+    /**
+     * Bring SUB socket subscriptions in line with what clients want. Only called from
+     * the thread that owns the SUB socket.
+     */
+    void UpdateZmqSubscriptions();
+
+    /**
+     * Join forwarding threads and release all sockets, the context and the wakeup.
+     * Used by Stop() and by Start() failure paths.
+     * @param context description used when logging cleanup errors
+     */
+    void ReleaseResources(const char* context);
+
+    /**
+     * Open everything Start() and Open() share
+     * @param shardCount TCP reactor shards to open
+     */
+    int OpenInternal(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort,
+                     zmq::context_t* sharedContext, int shardCount, const std::string& handoffPath);
+
+    /**
+     * Create a TCP shard configured from the options, not yet open
+     * @return its reactor
+     */
+    cISBridgeTcpReactor& AddTcpShard(bool reusePort);
+
+    /**
+     * Serve the sockets handed over by the running bridge from up to shardCount shards
+     * @return 0 if success; the sockets are closed otherwise
+     */
+    int TakeOver(int tcpPort, int shardCount, sISBridgeHandoffState& handoff);
+
+    /**
+     * Set up an executor and service for ZMQ and for each TCP shard, then start the
+     * ZMQ-to-TCP thread and a thread per shard to run them
+     * @return 0 if success, -1 if a ZMQ socket cannot be watched
+     */
+    int StartThreads();
+
+    /**
+     * Join the forwarding threads, if started, and release their executors
+     */
+    void JoinThreads();
+
+    struct sTcpShard;
+
+    /**
+     * Forwards one shard's reactor callbacks to the iISTcpServerDelegate methods above,
+     * recording the shard for them
+     */
+    class cShardDelegate : public iISBridgeTcpReactorDelegate
+    {
+    public:
+        cShardDelegate(cISZmqTcpBridge* bridge, sTcpShard* shard) : m_bridge(bridge), m_shard(shard) {}
+
+    protected:
+        void OnClientConnected(cISBridgeTcpReactor* reactor, is_socket_t socket) override;
+        void OnClientConnectFailed(cISBridgeTcpReactor* reactor) override;
+        void OnClientAccepting(cISBridgeTcpReactor* reactor, is_socket_t socket, std::vector<cISBridgeBufferRef>& initial) override;
+        void OnClientDataReceived(cISBridgeTcpReactor* reactor, is_socket_t socket, uint8_t* data, int dataLength) override;
+        void OnClientDisconnected(cISBridgeTcpReactor* reactor, is_socket_t socket) override;
+
+    private:
+        cISZmqTcpBridge* m_bridge;
+        sTcpShard* m_shard;
+    };
+
     /**
      * Thread function for forwarding TCP → ZMQ
+     * Runs the shard's executor, whose service calls ServiceTcp(), until Stop() or HandOff().
+     */
+    void TcpToZmqForwardingThread(int shardIndex);
+
+    /**
+     * Run one shard's TCP reactor, which dispatches accepts, reads and disconnects as
+     * soon as the kernel reports them, then write the broadcast ring out to its clients.
+     * Run by ServiceTcp().
+     * @param shardIndex the shard
+     * @param timeoutMs longest wait for an event, 0 to not block, -1 for no limit
+     * @return number of events handled, -1 on error
+     */
+    int ForwardTcp(int shardIndex, int timeoutMs);
+
+    /**
+     * @return the shard whose reactor is dispatching a callback on this thread, shard 0
+     * outside a dispatch
+     */
+    sTcpShard& DispatchShard();
+
+    /**
+     * Queue the last-value cache snapshot for a client ahead of live data
+     */
+    void QueueSnapshot(std::vector<cISBridgeBufferRef>& initial);
+
+    /**
+     * Capture a reactor-side record for a client. Only called from the shard's thread.
+     */
+    void CaptureClient(sTcpShard& shard, eISBridgeCaptureDirection direction, is_socket_t socket, const uint8_t* data, size_t size);
+
+    /**
+     * Capture a TCP → ZMQ side record; serialized because the capture ring has one producer
      */
-    void TcpToZmqForwardingThread();
+    void CaptureTcp(eISBridgeCaptureDirection direction, uint32_t clientId, const uint8_t* data, size_t size);
+
+    /**
+     * GetClientStats() with m_resourcesMutex already held
+     */
+    void GetClientStatsLocked(std::vector<sISBridgeTcpClientStats>& stats) const;
+
+    // Buffer pools. Retired rather than deleted, so buffers still held by libzmq (a
+    // shared context outlives Stop()), consumers or the application return safely.
+    std::unique_ptr<cISBridgeBufferPool, sISBridgeBufferPoolRetire> m_dataPool;      // TCP → ZMQ payload copies
+    std::unique_ptr<cISBridgeBufferPool, sISBridgeBufferPoolRetire> m_messagePool;   // Header-only handles wrapping received zmq_msg_t
 
     // ZMQ context and sockets
-    std::unique_ptr<zmq::context_t> m_zmqContext;
-    std::unique_ptr<zmq::socket_t> m_zmqRecvSocket;  // SUB socket for receiving from ZMQ
-    std::unique_ptr<zmq::socket_t> m_zmqSendSocket;  // PUB socket for sending to ZMQ
+    std::unique_ptr<zmq::context_t> m_zmqContext;    // Owned context, empty when using a shared one
+    zmq::context_t* m_context;                       // Context the sockets were created on
+    struct sZmqSource
+    {
+        std::string endpoint;
+        std::unique_ptr<zmq::socket_t> socket;          // SUB socket for receiving from ZMQ
+        std::unique_ptr<cISBridgePacketFramer> framer;  // Each publisher's stream is reassembled separately
+        std::atomic<uint64_t> messages = { 0 };
+        std::atomic<uint64_t> bytes = { 0 };
+    };
+    std::vector<std::unique_ptr<sZmqSource>> m_zmqSources;
+    std::unique_ptr<zmq::socket_t> m_zmqSendSocket;  // PUB socket for sending to ZMQ, owned by the SUB socket's thread
     
-    // TCP server
-    std::unique_ptr<cISTcpServer> m_tcpServer;
+    // TCP server shards, each an epoll reactor owning a listening socket and its clients,
+    // serviced by its own thread with Start(). The client maps are only touched by that thread.
+    struct sTcpShard
+    {
+        sTcpShard(cISZmqTcpBridge* bridge);
+        ~sTcpShard();
+
+        cShardDelegate delegate;
+        std::unique_ptr<cISBridgeTcpReactor> reactor;
+        std::unique_ptr<cISBridgePollExecutor> executor;    // Start() only, with the service and thread
+        std::unique_ptr<cISBridgeService> service;
+        std::unique_ptr<std::thread> thread;
+        std::atomic<bool> ringSignalled = { false };    // Woken for ring messages and not yet drained
+        std::vector<cISBridgeBufferRef> ringBatch;      // Messages read from the broadcast ring
+        std::unordered_map<is_socket_t, std::unique_ptr<cISBridgePacketFramer>> clientFramers;
+        std::unordered_map<is_socket_t, uint32_t> clientIds;
+    };
+    std::vector<std::unique_ptr<sTcpShard>> m_tcpShards;
+    static thread_local sTcpShard* s_dispatchShard;     // Set by cShardDelegate around each callback
+
+    // ZMQ → TCP hand-off with several shards; read by each shard's thread
+    std::unique_ptr<cISBridgeBroadcastRing> m_broadcastRing;
+
+    // Held while starting and teardown change the shards, ZMQ sources, broadcast ring,
+    // send queues and pools, and while statistics and per-client settings read them
+    // from other threads. Never held while joining the bridge's threads.
+    mutable std::mutex m_resourcesMutex;
+
+    // Sampled per-message trace, stamped by every forwarding thread
+    std::unique_ptr<cISBridgeTraceRing> m_trace;
     
-    // Threading
+    // Threading. Start() runs m_zmqService on m_zmqExecutor in m_zmqToTcpThread, and each
+    // shard's service on its own thread; hosted bridges have none.
+    std::unique_ptr<cISBridgePollExecutor> m_zmqExecutor;
+    std::unique_ptr<cISBridgeService> m_zmqService;
     std::unique_ptr<std::thread> m_zmqToTcpThread;
-    std::unique_ptr<std::thread> m_tcpToZmqThread;
     std::atomic<bool> m_isRunning;
-    std::mutex m_zmqSendMutex;  // Protects access to m_zmqSendSocket
+    std::atomic<int> m_injectsInFlight;  // Inject() calls past their m_isRunning check; ReleaseResources() waits for 0
+    bool m_busyPolling;           // Forwarding threads spin (busyPoll with Start()); set before they start
+    bool m_threaded;              // Start() services ZMQ and each shard on threads of their own; set before they start
+    cISBridgeWakeup m_zmqWakeup;  // Wakes the thread servicing ZMQ on Stop(), queued sends or subscription changes
+
+    // TCP → ZMQ messages. Any thread queues, the thread owning the sockets publishes.
+    // m_zmqSendSignalled is set by the first producer after a drain so a burst costs
+    // one wakeup.
+    std::unique_ptr<cISBridgeMpscQueue> m_zmqSendQueue;
+    std::atomic<bool> m_zmqSendSignalled;
+
+    // Control lane and bulk pacing. The control queue only exists with zmqControlLane;
+    // the token bucket is only touched by the thread owning the sockets.
+    std::unique_ptr<cISBridgeMpscQueue> m_zmqControlQueue;
+    cISBridgeHistogram m_controlLatency;
+    int64_t m_bulkTokens;               // Bytes bulk may still send this tick; may go negative by one message
+    uint64_t m_bulkRefillNs;            // When the budget was last refilled
     
+    // ZMQ → TCP batch, only touched by the ZMQ-to-TCP thread. A partial batch is held
+    // until m_batchDeadlineNs with maxBatchHoldUs, 0 otherwise.
+    std::vector<cISBridgeBufferRef> m_batch;
+    uint64_t m_batchDeadlineNs;
+    bool m_zmqRecvPending;  // The last pass stopped at zmqRecvBudget with messages left
+
+    // In-process consumers. The forwarding thread only takes the lock when m_hasConsumers
+    // is set; holding it while dispatching is what makes RemoveConsumer() final.
+    std::mutex m_consumersMutex;
+    std::vector<iISBridgeConsumer*> m_consumers;
+    std::atomic<bool> m_hasConsumers;
+
+    // Multi-endpoint merge, only touched by the ZMQ-to-TCP thread
+    cISBridgeReorderBuffer m_reorder;
+    cISBridgeReorderBuffer::release_handler_t m_releaseHandler;
+    bool m_merging;
+
+    // Packet framing. The ZMQ framers are only touched by the ZMQ-to-TCP thread and the
+    // per-client framers by their shard's thread.
+    sISBridgeFramerCounters m_zmqFramerCounters;
+    sISBridgeFramerCounters m_tcpFramerCounters;
+
+    // Latest packet per data ID, updated by the ZMQ-to-TCP thread and read on accept
+    cISBridgeLastValueCache m_lastValueCache;
+
+    // Capture. Client IDs number connections in accept order across all shards.
+    cISBridgeCaptureWriter m_capture;
+    std::mutex m_captureTcpMutex;       // Shards and Inject() share the TCP capture ring
+    std::atomic<uint32_t> m_nextClientId;
+
+    // Statistics; the reactor owns TCP counters and the latency histogram
+    struct sCounters
+    {
+        std::atomic<uint64_t> zmqRxMessages = { 0 };
+        std::atomic<uint64_t> zmqRxBytes = { 0 };
+        std::atomic<uint64_t> zmqTxMessages = { 0 };
+        std::atomic<uint64_t> zmqTxBytes = { 0 };
+        std::atomic<uint64_t> zmqTxEagain = { 0 };
+        std::atomic<uint64_t> zmqTxErrors = { 0 };
+        std::atomic<uint64_t> zmqBulkDeferred = { 0 };
+    };
+    sCounters m_counters;
+
+    // DID topic push-down. m_zmqSubscriptions is only touched by the SUB socket's thread.
+    std::atomic<bool> m_subscriptionsDirty;
+    sISBridgeDidSet m_zmqSubscriptions;
+
     // Configuration
-    std::string m_zmqRecvEndpoint;
+    sISZmqTcpBridgeOptions m_options;
     std::string m_zmqSendEndpoint;
     int m_tcpPort;
 };
@@ -0,0 +1,141 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __ISZMQTCPBRIDGEHOST__H__
+#define __ISZMQTCPBRIDGEHOST__H__
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include "ISZmqTcpBridge.h"
+#include "ISBridgeWakeup.h"
+
+/**
+ * One ZMQ/TCP pair served by a cISZmqTcpBridgeHost
+ */
+struct sISZmqTcpBridgeRoute
+{
+    std::string zmqRecvEndpoint;
+    std::string zmqSendEndpoint;
+    int tcpPort = 0;  // 0 for a free port, reported in the route's GetStats()
+};
+
+/**
+ * Multi-device bridge host
+ *
+ * Serves many ZMQ/TCP routes from one process. Every route is a cISZmqTcpBridge opened
+ * without its own threads; all routes share one ZMQ context and are spread across a
+ * small fixed pool of worker threads. Each worker blocks in a single zmq_poll() over the
+ * SUB sockets and TCP reactor descriptors of its routes, so idle routes cost nothing.
+ * A busy route gets at most zmqRecvBudget messages per turn, and the worker starts each
+ * pass at the next route, so one flooded route cannot starve the others.
+ *
+ * Route file format: one route per line, "<zmq-recv> <zmq-send> <tcp-port>". Blank lines
+ * and lines starting with '#' are ignored.
+ */
+class cISZmqTcpBridgeHost
+{
+public:
+    cISZmqTcpBridgeHost();
+    ~cISZmqTcpBridgeHost();
+
+    /**
+     * Add a route. Only allowed while stopped. TCP ports other than 0 must be unique.
+     * @return 0 if success, otherwise an error code
+     */
+    int AddRoute(const sISZmqTcpBridgeRoute& route);
+
+    /**
+     * Add every route listed in a route file
+     * @param path the file to read
+     * @return 0 if success, otherwise an error code (nothing is added on error)
+     */
+    int LoadRoutes(const std::string& path);
+
+    /**
+     * Set the options every route bridge is started with. Only takes effect on the next Start().
+     */
+    void SetOptions(const sISZmqTcpBridgeOptions& options) { m_options = options; }
+
+    /**
+     * Open every route and start the worker threads
+     * @param threadCount number of worker threads, clamped to [1, number of routes]
+     * @return 0 if success, otherwise an error code (no route is left running)
+     */
+    int Start(int threadCount);
+
+    /**
+     * Stop the workers and close every route
+     * @return 0 if success
+     */
+    int Stop();
+
+    bool IsRunning() const { return m_isRunning; }
+
+    const std::vector<sISZmqTcpBridgeRoute>& Routes() const { return m_routes; }
+
+    /**
+     * @param index route index, in the order routes were added
+     * @return the route's bridge while running, otherwise NULL
+     */
+    cISZmqTcpBridge* Bridge(size_t index) { return (index < m_bridges.size()) ? m_bridges[index].get() : NULL; }
+
+    /**
+     * Get host status information
+     * @return status string with one line per route
+     */
+    std::string GetStatus() const;
+
+    /**
+     * Snapshot statistics for every route, in route order
+     * @param stats receives one entry per route
+     */
+    void GetStats(std::vector<sISZmqTcpBridgeStats>& stats) const;
+
+    /**
+     * @return statistics for every route in the Prometheus text format
+     */
+    std::string FormatPrometheus() const;
+
+private:
+    cISZmqTcpBridgeHost(const cISZmqTcpBridgeHost&) = delete;
+    cISZmqTcpBridgeHost& operator=(const cISZmqTcpBridgeHost&) = delete;
+
+    struct sWorker
+    {
+        std::vector<cISZmqTcpBridge*> bridges;
+        cISBridgeWakeup wakeup;
+        std::unique_ptr<std::thread> thread;
+    };
+
+    /**
+     * Worker thread: poll the routes it owns and service whichever side is ready
+     */
+    void WorkerThread(sWorker* worker);
+
+    /**
+     * Poll timeout used when a route's TCP side has no pollable descriptor
+     */
+    static const int kFallbackPollMs = 10;
+
+    std::vector<sISZmqTcpBridgeRoute> m_routes;
+    sISZmqTcpBridgeOptions m_options;
+    std::unique_ptr<zmq::context_t> m_zmqContext;
+    std::vector<std::unique_ptr<cISZmqTcpBridge>> m_bridges;
+    std::vector<std::unique_ptr<sWorker>> m_workers;
+    std::atomic<bool> m_isRunning;
+};
+
+#endif // __ISZMQTCPBRIDGEHOST__H__
@@ -0,0 +1,617 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <iostream>
+#include <zmq.h>
+#if defined(__linux__)
+#include <poll.h>
+#endif
+#include "ISBridgeAsync.h"
+#include "ISBridgeMetrics.h"
+
+cISBridgePollExecutor::cISBridgePollExecutor()
+    : m_stopping(false)
+{
+    m_wakeup.Open();
+}
+
+void cISBridgePollExecutor::Post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_postedMutex);
+        m_posted.push_back(std::move(task));
+    }
+
+    // The loop's own thread is about to run posted tasks anyway
+    if (std::this_thread::get_id() != m_loopThread.load(std::memory_order_relaxed))
+    {
+        m_wakeup.Signal();
+    }
+}
+
+void cISBridgePollExecutor::PostAfter(int delayMs, std::function<void()> task)
+{
+    PostAfterNs(static_cast<int64_t>(delayMs) * 1000000, std::move(task));
+}
+
+void cISBridgePollExecutor::PostAfterNs(int64_t delayNs, std::function<void()> task)
+{
+    uint64_t due = bridgeClockNs() + static_cast<uint64_t>(delayNs > 0 ? delayNs : 0);
+    m_timers.emplace(due, std::move(task));
+}
+
+void cISBridgePollExecutor::Watch(is_socket_t fd, std::function<void()> onReadable)
+{
+    m_watches[fd] = std::move(onReadable);
+}
+
+void cISBridgePollExecutor::Unwatch(is_socket_t fd)
+{
+    m_watches.erase(fd);
+}
+
+int cISBridgePollExecutor::RunOnce(int timeoutMs)
+{
+    m_loopThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+    // Wait no longer than the next timer, and not at all with tasks already posted
+    int64_t timeoutNs = (timeoutMs < 0) ? -1 : static_cast<int64_t>(timeoutMs) * 1000000;
+    {
+        std::lock_guard<std::mutex> lock(m_postedMutex);
+        if (!m_posted.empty())
+        {
+            timeoutNs = 0;
+        }
+    }
+    if (!m_timers.empty())
+    {
+        uint64_t now = bridgeClockNs();
+        uint64_t due = m_timers.begin()->first;
+        int64_t dueNs = (due <= now) ? 0 : static_cast<int64_t>(due - now);
+        if (timeoutNs < 0 || dueNs < timeoutNs)
+        {
+            timeoutNs = dueNs;
+        }
+    }
+
+    std::vector<pollfd>& fds = m_pollFds;
+    fds.clear();
+    fds.push_back({ m_wakeup.Fd(), POLLIN, 0 });
+    for (const auto& watch : m_watches)
+    {
+        fds.push_back({ watch.first, POLLIN, 0 });
+    }
+
+    int ran = 0;
+#if defined(__linux__)
+    // ppoll() keeps sub-millisecond batch and merge deadlines that poll() would round up
+    timespec timeout = { static_cast<time_t>(timeoutNs / 1000000000), static_cast<long>(timeoutNs % 1000000000) };
+    int ready = ppoll(fds.data(), fds.size(), (timeoutNs < 0) ? NULL : &timeout, NULL);
+#else
+    // poll() takes milliseconds; round up so the timer is due on wakeup
+    int ready = bridgeSocketPoll(fds.data(), fds.size(), (timeoutNs < 0) ? -1 : static_cast<int>((timeoutNs + 999999) / 1000000));
+#endif
+    if (ready > 0)
+    {
+        if (fds[0].revents & POLLIN)
+        {
+            m_wakeup.Drain();
+        }
+        for (size_t i = 1; i < fds.size(); i++)
+        {
+            if (fds[i].revents == 0)
+            {
+                continue;
+            }
+            // An earlier callback may have unwatched or replaced this one
+            auto watch = m_watches.find(fds[i].fd);
+            if (watch == m_watches.end())
+            {
+                continue;
+            }
+            m_running.push_back(watch->second);
+            m_running.back()();
+            m_running.clear();
+            ran++;
+        }
+    }
+
+    // Timers armed by the callbacks run on a later round, even with no delay
+    uint64_t now = bridgeClockNs();
+    while (!m_timers.empty() && m_timers.begin()->first <= now)
+    {
+        m_running.push_back(std::move(m_timers.begin()->second));
+        m_timers.erase(m_timers.begin());
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_postedMutex);
+        for (std::function<void()>& task : m_posted)
+        {
+            m_running.push_back(std::move(task));
+        }
+        m_posted.clear();
+    }
+    for (std::function<void()>& task : m_running)
+    {
+        task();
+        ran++;
+    }
+    m_running.clear();
+    return ran;
+}
+
+void cISBridgePollExecutor::Run()
+{
+    while (!m_stopping.load(std::memory_order_acquire))
+    {
+        RunOnce(-1);
+    }
+    m_stopping.store(false, std::memory_order_release);
+}
+
+void cISBridgePollExecutor::Stop()
+{
+    m_stopping.store(true, std::memory_order_release);
+    m_wakeup.Signal();
+}
+
+cISBridgeService::cISBridgeService(cISZmqTcpBridge& bridge, iISBridgeExecutor& executor, int part)
+    : m_bridge(bridge)
+    , m_executor(executor)
+    , m_part(part)
+    , m_open(false)
+    , m_zmqServicePosted(false)
+    , m_serviceTimerDueNs(0)
+    , m_alive(std::make_shared<bool>(true))
+{
+}
+
+cISBridgeService::~cISBridgeService()
+{
+    Close();
+}
+
+int cISBridgeService::Open(std::function<void()> onServiced)
+{
+    if (m_open)
+    {
+        return -1;
+    }
+    m_onServiced = std::move(onServiced);
+    m_open = true;
+
+    for (int i = 0; ServicesZmq() && i < m_bridge.ZmqRecvHandleCount(); i++)
+    {
+        is_socket_t fd = m_bridge.ZmqRecvFd(i);
+        if (!bridgeSocketValid(fd))
+        {
+            std::cerr << "No descriptor for ZMQ receive socket " << i << std::endl;
+            Close();
+            return -1;
+        }
+        WatchFd(fd, [this]() { ServiceZmq(); });
+    }
+    if (ServicesZmq())
+    {
+        WatchFd(m_bridge.WakeupFd(), [this]() { ServiceZmq(); });
+    }
+
+    m_tcpTimerDueNs.assign(static_cast<size_t>(m_bridge.TcpShardCount()), 0);
+    for (int shard = 0; shard < m_bridge.TcpShardCount(); shard++)
+    {
+        if (!ServicesShard(shard))
+        {
+            continue;
+        }
+        if (m_bridge.TcpFd(shard) >= 0)
+        {
+            WatchFd(m_bridge.TcpFd(shard), [this, shard]() { ServiceTcp(shard); });
+        }
+        else
+        {
+            // No pollable descriptor (poll() reactor fallback): service it periodically
+            ArmTcpPoll(shard);
+        }
+    }
+
+    // ZMQ_FD only signals changes: pick up anything that arrived before the watches
+    if (ServicesZmq())
+    {
+        std::weak_ptr<bool> alive = m_alive;
+        m_executor.Post([this, alive]()
+        {
+            if (!alive.expired())
+            {
+                ServiceZmq();
+            }
+        });
+    }
+    return 0;
+}
+
+void cISBridgeService::Close()
+{
+    if (!m_open)
+    {
+        return;
+    }
+    m_open = false;
+
+    for (is_socket_t fd : m_watchedFds)
+    {
+        m_executor.Unwatch(fd);
+    }
+    m_watchedFds.clear();
+
+    // Timers still in the executor now do nothing
+    m_alive = std::make_shared<bool>(true);
+    m_zmqServicePosted = false;
+    m_serviceTimerDueNs = 0;
+    m_tcpTimerDueNs.clear();
+}
+
+void cISBridgeService::ServiceAll()
+{
+    if (!m_open)
+    {
+        return;
+    }
+    if (ServicesZmq())
+    {
+        ServiceZmq();
+    }
+    for (int shard = 0; shard < m_bridge.TcpShardCount(); shard++)
+    {
+        if (ServicesShard(shard))
+        {
+            ServiceTcp(shard);
+        }
+    }
+}
+
+void cISBridgeService::WatchFd(is_socket_t fd, std::function<void()> onReadable)
+{
+    m_executor.Watch(fd, std::move(onReadable));
+    m_watchedFds.push_back(fd);
+}
+
+void cISBridgeService::ServiceZmq()
+{
+    m_bridge.ServiceZmq();
+
+    // ZMQ_FD is edge triggered: a receive that stopped before EAGAIN (e.g. the message
+    // pool ran dry or the receive budget ran out) is not signalled again, so come back
+    // while messages are waiting
+    for (int i = 0; i < m_bridge.ZmqRecvHandleCount() && !m_zmqServicePosted; i++)
+    {
+        int events = 0;
+        size_t size = sizeof(events);
+        void* handle = m_bridge.ZmqRecvHandle(i);
+        if (handle && zmq_getsockopt(handle, ZMQ_EVENTS, &events, &size) == 0 && (events & ZMQ_POLLIN))
+        {
+            m_zmqServicePosted = true;
+            std::weak_ptr<bool> alive = m_alive;
+            m_executor.Post([this, alive]()
+            {
+                if (!alive.expired())
+                {
+                    m_zmqServicePosted = false;
+                    ServiceZmq();
+                }
+            });
+        }
+    }
+
+    ArmServiceTimer();
+    if (m_onServiced)
+    {
+        m_onServiced();
+    }
+}
+
+void cISBridgeService::ServiceTcp(int shard)
+{
+    // Also publishes what the clients sent when ZMQ is serviced here; otherwise the
+    // bridge wakes the ZMQ service for it
+    m_bridge.ServiceTcp(shard);
+    if (ServicesZmq())
+    {
+        ArmServiceTimer();
+    }
+    ArmTcpTimer(shard);
+    if (m_onServiced)
+    {
+        m_onServiced();
+    }
+}
+
+void cISBridgeService::ArmTcpPoll(int shard)
+{
+    std::weak_ptr<bool> alive = m_alive;
+    m_executor.PostAfter(kFallbackPollMs, [this, alive, shard]()
+    {
+        if (!alive.expired())
+        {
+            ServiceTcp(shard);
+            ArmTcpPoll(shard);
+        }
+    });
+}
+
+void cISBridgeService::ArmServiceTimer()
+{
+    int64_t timeoutNs = m_bridge.ZmqTimeoutNs();
+    if (timeoutNs < 0)
+    {
+        return;
+    }
+    uint64_t due = bridgeClockNs() + static_cast<uint64_t>(timeoutNs);
+    if (m_serviceTimerDueNs != 0 && m_serviceTimerDueNs <= due)
+    {
+        return;     // An earlier timer services it
+    }
+    m_serviceTimerDueNs = due;
+
+    std::weak_ptr<bool> alive = m_alive;
+    m_executor.PostAfterNs(timeoutNs, [this, alive, due]()
+    {
+        if (alive.expired())
+        {
+            return;
+        }
+        if (m_serviceTimerDueNs == due)
+        {
+            m_serviceTimerDueNs = 0;
+        }
+        ServiceZmq();
+    });
+}
+
+void cISBridgeService::ArmTcpTimer(int shard)
+{
+    // Accepting stopped after running out of descriptors; nothing signals the retry
+    int timeoutMs = m_bridge.TcpTimeoutMs(shard);
+    if (timeoutMs < 0)
+    {
+        return;
+    }
+    uint64_t due = bridgeClockNs() + static_cast<uint64_t>(timeoutMs) * 1000000;
+    uint64_t& armed = m_tcpTimerDueNs[static_cast<size_t>(shard)];
+    if (armed != 0 && armed <= due)
+    {
+        return;
+    }
+    armed = due;
+
+    std::weak_ptr<bool> alive = m_alive;
+    m_executor.PostAfter(timeoutMs, [this, alive, shard, due]()
+    {
+        if (alive.expired())
+        {
+            return;
+        }
+        if (m_tcpTimerDueNs[static_cast<size_t>(shard)] == due)
+        {
+            m_tcpTimerDueNs[static_cast<size_t>(shard)] = 0;
+        }
+        ServiceTcp(shard);
+    });
+}
+
+bool cISBridgeReceiveAwaiter::await_ready()
+{
+    if (!m_owner.m_open)
+    {
+        return true;
+    }
+    // Earlier callers are served first
+    return m_owner.m_receivers.empty() && m_owner.m_received.Pop(m_message);
+}
+
+void cISBridgeReceiveAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    m_handle = handle;
+    m_owner.m_receivers.push_back(this);
+    m_owner.DeliverReceived();
+}
+
+bool cISBridgeSendAwaiter::await_ready()
+{
+    if (!m_owner.m_open)
+    {
+        m_result = -1;
+        return true;
+    }
+    // Sends complete in call order
+    return m_owner.m_senders.empty() && m_owner.TrySend(*this);
+}
+
+void cISBridgeSendAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    m_handle = handle;
+    m_owner.m_senders.push_back(this);
+    m_owner.RetrySenders();
+}
+
+cISBridgeAsync::cISBridgeAsync(cISZmqTcpBridge& bridge, iISBridgeExecutor& executor, size_t receiveCapacity)
+    : m_bridge(bridge)
+    , m_executor(executor)
+    , m_service(bridge, executor)
+    , m_received(receiveCapacity)
+    , m_open(false)
+    , m_hosting(false)
+    , m_watchingReceived(false)
+    , m_sendRetryArmed(false)
+    , m_alive(std::make_shared<bool>(true))
+{
+}
+
+cISBridgeAsync::~cISBridgeAsync()
+{
+    Close();
+}
+
+int cISBridgeAsync::Open(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext)
+{
+    if (m_open)
+    {
+        return -1;
+    }
+    if (m_bridge.Open(zmqRecvEndpoints, zmqSendEndpoint, tcpPort, sharedContext) != 0)
+    {
+        return -1;
+    }
+    m_hosting = true;
+
+    m_open = true;
+    if (m_bridge.AddConsumer(&m_received) != 0 ||
+        m_service.Open([this]() { DeliverReceived(); RetrySenders(); }) != 0)
+    {
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+int cISBridgeAsync::Attach()
+{
+    if (m_open || m_bridge.AddConsumer(&m_received) != 0)
+    {
+        return -1;
+    }
+    m_open = true;
+    return 0;
+}
+
+void cISBridgeAsync::Close()
+{
+    if (!m_open && !m_hosting)
+    {
+        return;
+    }
+    m_open = false;
+
+    m_service.Close();
+    if (m_watchingReceived)
+    {
+        m_executor.Unwatch(m_received.Fd());
+        m_watchingReceived = false;
+    }
+
+    // Release buffered messages while the bridge's pools still exist
+    m_bridge.RemoveConsumer(&m_received);
+    cISBridgeBufferRef message;
+    while (m_received.Pop(message))
+    {
+        message.Reset();
+    }
+    if (m_hosting)
+    {
+        m_bridge.Stop();
+        m_hosting = false;
+    }
+
+    // Timers still in the executor now do nothing
+    m_alive = std::make_shared<bool>(true);
+    m_sendRetryArmed = false;
+
+    while (!m_receivers.empty())
+    {
+        Resume(m_receivers.front()->m_handle);
+        m_receivers.pop_front();
+    }
+    while (!m_senders.empty())
+    {
+        m_senders.front()->m_result = -1;
+        Resume(m_senders.front()->m_handle);
+        m_senders.pop_front();
+    }
+}
+
+void cISBridgeAsync::DeliverReceived()
+{
+    cISBridgeBufferRef message;
+    while (!m_receivers.empty() && m_received.Pop(message))
+    {
+        cISBridgeReceiveAwaiter* receiver = m_receivers.front();
+        m_receivers.pop_front();
+        receiver->m_message = std::move(message);
+        Resume(receiver->m_handle);
+    }
+
+    // Watch the buffer only while someone waits, so a level-triggered loop does not
+    // spin on messages nobody has asked for yet
+    bool waiting = !m_receivers.empty();
+    if (waiting != m_watchingReceived)
+    {
+        if (waiting)
+        {
+            m_executor.Watch(m_received.Fd(), [this]() { DeliverReceived(); });
+        }
+        else
+        {
+            m_executor.Unwatch(m_received.Fd());
+        }
+        m_watchingReceived = waiting;
+    }
+}
+
+bool cISBridgeAsync::TrySend(cISBridgeSendAwaiter& sender)
+{
+    if (sender.m_data == NULL || sender.m_size == 0)
+    {
+        sender.m_result = -1;
+        return true;
+    }
+    if (m_bridge.Inject(sender.m_data, sender.m_size, sender.m_lane) == 0)
+    {
+        sender.m_result = 0;
+        return true;
+    }
+    if (!m_bridge.IsRunning())
+    {
+        sender.m_result = -1;
+        return true;
+    }
+    return false;   // Send queue or buffer pool full
+}
+
+void cISBridgeAsync::RetrySenders()
+{
+    while (!m_senders.empty() && TrySend(*m_senders.front()))
+    {
+        Resume(m_senders.front()->m_handle);
+        m_senders.pop_front();
+    }
+    if (m_senders.empty() || m_sendRetryArmed)
+    {
+        return;
+    }
+
+    // Nothing signals when the queue drains on the bridge's own thread; poll for room
+    m_sendRetryArmed = true;
+    std::weak_ptr<bool> alive = m_alive;
+    m_executor.PostAfter(kSendRetryMs, [this, alive]()
+    {
+        if (!alive.expired())
+        {
+            m_sendRetryArmed = false;
+            RetrySenders();
+        }
+    });
+}
+
+void cISBridgeAsync::Resume(std::coroutine_handle<> handle)
+{
+    m_executor.Post([handle]() { handle.resume(); });
+}
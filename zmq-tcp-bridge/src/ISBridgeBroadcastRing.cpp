@@ -0,0 +1,111 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeBroadcastRing.h"
+#include "ISBridgeMetrics.h"
+
+cISBridgeBroadcastRing::cISBridgeBroadcastRing(size_t capacity, int readerCount)
+    : m_readerCount(readerCount > 0 ? readerCount : 1)
+    , m_head(0)
+    , m_published(0)
+    , m_dropped(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots.reset(new sSlot[size]);
+    for (size_t i = 0; i < size; i++)
+    {
+        m_slots[i].pending.store(0, std::memory_order_relaxed);
+    }
+    m_cursors.reset(new sCursor[m_readerCount]);
+    for (int i = 0; i < m_readerCount; i++)
+    {
+        m_cursors[i].next.store(0, std::memory_order_relaxed);
+    }
+}
+
+int cISBridgeBroadcastRing::Publish(const cISBridgeBufferRef* messages, int count)
+{
+    if (messages == NULL || count <= 0)
+    {
+        return 0;
+    }
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t slowest = head;
+    for (int i = 0; i < m_readerCount; i++)
+    {
+        uint64_t next = m_cursors[i].next.load(std::memory_order_acquire);
+        slowest = (next < slowest) ? next : slowest;
+    }
+
+    // Every slot behind the slowest reader has been taken by all readers and released
+    // by the last of them
+    uint64_t space = (m_mask + 1) - (head - slowest);
+    int n = (static_cast<uint64_t>(count) < space) ? count : static_cast<int>(space);
+    for (int i = 0; i < n; i++)
+    {
+        sSlot& slot = m_slots[(head + i) & m_mask];
+        slot.buffer = messages[i];
+        slot.pending.store(m_readerCount, std::memory_order_relaxed);
+    }
+
+    // Sequentially consistent so a reader that clears its wakeup flag and then reads the
+    // head cannot miss messages published before the producer checked that flag
+    m_head.store(head + n);
+    bridgeCounterAdd(m_published, static_cast<uint64_t>(n));
+    if (n < count)
+    {
+        bridgeCounterAdd(m_dropped, static_cast<uint64_t>(count - n));
+    }
+    return n;
+}
+
+int cISBridgeBroadcastRing::Read(int reader, cISBridgeBufferRef* messages, int maxCount)
+{
+    if (reader < 0 || reader >= m_readerCount || maxCount <= 0)
+    {
+        return 0;
+    }
+
+    std::atomic<uint64_t>& cursor = m_cursors[reader].next;
+    uint64_t next = cursor.load(std::memory_order_relaxed);
+    uint64_t head = m_head.load();
+    int n = (head - next < static_cast<uint64_t>(maxCount)) ? static_cast<int>(head - next) : maxCount;
+    for (int i = 0; i < n; i++)
+    {
+        sSlot& slot = m_slots[(next + i) & m_mask];
+        messages[i] = slot.buffer;
+        if (slot.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            slot.buffer.Reset();
+        }
+    }
+
+    // Hands the slots back to the producer
+    cursor.store(next + n, std::memory_order_release);
+    return n;
+}
+
+sISBridgeBroadcastRingStats cISBridgeBroadcastRing::GetStats() const
+{
+    sISBridgeBroadcastRingStats stats;
+    stats.capacity = m_mask + 1;
+    stats.published = m_published.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
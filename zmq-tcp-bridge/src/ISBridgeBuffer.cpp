@@ -0,0 +1,231 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeBuffer.h"
+
+#include <cassert>
+#include <new>
+
+cISBridgeBuffer::cISBridgeBuffer(cISBridgeBufferPool* pool, uint8_t* data, size_t capacity)
+    : m_refCount(1)
+    , m_size(0)
+    , m_capacity(capacity)
+    , m_data(data)
+    , m_pool(pool)
+    , m_releaseHook(NULL)
+    , m_protocol(0)
+    , m_packetType(0)
+    , m_packetId(0)
+    , m_timestampNs(0)
+    , m_traceId(0)
+{
+}
+
+cISBridgeBuffer* cISBridgeBuffer::Create(size_t capacity)
+{
+    // Header and payload share one allocation
+    uint8_t* mem = new (std::nothrow) uint8_t[sizeof(cISBridgeBuffer) + capacity];
+    if (mem == NULL)
+    {
+        return NULL;
+    }
+    return new (mem) cISBridgeBuffer(NULL, mem + sizeof(cISBridgeBuffer), capacity);
+}
+
+void cISBridgeBuffer::Reset(uint8_t* data, size_t capacity)
+{
+    m_refCount.store(1, std::memory_order_relaxed);
+    m_size = 0;
+    m_capacity = capacity;
+    m_data = data;
+    m_releaseHook = NULL;
+    m_protocol = 0;
+    m_packetType = 0;
+    m_packetId = 0;
+    m_timestampNs = 0;
+    m_traceId = 0;
+}
+
+void cISBridgeBuffer::Destroy()
+{
+    if (m_releaseHook)
+    {
+        m_releaseHook(this);
+        m_releaseHook = NULL;
+    }
+
+    if (m_pool)
+    {
+        m_pool->Return(this);
+        return;
+    }
+
+    uint8_t* mem = reinterpret_cast<uint8_t*>(this);
+    this->~cISBridgeBuffer();
+    delete[] mem;
+}
+
+cISBridgeBufferPool::cISBridgeBufferPool(size_t blockSize, size_t blockCount)
+    : m_blockSize(blockSize)
+    , m_blockCount(blockCount)
+    , m_head(kNil)
+    , m_inUse(0)
+    , m_holds(1)
+    , m_acquired(0)
+    , m_heapAllocations(0)
+{
+    // Round each block up to a cache line so neighbouring buffers do not share one
+    m_stride = (sizeof(cISBridgeBuffer) + blockSize + 63) & ~static_cast<size_t>(63);
+    if (m_blockCount >= kNil)
+    {
+        m_blockCount = kNil - 1;
+    }
+
+    m_arena.reset(new (std::nothrow) uint8_t[m_stride * m_blockCount]);
+    m_next.reset(new (std::nothrow) std::atomic<uint32_t>[m_blockCount]);
+    if (!m_arena || !m_next)
+    {
+        // Every Acquire() falls back to the heap
+        m_blockCount = 0;
+        return;
+    }
+
+    for (size_t i = m_blockCount; i-- > 0;)
+    {
+        uint8_t* mem = m_arena.get() + i * m_stride;
+        new (mem) cISBridgeBuffer(this, mem + sizeof(cISBridgeBuffer), m_blockSize);
+        Push(static_cast<uint32_t>(i));
+    }
+}
+
+cISBridgeBufferPool::~cISBridgeBufferPool()
+{
+    // Blocks are trivially destructible; the arena goes with the pool, so none may
+    // still be referenced
+    assert(m_inUse.load(std::memory_order_acquire) == 0);
+}
+
+cISBridgeBufferRef cISBridgeBufferPool::Acquire(size_t size)
+{
+    m_acquired.fetch_add(1, std::memory_order_relaxed);
+
+    if (size <= m_blockSize)
+    {
+        uint32_t index = Pop();
+        if (index != kNil)
+        {
+            m_inUse.fetch_add(1, std::memory_order_relaxed);
+            m_holds.fetch_add(1, std::memory_order_relaxed);
+            cISBridgeBuffer* buffer = Block(index);
+            buffer->Reset(reinterpret_cast<uint8_t*>(buffer) + sizeof(cISBridgeBuffer), m_blockSize);
+            return cISBridgeBufferRef(buffer);
+        }
+    }
+
+    m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return cISBridgeBufferRef(cISBridgeBuffer::Create(size));
+}
+
+cISBridgeBufferRef cISBridgeBufferPool::Slice(const cISBridgeBufferRef& parent, size_t offset, size_t size)
+{
+    if (!parent || offset + size > parent->Size())
+    {
+        return cISBridgeBufferRef();
+    }
+    if (offset == 0 && size == parent->Size())
+    {
+        return parent;
+    }
+
+    cISBridgeBufferRef view = Acquire(0);
+    if (!view)
+    {
+        return view;
+    }
+    parent->AddRef();
+    *static_cast<cISBridgeBuffer**>(view->Storage()) = parent.Get();
+    view->SetReleaseHook(ReleaseSliceParent);
+    view->SetExternal(parent->Data() + offset, size);
+    return view;
+}
+
+void cISBridgeBufferPool::ReleaseSliceParent(cISBridgeBuffer* buffer)
+{
+    (*static_cast<cISBridgeBuffer**>(buffer->Storage()))->Release();
+}
+
+uint32_t cISBridgeBufferPool::Pop()
+{
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t index = static_cast<uint32_t>(head);
+        if (index == kNil)
+        {
+            return kNil;
+        }
+        uint32_t next = m_next[index].load(std::memory_order_relaxed);
+        uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+        if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return index;
+        }
+    }
+}
+
+void cISBridgeBufferPool::Push(uint32_t index)
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    while (true)
+    {
+        m_next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t newHead = (((head >> 32) + 1) << 32) | index;
+        if (m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+void cISBridgeBufferPool::Return(cISBridgeBuffer* buffer)
+{
+    size_t index = (reinterpret_cast<uint8_t*>(buffer) - m_arena.get()) / m_stride;
+    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+    Push(static_cast<uint32_t>(index));
+
+    // The last buffer of a retired pool frees it; the block was in the arena, so
+    // nothing may touch either afterwards
+    if (m_holds.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete this;
+    }
+}
+
+void cISBridgeBufferPool::Retire()
+{
+    if (m_holds.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete this;
+    }
+}
+
+sISBridgeBufferPoolStats cISBridgeBufferPool::GetStats() const
+{
+    sISBridgeBufferPoolStats stats;
+    stats.blockSize = m_blockSize;
+    stats.blockCount = m_blockCount;
+    stats.blocksInUse = m_inUse.load(std::memory_order_relaxed);
+    stats.acquired = m_acquired.load(std::memory_order_relaxed);
+    stats.heapAllocations = m_heapAllocations.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,455 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeCapture.h"
+#include "ISBridgeMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const int kIdleSleepMs = 1;          // Writer thread poll interval when the rings are empty
+static const size_t kPageSize = 4096;
+
+static size_t alignRecord(size_t size)
+{
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+cISBridgeCaptureWriter::cISBridgeCaptureWriter()
+    : m_segmentBytes(0)
+    , m_running(false)
+    , m_fd(-1)
+    , m_map(NULL)
+    , m_used(0)
+    , m_segmentIndex(0)
+    , m_lastTimestampNs(0)
+    , m_startClockNs(0)
+    , m_startWallNs(0)
+    , m_failed(false)
+{
+}
+
+cISBridgeCaptureWriter::~cISBridgeCaptureWriter()
+{
+    Close();
+}
+
+std::string cISBridgeCaptureWriter::SegmentPath(const std::string& path, uint32_t index)
+{
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), ".%03u", index);
+    return path + suffix;
+}
+
+int cISBridgeCaptureWriter::Open(const std::string& path, size_t segmentBytes, size_t ringBytes)
+{
+    if (IsOpen())
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < kRingCount; i++)
+    {
+        m_rings[i] = std::make_unique<cISBridgeRecordRing>(ringBytes);
+    }
+
+    // Every record the rings accept must fit in one segment
+    size_t minimum = sizeof(sISBridgeCaptureFileHeader) + alignRecord(m_rings[0]->MaxRecordSize());
+    m_segmentBytes = (std::max(segmentBytes, minimum) + kPageSize - 1) & ~(kPageSize - 1);
+    m_path = path;
+    m_lastTimestampNs = 0;
+    m_failed = false;
+    m_startClockNs = bridgeClockNs();
+    m_startWallNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+    if (OpenSegment(0) != 0)
+    {
+        return -1;
+    }
+
+    m_running = true;
+    m_thread = std::make_unique<std::thread>(&cISBridgeCaptureWriter::WriterThread, this);
+    return 0;
+}
+
+void cISBridgeCaptureWriter::Close()
+{
+    if (!m_thread)
+    {
+        return;
+    }
+
+    // The writer drains both rings before it exits
+    m_running = false;
+    if (m_thread->joinable())
+    {
+        m_thread->join();
+    }
+    m_thread.reset();
+    CloseSegment();
+}
+
+void cISBridgeCaptureWriter::Record(eISBridgeCaptureDirection direction, uint32_t clientId, const uint8_t* data, size_t size, uint64_t timestampNs)
+{
+    sISBridgeCaptureRecordHeader header = {};
+    header.length = static_cast<uint32_t>(sizeof(header) + size);
+    header.direction = static_cast<uint8_t>(direction);
+    header.clientId = clientId;
+    header.timestampNs = timestampNs;
+
+    cISBridgeRecordRing& ring = *m_rings[direction == BRIDGE_CAPTURE_ZMQ_TO_TCP ? kRingZmq : kRingTcp];
+    if (!ring.Write(&header, sizeof(header), data, size))
+    {
+        bridgeCounterAdd(m_counters.droppedRecords, 1);
+        bridgeCounterAdd(m_counters.droppedBytes, size);
+    }
+}
+
+sISBridgeCaptureStats cISBridgeCaptureWriter::GetStats() const
+{
+    sISBridgeCaptureStats stats;
+    stats.records = m_counters.records.load(std::memory_order_relaxed);
+    stats.bytes = m_counters.bytes.load(std::memory_order_relaxed);
+    stats.droppedRecords = m_counters.droppedRecords.load(std::memory_order_relaxed);
+    stats.droppedBytes = m_counters.droppedBytes.load(std::memory_order_relaxed);
+    stats.segments = m_counters.segments.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void cISBridgeCaptureWriter::WriterThread()
+{
+    for (;;)
+    {
+        // Read the flag first so records queued before Close() are always written
+        bool running = m_running.load(std::memory_order_acquire);
+        if (Drain() == 0)
+        {
+            if (!running)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(kIdleSleepMs));
+        }
+    }
+}
+
+int cISBridgeCaptureWriter::Drain()
+{
+    int count = 0;
+    for (;;)
+    {
+        // Merge the rings: each is in timestamp order, so the older head goes first
+        const uint8_t* records[kRingCount];
+        size_t sizes[kRingCount];
+        int pick = -1;
+        uint64_t pickTimestamp = 0;
+        for (int i = 0; i < kRingCount; i++)
+        {
+            records[i] = m_rings[i]->Peek(sizes[i]);
+            if (!records[i])
+            {
+                continue;
+            }
+            uint64_t timestamp;
+            memcpy(&timestamp, records[i] + offsetof(sISBridgeCaptureRecordHeader, timestampNs), sizeof(timestamp));
+            if (pick < 0 || timestamp < pickTimestamp)
+            {
+                pick = i;
+                pickTimestamp = timestamp;
+            }
+        }
+        if (pick < 0)
+        {
+            return count;
+        }
+
+        sISBridgeCaptureRecordHeader header;
+        memcpy(&header, records[pick], sizeof(header));
+        size_t size = sizes[pick] - sizeof(header);
+
+        // A record stamped just before one already written from the other ring is
+        // clamped so timestamps in the file never go backwards
+        header.timestampNs = std::max(header.timestampNs, m_lastTimestampNs);
+        m_lastTimestampNs = header.timestampNs;
+
+        if (!m_failed && Append(header, records[pick] + sizeof(header), size) == 0)
+        {
+            bridgeCounterAdd(m_counters.records, 1);
+            bridgeCounterAdd(m_counters.bytes, size);
+        }
+        else
+        {
+            bridgeCounterAdd(m_counters.droppedRecords, 1);
+            bridgeCounterAdd(m_counters.droppedBytes, size);
+        }
+        m_rings[pick]->Pop();
+        count++;
+    }
+}
+
+int cISBridgeCaptureWriter::Append(const sISBridgeCaptureRecordHeader& header, const uint8_t* payload, size_t size)
+{
+    size_t padded = alignRecord(header.length);
+    if (m_used + padded > m_segmentBytes)
+    {
+        CloseSegment();
+        if (OpenSegment(m_segmentIndex + 1) != 0)
+        {
+            m_failed = true;
+            return -1;
+        }
+    }
+
+    // Payload before header, so a reader of a crashed capture never sees a length
+    // covering unwritten bytes
+    uint8_t* record = m_map + m_used;
+    memcpy(record + sizeof(header), payload, size);
+    memcpy(record, &header, sizeof(header));
+    m_used += padded;
+    return 0;
+}
+
+#if defined(_WIN32)
+
+// Segments are memory-mapped files; not ported to Windows
+
+int cISBridgeCaptureWriter::OpenSegment(uint32_t index)
+{
+    (void)index;
+    std::cerr << "Traffic capture is not supported on Windows" << std::endl;
+    return -1;
+}
+
+void cISBridgeCaptureWriter::CloseSegment()
+{
+    m_used = 0;
+}
+
+#else
+
+int cISBridgeCaptureWriter::OpenSegment(uint32_t index)
+{
+    std::string name = SegmentPath(m_path, index);
+    m_fd = open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        std::cerr << "Failed to create capture segment " << name << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+#if defined(__linux__)
+    // Reserve the blocks now: running out of disk while storing into a sparse mapping
+    // raises SIGBUS instead of returning an error
+    int result = posix_fallocate(m_fd, 0, static_cast<off_t>(m_segmentBytes));
+#else
+    int result = (ftruncate(m_fd, static_cast<off_t>(m_segmentBytes)) == 0) ? 0 : errno;
+#endif
+    if (result != 0)
+    {
+        std::cerr << "Failed to size capture segment " << name << ": " << strerror(result) << std::endl;
+        close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+
+    void* map = mmap(NULL, m_segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "Failed to map capture segment " << name << ": " << strerror(errno) << std::endl;
+        close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+    m_map = static_cast<uint8_t*>(map);
+    madvise(m_map, m_segmentBytes, MADV_SEQUENTIAL);
+
+    sISBridgeCaptureFileHeader header = {};
+    memcpy(header.magic, BRIDGE_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = BRIDGE_CAPTURE_VERSION;
+    header.headerSize = sizeof(header);
+    header.segmentIndex = index;
+    header.startClockNs = m_startClockNs;
+    header.startWallNs = m_startWallNs;
+    memcpy(m_map, &header, sizeof(header));
+
+    m_segmentIndex = index;
+    m_used = sizeof(header);
+    bridgeCounterAdd(m_counters.segments, 1);
+    return 0;
+}
+
+void cISBridgeCaptureWriter::CloseSegment()
+{
+    if (m_map)
+    {
+        munmap(m_map, m_segmentBytes);
+        m_map = NULL;
+    }
+    if (m_fd >= 0)
+    {
+        // Trim the preallocated tail so the file ends at the last record
+        if (ftruncate(m_fd, static_cast<off_t>(m_used)) != 0)
+        {
+            std::cerr << "Failed to trim capture segment: " << strerror(errno) << std::endl;
+        }
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_used = 0;
+}
+
+#endif
+
+cISBridgeCaptureReader::cISBridgeCaptureReader()
+    : m_header()
+    , m_segment(0)
+    , m_offset(0)
+{
+}
+
+cISBridgeCaptureReader::~cISBridgeCaptureReader()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+int cISBridgeCaptureReader::Open(const std::string& path)
+{
+    (void)path;
+    std::cerr << "Capture replay is not supported on Windows" << std::endl;
+    return -1;
+}
+
+void cISBridgeCaptureReader::Close()
+{
+    m_segments.clear();
+    m_segment = 0;
+    m_offset = 0;
+}
+
+#else
+
+int cISBridgeCaptureReader::Open(const std::string& path)
+{
+    Close();
+
+    for (uint32_t index = 0; ; index++)
+    {
+        std::string name = cISBridgeCaptureWriter::SegmentPath(path, index);
+        int fd = open(name.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == ENOENT && index > 0)
+            {
+                break;
+            }
+            std::cerr << "Failed to open capture " << name << ": " << strerror(errno) << std::endl;
+            Close();
+            return -1;
+        }
+
+        struct stat info;
+        sISBridgeCaptureFileHeader header;
+        void* map = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(header))
+        {
+            map = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            std::cerr << "Failed to map capture " << name << std::endl;
+            Close();
+            return -1;
+        }
+
+        sSegment segment = { static_cast<const uint8_t*>(map), static_cast<size_t>(info.st_size) };
+        m_segments.push_back(segment);
+
+        memcpy(&header, segment.data, sizeof(header));
+        if (memcmp(header.magic, BRIDGE_CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != BRIDGE_CAPTURE_VERSION ||
+            header.headerSize < sizeof(header) || header.headerSize > segment.size)
+        {
+            std::cerr << "Not a bridge capture: " << name << std::endl;
+            Close();
+            return -1;
+        }
+        if (index == 0)
+        {
+            m_header = header;
+        }
+    }
+
+    Rewind();
+    return 0;
+}
+
+void cISBridgeCaptureReader::Close()
+{
+    for (const sSegment& segment : m_segments)
+    {
+        munmap(const_cast<uint8_t*>(segment.data), segment.size);
+    }
+    m_segments.clear();
+    m_segment = 0;
+    m_offset = 0;
+}
+
+#endif
+
+void cISBridgeCaptureReader::Rewind()
+{
+    m_segment = 0;
+    m_offset = m_header.headerSize;
+}
+
+bool cISBridgeCaptureReader::Next(sISBridgeCaptureRecord& record)
+{
+    while (m_segment < m_segments.size())
+    {
+        const sSegment& segment = m_segments[m_segment];
+        sISBridgeCaptureRecordHeader header;
+        if (m_offset + sizeof(header) <= segment.size)
+        {
+            memcpy(&header, segment.data + m_offset, sizeof(header));
+
+            // Zero length: end of a segment left preallocated by a crash
+            if (header.length >= sizeof(header) && m_offset + header.length <= segment.size)
+            {
+                record.direction = static_cast<eISBridgeCaptureDirection>(header.direction);
+                record.clientId = header.clientId;
+                record.timestampNs = header.timestampNs;
+                record.data = segment.data + m_offset + sizeof(header);
+                record.size = header.length - sizeof(header);
+                m_offset += alignRecord(header.length);
+                return true;
+            }
+        }
+
+        m_segment++;
+        m_offset = m_header.headerSize;
+    }
+    return false;
+}
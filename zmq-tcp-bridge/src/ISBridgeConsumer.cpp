@@ -0,0 +1,50 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeConsumer.h"
+
+cISBridgeConsumerQueue::cISBridgeConsumerQueue(size_t capacity)
+    : m_queue(capacity)
+    , m_signalled(false)
+{
+    m_wakeup.Open();
+}
+
+bool cISBridgeConsumerQueue::Pop(cISBridgeBufferRef& buffer)
+{
+    if (m_queue.Pop(buffer))
+    {
+        return true;
+    }
+
+    // Ran dry: re-arm the signal, then look once more for a message pushed while the
+    // flag was still set (its producer did not signal)
+    m_signalled.store(false, std::memory_order_seq_cst);
+    m_wakeup.Drain();
+    return m_queue.Pop(buffer);
+}
+
+void cISBridgeConsumerQueue::OnBridgeMessages(const cISBridgeBufferRef* messages, int count)
+{
+    bool pushed = false;
+    for (int i = 0; i < count; i++)
+    {
+        cISBridgeBufferRef message = messages[i];
+        pushed |= m_queue.Push(message);
+    }
+
+    if (pushed && !m_signalled.exchange(true, std::memory_order_seq_cst))
+    {
+        m_wakeup.Signal();
+    }
+}
@@ -0,0 +1,207 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeDidFilter.h"
+
+// p_data_get_t in the SDK: u16 id, size, offset and period (multiple of the DID's source period)
+static const size_t kGetDataSize = 8;
+static const size_t kGetDataPeriodOffset = 6;
+
+static uint16_t readU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/**
+ * Locate the payload of an ISB packet
+ * @param packet a framed ISB packet
+ * @param payload receives the first payload byte after any data set offset
+ * @param offset receives the data set offset the SDK prepends to partial writes, else 0
+ * @return payload size in bytes
+ */
+static size_t isbPayload(const sISBridgePacket& packet, const uint8_t*& payload, uint16_t& offset)
+{
+    payload = packet.data + BRIDGE_ISB_HEADER_SIZE;
+    offset = 0;
+    size_t size = packet.size - BRIDGE_ISB_HEADER_SIZE - 2;
+    if ((packet.data[2] & BRIDGE_ISB_FLAGS_PAYLOAD_W_OFFSET) != 0)
+    {
+        if (size < 2)
+        {
+            return 0;
+        }
+        offset = readU16(payload);
+        payload += 2;
+        size -= 2;
+    }
+    return size;
+}
+
+cISBridgeDidFilter::cISBridgeDidFilter()
+    : m_active(false), m_rmc(false)
+{
+    for (int i = 0; i < sISBridgeDidSet::kWordCount; i++)
+    {
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool cISBridgeDidFilter::ApplyCommand(const sISBridgePacket& packet)
+{
+    if (packet.protocol != BRIDGE_PROTOCOL_ISB || packet.size < BRIDGE_ISB_HEADER_SIZE + 2)
+    {
+        return false;
+    }
+
+    bool wasActive = m_active.load(std::memory_order_relaxed);
+    bool active = wasActive;
+    sISBridgeDidSet before;
+    before.all = false;
+    MergeInto(before);
+
+    const uint8_t* payload;
+    uint16_t offset;
+    size_t size = isbPayload(packet, payload, offset);
+
+    switch (packet.type)
+    {
+    case BRIDGE_ISB_PKT_TYPE_GET_DATA:
+    {
+        // The SDK sends get-data with data ID 0 in the header and the DID in the payload
+        uint16_t did = packet.id;
+        uint16_t period = 1;
+        if (size >= kGetDataSize)
+        {
+            did = readU16(payload);
+            period = readU16(payload + kGetDataPeriodOffset);
+        }
+        if (did >= sISBridgeDidSet::kWordCount * 64 || m_rmc.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        if (period != 0)
+        {
+            Add(static_cast<uint8_t>(did));
+            active = true;
+        }
+        else if (active)
+        {
+            // One-shot request: let the reply through without turning filtering on
+            Add(static_cast<uint8_t>(did));
+        }
+        break;
+    }
+
+    case BRIDGE_ISB_PKT_TYPE_STOP_DID_BROADCAST:
+    {
+        // Header data ID, or a DID payload from older senders
+        uint16_t did = packet.id;
+        if (did == 0 && size >= 2)
+        {
+            did = readU16(payload);
+        }
+        if (did >= sISBridgeDidSet::kWordCount * 64)
+        {
+            return false;
+        }
+        Remove(static_cast<uint8_t>(did));
+        break;
+    }
+
+    case BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_ALL:
+    case BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_PORT:
+        // Whatever the client enables next (get-data or RMC) decides whether it is filtered
+        Clear();
+        m_rmc.store(false, std::memory_order_relaxed);
+        active = false;
+        break;
+
+    case BRIDGE_ISB_PKT_TYPE_SET_DATA:
+    {
+        if (packet.id != BRIDGE_ISB_DID_RMC || offset >= sizeof(uint64_t))
+        {
+            return false;
+        }
+        uint64_t bits = ~0ULL;
+        if (offset == 0 && size >= sizeof(uint64_t))
+        {
+            bits = 0;
+            for (size_t i = 0; i < sizeof(uint64_t); i++)
+            {
+                bits |= static_cast<uint64_t>(payload[i]) << (8 * i);
+            }
+        }
+        m_rmc.store(bits != 0, std::memory_order_relaxed);
+        if (bits != 0)
+        {
+            // RMC streams are not tied to data IDs, so forward everything
+            Clear();
+            active = false;
+        }
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    m_active.store(active, std::memory_order_relaxed);
+    sISBridgeDidSet after;
+    after.all = false;
+    MergeInto(after);
+    return active != wasActive || (active && before != after);
+}
+
+void cISBridgeDidFilter::MergeInto(sISBridgeDidSet& set) const
+{
+    for (int i = 0; i < sISBridgeDidSet::kWordCount; i++)
+    {
+        set.words[i] |= m_words[i].load(std::memory_order_relaxed);
+    }
+}
+
+void cISBridgeDidFilter::Export(sISBridgeDidSet& set) const
+{
+    set = sISBridgeDidSet();
+    set.all = !m_active.load(std::memory_order_relaxed);
+    set.rmc = m_rmc.load(std::memory_order_relaxed);
+    MergeInto(set);
+}
+
+void cISBridgeDidFilter::Import(const sISBridgeDidSet& set)
+{
+    for (int i = 0; i < sISBridgeDidSet::kWordCount; i++)
+    {
+        m_words[i].store(set.words[i], std::memory_order_relaxed);
+    }
+    m_active.store(!set.all, std::memory_order_relaxed);
+    m_rmc.store(set.rmc, std::memory_order_relaxed);
+}
+
+void cISBridgeDidFilter::Add(uint8_t did)
+{
+    m_words[did >> 6].fetch_or(1ULL << (did & 63), std::memory_order_relaxed);
+}
+
+void cISBridgeDidFilter::Remove(uint8_t did)
+{
+    m_words[did >> 6].fetch_and(~(1ULL << (did & 63)), std::memory_order_relaxed);
+}
+
+void cISBridgeDidFilter::Clear()
+{
+    for (int i = 0; i < sISBridgeDidSet::kWordCount; i++)
+    {
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,440 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeHandoff.h"
+#include <iostream>
+#include <errno.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace
+{
+    const uint32_t kHandoffMagic = 0x48425349;      // "ISBH"
+    const uint16_t kHandoffVersion = 2;             // 2: the new bridge acknowledges
+    const int kMaxFdsPerMessage = 64;               // Well below the kernel's SCM_MAX_FD
+
+    // First message; carries the listening sockets. Client messages follow, each with
+    // up to kMaxFdsPerMessage records and their sockets in the same order.
+    struct sHandoffHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t listenCount;
+        uint32_t clientCount;
+        uint32_t reserved;
+    };
+
+    struct sHandoffClientRecord
+    {
+        uint8_t all;
+        uint8_t rmc;                                // Was reserved, so zero from older bridges
+        uint8_t reserved[6];
+        uint64_t words[sISBridgeDidSet::kWordCount];
+    };
+
+    // Final message, from the new bridge once it serves every socket it received
+    struct sHandoffAck
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t listenCount;
+        uint32_t clientCount;
+        uint32_t reserved;
+    };
+
+    sHandoffAck makeAck(size_t listenCount, size_t clientCount)
+    {
+        sHandoffAck ack;
+        memset(&ack, 0, sizeof(ack));
+        ack.magic = kHandoffMagic;
+        ack.version = kHandoffVersion;
+        ack.listenCount = static_cast<uint16_t>(listenCount);
+        ack.clientCount = static_cast<uint32_t>(clientCount);
+        return ack;
+    }
+}
+
+void sISBridgeHandoffState::Close()
+{
+    for (is_socket_t socket : listenSockets)
+    {
+        bridgeSocketClose(socket);
+    }
+    for (const sISBridgeTcpHandoffClient& client : clients)
+    {
+        bridgeSocketClose(client.socket);
+    }
+    listenSockets.clear();
+    clients.clear();
+}
+
+#if defined(__linux__)
+
+static int fillUnixAddress(const std::string& path, sockaddr_un& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Invalid hand-off socket path: " << path << std::endl;
+        return -1;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return 0;
+}
+
+static int sendWithFds(int socket, const void* data, size_t size, const int* fds, int fdCount)
+{
+    iovec iov;
+    iov.iov_base = const_cast<void*>(data);
+    iov.iov_len = size;
+
+    union
+    {
+        char buffer[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+        cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fdCount > 0)
+    {
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fdCount);
+    }
+
+    ssize_t n;
+    do
+    {
+        n = sendmsg(socket, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return (n == static_cast<ssize_t>(size)) ? 0 : -1;
+}
+
+/**
+ * Receive one message and the descriptors attached to it
+ * @return bytes received, -1 on error or timeout
+ */
+static ssize_t receiveWithFds(int socket, void* data, size_t size, std::vector<int>& fds, int timeoutMs)
+{
+    pollfd p = { socket, POLLIN, 0 };
+    int ready;
+    do
+    {
+        ready = poll(&p, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0)
+    {
+        return -1;
+    }
+
+    iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = size;
+
+    union
+    {
+        char buffer[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+        cmsghdr align;
+    } control;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    ssize_t n;
+    do
+    {
+        n = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+
+    // Collect what arrived even on a bad message, so the caller can close it
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); n >= 0 && cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            int count = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            for (int i = 0; i < count; i++)
+            {
+                int fd;
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                fds.push_back(fd);
+            }
+        }
+    }
+    if (n >= 0 && (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0)
+    {
+        return -1;
+    }
+    return n;
+}
+
+int bridgeHandoffListen(const std::string& path)
+{
+    sockaddr_un addr;
+    if (fillUnixAddress(path, addr) != 0)
+    {
+        return -1;
+    }
+
+    int socket = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (socket < 0)
+    {
+        return -1;
+    }
+
+    // The bridge being replaced may still listen on the old node; unlinking it leaves
+    // that socket working for connections already made and sends new ones here
+    unlink(path.c_str());
+    if (bind(socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(socket, 1) != 0)
+    {
+        std::cerr << "Failed to listen for hand-off on " << path << ": " << strerror(errno) << std::endl;
+        close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+int bridgeHandoffAccept(int listenSocket, int timeoutMs)
+{
+    pollfd p = { listenSocket, POLLIN, 0 };
+    if (poll(&p, 1, timeoutMs) <= 0)
+    {
+        return -1;
+    }
+    return accept4(listenSocket, NULL, NULL, SOCK_CLOEXEC);
+}
+
+void bridgeHandoffClose(int socket, const std::string& path)
+{
+    if (socket >= 0)
+    {
+        close(socket);
+    }
+    if (!path.empty())
+    {
+        unlink(path.c_str());
+    }
+}
+
+int bridgeHandoffConnect(const std::string& path)
+{
+    sockaddr_un addr;
+    if (fillUnixAddress(path, addr) != 0)
+    {
+        return -1;
+    }
+
+    int socket = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (socket < 0)
+    {
+        return -1;
+    }
+    if (connect(socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+int bridgeHandoffSend(int socket, const sISBridgeHandoffState& state)
+{
+    if (state.listenSockets.empty() || state.listenSockets.size() > static_cast<size_t>(kMaxFdsPerMessage))
+    {
+        return -1;
+    }
+
+    sHandoffHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kHandoffMagic;
+    header.version = kHandoffVersion;
+    header.listenCount = static_cast<uint16_t>(state.listenSockets.size());
+    header.clientCount = static_cast<uint32_t>(state.clients.size());
+    if (sendWithFds(socket, &header, sizeof(header), state.listenSockets.data(), header.listenCount) != 0)
+    {
+        return -1;
+    }
+
+    sHandoffClientRecord records[kMaxFdsPerMessage];
+    int fds[kMaxFdsPerMessage];
+    for (size_t first = 0; first < state.clients.size(); first += kMaxFdsPerMessage)
+    {
+        size_t remaining = state.clients.size() - first;
+        int count = (remaining < static_cast<size_t>(kMaxFdsPerMessage)) ? static_cast<int>(remaining) : kMaxFdsPerMessage;
+        for (int i = 0; i < count; i++)
+        {
+            const sISBridgeTcpHandoffClient& client = state.clients[first + i];
+            memset(&records[i], 0, sizeof(records[i]));
+            records[i].all = client.filter.all ? 1 : 0;
+            records[i].rmc = client.filter.rmc ? 1 : 0;
+            memcpy(records[i].words, client.filter.words, sizeof(records[i].words));
+            fds[i] = client.socket;
+        }
+        if (sendWithFds(socket, records, sizeof(records[0]) * count, fds, count) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int bridgeHandoffWaitAcknowledge(int socket, const sISBridgeHandoffState& state, int timeoutMs)
+{
+    sHandoffAck expected = makeAck(state.listenSockets.size(), state.clients.size());
+    sHandoffAck ack;
+    std::vector<int> fds;
+    ssize_t n = receiveWithFds(socket, &ack, sizeof(ack), fds, timeoutMs);
+    for (int fd : fds)
+    {
+        close(fd);
+    }
+    if (n != static_cast<ssize_t>(sizeof(ack)) || memcmp(&ack, &expected, sizeof(ack)) != 0)
+    {
+        std::cerr << "The new bridge did not acknowledge the hand-off" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int bridgeHandoffReceive(int socket, sISBridgeHandoffState& state, int timeoutMs)
+{
+    state = sISBridgeHandoffState();
+
+    sHandoffHeader header;
+    std::vector<int> fds;
+    ssize_t n = receiveWithFds(socket, &header, sizeof(header), fds, timeoutMs);
+    if (n != static_cast<ssize_t>(sizeof(header)) || header.magic != kHandoffMagic || header.version != kHandoffVersion ||
+        header.listenCount == 0 || fds.size() != header.listenCount)
+    {
+        std::cerr << "Invalid hand-off from the running bridge" << std::endl;
+        for (int fd : fds)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    state.listenSockets = fds;
+
+    sHandoffClientRecord records[kMaxFdsPerMessage];
+    while (state.clients.size() < header.clientCount)
+    {
+        fds.clear();
+        n = receiveWithFds(socket, records, sizeof(records), fds, timeoutMs);
+        if (n <= 0 || n % sizeof(records[0]) != 0 || fds.size() != n / sizeof(records[0]))
+        {
+            std::cerr << "Hand-off interrupted after " << state.clients.size() << " of " << header.clientCount << " clients" << std::endl;
+            for (int fd : fds)
+            {
+                close(fd);
+            }
+            state.Close();
+            return -1;
+        }
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            sISBridgeTcpHandoffClient client;
+            client.socket = fds[i];
+            client.filter.all = records[i].all != 0;
+            client.filter.rmc = records[i].rmc != 0;
+            memcpy(client.filter.words, records[i].words, sizeof(client.filter.words));
+            state.clients.push_back(client);
+        }
+    }
+    return 0;
+}
+
+int bridgeHandoffAcknowledge(int socket, size_t listenCount, size_t clientCount)
+{
+    sHandoffAck ack = makeAck(listenCount, clientCount);
+    return sendWithFds(socket, &ack, sizeof(ack), NULL, 0);
+}
+
+#else
+
+int bridgeHandoffListen(const std::string& path)
+{
+    (void)path;
+    std::cerr << "Socket hand-off is only supported on Linux" << std::endl;
+    return -1;
+}
+
+int bridgeHandoffAccept(int listenSocket, int timeoutMs)
+{
+    (void)listenSocket;
+    (void)timeoutMs;
+    return -1;
+}
+
+void bridgeHandoffClose(int socket, const std::string& path)
+{
+    (void)socket;
+    (void)path;
+}
+
+int bridgeHandoffConnect(const std::string& path)
+{
+    (void)path;
+    return -1;
+}
+
+int bridgeHandoffSend(int socket, const sISBridgeHandoffState& state)
+{
+    (void)socket;
+    (void)state;
+    return -1;
+}
+
+int bridgeHandoffWaitAcknowledge(int socket, const sISBridgeHandoffState& state, int timeoutMs)
+{
+    (void)socket;
+    (void)state;
+    (void)timeoutMs;
+    return -1;
+}
+
+int bridgeHandoffReceive(int socket, sISBridgeHandoffState& state, int timeoutMs)
+{
+    (void)socket;
+    (void)timeoutMs;
+    state = sISBridgeHandoffState();
+    return -1;
+}
+
+int bridgeHandoffAcknowledge(int socket, size_t listenCount, size_t clientCount)
+{
+    (void)socket;
+    (void)listenCount;
+    (void)clientCount;
+    return -1;
+}
+
+#endif
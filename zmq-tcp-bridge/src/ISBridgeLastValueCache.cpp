@@ -0,0 +1,126 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeLastValueCache.h"
+
+#include <string.h>
+
+static const size_t kCapacityGranularity = 64;     // Room for a DID's size to vary a little without reallocating
+
+cISBridgeLastValueCache::cISBridgeLastValueCache()
+    : m_maxBytes(kDefaultMaxBytes)
+    , m_bytes(0)
+    , m_entries(0)
+    , m_updates(0)
+    , m_rejected(0)
+    , m_snapshots(0)
+    , m_snapshotMessages(0)
+{
+}
+
+void cISBridgeLastValueCache::Configure(const sISBridgeDidSet& dids, size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dids = dids;
+    m_maxBytes = maxBytes;
+    for (int i = 0; i < kDidCount; i++)
+    {
+        m_values[i].Reset();
+    }
+    m_bytes = 0;
+    m_entries = 0;
+}
+
+void cISBridgeLastValueCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i = 0; i < kDidCount; i++)
+    {
+        m_values[i].Reset();
+    }
+    m_bytes = 0;
+    m_entries = 0;
+}
+
+void cISBridgeLastValueCache::Update(const cISBridgeBuffer& packet)
+{
+    if (packet.Protocol() != BRIDGE_PROTOCOL_ISB || packet.PacketType() != BRIDGE_ISB_PKT_TYPE_DATA || packet.PacketId() >= kDidCount)
+    {
+        return;
+    }
+
+    uint8_t did = static_cast<uint8_t>(packet.PacketId());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_dids.Contains(did))
+    {
+        return;
+    }
+
+    cISBridgeBufferRef& value = m_values[did];
+    if (!value || value->IsShared() || value->Capacity() < packet.Size())
+    {
+        // A client queue still holds the old value, or it is too small: replace it
+        size_t capacity = (packet.Size() + kCapacityGranularity - 1) & ~(kCapacityGranularity - 1);
+        size_t released = value ? value->Capacity() : 0;
+        if (m_bytes - released + capacity > m_maxBytes)
+        {
+            m_rejected++;
+            return;
+        }
+        cISBridgeBufferRef replacement(cISBridgeBuffer::Create(capacity));
+        if (!replacement)
+        {
+            m_rejected++;
+            return;
+        }
+        m_entries += value ? 0 : 1;
+        m_bytes = m_bytes - released + capacity;
+        value = std::move(replacement);
+    }
+
+    memcpy(value->Data(), packet.Data(), packet.Size());
+    value->SetSize(packet.Size());
+    value->SetPacketInfo(packet.Protocol(), packet.PacketType(), packet.PacketId());
+    value->SetTimestamp(0);     // Replayed state, not live: keep it out of latency statistics
+    m_updates++;
+}
+
+int cISBridgeLastValueCache::Snapshot(std::vector<cISBridgeBufferRef>& out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int count = 0;
+    for (int i = 0; i < kDidCount; i++)
+    {
+        if (m_values[i])
+        {
+            out.push_back(m_values[i]);
+            count++;
+        }
+    }
+    m_snapshots++;
+    m_snapshotMessages += static_cast<uint64_t>(count);
+    return count;
+}
+
+sISBridgeLastValueCacheStats cISBridgeLastValueCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sISBridgeLastValueCacheStats stats;
+    stats.entries = m_entries;
+    stats.bytes = m_bytes;
+    stats.updates = m_updates;
+    stats.rejected = m_rejected;
+    stats.snapshots = m_snapshots;
+    stats.snapshotMessages = m_snapshotMessages;
+    return stats;
+}
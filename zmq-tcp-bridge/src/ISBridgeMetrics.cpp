@@ -0,0 +1,170 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeMetrics.h"
+
+#include <chrono>
+#include <stdio.h>
+
+uint64_t bridgeClockNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+cISBridgeHistogram::cISBridgeHistogram()
+{
+    Reset();
+}
+
+void cISBridgeHistogram::Reset()
+{
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+void cISBridgeHistogram::MergeInto(cISBridgeHistogram& other) const
+{
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        uint64_t count = m_buckets[i].load(std::memory_order_relaxed);
+        if (count != 0)
+        {
+            other.m_buckets[i].fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+    other.m_sum.fetch_add(m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    uint64_t otherMax = other.m_max.load(std::memory_order_relaxed);
+    while (max > otherMax && !other.m_max.compare_exchange_weak(otherMax, max, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t cISBridgeHistogram::BucketUpperBound(int index)
+{
+    if (index < kSubBucketCount)
+    {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / kSubBucketCount - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBucketCount + index % kSubBucketCount) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+sISBridgeHistogramStats cISBridgeHistogram::Stats() const
+{
+    sISBridgeHistogramStats stats;
+    uint64_t counts[kBucketCount];
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        stats.count += counts[i];
+    }
+    stats.sumNs = m_sum.load(std::memory_order_relaxed);
+    stats.maxNs = m_max.load(std::memory_order_relaxed);
+    if (stats.count == 0)
+    {
+        return stats;
+    }
+
+    // Walk the buckets once, filling each percentile as its rank is crossed
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    uint64_t* results[] = { &stats.p50Ns, &stats.p90Ns, &stats.p99Ns, &stats.p999Ns };
+    int next = 0;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount && next < 4; i++)
+    {
+        seen += counts[i];
+        while (next < 4 && seen >= static_cast<uint64_t>(quantiles[next] * static_cast<double>(stats.count) + 0.5) && seen > 0)
+        {
+            uint64_t bound = BucketUpperBound(i);
+            *results[next++] = (bound < stats.maxNs) ? bound : stats.maxNs;
+        }
+    }
+    return stats;
+}
+
+void bridgeFormatPrometheusSample(const char* name, const std::string& labels, uint64_t value, std::string& out)
+{
+    out += name;
+    if (!labels.empty())
+    {
+        out += "{";
+        out += labels;
+        out += "}";
+    }
+    out += " ";
+    out += std::to_string(value);
+    out += "\n";
+}
+
+std::string bridgePrometheusLabelValue(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value)
+    {
+        if (c == '\\')
+        {
+            escaped += "\\\\";
+        }
+        else if (c == '"')
+        {
+            escaped += "\\\"";
+        }
+        else if (c == '\n')
+        {
+            escaped += "\\n";
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void bridgeFormatPrometheusSummary(const char* name, const std::string& labels, const sISBridgeHistogramStats& stats, std::string& out)
+{
+    const char* quantiles[] = { "0.5", "0.9", "0.99", "0.999" };
+    const uint64_t values[] = { stats.p50Ns, stats.p90Ns, stats.p99Ns, stats.p999Ns };
+    char value[32];
+    for (int i = 0; i < 4; i++)
+    {
+        out += name;
+        out += "{";
+        if (!labels.empty())
+        {
+            out += labels;
+            out += ",";
+        }
+        out += "quantile=\"";
+        out += quantiles[i];
+        snprintf(value, sizeof(value), "\"} %.9f\n", static_cast<double>(values[i]) / 1e9);
+        out += value;
+    }
+
+    std::string suffixed = std::string(name) + "_sum";
+    out += suffixed;
+    if (!labels.empty())
+    {
+        out += "{" + labels + "}";
+    }
+    snprintf(value, sizeof(value), " %.9f\n", static_cast<double>(stats.sumNs) / 1e9);
+    out += value;
+    bridgeFormatPrometheusSample((std::string(name) + "_count").c_str(), labels, stats.count, out);
+}
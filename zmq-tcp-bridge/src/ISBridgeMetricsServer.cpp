@@ -0,0 +1,209 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeMetricsServer.h"
+
+#include <chrono>
+#include <errno.h>
+#include <iostream>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <sys/time.h>
+#endif
+
+cISBridgeMetricsServer::cISBridgeMetricsServer()
+    : m_listenSocket(-1)
+    , m_running(false)
+{
+}
+
+cISBridgeMetricsServer::~cISBridgeMetricsServer()
+{
+    Stop();
+}
+
+int cISBridgeMetricsServer::Start(int port, render_t render, const std::string& bindAddress)
+{
+    Stop();
+
+    if (bridgeSocketStartup() != 0 || m_wakeup.Open() != 0)
+    {
+        return -1;
+    }
+
+    m_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (!bridgeSocketValid(m_listenSocket))
+    {
+        Stop();
+        return -1;
+    }
+    bridgeSocketSetCloseOnExec(m_listenSocket);
+
+#if !defined(_WIN32)
+    int one = 1;
+    setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1 ||
+        bind(m_listenSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(m_listenSocket, 16) != 0)
+    {
+        std::cerr << "Failed to open metrics port " << bindAddress << ":" << port << ": " << strerror(errno) << std::endl;
+        Stop();
+        return -1;
+    }
+
+    m_render = render;
+    m_running = true;
+    try
+    {
+        m_thread = std::make_unique<std::thread>(&cISBridgeMetricsServer::ServerThread, this);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error starting metrics thread: " << e.what() << std::endl;
+        Stop();
+        return -1;
+    }
+    return 0;
+}
+
+void cISBridgeMetricsServer::Stop()
+{
+    m_running = false;
+    m_wakeup.Signal();
+    if (m_thread && m_thread->joinable())
+    {
+        m_thread->join();
+    }
+    m_thread.reset();
+
+    if (bridgeSocketValid(m_listenSocket))
+    {
+        bridgeSocketClose(m_listenSocket);
+        m_listenSocket = -1;
+    }
+    m_wakeup.Close();
+}
+
+int cISBridgeMetricsServer::Port() const
+{
+    if (!bridgeSocketValid(m_listenSocket))
+    {
+        return -1;
+    }
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    {
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void cISBridgeMetricsServer::ServerThread()
+{
+    pollfd fds[2] = {
+        { m_listenSocket, POLLIN, 0 },
+        { m_wakeup.Fd(), POLLIN, 0 },
+    };
+
+    while (m_running)
+    {
+        if (bridgeSocketPoll(fds, 2, -1) < 0)
+        {
+            if (bridgeSocketInterrupted(bridgeSocketError()))
+            {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            m_wakeup.Drain();
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            is_socket_t client = accept(m_listenSocket, NULL, NULL);
+            if (bridgeSocketValid(client))
+            {
+                HandleConnection(client);
+                bridgeSocketClose(client);
+            }
+        }
+    }
+}
+
+void cISBridgeMetricsServer::HandleConnection(is_socket_t socket)
+{
+    // Read until the end of the request head; the path and headers are not needed
+    char request[2048];
+    size_t received = 0;
+    const int timeoutMs = kRequestTimeoutMs;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (received < sizeof(request) - 1)
+    {
+        int remainingMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+        pollfd pfd = { socket, POLLIN, 0 };
+        if (remainingMs <= 0 || bridgeSocketPoll(&pfd, 1, remainingMs) <= 0)
+        {
+            return;
+        }
+        ssize_t n = bridgeSocketRecv(socket, request + received, sizeof(request) - 1 - received, 0);
+        if (n <= 0)
+        {
+            return;
+        }
+        received += static_cast<size_t>(n);
+        request[received] = '\0';
+        if (strstr(request, "\r\n\r\n") != NULL || strstr(request, "\n\n") != NULL)
+        {
+            break;
+        }
+    }
+
+    // A scraper that stops reading must not stall the server
+#if defined(_WIN32)
+    DWORD timeout = timeoutMs;
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+    timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    std::string body = m_render ? m_render() : std::string();
+    std::string response = "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        ssize_t n = send(socket, response.data() + sent, static_cast<int>(response.size() - sent), MSG_NOSIGNAL);
+        if (n < 0 && bridgeSocketInterrupted(bridgeSocketError()))
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
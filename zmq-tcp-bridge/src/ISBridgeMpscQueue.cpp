@@ -0,0 +1,124 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeMpscQueue.h"
+#include "ISBridgeMetrics.h"
+
+cISBridgeMpscQueue::cISBridgeMpscQueue(size_t capacity)
+    : m_capacity(2)
+    , m_tail(0)
+    , m_dropped(0)
+    , m_head(0)
+    , m_highWatermark(0)
+{
+    while (m_capacity < capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_cells.reset(new sCell[m_capacity]);
+    for (size_t i = 0; i < m_capacity; i++)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].buffer = NULL;
+    }
+}
+
+cISBridgeMpscQueue::~cISBridgeMpscQueue()
+{
+    Clear();
+}
+
+bool cISBridgeMpscQueue::Push(cISBridgeBufferRef& buffer)
+{
+    uint64_t pos = m_tail.load(std::memory_order_relaxed);
+    sCell* cell;
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+        uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence - pos);
+        if (diff == 0)
+        {
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The consumer has not freed this slot yet: full
+            bridgeCounterAdd(m_dropped, 1);
+            return false;
+        }
+        else
+        {
+            // Another producer claimed it first
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->buffer = buffer.Detach();
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool cISBridgeMpscQueue::Pop(cISBridgeBufferRef& buffer)
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    sCell& cell = m_cells[head & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != head + 1)
+    {
+        return false;
+    }
+
+    // Occupancy is sampled here rather than by producers to keep Push() to one atomic
+    size_t queued = static_cast<size_t>(m_tail.load(std::memory_order_relaxed) - head);
+    if (queued > m_highWatermark.load(std::memory_order_relaxed))
+    {
+        m_highWatermark.store(queued, std::memory_order_relaxed);
+    }
+
+    buffer = cISBridgeBufferRef(cell.buffer);
+    cell.buffer = NULL;
+    cell.sequence.store(head + m_capacity, std::memory_order_release);
+    m_head.store(head + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void cISBridgeMpscQueue::Clear()
+{
+    cISBridgeBufferRef buffer;
+    while (Pop(buffer))
+    {
+        buffer.Reset();
+    }
+}
+
+size_t cISBridgeMpscQueue::Size() const
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    return (tail > head) ? static_cast<size_t>(tail - head) : 0;
+}
+
+sISBridgeMpscQueueStats cISBridgeMpscQueue::GetStats() const
+{
+    sISBridgeMpscQueueStats stats;
+    stats.capacity = m_capacity;
+    stats.queued = Size();
+    stats.highWatermark = m_highWatermark.load(std::memory_order_relaxed);
+    stats.pushed = m_tail.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,505 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgePacketFramer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define BRIDGE_NMEA_START_BYTE      '$'
+#define BRIDGE_RTCM3_PREAMBLE       0xD3
+#define BRIDGE_UBX_PREAMBLE0        0xB5
+#define BRIDGE_UBX_PREAMBLE1        0x62
+
+// CRC-24Q (RTCM3), polynomial 0x1864CFB
+static constexpr std::array<uint32_t, 256> makeCrc24qTable()
+{
+    std::array<uint32_t, 256> table = {};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i << 16;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc <<= 1;
+            if (crc & 0x1000000)
+            {
+                crc ^= 0x1864CFB;
+            }
+        }
+        table[i] = crc & 0xFFFFFF;
+    }
+    return table;
+}
+
+static constexpr std::array<uint32_t, 256> s_crc24qTable = makeCrc24qTable();
+
+static uint32_t crc24q(uint32_t crc, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = ((crc << 8) & 0xFFFFFF) ^ s_crc24qTable[((crc >> 16) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+static int hexValue(uint8_t c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// 8-bit Fletcher, A in the low byte of sum and B in the next
+static uint32_t fletcher8(uint32_t sum, const uint8_t* data, size_t size)
+{
+    uint8_t a = static_cast<uint8_t>(sum);
+    uint8_t b = static_cast<uint8_t>(sum >> 8);
+    for (size_t i = 0; i < size; i++)
+    {
+        a = static_cast<uint8_t>(a + data[i]);
+        b = static_cast<uint8_t>(b + a);
+    }
+    return a | (static_cast<uint32_t>(b) << 8);
+}
+
+static inline bool isSyncByte(uint8_t c)
+{
+    return c == BRIDGE_ISB_PREAMBLE0 || c == BRIDGE_NMEA_START_BYTE || c == BRIDGE_RTCM3_PREAMBLE || c == BRIDGE_UBX_PREAMBLE0;
+}
+
+cISBridgePacketFramer::cISBridgePacketFramer(sISBridgeFramerCounters* counters)
+    : m_counters(counters)
+{
+    m_pending.reserve(kMaxFrameSize);
+}
+
+size_t cISBridgePacketFramer::FindSync(const uint8_t* data, size_t size)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i isb = _mm_set1_epi8(static_cast<char>(BRIDGE_ISB_PREAMBLE0));
+    const __m128i nmea = _mm_set1_epi8(static_cast<char>(BRIDGE_NMEA_START_BYTE));
+    const __m128i rtcm = _mm_set1_epi8(static_cast<char>(BRIDGE_RTCM3_PREAMBLE));
+    const __m128i ubx = _mm_set1_epi8(static_cast<char>(BRIDGE_UBX_PREAMBLE0));
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, isb), _mm_cmpeq_epi8(v, nmea)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, rtcm), _mm_cmpeq_epi8(v, ubx)));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+        {
+            return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t isb = vdupq_n_u8(BRIDGE_ISB_PREAMBLE0);
+    const uint8x16_t nmea = vdupq_n_u8(BRIDGE_NMEA_START_BYTE);
+    const uint8x16_t rtcm = vdupq_n_u8(BRIDGE_RTCM3_PREAMBLE);
+    const uint8x16_t ubx = vdupq_n_u8(BRIDGE_UBX_PREAMBLE0);
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(data + i);
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, isb), vceqq_u8(v, nmea)), vorrq_u8(vceqq_u8(v, rtcm), vceqq_u8(v, ubx)));
+        if (vmaxvq_u8(hit) != 0)
+        {
+            // Narrow each byte lane to a nibble to get a 64-bit mask, 4 bits per byte
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+            return i + static_cast<size_t>(std::countr_zero(mask) >> 2);
+        }
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        if (isSyncByte(data[i]))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+int cISBridgePacketFramer::ParseFrame(const uint8_t* data, size_t size, sISBridgePacket& packet, sISBridgeFramerCounters* counters, size_t* frameLength)
+{
+    sRunningChecksum running;
+    return ParseFrame(data, size, packet, counters, frameLength, running);
+}
+
+int cISBridgePacketFramer::ParseFrame(const uint8_t* data, size_t size, sISBridgePacket& packet, sISBridgeFramerCounters* counters, size_t* frameLength, sRunningChecksum& running)
+{
+    if (frameLength)
+    {
+        *frameLength = 0;
+    }
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    size_t total = 0;
+    packet.type = 0;
+    packet.id = 0;
+    packet.data = data;
+
+    switch (data[0])
+    {
+    case BRIDGE_ISB_PREAMBLE0:
+    {
+        if (size >= 2 && data[1] != BRIDGE_ISB_PREAMBLE1)
+        {
+            return -1;
+        }
+        if (size < BRIDGE_ISB_HEADER_SIZE)
+        {
+            return 0;
+        }
+        size_t payloadSize = data[4] | (static_cast<size_t>(data[5]) << 8);
+        total = BRIDGE_ISB_HEADER_SIZE + payloadSize + 2;
+        if (total > kMaxFrameSize)
+        {
+            if (counters)
+            {
+                counters->oversizeFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+            return -1;
+        }
+        if (frameLength)
+        {
+            *frameLength = total;
+        }
+
+        // Fletcher-16 over header and payload, stored little endian
+        size_t end = std::min(size, total - 2);
+        if (running.covered < end)
+        {
+            running.sum = fletcher8(running.sum, data + running.covered, end - running.covered);
+            running.covered = end;
+        }
+        if (size < total)
+        {
+            return 0;
+        }
+        if (data[total - 2] != (running.sum & 0xFF) || data[total - 1] != (running.sum >> 8))
+        {
+            break;
+        }
+        packet.protocol = BRIDGE_PROTOCOL_ISB;
+        packet.type = data[2] & BRIDGE_ISB_PKT_TYPE_MASK;
+        packet.id = data[3];
+        packet.size = total;
+        return static_cast<int>(total);
+    }
+
+    case BRIDGE_UBX_PREAMBLE0:
+    {
+        if (size >= 2 && data[1] != BRIDGE_UBX_PREAMBLE1)
+        {
+            return -1;
+        }
+        if (size < 6)
+        {
+            return 0;
+        }
+        size_t payloadSize = data[4] | (static_cast<size_t>(data[5]) << 8);
+        total = 6 + payloadSize + 2;
+        if (total > kMaxFrameSize)
+        {
+            if (counters)
+            {
+                counters->oversizeFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+            return -1;
+        }
+        if (frameLength)
+        {
+            *frameLength = total;
+        }
+
+        // 8-bit Fletcher over class, id, length and payload
+        size_t start = std::max<size_t>(running.covered, 2);
+        size_t end = std::min(size, total - 2);
+        if (start < end)
+        {
+            running.sum = fletcher8(running.sum, data + start, end - start);
+            running.covered = end;
+        }
+        if (size < total)
+        {
+            return 0;
+        }
+        if (data[total - 2] != (running.sum & 0xFF) || data[total - 1] != (running.sum >> 8))
+        {
+            break;
+        }
+        packet.protocol = BRIDGE_PROTOCOL_UBX;
+        packet.id = static_cast<uint16_t>((data[2] << 8) | data[3]);
+        packet.size = total;
+        return static_cast<int>(total);
+    }
+
+    case BRIDGE_RTCM3_PREAMBLE:
+    {
+        if (size >= 2 && (data[1] & 0xFC) != 0)
+        {
+            return -1;  // Reserved bits must be zero
+        }
+        if (size < 3)
+        {
+            return 0;
+        }
+        size_t payloadSize = ((data[1] & 0x03) << 8) | data[2];
+        total = 3 + payloadSize + 3;
+        if (frameLength)
+        {
+            *frameLength = total;
+        }
+
+        size_t end = std::min(size, total - 3);
+        if (running.covered < end)
+        {
+            running.sum = crc24q(running.sum, data + running.covered, end - running.covered);
+            running.covered = end;
+        }
+        if (size < total)
+        {
+            return 0;
+        }
+
+        uint32_t crc = (static_cast<uint32_t>(data[total - 3]) << 16) | (static_cast<uint32_t>(data[total - 2]) << 8) | data[total - 1];
+        if (running.sum != crc)
+        {
+            break;
+        }
+        packet.protocol = BRIDGE_PROTOCOL_RTCM3;
+        if (payloadSize >= 2)
+        {
+            packet.id = static_cast<uint16_t>((data[3] << 4) | (data[4] >> 4));
+        }
+        packet.size = total;
+        return static_cast<int>(total);
+    }
+
+    case BRIDGE_NMEA_START_BYTE:
+    {
+        // "$" + talker/sentence (printable ASCII) [+ "*HH"] + "\r\n"
+        if (size >= 2 && !((data[1] >= 'A' && data[1] <= 'Z') || (data[1] >= '0' && data[1] <= '9')))
+        {
+            return -1;
+        }
+        // Resume after the characters already checked
+        size_t star = running.star;
+        uint8_t checksum = static_cast<uint8_t>(running.sum);
+        for (size_t i = std::max<size_t>(running.covered, 1); i < size; i++)
+        {
+            uint8_t c = data[i];
+            if (c == '\n')
+            {
+                total = i + 1;
+                break;
+            }
+            if (c == '\r')
+            {
+                continue;
+            }
+            if (c < 0x20 || c > 0x7E || i + 1 >= kMaxNmeaSize)
+            {
+                return -1;  // Binary data or runaway line: not a sentence
+            }
+            if (star == 0)
+            {
+                if (c == '*')
+                {
+                    star = i;
+                }
+                else
+                {
+                    checksum ^= c;
+                }
+            }
+        }
+        if (total == 0)
+        {
+            running.covered = size;
+            running.sum = checksum;
+            running.star = star;
+            return 0;
+        }
+
+        // Sentences without "*HH" carry nothing to validate
+        if (star != 0)
+        {
+            int hi = (star + 2 < total) ? hexValue(data[star + 1]) : -1;
+            int lo = (star + 2 < total) ? hexValue(data[star + 2]) : -1;
+            if (hi < 0 || lo < 0 || ((hi << 4) | lo) != checksum)
+            {
+                break;
+            }
+        }
+        packet.protocol = BRIDGE_PROTOCOL_NMEA;
+        packet.size = total;
+        return static_cast<int>(total);
+    }
+
+    default:
+        return -1;
+    }
+
+    // Complete frame with a bad checksum
+    if (counters)
+    {
+        counters->checksumErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    return -1;
+}
+
+void cISBridgePacketFramer::Feed(const uint8_t* data, size_t size, const packet_handler_t& handler)
+{
+    // Finish a frame left over from the previous chunk, taking only the bytes it needs
+    while (!m_pending.empty() && size > 0)
+    {
+        size_t taken = FillPending(data, size);
+        data += taken;
+        size -= taken;
+
+        sISBridgePacket packet;
+        int result = ParseFrame(m_pending.data(), m_pending.size(), packet, m_counters, NULL, m_checksum);
+        if (result > 0)
+        {
+            if (m_counters)
+            {
+                m_counters->packets[packet.protocol].fetch_add(1, std::memory_order_relaxed);
+            }
+            handler(packet);
+            m_pending.clear();
+        }
+        else if (result < 0)
+        {
+            // Not a frame after all: rescan what we held, one byte past its sync byte
+            std::vector<uint8_t> held(m_pending.begin() + 1, m_pending.end());
+            m_pending.clear();
+            Discard(1);
+            size_t tail = Scan(held.data(), held.size(), handler);
+            if (tail < held.size())
+            {
+                m_pending.assign(held.begin() + static_cast<std::ptrdiff_t>(tail), held.end());
+            }
+        }
+    }
+
+    if (size > 0)
+    {
+        size_t tail = Scan(data, size, handler);
+        if (tail < size)
+        {
+            m_pending.assign(data + tail, data + size);
+        }
+    }
+}
+
+size_t cISBridgePacketFramer::FillPending(const uint8_t* data, size_t size)
+{
+    size_t want;
+    if (m_pending[0] == BRIDGE_NMEA_START_BYTE)
+    {
+        // Up to and including the next newline
+        size_t limit = std::min(size, kMaxNmeaSize - std::min(kMaxNmeaSize - 1, m_pending.size()));
+        const void* newline = memchr(data, '\n', limit);
+        want = newline ? static_cast<size_t>(static_cast<const uint8_t*>(newline) - data) + 1 : limit;
+    }
+    else
+    {
+        sISBridgePacket packet;
+        size_t frameLength = 0;
+        ParseFrame(m_pending.data(), m_pending.size(), packet, NULL, &frameLength, m_checksum);
+        if (frameLength > m_pending.size())
+        {
+            want = frameLength - m_pending.size();
+        }
+        else
+        {
+            // Header not complete yet; every binary header fits in 6 bytes
+            want = (m_pending.size() < BRIDGE_ISB_HEADER_SIZE) ? BRIDGE_ISB_HEADER_SIZE - m_pending.size() : 1;
+        }
+    }
+
+    want = std::min(want, size);
+    m_pending.insert(m_pending.end(), data, data + want);
+    return want;
+}
+
+size_t cISBridgePacketFramer::Scan(const uint8_t* data, size_t size, const packet_handler_t& handler)
+{
+    size_t pos = 0;
+    while (pos < size)
+    {
+        size_t skip = FindSync(data + pos, size - pos);
+        Discard(skip);
+        pos += skip;
+        if (pos >= size)
+        {
+            break;
+        }
+
+        // A frame left incomplete here becomes m_pending with its checksum so far
+        sISBridgePacket packet;
+        m_checksum = sRunningChecksum();
+        int result = ParseFrame(data + pos, size - pos, packet, m_counters, NULL, m_checksum);
+        if (result > 0)
+        {
+            if (m_counters)
+            {
+                m_counters->packets[packet.protocol].fetch_add(1, std::memory_order_relaxed);
+            }
+            handler(packet);
+            pos += static_cast<size_t>(result);
+        }
+        else if (result == 0)
+        {
+            return pos;     // Frame continues in the next chunk
+        }
+        else
+        {
+            Discard(1);
+            pos++;
+        }
+    }
+    return size;
+}
+
+void cISBridgePacketFramer::Discard(size_t bytes)
+{
+    if (m_counters && bytes > 0)
+    {
+        m_counters->discardedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
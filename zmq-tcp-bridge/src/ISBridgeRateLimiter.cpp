@@ -0,0 +1,67 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeRateLimiter.h"
+#include "ISBridgePacketFramer.h"
+
+cISBridgeRateLimiter::cISBridgeRateLimiter()
+    : m_active(false)
+    , m_suppressed(0)
+{
+    SetLimits(sISBridgeRateLimits());
+}
+
+void cISBridgeRateLimiter::SetLimits(const sISBridgeRateLimits& limits)
+{
+    m_active = false;
+    for (int i = 0; i < sISBridgeRateLimits::kDidCount; i++)
+    {
+        m_intervalNs[i] = (limits.maxHz[i] > 0.0f) ? static_cast<uint64_t>(1e9 / limits.maxHz[i]) : 0;
+        m_nextNs[i] = 0;
+        m_active = m_active || m_intervalNs[i] != 0;
+    }
+}
+
+bool cISBridgeRateLimiter::Accept(const cISBridgeBuffer& buffer, uint64_t nowNs)
+{
+    if (!m_active ||
+        buffer.Protocol() != BRIDGE_PROTOCOL_ISB ||
+        buffer.PacketType() != BRIDGE_ISB_PKT_TYPE_DATA)
+    {
+        return true;
+    }
+
+    uint8_t did = static_cast<uint8_t>(buffer.PacketId());
+    uint64_t interval = m_intervalNs[did];
+    if (interval == 0)
+    {
+        return true;
+    }
+
+    uint64_t t = (buffer.Timestamp() != 0) ? buffer.Timestamp() : nowNs;
+    uint64_t& next = m_nextNs[did];
+    if (t + interval / 4 < next)
+    {
+        m_suppressed++;
+        return false;
+    }
+
+    // Keep the cadence, but start over after a gap (or the first packet) instead of
+    // letting a burst catch up
+    next += interval;
+    if (next <= t)
+    {
+        next = t + interval;
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeRecordRing.h"
+
+#include <string.h>
+
+cISBridgeRecordRing::cISBridgeRecordRing(size_t capacity)
+    : m_capacity(64)
+    , m_tail(0)
+    , m_cachedHead(0)
+    , m_head(0)
+    , m_cachedTail(0)
+    , m_peekSize(0)
+{
+    while (m_capacity < capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_data.reset(new uint8_t[m_capacity]);
+}
+
+bool cISBridgeRecordRing::Write(const void* first, size_t firstSize, const void* second, size_t secondSize)
+{
+    size_t size = firstSize + secondSize;
+    if (size > MaxRecordSize())
+    {
+        return false;
+    }
+
+    size_t needed = kPrefixSize + Align(size);
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t offset = static_cast<size_t>(tail & m_mask);
+    size_t untilEnd = m_capacity - offset;
+    size_t wrap = (needed > untilEnd) ? untilEnd : 0;
+
+    if (tail + wrap + needed - m_cachedHead > m_capacity)
+    {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        if (tail + wrap + needed - m_cachedHead > m_capacity)
+        {
+            return false;
+        }
+    }
+
+    if (wrap)
+    {
+        // Not enough room before the end: mark the rest as skipped and start over
+        uint32_t marker = kWrapMarker;
+        memcpy(&m_data[offset], &marker, sizeof(marker));
+        tail += wrap;
+        offset = 0;
+    }
+
+    uint32_t length = static_cast<uint32_t>(size);
+    memcpy(&m_data[offset], &length, sizeof(length));
+    memcpy(&m_data[offset + kPrefixSize], first, firstSize);
+    if (secondSize)
+    {
+        memcpy(&m_data[offset + kPrefixSize + firstSize], second, secondSize);
+    }
+    m_tail.store(tail + needed, std::memory_order_release);
+    return true;
+}
+
+const uint8_t* cISBridgeRecordRing::Peek(size_t& size)
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail)
+    {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head == m_cachedTail)
+        {
+            return NULL;
+        }
+    }
+
+    size_t offset = static_cast<size_t>(head & m_mask);
+    uint32_t length;
+    memcpy(&length, &m_data[offset], sizeof(length));
+    if (length == kWrapMarker)
+    {
+        // Skip the unused end of the ring; the record continues at the start
+        size_t skipped = m_capacity - offset;
+        head += skipped;
+        m_head.store(head, std::memory_order_release);
+        offset = 0;
+        memcpy(&length, &m_data[0], sizeof(length));
+    }
+
+    size = length;
+    m_peekSize = kPrefixSize + Align(length);
+    return &m_data[offset + kPrefixSize];
+}
+
+void cISBridgeRecordRing::Pop()
+{
+    if (m_peekSize)
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + m_peekSize, std::memory_order_release);
+        m_peekSize = 0;
+    }
+}
@@ -0,0 +1,186 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeReorderBuffer.h"
+#include "ISBridgeMetrics.h"
+
+#include <algorithm>
+
+cISBridgeReorderBuffer::cISBridgeReorderBuffer()
+    : m_sourceCount(0)
+    , m_windowNs(0)
+    , m_capacity(1)
+    , m_arrivalHead(0)
+    , m_arrivalCount(0)
+    , m_seq(0)
+    , m_releasedNs(0)
+    , m_deadlineNs(0)
+    , m_held(0)
+    , m_watermarkReleases(0)
+    , m_deadlineReleases(0)
+{
+}
+
+void cISBridgeReorderBuffer::Configure(int sourceCount, uint64_t windowNs, size_t capacity)
+{
+    m_sourceCount = std::max(0, sourceCount);
+    m_windowNs = windowNs;
+    m_capacity = std::max<size_t>(1, capacity);
+    m_sources.reset(new sSource[m_sourceCount]);
+    m_heap.clear();
+    m_heap.reserve(m_capacity);
+    m_arrivals.assign(m_capacity, sArrival());
+    Clear();
+    m_watermarkReleases = 0;
+    m_deadlineReleases = 0;
+}
+
+void cISBridgeReorderBuffer::Push(int source, uint64_t publisherNs, uint64_t arrivalNs, const cISBridgeBufferRef& buffer, const release_handler_t& handler)
+{
+    if (source < 0 || source >= m_sourceCount)
+    {
+        cISBridgeBufferRef pass = buffer;
+        handler(pass);
+        return;
+    }
+
+    sSource& s = m_sources[source];
+    bridgeCounterAdd(s.messages, 1);
+    if (publisherNs > s.watermarkNs.load(std::memory_order_relaxed))
+    {
+        s.watermarkNs.store(publisherNs, std::memory_order_relaxed);
+    }
+
+    if (m_heap.size() >= m_capacity)
+    {
+        ReleaseTop(handler, true);
+    }
+    if (publisherNs < m_releasedNs)
+    {
+        bridgeCounterAdd(s.lateMessages, 1);
+        cISBridgeBufferRef pass = buffer;
+        handler(pass);
+        return;
+    }
+
+    if (m_arrivalCount == m_arrivals.size())
+    {
+        // More arrivals within a window than packets can be held: expire the oldest early
+        m_deadlineNs = std::max(m_deadlineNs, m_arrivals[m_arrivalHead].publisherNs);
+        m_arrivalHead = (m_arrivalHead + 1) % m_arrivals.size();
+        m_arrivalCount--;
+    }
+    m_arrivals[(m_arrivalHead + m_arrivalCount) % m_arrivals.size()] = { arrivalNs, publisherNs };
+    m_arrivalCount++;
+
+    m_heap.push_back({ publisherNs, m_seq++, buffer });
+    std::push_heap(m_heap.begin(), m_heap.end());
+    m_held.store(m_heap.size(), std::memory_order_relaxed);
+}
+
+int cISBridgeReorderBuffer::Release(uint64_t nowNs, const release_handler_t& handler)
+{
+    // A packet that has waited the whole window goes now, and so does everything older
+    while (m_arrivalCount > 0 && m_arrivals[m_arrivalHead].arrivalNs + m_windowNs <= nowNs)
+    {
+        m_deadlineNs = std::max(m_deadlineNs, m_arrivals[m_arrivalHead].publisherNs);
+        m_arrivalHead = (m_arrivalHead + 1) % m_arrivals.size();
+        m_arrivalCount--;
+    }
+
+    // Nothing older than the lowest watermark can still arrive. A source that has never
+    // sent does not count; one that stops sending leaves packets to the deadline.
+    uint64_t safeNs = UINT64_MAX;
+    for (int i = 0; i < m_sourceCount; i++)
+    {
+        uint64_t watermark = m_sources[i].watermarkNs.load(std::memory_order_relaxed);
+        if (watermark != 0)
+        {
+            safeNs = std::min(safeNs, watermark);
+        }
+    }
+
+    int released = 0;
+    while (!m_heap.empty())
+    {
+        uint64_t publisherNs = m_heap.front().publisherNs;
+        if (publisherNs <= safeNs)
+        {
+            ReleaseTop(handler, false);
+        }
+        else if (publisherNs <= m_deadlineNs)
+        {
+            ReleaseTop(handler, true);
+        }
+        else
+        {
+            break;
+        }
+        released++;
+    }
+    return released;
+}
+
+void cISBridgeReorderBuffer::ReleaseTop(const release_handler_t& handler, bool byDeadline)
+{
+    std::pop_heap(m_heap.begin(), m_heap.end());
+    cISBridgeBufferRef buffer = std::move(m_heap.back().buffer);
+    m_releasedNs = std::max(m_releasedNs, m_heap.back().publisherNs);
+    m_heap.pop_back();
+    m_held.store(m_heap.size(), std::memory_order_relaxed);
+    bridgeCounterAdd(byDeadline ? m_deadlineReleases : m_watermarkReleases, 1);
+    handler(buffer);
+}
+
+void cISBridgeReorderBuffer::Clear()
+{
+    m_heap.clear();
+    m_arrivalHead = 0;
+    m_arrivalCount = 0;
+    m_seq = 0;
+    m_releasedNs = 0;
+    m_deadlineNs = 0;
+    m_held = 0;
+}
+
+uint64_t cISBridgeReorderBuffer::NextDeadlineNs() const
+{
+    if (m_heap.empty())
+    {
+        return 0;
+    }
+    // Held packets without an arrival entry were expired early and are already due
+    return (m_arrivalCount > 0) ? m_arrivals[m_arrivalHead].arrivalNs + m_windowNs : 1;
+}
+
+sISBridgeReorderStats cISBridgeReorderBuffer::GetStats() const
+{
+    sISBridgeReorderStats stats;
+    stats.held = m_held.load(std::memory_order_relaxed);
+    stats.watermarkReleases = m_watermarkReleases.load(std::memory_order_relaxed);
+    stats.deadlineReleases = m_deadlineReleases.load(std::memory_order_relaxed);
+    return stats;
+}
+
+sISBridgeReorderSourceStats cISBridgeReorderBuffer::GetSourceStats(int source) const
+{
+    sISBridgeReorderSourceStats stats;
+    if (source >= 0 && source < m_sourceCount)
+    {
+        const sSource& s = m_sources[source];
+        stats.messages = s.messages.load(std::memory_order_relaxed);
+        stats.watermarkNs = s.watermarkNs.load(std::memory_order_relaxed);
+        stats.lateMessages = s.lateMessages.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
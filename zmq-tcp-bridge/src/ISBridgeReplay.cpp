@@ -0,0 +1,263 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeReplay.h"
+#include "ISBridgeMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <errno.h>
+#include <string.h>
+
+static const int kWaitSleepMs = 1;          // Poll interval while clients connect or catch up
+static const uint64_t kMaxSleepNs = 100000000;  // Longest single pacing sleep, keeps Stop() responsive
+
+cISBridgeReplay::cISBridgeReplay()
+    : m_running(false)
+    , m_finished(false)
+    , m_recordsSent(0)
+    , m_bytesSent(0)
+{
+}
+
+cISBridgeReplay::~cISBridgeReplay()
+{
+    Stop();
+}
+
+int cISBridgeReplay::Start(const std::string& capturePath, int tcpPort)
+{
+    if (m_replayThread)
+    {
+        std::cerr << "Replay is already running" << std::endl;
+        return -1;
+    }
+
+    if (m_reader.Open(capturePath) != 0)
+    {
+        return -1;
+    }
+
+    m_pool = std::make_unique<cISBridgeBufferPool>(0, m_options.clientQueue.maxMessages);
+    m_tcpReactor = std::make_unique<cISBridgeTcpReactor>();
+    m_tcpReactor->SetClientQueueLimits(m_options.clientQueue);
+    if (m_tcpReactor->Open("", tcpPort) != 0)
+    {
+        std::cerr << "Failed to open TCP server on port " << tcpPort << std::endl;
+        m_tcpReactor.reset();
+        m_pool.reset();
+        m_reader.Close();
+        return -1;
+    }
+
+    m_batch.reserve(kMaxBatch);
+    m_recordsSent = 0;
+    m_bytesSent = 0;
+    m_finished = false;
+    m_running = true;
+    m_reactorThread = std::make_unique<std::thread>(&cISBridgeReplay::ReactorThread, this);
+    m_replayThread = std::make_unique<std::thread>(&cISBridgeReplay::ReplayThread, this);
+
+    std::cout << "Replaying " << capturePath << " on TCP port " << m_tcpReactor->Port() << " at ";
+    if (m_options.speed > 0)
+    {
+        std::cout << m_options.speed << "x";
+    }
+    else
+    {
+        std::cout << "max";
+    }
+    std::cout << " speed" << std::endl;
+    return 0;
+}
+
+int cISBridgeReplay::Stop()
+{
+    if (!m_replayThread)
+    {
+        return 0;
+    }
+
+    m_running = false;
+    m_tcpReactor->Wakeup();
+    if (m_replayThread->joinable())
+    {
+        m_replayThread->join();
+    }
+    if (m_reactorThread->joinable())
+    {
+        m_reactorThread->join();
+    }
+    m_replayThread.reset();
+    m_reactorThread.reset();
+
+    // Client queues reference the mapped capture; close them before unmapping
+    m_batch.clear();
+    m_tcpReactor->Close();
+    m_tcpReactor.reset();
+    m_pool.reset();
+    m_reader.Close();
+    return 0;
+}
+
+std::string cISBridgeReplay::GetStatus()
+{
+    std::ostringstream status;
+    status << (m_finished ? "Finished: " : (m_running ? "Replaying: " : "Stopped: "))
+           << m_recordsSent.load() << " records, " << m_bytesSent.load() << " bytes, "
+           << (m_tcpReactor ? m_tcpReactor->ClientCount() : 0) << " clients";
+    return status.str();
+}
+
+void cISBridgeReplay::ReactorThread()
+{
+    while (m_running)
+    {
+        if (m_tcpReactor->Run(-1) < 0)
+        {
+            std::cerr << "TCP reactor error: " << strerror(errno) << std::endl;
+            break;
+        }
+    }
+}
+
+bool cISBridgeReplay::NextRecord(sISBridgeCaptureRecord& record)
+{
+    // Only the ZMQ → TCP side reaches clients; client traffic and connection events
+    // are kept in the capture for analysis
+    while (m_reader.Next(record))
+    {
+        if (record.direction == BRIDGE_CAPTURE_ZMQ_TO_TCP && record.size > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void cISBridgeReplay::ReplayThread()
+{
+    while (m_running && m_tcpReactor->ClientCount() < m_options.waitClients)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWaitSleepMs));
+    }
+
+    sISBridgeCaptureRecord record;
+    bool pending = NextRecord(record);
+    const uint64_t firstTimestampNs = pending ? record.timestampNs : 0;
+    uint64_t startNs = bridgeClockNs();
+
+    // A batch never exceeds what an empty client queue holds, so nothing is dropped
+    const sISBridgeSendQueueLimits& limits = m_options.clientQueue;
+    const size_t maxBatch = std::min(static_cast<size_t>(kMaxBatch), std::max<size_t>(1, limits.maxMessages));
+
+    while (m_running && pending)
+    {
+        size_t bytes = 0;
+        uint64_t nowNs = bridgeClockNs();
+        while (pending && m_batch.size() < maxBatch && (m_batch.empty() || bytes + record.size <= limits.maxBytes))
+        {
+            if (m_options.speed > 0)
+            {
+                uint64_t dueNs = startNs + static_cast<uint64_t>(static_cast<double>(record.timestampNs - firstTimestampNs) / m_options.speed);
+                if (dueNs > nowNs)
+                {
+                    if (!m_batch.empty())
+                    {
+                        break;      // Send what is due, then wait
+                    }
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(dueNs - nowNs, kMaxSleepNs)));
+                    if (!m_running)
+                    {
+                        break;
+                    }
+                    nowNs = bridgeClockNs();
+                    continue;
+                }
+            }
+
+            cISBridgeBufferRef buffer = m_pool->Acquire(0);
+            if (!buffer)
+            {
+                break;
+            }
+            buffer->SetExternal(const_cast<uint8_t*>(record.data), record.size);
+            buffer->SetTimestamp(nowNs);
+            bytes += record.size;
+            m_batch.push_back(std::move(buffer));
+            pending = NextRecord(record);
+        }
+
+        if (m_batch.empty())
+        {
+            continue;
+        }
+
+        // Shift the clock by any wait so later records keep their recorded spacing
+        startNs += WaitForRoom(m_batch.size(), bytes);
+        m_tcpReactor->Broadcast(m_batch.data(), static_cast<int>(m_batch.size()));
+        bridgeCounterAdd(m_recordsSent, m_batch.size());
+        bridgeCounterAdd(m_bytesSent, bytes);
+        m_batch.clear();
+    }
+
+    WaitForDrain();
+    m_finished = true;
+}
+
+uint64_t cISBridgeReplay::WaitForRoom(size_t messages, size_t bytes)
+{
+    const sISBridgeSendQueueLimits& limits = m_options.clientQueue;
+    uint64_t startNs = bridgeClockNs();
+    while (m_running)
+    {
+        m_tcpReactor->GetClientStats(m_clientStats);
+        bool room = true;
+        for (const sISBridgeTcpClientStats& client : m_clientStats)
+        {
+            // An empty queue always takes the batch, however large
+            if (client.queue.queuedMessages > 0 &&
+                (client.queue.queuedMessages + messages > limits.maxMessages || client.queue.queuedBytes + bytes > limits.maxBytes))
+            {
+                room = false;
+                break;
+            }
+        }
+        if (room)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWaitSleepMs));
+    }
+    return bridgeClockNs() - startNs;
+}
+
+void cISBridgeReplay::WaitForDrain()
+{
+    while (m_running)
+    {
+        m_tcpReactor->GetClientStats(m_clientStats);
+        bool drained = true;
+        for (const sISBridgeTcpClientStats& client : m_clientStats)
+        {
+            drained = drained && client.queue.queuedMessages == 0;
+        }
+        if (drained)
+        {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWaitSleepMs));
+    }
+}
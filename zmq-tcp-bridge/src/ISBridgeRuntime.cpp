@@ -0,0 +1,89 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeRuntime.h"
+
+#include <iostream>
+#include <errno.h>
+#include <string.h>
+#include "ISBridgeSocket.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+int bridgeApplyThreadProfile(const sISBridgeThreadProfile& profile, const char* name)
+{
+    int result = 0;
+
+#if defined(__linux__)
+    if (name)
+    {
+        char shortName[16];
+        strncpy(shortName, name, sizeof(shortName) - 1);
+        shortName[sizeof(shortName) - 1] = '\0';
+        pthread_setname_np(pthread_self(), shortName);
+    }
+
+    if (profile.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(profile.cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0)
+        {
+            std::cerr << "Failed to pin " << (name ? name : "thread") << " to CPU " << profile.cpu << ": " << strerror(err) << std::endl;
+            result = -1;
+        }
+    }
+
+    if (profile.fifoPriority > 0)
+    {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = profile.fifoPriority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0)
+        {
+            std::cerr << "Failed to set SCHED_FIFO priority " << profile.fifoPriority << " for " << (name ? name : "thread") << ": " << strerror(err) << std::endl;
+            result = -1;
+        }
+    }
+#else
+    (void)name;
+    if (profile.cpu >= 0 || profile.fifoPriority > 0)
+    {
+        std::cerr << "CPU pinning and SCHED_FIFO are only supported on Linux" << std::endl;
+        result = -1;
+    }
+#endif
+
+    return result;
+}
+
+int bridgeSetBusyPoll(int fd, int usec)
+{
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) != 0)
+    {
+        return -1;
+    }
+    return 0;
+#else
+    (void)fd;
+    (void)usec;
+    return -1;
+#endif
+}
@@ -0,0 +1,219 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeSendQueue.h"
+#include "ISBridgePacketFramer.h"
+
+#include <algorithm>
+
+cISBridgeSendQueue::cISBridgeSendQueue()
+    : m_head(0)
+    , m_count(0)
+    , m_headOffset(0)
+    , m_pinned(0)
+{
+    std::fill(m_didSlot, m_didSlot + 256, SIZE_MAX);
+    SetLimits(sISBridgeSendQueueLimits());
+}
+
+void cISBridgeSendQueue::SetLimits(const sISBridgeSendQueueLimits& limits)
+{
+    Clear();
+    m_limits = limits;
+    m_limits.maxMessages = std::max<size_t>(1, m_limits.maxMessages);
+    m_ring.clear();
+    m_ring.resize(m_limits.maxMessages);
+    m_head = 0;
+}
+
+bool cISBridgeSendQueue::Push(const cISBridgeBufferRef& buffer)
+{
+    if (!buffer || buffer->Size() == 0)
+    {
+        return true;
+    }
+
+    bool isData = buffer->Protocol() == BRIDGE_PROTOCOL_ISB && buffer->PacketType() == BRIDGE_ISB_PKT_TYPE_DATA;
+    if (isData && m_limits.conflate && Conflate(buffer))
+    {
+        return true;
+    }
+
+    size_t size = buffer->Size();
+    if (!Fits(size))
+    {
+        switch (m_limits.dropPolicy)
+        {
+        case BRIDGE_DROP_DISCONNECT:
+            return false;
+
+        case BRIDGE_DROP_OLDEST:
+            while (!Fits(size) && DropOldest())
+            {
+            }
+            break;
+
+        case BRIDGE_DROP_NEWEST:
+            break;
+        }
+
+        if (!Fits(size))
+        {
+            // Newest-drop policy, or nothing droppable is left (only pinned or partially written messages)
+            m_stats.droppedMessages++;
+            m_stats.droppedBytes += size;
+            return true;
+        }
+    }
+
+    if (isData)
+    {
+        m_didSlot[buffer->PacketId() & 0xFF] = Index(m_count);
+    }
+    m_ring[Index(m_count)] = buffer;
+    m_count++;
+    m_stats.queuedMessages = m_count;
+    m_stats.queuedBytes += size;
+    m_stats.highWatermarkBytes = std::max(m_stats.highWatermarkBytes, m_stats.queuedBytes);
+    m_stats.highWatermarkMessages = std::max(m_stats.highWatermarkMessages, m_count);
+    return true;
+}
+
+bool cISBridgeSendQueue::DropOldest()
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+
+    // A partially written head and pinned messages are on their way to the wire and must
+    // finish; drop the first message behind them by sliding them forward into its slot.
+    size_t keep = std::max(m_pinned, static_cast<size_t>(m_headOffset != 0 ? 1 : 0));
+    if (m_count <= keep)
+    {
+        return false;
+    }
+    size_t size = m_ring[Index(keep)]->Size();
+    m_ring[Index(keep)].Reset();
+    for (size_t i = keep; i > 0; i--)
+    {
+        m_ring[Index(i)] = std::move(m_ring[Index(i - 1)]);
+    }
+    m_head = Index(1);
+    m_count--;
+    m_stats.droppedMessages++;
+    m_stats.droppedBytes += size;
+    m_stats.queuedBytes -= size;
+    m_stats.queuedMessages = m_count;
+    return true;
+}
+
+bool cISBridgeSendQueue::Conflate(const cISBridgeBufferRef& buffer)
+{
+    uint8_t did = static_cast<uint8_t>(buffer->PacketId());
+    size_t slot = m_didSlot[did];
+    if (slot >= m_ring.size())
+    {
+        return false;
+    }
+
+    // The slot may since have been written, dropped or reused; only replace a packet of
+    // this ID that is still queued behind anything being written
+    size_t position = (slot + m_ring.size() - m_head) % m_ring.size();
+    size_t keep = std::max(m_pinned, static_cast<size_t>(m_headOffset != 0 ? 1 : 0));
+    if (position >= m_count || position < keep)
+    {
+        return false;
+    }
+    cISBridgeBufferRef& queued = m_ring[slot];
+    if (queued->Protocol() != BRIDGE_PROTOCOL_ISB ||
+        queued->PacketType() != BRIDGE_ISB_PKT_TYPE_DATA ||
+        queued->PacketId() != buffer->PacketId())
+    {
+        return false;
+    }
+    size_t bytes = m_stats.queuedBytes - queued->Size() + buffer->Size();
+    if (bytes > m_limits.maxBytes)
+    {
+        return false;
+    }
+
+    m_stats.queuedBytes = bytes;
+    m_stats.highWatermarkBytes = std::max(m_stats.highWatermarkBytes, bytes);
+    m_stats.conflatedMessages++;
+    queued = buffer;
+    return true;
+}
+
+int cISBridgeSendQueue::Peek(iovec* iov, int maxIov) const
+{
+    int n = 0;
+    for (size_t i = 0; i < m_count && n < maxIov; i++, n++)
+    {
+        const cISBridgeBufferRef& buffer = m_ring[Index(i)];
+        size_t offset = (i == 0) ? m_headOffset : 0;
+        iov[n].iov_base = const_cast<uint8_t*>(buffer->Data()) + offset;
+        iov[n].iov_len = buffer->Size() - offset;
+    }
+    return n;
+}
+
+size_t cISBridgeSendQueue::Consume(size_t bytes, cISBridgeHistogram* latency, uint64_t nowNs, cISBridgeTraceRing* trace)
+{
+    m_stats.queuedBytes -= std::min(bytes, m_stats.queuedBytes);
+    m_stats.sentBytes += bytes;
+    size_t completed = 0;
+    while (bytes > 0 && m_count > 0)
+    {
+        cISBridgeBufferRef& head = m_ring[m_head];
+        size_t remaining = head->Size() - m_headOffset;
+        if (bytes < remaining)
+        {
+            m_headOffset += bytes;
+            break;
+        }
+        bytes -= remaining;
+        if (latency && head->Timestamp() != 0 && nowNs > head->Timestamp())
+        {
+            latency->Record(nowNs - head->Timestamp());
+        }
+        if (trace && head->TraceId() != 0)
+        {
+            trace->Stamp(head->TraceId(), BRIDGE_TRACE_TCP_FIRST_WRITE, nowNs);
+            trace->Stamp(head->TraceId(), BRIDGE_TRACE_TCP_LAST_WRITE, nowNs);
+        }
+        head.Reset();
+        m_headOffset = 0;
+        m_head = Index(1);
+        m_count--;
+        m_stats.queuedMessages = m_count;
+        completed++;
+    }
+    m_stats.sentMessages += completed;
+    m_pinned -= std::min(completed, m_pinned);
+    return completed;
+}
+
+void cISBridgeSendQueue::Clear()
+{
+    for (size_t i = 0; i < m_count; i++)
+    {
+        m_ring[Index(i)].Reset();
+    }
+    m_head = 0;
+    m_count = 0;
+    m_headOffset = 0;
+    m_pinned = 0;
+    m_stats.queuedMessages = 0;
+    m_stats.queuedBytes = 0;
+}
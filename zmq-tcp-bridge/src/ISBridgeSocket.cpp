@@ -0,0 +1,172 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeSocket.h"
+
+#include <errno.h>
+
+#if defined(_WIN32)
+
+#include <mutex>
+
+int bridgeSocketStartup()
+{
+    static std::once_flag once;
+    static int result = -1;
+    std::call_once(once, []()
+    {
+        WSADATA data;
+        result = (WSAStartup(MAKEWORD(2, 2), &data) == 0) ? 0 : -1;
+    });
+    return result;
+}
+
+int bridgeSocketClose(is_socket_t socket)
+{
+    return closesocket(socket);
+}
+
+int bridgeSocketSetNonBlocking(is_socket_t socket, bool nonBlocking)
+{
+    u_long mode = nonBlocking ? 1 : 0;
+    return (ioctlsocket(socket, FIONBIO, &mode) == 0) ? 0 : -1;
+}
+
+void bridgeSocketSetCloseOnExec(is_socket_t socket)
+{
+    (void)socket;
+}
+
+ssize_t bridgeSocketSendmsg(is_socket_t socket, const msghdr* msg, int flags)
+{
+    WSABUF buffers[64];
+    DWORD count = static_cast<DWORD>(msg->msg_iovlen < 64 ? msg->msg_iovlen : 64);
+    for (DWORD i = 0; i < count; i++)
+    {
+        buffers[i].buf = static_cast<CHAR*>(msg->msg_iov[i].iov_base);
+        buffers[i].len = static_cast<ULONG>(msg->msg_iov[i].iov_len);
+    }
+    DWORD sent = 0;
+    if (WSASend(socket, buffers, count, &sent, static_cast<DWORD>(flags), NULL, NULL) != 0)
+    {
+        return -1;
+    }
+    return static_cast<ssize_t>(sent);
+}
+
+ssize_t bridgeSocketRecv(is_socket_t socket, void* data, size_t size, int flags)
+{
+    return recv(socket, static_cast<char*>(data), static_cast<int>(size), flags);
+}
+
+int bridgeSocketPoll(pollfd* fds, size_t count, int timeoutMs)
+{
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+
+int bridgeSocketError()
+{
+    return WSAGetLastError();
+}
+
+bool bridgeSocketWouldBlock(int error)
+{
+    return error == WSAEWOULDBLOCK;
+}
+
+bool bridgeSocketInterrupted(int error)
+{
+    return error == WSAEINTR;
+}
+
+bool bridgeSocketAcceptAborted(int error)
+{
+    return error == WSAECONNRESET;
+}
+
+bool bridgeSocketOutOfDescriptors(int error)
+{
+    return error == WSAEMFILE;
+}
+
+#else
+
+#include <fcntl.h>
+#include <unistd.h>
+
+int bridgeSocketStartup()
+{
+    return 0;
+}
+
+int bridgeSocketClose(is_socket_t socket)
+{
+    return close(socket);
+}
+
+int bridgeSocketSetNonBlocking(is_socket_t socket, bool nonBlocking)
+{
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags < 0)
+    {
+        return -1;
+    }
+    return fcntl(socket, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+void bridgeSocketSetCloseOnExec(is_socket_t socket)
+{
+    fcntl(socket, F_SETFD, FD_CLOEXEC);
+}
+
+ssize_t bridgeSocketSendmsg(is_socket_t socket, const msghdr* msg, int flags)
+{
+    return sendmsg(socket, msg, flags);
+}
+
+ssize_t bridgeSocketRecv(is_socket_t socket, void* data, size_t size, int flags)
+{
+    return recv(socket, data, size, flags);
+}
+
+int bridgeSocketPoll(pollfd* fds, size_t count, int timeoutMs)
+{
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+
+int bridgeSocketError()
+{
+    return errno;
+}
+
+bool bridgeSocketWouldBlock(int error)
+{
+    return error == EAGAIN || error == EWOULDBLOCK;
+}
+
+bool bridgeSocketInterrupted(int error)
+{
+    return error == EINTR;
+}
+
+bool bridgeSocketAcceptAborted(int error)
+{
+    return error == ECONNABORTED || error == EPROTO;
+}
+
+bool bridgeSocketOutOfDescriptors(int error)
+{
+    return error == EMFILE || error == ENFILE;
+}
+
+#endif
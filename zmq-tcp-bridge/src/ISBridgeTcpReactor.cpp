@@ -0,0 +1,1574 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeTcpReactor.h"
+#include "ISBridgeRuntime.h"
+
+#include <chrono>
+#include <iostream>
+#include <errno.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
+// io_uring request kinds, stored in the top half of user_data above the socket
+enum eUringOp
+{
+    URING_ACCEPT = 1,
+    URING_RECV,
+    URING_SEND,
+    URING_WAKEUP,
+    URING_CANCEL,
+    URING_TX_TIMER,
+};
+
+static uint64_t uringUserData(eUringOp op, is_socket_t socket)
+{
+    return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(socket);
+}
+
+static const unsigned kUringEntries = 1024;
+static const int kUringCloseTimeoutMs = 1000;
+static const uint64_t kAcceptRetryNs = 10000000;
+
+
+static void setNoSigPipe(is_socket_t socket)
+{
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<const char*>(&one), sizeof(one));
+#else
+    (void)socket;
+#endif
+}
+
+cISBridgeTcpReactor::cISBridgeTcpReactor(iISBridgeTcpReactorDelegate* delegate)
+    : m_delegate(delegate)
+    , m_listenSocket(-1)
+    , m_pollFd(-1)
+    , m_reserveFd(-1)
+    , m_acceptRetryNs(0)
+    , m_backend(BRIDGE_TCP_BACKEND_EPOLL)
+    , m_uringPending(0)
+    , m_paused(false)
+    , m_busyPollUs(0)
+    , m_busyPollWarned(false)
+    , m_reusePort(false)
+    , m_trace(NULL)
+    , m_txTimer(-1)
+    , m_txTimerDueNs(0)
+{
+}
+
+cISBridgeTcpReactor::~cISBridgeTcpReactor()
+{
+    Close();
+}
+
+int cISBridgeTcpReactor::Open(const std::string& ipAddress, int port)
+{
+    Close();
+    if (bridgeSocketStartup() != 0)
+    {
+        return -1;
+    }
+
+    is_socket_t listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (!bridgeSocketValid(listenSocket))
+    {
+        return -1;
+    }
+    bridgeSocketSetCloseOnExec(listenSocket);
+
+    int one = 1;
+#if !defined(_WIN32)
+    // On Windows SO_REUSEADDR lets another process steal the port; the default already
+    // allows rebinding while old connections linger
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+#else
+    (void)one;
+#endif
+    if (m_reusePort)
+    {
+#if defined(SO_REUSEPORT)
+        if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&one), sizeof(one)) != 0)
+        {
+            std::cerr << "SO_REUSEPORT failed: " << strerror(errno) << std::endl;
+            bridgeSocketClose(listenSocket);
+            return -1;
+        }
+#else
+        std::cerr << "SO_REUSEPORT is not supported on this platform" << std::endl;
+        bridgeSocketClose(listenSocket);
+        return -1;
+#endif
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (ipAddress.empty())
+    {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    }
+    else if (inet_pton(AF_INET, ipAddress.c_str(), &addr.sin_addr) != 1)
+    {
+        bridgeSocketClose(listenSocket);
+        return -1;
+    }
+
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenSocket, SOMAXCONN) != 0)
+    {
+        bridgeSocketClose(listenSocket);
+        return -1;
+    }
+    return Attach(listenSocket);
+}
+
+int cISBridgeTcpReactor::Open(is_socket_t listenSocket)
+{
+    Close();
+    if (!bridgeSocketValid(listenSocket) || bridgeSocketStartup() != 0)
+    {
+        return -1;
+    }
+    bridgeSocketSetCloseOnExec(listenSocket);
+    return Attach(listenSocket);
+}
+
+int cISBridgeTcpReactor::Attach(is_socket_t listenSocket)
+{
+    m_listenSocket = listenSocket;
+    if (m_wakeup.Open() != 0 || bridgeSocketSetNonBlocking(m_listenSocket, true) != 0)
+    {
+        Close();
+        return -1;
+    }
+#if !defined(_WIN32)
+    m_reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+#endif
+
+    if (m_txOptions.adaptive)
+    {
+#if defined(__linux__)
+        m_txTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+        if (m_txTimer < 0)
+        {
+            std::cerr << "Adaptive transmit scheduling unavailable, writing immediately" << std::endl;
+            m_txOptions.adaptive = false;
+        }
+    }
+
+    if (m_backend == BRIDGE_TCP_BACKEND_IO_URING)
+    {
+        m_uring.reset(new cISBridgeUring());
+        if (m_uring->Open(kUringEntries, kUringReadBuffers, kReadBufferSize) != 0)
+        {
+            std::cerr << "io_uring unavailable (" << strerror(errno) << "), using epoll" << std::endl;
+            m_uring.reset();
+        }
+        else
+        {
+            // Both stay armed until Close()
+            if (m_uring->PrepAccept(m_listenSocket, uringUserData(URING_ACCEPT, m_listenSocket)) != 0 ||
+                m_uring->PrepPoll(m_wakeup.Fd(), uringUserData(URING_WAKEUP, m_wakeup.Fd())) != 0 ||
+                (m_txTimer >= 0 && m_uring->PrepPoll(m_txTimer, uringUserData(URING_TX_TIMER, m_txTimer)) != 0) ||
+                m_uring->Submit() < 0)
+            {
+                Close();
+                return -1;
+            }
+            m_uringPending = (m_txTimer >= 0) ? 3 : 2;
+            return 0;
+        }
+    }
+
+#if defined(__linux__)
+    m_pollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_pollFd < 0)
+    {
+        Close();
+        return -1;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = m_listenSocket;
+    if (epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_listenSocket, &ev) != 0)
+    {
+        Close();
+        return -1;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeup.Fd();
+    if (epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_wakeup.Fd(), &ev) != 0)
+    {
+        Close();
+        return -1;
+    }
+
+    if (m_txTimer >= 0)
+    {
+        ev.data.fd = m_txTimer;
+        if (epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_txTimer, &ev) != 0)
+        {
+            Close();
+            return -1;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+int cISBridgeTcpReactor::Close()
+{
+    if (m_uring)
+    {
+        // Cancel every request and wait for the kernel to let go of client buffers and
+        // send queues before freeing them
+        if (m_uring->PrepCancelAll(uringUserData(URING_CANCEL, 0)) == 0)
+        {
+            m_uringPending++;
+        }
+        m_uring->Submit();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kUringCloseTimeoutMs);
+        while (m_uringPending > 0 && std::chrono::steady_clock::now() < deadline)
+        {
+            m_uring->Wait(10);
+            sISBridgeUringCompletion completion;
+            while (m_uring->Next(completion))
+            {
+                if (completion.hasBuffer)
+                {
+                    m_uring->RecycleBuffer(completion.bufferId);
+                }
+                if (!completion.more)
+                {
+                    m_uringPending--;
+                }
+            }
+        }
+        m_uring.reset();
+        m_uringPending = 0;
+    }
+    m_paused = false;
+    for (auto& entry : m_closing)
+    {
+        bridgeSocketClose(entry.first);
+    }
+    m_closing.clear();
+
+    std::map<is_socket_t, std::shared_ptr<sClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        clients.swap(m_clients);
+    }
+    for (auto& entry : clients)
+    {
+        // A Broadcast() snapshot may still hold the client; it must not write to the
+        // descriptor once it is closed and possibly reused
+        {
+            std::lock_guard<std::mutex> lock(entry.second->mutex);
+            entry.second->shutdown = true;
+        }
+        bridgeSocketClose(entry.first);
+    }
+
+    if (bridgeSocketValid(m_listenSocket))
+    {
+        bridgeSocketClose(m_listenSocket);
+        m_listenSocket = -1;
+    }
+#if !defined(_WIN32)
+    if (m_reserveFd >= 0)
+    {
+        close(m_reserveFd);
+        m_reserveFd = -1;
+    }
+#endif
+    m_acceptRetryNs = 0;
+#if defined(__linux__)
+    if (m_pollFd >= 0)
+    {
+        close(m_pollFd);
+        m_pollFd = -1;
+    }
+    if (m_txTimer >= 0)
+    {
+        close(m_txTimer);
+        m_txTimer = -1;
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(m_txTimerMutex);
+        m_txTimerDueNs = 0;
+    }
+    m_wakeup.Close();
+    return 0;
+}
+
+int cISBridgeTcpReactor::Run(int timeoutMs)
+{
+    if (!IsOpen())
+    {
+        return -1;
+    }
+
+    if (m_uring)
+    {
+        return RunUring(timeoutMs);
+    }
+
+    int handled = 0;
+
+#if defined(__linux__)
+    epoll_event events[64];
+    int n = epoll_wait(m_pollFd, events, 64, AcceptRetryTimeout(timeoutMs));
+    if (n < 0)
+    {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        int fd = events[i].data.fd;
+        if (fd == m_listenSocket)
+        {
+            AcceptClients();
+        }
+        else if (fd == m_wakeup.Fd())
+        {
+            m_wakeup.Drain();
+        }
+        else if (fd == m_txTimer)
+        {
+            FlushDueClients();
+        }
+        else
+        {
+            if (events[i].events & EPOLLOUT)
+            {
+                FlushClient(fd);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            {
+                // Readable, peer closed or error: ReadClient() tells them apart
+                ReadClient(fd);
+            }
+        }
+        handled++;
+    }
+    if (m_acceptRetryNs != 0 && bridgeClockNs() >= m_acceptRetryNs)
+    {
+        AcceptClients();
+    }
+#else
+    // Rebuilt in place each call; the capacity is kept. While an accept retry is
+    // pending the listener is left out, otherwise a backlog that cannot be accepted
+    // (out of descriptors) reports it readable on every call and Run() spins.
+    m_pollFds.clear();
+    m_pollFds.push_back({ m_wakeup.Fd(), POLLIN, 0 });
+    if (m_acceptRetryNs == 0)
+    {
+        m_pollFds.push_back({ m_listenSocket, POLLIN, 0 });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        for (auto& entry : m_clients)
+        {
+            short events = POLLIN;
+            if (entry.second->writeBlocked)
+            {
+                events |= POLLOUT;
+            }
+            m_pollFds.push_back({ entry.first, events, 0 });
+        }
+    }
+
+    int n = bridgeSocketPoll(m_pollFds.data(), m_pollFds.size(), AcceptRetryTimeout(timeoutMs));
+    if (n < 0)
+    {
+        return bridgeSocketInterrupted(bridgeSocketError()) ? 0 : -1;
+    }
+
+    for (const pollfd& p : m_pollFds)
+    {
+        if (p.revents == 0)
+        {
+            continue;
+        }
+        if (p.fd == m_listenSocket)
+        {
+            AcceptClients();
+        }
+        else if (p.fd == m_wakeup.Fd())
+        {
+            m_wakeup.Drain();
+        }
+        else
+        {
+            if (p.revents & POLLOUT)
+            {
+                FlushClient(p.fd);
+            }
+            if (p.revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                ReadClient(p.fd);
+            }
+        }
+        handled++;
+    }
+    if (m_acceptRetryNs != 0 && bridgeClockNs() >= m_acceptRetryNs)
+    {
+        AcceptClients();
+    }
+#endif
+
+    return handled;
+}
+
+int cISBridgeTcpReactor::Port() const
+{
+    if (!bridgeSocketValid(m_listenSocket))
+    {
+        return -1;
+    }
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    {
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void cISBridgeTcpReactor::Wakeup()
+{
+    m_wakeup.Signal();
+}
+
+void cISBridgeTcpReactor::AcceptClients()
+{
+    // Edge-triggered: accept until the backlog is empty, since the listener is not
+    // reported again until another client connects
+    m_acceptRetryNs = 0;
+    while (true)
+    {
+        is_socket_t socket = accept(m_listenSocket, NULL, NULL);
+        if (!bridgeSocketValid(socket))
+        {
+            int error = bridgeSocketError();
+            if (bridgeSocketInterrupted(error) || bridgeSocketAcceptAborted(error))
+            {
+                continue;
+            }
+            if (bridgeSocketWouldBlock(error))
+            {
+                return;
+            }
+            // accept() runs out of descriptors even with an empty backlog, so only a
+            // connection taken with the reserve descriptor counts as refused
+            int shed = bridgeSocketOutOfDescriptors(error) ? ShedConnection() : -1;
+            if (shed == 0)
+            {
+                return;
+            }
+            if (m_delegate)
+            {
+                m_delegate->OnClientConnectFailed(this);
+            }
+            if (shed > 0)
+            {
+                continue;
+            }
+            // Out of memory (ENOBUFS, ENOMEM) or no reserve descriptor: connections stay
+            // in the backlog, try again shortly
+            m_acceptRetryNs = bridgeClockNs() + kAcceptRetryNs;
+            return;
+        }
+
+        if (!AddClient(socket) && m_delegate)
+        {
+            m_delegate->OnClientConnectFailed(this);
+        }
+    }
+}
+
+int cISBridgeTcpReactor::ShedConnection()
+{
+#if !defined(_WIN32)
+    if (m_reserveFd < 0)
+    {
+        m_reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return -1;
+    }
+    close(m_reserveFd);
+    is_socket_t socket = accept(m_listenSocket, NULL, NULL);
+    int shed = bridgeSocketValid(socket) ? 1 : (bridgeSocketWouldBlock(bridgeSocketError()) ? 0 : -1);
+    if (shed > 0)
+    {
+        bridgeSocketClose(socket);
+    }
+    m_reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return shed;
+#else
+    return -1;
+#endif
+}
+
+int cISBridgeTcpReactor::AcceptRetryTimeout(int timeoutMs) const
+{
+    if (m_acceptRetryNs == 0)
+    {
+        return timeoutMs;
+    }
+    uint64_t nowNs = bridgeClockNs();
+    int retryMs = (m_acceptRetryNs > nowNs) ? static_cast<int>((m_acceptRetryNs - nowNs + 999999) / 1000000) : 0;
+    return (timeoutMs < 0 || retryMs < timeoutMs) ? retryMs : timeoutMs;
+}
+
+int cISBridgeTcpReactor::AdoptClient(is_socket_t socket, const sISBridgeDidSet& filter)
+{
+    if (!IsOpen())
+    {
+        bridgeSocketClose(socket);
+        return -1;
+    }
+    return AddClient(socket, &filter) ? 0 : -1;
+}
+
+int cISBridgeTcpReactor::HandOff(is_socket_t& listenSocket, std::vector<sISBridgeTcpHandoffClient>& clients)
+{
+    listenSocket = -1;
+    clients.clear();
+    if (!IsOpen())
+    {
+        return -1;
+    }
+
+#if defined(_WIN32)
+    // Sockets are handed over as SCM_RIGHTS descriptors, see bridgeHandoffSend()
+    return -1;
+#else
+    m_paused = true;
+    int result = 0;
+    if (m_uring)
+    {
+        // Take back every request, handling the completions so each client is left
+        // ready to be rearmed by Resume(). Reads that complete meanwhile still reach
+        // the delegate.
+        if (m_uring->PrepCancelAll(uringUserData(URING_CANCEL, 0)) == 0)
+        {
+            m_uringPending++;
+        }
+        m_uring->Submit();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kUringCloseTimeoutMs);
+        while (m_uringPending > 0 && std::chrono::steady_clock::now() < deadline)
+        {
+            m_uring->Wait(10);
+            sISBridgeUringCompletion completion;
+            while (m_uring->Next(completion))
+            {
+                HandleCompletion(completion);
+            }
+        }
+        if (m_uringPending > 0)
+        {
+            result = -1;
+        }
+    }
+
+    // Duplicates share the open file description, so closing ours later neither
+    // sends FIN nor resets the backlog
+    listenSocket = fcntl(m_listenSocket, F_DUPFD_CLOEXEC, 0);
+    if (listenSocket < 0)
+    {
+        result = -1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        for (auto& entry : m_clients)
+        {
+            if (entry.second->shutdown)
+            {
+                continue;
+            }
+            sISBridgeTcpHandoffClient client;
+            client.socket = fcntl(entry.first, F_DUPFD_CLOEXEC, 0);
+            if (client.socket < 0)
+            {
+                result = -1;
+                continue;
+            }
+            entry.second->filter.Export(client.filter);
+            clients.push_back(client);
+        }
+    }
+    return result;
+#endif
+}
+
+int cISBridgeTcpReactor::Resume()
+{
+    if (!IsOpen())
+    {
+        return -1;
+    }
+    if (!m_paused)
+    {
+        return 0;
+    }
+    m_paused = false;
+    if (!m_uring)
+    {
+        // epoll and poll() kept watching; readiness that arrived meanwhile is still reported
+        return 0;
+    }
+
+    // Rearm what HandOff() cancelled, submitting whenever the queue fills. The accept
+    // is rearmed here, so a pending retry is dropped.
+    m_acceptRetryNs = 0;
+    auto prep = [this](auto request)
+    {
+        if (request() != 0 && (m_uring->Submit() < 0 || request() != 0))
+        {
+            return false;
+        }
+        m_uringPending++;
+        return true;
+    };
+    bool ok = prep([this]() { return m_uring->PrepAccept(m_listenSocket, uringUserData(URING_ACCEPT, m_listenSocket)); }) &&
+              prep([this]() { return m_uring->PrepPoll(m_wakeup.Fd(), uringUserData(URING_WAKEUP, m_wakeup.Fd())); }) &&
+              (m_txTimer < 0 || prep([this]() { return m_uring->PrepPoll(m_txTimer, uringUserData(URING_TX_TIMER, m_txTimer)); }));
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        for (auto& entry : m_clients)
+        {
+            sClient& client = *entry.second;
+            is_socket_t socket = entry.first;
+            if (ok && !client.shutdown && !client.uring->recvArmed)
+            {
+                ok = prep([this, socket]() { return m_uring->PrepRecv(socket, uringUserData(URING_RECV, socket)); });
+                client.uring->recvArmed = ok;
+            }
+            std::lock_guard<std::mutex> clientLock(client.mutex);
+            SendLocked(client);
+        }
+    }
+    if (m_uring->Submit() < 0)
+    {
+        ok = false;
+    }
+    return ok ? 0 : -1;
+}
+
+bool cISBridgeTcpReactor::AddClient(is_socket_t socket, const sISBridgeDidSet* handoff)
+{
+    bridgeSocketSetCloseOnExec(socket);
+    if (!m_uring)
+    {
+        // io_uring sockets stay blocking so the kernel arms a poll and retries requests
+        // instead of failing them with EAGAIN
+        bridgeSocketSetNonBlocking(socket, true);
+    }
+    else if (handoff)
+    {
+        // Handed over by an epoll bridge, which left it non-blocking
+        bridgeSocketSetNonBlocking(socket, false);
+    }
+    setNoSigPipe(socket);
+    int one = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    if (m_busyPollUs > 0 && bridgeSetBusyPoll(socket, m_busyPollUs) != 0 && !m_busyPollWarned)
+    {
+        std::cerr << "SO_BUSY_POLL not applied: " << strerror(errno) << std::endl;
+        m_busyPollWarned = true;
+    }
+
+    std::shared_ptr<sClient> client = std::make_shared<sClient>();
+    client->socket = socket;
+    client->queue.SetLimits(m_queueLimits);
+    client->rates.SetLimits(m_rateLimits);
+    client->writeBlocked = false;
+    client->shutdown = false;
+    client->bytesRead = 0;
+    client->writeBlocks = 0;
+    client->tx.SetOptions(m_txOptions);
+    if (handoff)
+    {
+        client->filter.Import(*handoff);
+    }
+
+    if (m_uring)
+    {
+        // One multishot receive serves the client until it disconnects. Its completions
+        // are handled on this thread, so arming it before the client is listed is safe.
+        // A client accepted while handing off is armed by Resume().
+        client->uring.reset(new sUringState());
+        if (!m_paused)
+        {
+            if (m_uring->PrepRecv(socket, uringUserData(URING_RECV, socket)) != 0)
+            {
+                bridgeSocketClose(socket);
+                return false;
+            }
+            m_uringPending++;
+            client->uring->recvArmed = true;
+        }
+    }
+    sClient* added = client.get();
+
+    {
+        // Queue the delegate's initial messages while holding the list lock, so no
+        // Broadcast() can reach the client before them
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        if (m_delegate && !handoff)
+        {
+            m_delegate->OnClientAccepting(this, socket, m_initial);
+            for (size_t i = 0; i < m_initial.size() && client->queue.Push(m_initial[i]); i++)
+            {
+            }
+            m_initial.clear();
+
+            // Have the first writable event flush them (the poll() fallback only
+            // watches writability for blocked clients)
+            client->writeBlocked = !m_uring && !client->queue.Empty();
+        }
+        m_clients[socket] = client;
+    }
+
+    if (m_uring)
+    {
+        std::lock_guard<std::mutex> lock(added->mutex);
+        SendLocked(*added);
+    }
+#if defined(__linux__)
+    else
+    {
+        // EPOLLOUT stays armed: with edge triggering it only fires when a full socket
+        // buffer drains, which is exactly when a queued backlog can make progress.
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = socket;
+        if (epoll_ctl(m_pollFd, EPOLL_CTL_ADD, socket, &ev) != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_clientsMutex);
+                m_clients.erase(socket);
+            }
+            {
+                std::lock_guard<std::mutex> lock(added->mutex);
+                added->shutdown = true;
+            }
+            bridgeSocketClose(socket);
+            return false;
+        }
+    }
+#endif
+
+    bridgeCounterAdd(m_counters.accepts, 1);
+    if (m_delegate)
+    {
+        m_delegate->OnClientConnected(this, socket);
+    }
+    return true;
+}
+
+void cISBridgeTcpReactor::ReadClient(is_socket_t socket)
+{
+    sClient* client = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        auto it = m_clients.find(socket);
+        if (it != m_clients.end())
+        {
+            client = it->second.get();
+        }
+    }
+
+    // Edge-triggered: read until the socket would block, otherwise no further event arrives
+    while (true)
+    {
+        ssize_t n = bridgeSocketRecv(socket, m_readBuffer, sizeof(m_readBuffer), 0);
+        if (n > 0)
+        {
+            bridgeCounterAdd(m_counters.reads, 1);
+            bridgeCounterAdd(m_counters.bytesRead, static_cast<uint64_t>(n));
+            if (client)
+            {
+                // Single writer: a plain load and store is enough
+                client->bytesRead.store(client->bytesRead.load(std::memory_order_relaxed) + static_cast<uint64_t>(n), std::memory_order_relaxed);
+            }
+            BRIDGE_TRACE2(tcp_read, socket, n);
+            if (m_delegate)
+            {
+                m_delegate->OnClientDataReceived(this, socket, m_readBuffer, static_cast<int>(n));
+            }
+            continue;
+        }
+        int error = (n < 0) ? bridgeSocketError() : 0;
+        if (n < 0 && bridgeSocketInterrupted(error))
+        {
+            continue;
+        }
+        if (n < 0 && bridgeSocketWouldBlock(error))
+        {
+            return;
+        }
+
+        // Orderly shutdown (0) or socket error
+        CloseClient(socket);
+        return;
+    }
+}
+
+void cISBridgeTcpReactor::FlushClient(is_socket_t socket)
+{
+    sClient* client = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        auto it = m_clients.find(socket);
+        if (it == m_clients.end())
+        {
+            return;
+        }
+        // Only this thread erases clients, so the pointer outlives the lock
+        client = it->second.get();
+    }
+
+    std::lock_guard<std::mutex> lock(client->mutex);
+    client->writeBlocked = false;
+    FlushLocked(*client);
+}
+
+void cISBridgeTcpReactor::CloseClient(is_socket_t socket)
+{
+    std::shared_ptr<sClient> client;
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        auto it = m_clients.find(socket);
+        if (it == m_clients.end())
+        {
+            return;
+        }
+        client = std::move(it->second);
+        m_clients.erase(it);
+    }
+
+    bridgeCounterAdd(m_counters.disconnects, 1);
+    if (m_delegate)
+    {
+        m_delegate->OnClientDisconnected(this, socket);
+    }
+
+    if (m_uring)
+    {
+        // Requests still in flight reference the client and its socket; end them and
+        // close once they have all completed, so the descriptor cannot be reused early
+        {
+            std::lock_guard<std::mutex> lock(client->mutex);
+            ShutdownLocked(*client);
+        }
+        if (client->uring->recvArmed || client->uring->sendsInFlight > 0)
+        {
+            m_closing[socket] = std::move(client);
+            return;
+        }
+    }
+    else
+    {
+        // Whatever is still queued never reaches the client. Marked shutdown, a
+        // Broadcast() snapshot still holding the client leaves the closed socket alone.
+        std::lock_guard<std::mutex> lock(client->mutex);
+        client->shutdown = true;
+        DiscardQueueLocked(*client);
+#if defined(__linux__)
+        epoll_ctl(m_pollFd, EPOLL_CTL_DEL, socket, NULL);
+#endif
+    }
+    bridgeSocketClose(socket);
+}
+
+int cISBridgeTcpReactor::Broadcast(const cISBridgeBufferRef* messages, int count)
+{
+    if (messages == NULL || count <= 0)
+    {
+        return 0;
+    }
+
+    int queued = 0;
+    uint64_t nowNs = bridgeClockNs();
+    BRIDGE_TRACE1(tcp_broadcast_begin, count);
+    std::lock_guard<std::mutex> lock(m_broadcastMutex);
+    SnapshotClients(m_broadcastClients);
+    for (auto& entry : m_broadcastClients)
+    {
+        sClient& client = *entry;
+        std::lock_guard<std::mutex> clientLock(client.mutex);
+        if (client.shutdown)
+        {
+            continue;
+        }
+
+        // Once a push fails (BRIDGE_DROP_DISCONNECT) the rest of the batch is only counted
+        int failedAt = -1;
+        uint64_t refused = 0;
+        int pushed = 0;
+        size_t pushedBytes = 0;
+        uint64_t dropped = client.queue.Stats().droppedMessages;
+        uint64_t conflated = client.queue.Stats().conflatedMessages;
+        uint64_t suppressed = client.rates.Suppressed();
+        for (int i = 0; i < count; i++)
+        {
+            if (!client.filter.Accepts(*messages[i].Get()) || !client.rates.Accept(*messages[i].Get(), nowNs))
+            {
+                continue;
+            }
+            if (failedAt < 0 && !client.queue.Push(messages[i]))
+            {
+                failedAt = i;
+            }
+            if (failedAt >= 0)
+            {
+                refused++;
+                continue;
+            }
+            pushed++;
+            pushedBytes += messages[i]->Size();
+        }
+        if (client.queue.Stats().droppedMessages != dropped)
+        {
+            bridgeCounterAdd(m_counters.droppedMessages, client.queue.Stats().droppedMessages - dropped);
+        }
+        if (client.queue.Stats().conflatedMessages != conflated)
+        {
+            bridgeCounterAdd(m_counters.conflatedMessages, client.queue.Stats().conflatedMessages - conflated);
+        }
+        if (client.rates.Suppressed() != suppressed)
+        {
+            bridgeCounterAdd(m_counters.rateSuppressed, client.rates.Suppressed() - suppressed);
+        }
+        if (failedAt >= 0)
+        {
+            // BRIDGE_DROP_DISCONNECT: the refused message and the rest of the batch
+            // meant for this client; ShutdownLocked() counts what was already queued
+            bridgeCounterAdd(m_counters.droppedMessages, refused);
+            ShutdownLocked(client);
+            continue;
+        }
+        if (pushed == 0)
+        {
+            continue;
+        }
+        queued++;
+
+        if (client.tx.SampleDue(nowNs))
+        {
+            eISBridgeTxMode mode = client.tx.Mode();
+            client.tx.Sample(client.socket, client.writeBlocked, nowNs);
+            if (client.tx.Mode() != mode)
+            {
+                bridgeCounterAdd(m_counters.txModeSwitches, 1);
+            }
+        }
+
+        // A blocked client is flushed from Run() once its socket drains; a coalescing
+        // one when enough is queued or the flush timer fires
+        bool flush = client.tx.OnQueued(pushed, pushedBytes, client.queue.Stats().queuedBytes, nowNs);
+        if (!client.writeBlocked)
+        {
+            if (flush)
+            {
+                FlushLocked(client);
+            }
+            else
+            {
+                ArmTxTimer(client.tx.DeadlineNs());
+            }
+        }
+    }
+    // Drop the references so closed clients are freed; the capacity is kept
+    m_broadcastClients.clear();
+
+    if (m_uring && queued > 0)
+    {
+        // Every client's sends go to the kernel in one call
+        m_uring->Submit();
+    }
+    BRIDGE_TRACE2(tcp_broadcast_end, count, queued);
+    return queued;
+}
+
+int cISBridgeTcpReactor::Write(const void* data, int dataLength)
+{
+    if (data == NULL || dataLength <= 0)
+    {
+        return 0;
+    }
+
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(static_cast<size_t>(dataLength)));
+    if (!buffer)
+    {
+        return 0;
+    }
+    memcpy(buffer->Data(), data, static_cast<size_t>(dataLength));
+    buffer->SetSize(static_cast<size_t>(dataLength));
+    return Broadcast(&buffer, 1);
+}
+
+void cISBridgeTcpReactor::FlushLocked(sClient& client)
+{
+    client.tx.OnFlushed();
+    if (m_uring)
+    {
+        SendLocked(client);
+        return;
+    }
+
+    iovec iov[kMaxWriteIov];
+    while (!client.shutdown && !client.queue.Empty())
+    {
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = client.queue.Peek(iov, kMaxWriteIov);
+
+        // Coalescing: hold partial segments back while more of this flush follows
+        bool more = client.queue.Stats().queuedMessages > msg.msg_iovlen;
+        ssize_t n = bridgeSocketSendmsg(client.socket, &msg, MSG_NOSIGNAL | client.tx.SendFlags(more));
+        bridgeCounterAdd(m_counters.writeCalls, 1);
+        if (n > 0)
+        {
+            size_t completed = client.queue.Consume(static_cast<size_t>(n), &m_writeLatency, bridgeClockNs(), m_trace);
+            bridgeCounterAdd(m_counters.bytesWritten, static_cast<uint64_t>(n));
+            bridgeCounterAdd(m_counters.messagesWritten, completed);
+            BRIDGE_TRACE3(tcp_write, client.socket, n, completed);
+            continue;
+        }
+        int error = (n < 0) ? bridgeSocketError() : 0;
+        if (n < 0 && bridgeSocketInterrupted(error))
+        {
+            continue;
+        }
+        if (n < 0 && bridgeSocketWouldBlock(error))
+        {
+            client.writeBlocked = true;
+            client.writeBlocks++;
+            bridgeCounterAdd(m_counters.writeBlocks, 1);
+#if !defined(__linux__)
+            // poll() fallback only watches POLLOUT for blocked clients; rebuild the set
+            Wakeup();
+#endif
+            return;
+        }
+        ShutdownLocked(client);
+    }
+}
+
+void cISBridgeTcpReactor::SnapshotClients(std::vector<std::shared_ptr<sClient>>& clients)
+{
+    clients.clear();
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    for (auto& entry : m_clients)
+    {
+        clients.push_back(entry.second);
+    }
+}
+
+void cISBridgeTcpReactor::ArmTxTimer(uint64_t dueNs)
+{
+    if (m_txTimer < 0 || dueNs == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_txTimerMutex);
+    if (m_txTimerDueNs != 0 && m_txTimerDueNs <= dueNs)
+    {
+        return;
+    }
+    m_txTimerDueNs = dueNs;
+#if defined(__linux__)
+    // bridgeClockNs() is steady_clock, which is CLOCK_MONOTONIC on Linux
+    itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = static_cast<time_t>(dueNs / 1000000000ULL);
+    spec.it_value.tv_nsec = static_cast<long>(dueNs % 1000000000ULL);
+    timerfd_settime(m_txTimer, TFD_TIMER_ABSTIME, &spec, NULL);
+#endif
+}
+
+void cISBridgeTcpReactor::FlushDueClients()
+{
+#if defined(__linux__)
+    uint64_t expirations;
+    if (read(m_txTimer, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    {
+        return;
+    }
+#endif
+
+    uint64_t nowNs = bridgeClockNs();
+    uint64_t nextNs = 0;
+    {
+        // Disarmed before the clients are checked, so a Broadcast() setting a deadline
+        // meanwhile either rearms the timer or has its client seen below
+        std::lock_guard<std::mutex> lock(m_txTimerMutex);
+        m_txTimerDueNs = 0;
+    }
+    SnapshotClients(m_dueClients);
+    for (auto& entry : m_dueClients)
+    {
+        sClient& client = *entry;
+        std::lock_guard<std::mutex> clientLock(client.mutex);
+        uint64_t dueNs = client.tx.DeadlineNs();
+        if (dueNs == 0 || client.shutdown)
+        {
+            continue;
+        }
+        if (dueNs > nowNs)
+        {
+            nextNs = (nextNs == 0 || dueNs < nextNs) ? dueNs : nextNs;
+        }
+        else if (client.writeBlocked)
+        {
+            // Flushed when the socket drains
+            client.tx.OnFlushed();
+        }
+        else
+        {
+            FlushLocked(client);
+            bridgeCounterAdd(m_counters.txDeadlineFlushes, 1);
+        }
+    }
+    m_dueClients.clear();
+    ArmTxTimer(nextNs);
+    if (m_uring)
+    {
+        m_uring->Submit();
+    }
+}
+
+void cISBridgeTcpReactor::ShutdownLocked(sClient& client)
+{
+    client.shutdown = true;
+    if (!client.uring || client.uring->sendsInFlight == 0)
+    {
+        // In-flight io_uring sends still reference the queue; it is cleared when they complete
+        DiscardQueueLocked(client);
+    }
+    shutdown(client.socket, SHUT_RDWR);
+}
+
+void cISBridgeTcpReactor::DiscardQueueLocked(sClient& client)
+{
+    bridgeCounterAdd(m_counters.droppedMessages, client.queue.Stats().queuedMessages);
+    client.queue.Clear();
+}
+
+int cISBridgeTcpReactor::RunUring(int timeoutMs)
+{
+    // Submit requests queued since the last call (rearms, follow-on sends) and wait
+    if (m_uring->Submit() < 0 && errno != EBUSY && errno != EAGAIN)
+    {
+        return -1;
+    }
+    if (m_uring->Wait(AcceptRetryTimeout(timeoutMs)) != 0)
+    {
+        return -1;
+    }
+
+    int handled = 0;
+    sISBridgeUringCompletion completion;
+    while (m_uring->Next(completion))
+    {
+        HandleCompletion(completion);
+        handled++;
+    }
+
+    if (m_acceptRetryNs != 0 && bridgeClockNs() >= m_acceptRetryNs && !m_paused)
+    {
+        m_acceptRetryNs = 0;
+        if (m_uring->PrepAccept(m_listenSocket, uringUserData(URING_ACCEPT, m_listenSocket)) == 0)
+        {
+            m_uringPending++;
+        }
+    }
+
+    m_uring->Submit();
+    return handled;
+}
+
+void cISBridgeTcpReactor::HandleCompletion(const sISBridgeUringCompletion& completion)
+{
+    eUringOp op = static_cast<eUringOp>(completion.userData >> 32);
+    is_socket_t socket = static_cast<is_socket_t>(static_cast<uint32_t>(completion.userData));
+    if (!completion.more)
+    {
+        m_uringPending--;
+    }
+
+    switch (op)
+    {
+    case URING_ACCEPT:
+    {
+        bool failed;
+        if (completion.result >= 0)
+        {
+            failed = !AddClient(completion.result);
+        }
+        else if (bridgeSocketOutOfDescriptors(-completion.result))
+        {
+            // Fails this way even with an empty backlog: reset whoever is waiting
+            int shed;
+            while ((shed = ShedConnection()) > 0 && m_delegate)
+            {
+                m_delegate->OnClientConnectFailed(this);
+            }
+            failed = shed < 0;
+        }
+        else
+        {
+            failed = completion.result != -ECANCELED && !bridgeSocketAcceptAborted(-completion.result);
+        }
+        if (failed && m_delegate)
+        {
+            m_delegate->OnClientConnectFailed(this);
+        }
+        if (!completion.more && !m_paused)
+        {
+            if (completion.result < 0 && completion.result != -ECANCELED)
+            {
+                // Stopped by an error such as EMFILE, which a rearmed accept would hit
+                // again at once; retry shortly
+                m_acceptRetryNs = bridgeClockNs() + kAcceptRetryNs;
+            }
+            else if (m_uring->PrepAccept(m_listenSocket, completion.userData) == 0)
+            {
+                m_uringPending++;
+            }
+        }
+        break;
+    }
+
+    case URING_WAKEUP:
+        m_wakeup.Drain();
+        if (!completion.more && !m_paused && m_uring->PrepPoll(m_wakeup.Fd(), completion.userData) == 0)
+        {
+            m_uringPending++;
+        }
+        break;
+
+    case URING_RECV:
+    {
+        sClient* client = FindClient(socket);
+        if (completion.hasBuffer)
+        {
+            if (completion.result > 0)
+            {
+                bridgeCounterAdd(m_counters.reads, 1);
+                bridgeCounterAdd(m_counters.bytesRead, static_cast<uint64_t>(completion.result));
+                if (client)
+                {
+                    client->bytesRead.store(client->bytesRead.load(std::memory_order_relaxed) + static_cast<uint64_t>(completion.result), std::memory_order_relaxed);
+                }
+                BRIDGE_TRACE2(tcp_read, socket, completion.result);
+                if (m_delegate && m_closing.find(socket) == m_closing.end())
+                {
+                    m_delegate->OnClientDataReceived(this, socket, m_uring->Buffer(completion.bufferId), completion.result);
+                }
+            }
+            m_uring->RecycleBuffer(completion.bufferId);
+        }
+        if (completion.more || client == NULL)
+        {
+            break;
+        }
+
+        if (m_closing.find(socket) != m_closing.end())
+        {
+            ReleaseClosing(socket);
+        }
+        else if (m_paused && (completion.result > 0 || completion.result == -ENOBUFS || completion.result == -ECANCELED))
+        {
+            // Cancelled by HandOff(); Resume() rearms it
+        }
+        else if (completion.result > 0 || completion.result == -ENOBUFS)
+        {
+            // Ran out of receive buffers or the completion queue overflowed; rearm
+            if (m_uring->PrepRecv(socket, completion.userData) == 0)
+            {
+                m_uringPending++;
+                client->uring->recvArmed = true;
+            }
+            else
+            {
+                CloseClient(socket);
+            }
+        }
+        else
+        {
+            // Orderly shutdown (0) or socket error
+            CloseClient(socket);
+        }
+        break;
+    }
+
+    case URING_SEND:
+    {
+        sClient* client = FindClient(socket);
+        if (client == NULL)
+        {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(client->mutex);
+            client->uring->sendsInFlight--;
+            if (completion.result > 0)
+            {
+                size_t completed = client->queue.Consume(static_cast<size_t>(completion.result), &m_writeLatency, bridgeClockNs(), m_trace);
+                bridgeCounterAdd(m_counters.bytesWritten, static_cast<uint64_t>(completion.result));
+                bridgeCounterAdd(m_counters.messagesWritten, completed);
+                BRIDGE_TRACE3(tcp_write, socket, completion.result, completed);
+            }
+            else if (completion.result < 0 && completion.result != -ECANCELED && !client->shutdown)
+            {
+                // Peer reset or socket error; the receive completes next and closes it
+                ShutdownLocked(*client);
+            }
+
+            if (client->uring->sendsInFlight == 0)
+            {
+                // Cancelled links after a short send are simply resent from the queue head
+                client->queue.Pin(0);
+                if (client->shutdown)
+                {
+                    DiscardQueueLocked(*client);
+                }
+                else
+                {
+                    SendLocked(*client);
+                }
+            }
+        }
+
+        if (m_closing.find(socket) != m_closing.end())
+        {
+            ReleaseClosing(socket);
+        }
+        break;
+    }
+
+    case URING_TX_TIMER:
+        FlushDueClients();
+        if (!completion.more && !m_paused && m_uring->PrepPoll(m_txTimer, completion.userData) == 0)
+        {
+            m_uringPending++;
+        }
+        break;
+
+    case URING_CANCEL:
+        break;
+    }
+}
+
+void cISBridgeTcpReactor::SendLocked(sClient& client)
+{
+    sUringState& state = *client.uring;
+    if (client.shutdown || client.queue.Empty() || m_paused)
+    {
+        return;
+    }
+    if (state.sendsInFlight > 0)
+    {
+        // The socket has not taken the previous chain yet; the next one follows it
+        if (!state.sendBlocked)
+        {
+            state.sendBlocked = true;
+            client.writeBlocks++;
+            bridgeCounterAdd(m_counters.writeBlocks, 1);
+        }
+        return;
+    }
+
+    int iovCount = client.queue.Peek(state.iov, kMaxWriteIov * kUringLinkedSends);
+    int sends = (iovCount + kMaxWriteIov - 1) / kMaxWriteIov;
+    for (int i = 0; i < sends; i++)
+    {
+        msghdr& msg = state.msg[i];
+        memset(&msg, 0, sizeof(msg));
+        int remaining = iovCount - i * kMaxWriteIov;
+        msg.msg_iov = state.iov + i * kMaxWriteIov;
+        msg.msg_iovlen = remaining < kMaxWriteIov ? remaining : kMaxWriteIov;
+    }
+
+    // MSG_WAITALL: a short send breaks the chain, so later links never skip bytes
+    if (m_uring->PrepSendmsgChain(client.socket, state.msg, sends, MSG_NOSIGNAL | MSG_WAITALL, uringUserData(URING_SEND, client.socket)) != 0)
+    {
+        // Submission queue full; retried on the next Broadcast() or completion
+        return;
+    }
+    client.queue.Pin(static_cast<size_t>(iovCount));
+    state.sendsInFlight = sends;
+    state.sendBlocked = false;
+    m_uringPending += sends;
+    bridgeCounterAdd(m_counters.writeCalls, static_cast<uint64_t>(sends));
+}
+
+cISBridgeTcpReactor::sClient* cISBridgeTcpReactor::FindClient(is_socket_t socket)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        auto it = m_clients.find(socket);
+        if (it != m_clients.end())
+        {
+            // Only this thread erases clients, so the pointer outlives the lock
+            return it->second.get();
+        }
+    }
+    auto it = m_closing.find(socket);
+    return it != m_closing.end() ? it->second.get() : NULL;
+}
+
+void cISBridgeTcpReactor::ReleaseClosing(is_socket_t socket)
+{
+    auto it = m_closing.find(socket);
+    if (it == m_closing.end() || it->second->uring->recvArmed || it->second->uring->sendsInFlight > 0)
+    {
+        return;
+    }
+    bridgeSocketClose(socket);
+    m_closing.erase(it);
+}
+
+int cISBridgeTcpReactor::ClientCount()
+{
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    return static_cast<int>(m_clients.size());
+}
+
+int cISBridgeTcpReactor::SetClientRateLimits(is_socket_t socket, const sISBridgeRateLimits& limits)
+{
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end())
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> clientLock(it->second->mutex);
+    it->second->rates.SetLimits(limits);
+    return 0;
+}
+
+int cISBridgeTcpReactor::SetClientConflate(is_socket_t socket, bool conflate)
+{
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end())
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> clientLock(it->second->mutex);
+    it->second->queue.SetConflate(conflate);
+    return 0;
+}
+
+cISBridgeDidFilter* cISBridgeTcpReactor::ClientFilter(is_socket_t socket)
+{
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    auto it = m_clients.find(socket);
+    return it != m_clients.end() ? &it->second->filter : NULL;
+}
+
+void cISBridgeTcpReactor::GetSubscriptions(sISBridgeDidSet& set)
+{
+    cISBridgeTcpReactor* self = this;
+    GetSubscriptions(&self, 1, set);
+}
+
+void cISBridgeTcpReactor::GetSubscriptions(cISBridgeTcpReactor* const* reactors, size_t count, sISBridgeDidSet& set)
+{
+    set = sISBridgeDidSet();
+    set.all = false;
+    bool anyClients = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        std::lock_guard<std::mutex> lock(reactors[i]->m_clientsMutex);
+        for (auto& entry : reactors[i]->m_clients)
+        {
+            anyClients = true;
+            if (!entry.second->filter.IsActive())
+            {
+                set.all = true;
+                return;
+            }
+            entry.second->filter.MergeInto(set);
+        }
+    }
+    if (!anyClients)
+    {
+        set.all = true;
+    }
+}
+
+void cISBridgeTcpReactor::GetClientStats(std::vector<sISBridgeTcpClientStats>& stats)
+{
+    stats.clear();
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    for (auto& entry : m_clients)
+    {
+        std::lock_guard<std::mutex> clientLock(entry.second->mutex);
+        sISBridgeTcpClientStats s;
+        s.socket = entry.first;
+        s.queue = entry.second->queue.Stats();
+        s.bytesRead = entry.second->bytesRead.load(std::memory_order_relaxed);
+        s.writeBlocks = entry.second->writeBlocks;
+        s.rateSuppressed = entry.second->rates.Suppressed();
+        s.tx = entry.second->tx.Stats();
+        stats.push_back(s);
+    }
+}
+
+sISBridgeTcpReactorStats cISBridgeTcpReactor::GetStats() const
+{
+    sISBridgeTcpReactorStats stats;
+    stats.accepts = m_counters.accepts.load(std::memory_order_relaxed);
+    stats.disconnects = m_counters.disconnects.load(std::memory_order_relaxed);
+    stats.reads = m_counters.reads.load(std::memory_order_relaxed);
+    stats.bytesRead = m_counters.bytesRead.load(std::memory_order_relaxed);
+    stats.writeCalls = m_counters.writeCalls.load(std::memory_order_relaxed);
+    stats.messagesWritten = m_counters.messagesWritten.load(std::memory_order_relaxed);
+    stats.bytesWritten = m_counters.bytesWritten.load(std::memory_order_relaxed);
+    stats.writeBlocks = m_counters.writeBlocks.load(std::memory_order_relaxed);
+    stats.droppedMessages = m_counters.droppedMessages.load(std::memory_order_relaxed);
+    stats.rateSuppressed = m_counters.rateSuppressed.load(std::memory_order_relaxed);
+    stats.conflatedMessages = m_counters.conflatedMessages.load(std::memory_order_relaxed);
+    stats.txModeSwitches = m_counters.txModeSwitches.load(std::memory_order_relaxed);
+    stats.txDeadlineFlushes = m_counters.txDeadlineFlushes.load(std::memory_order_relaxed);
+    return stats;
+}
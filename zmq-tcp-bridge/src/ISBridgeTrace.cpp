@@ -0,0 +1,176 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include "ISBridgeTrace.h"
+
+// sSlot::info layout: size in bits 0-30, direction in bit 31, then protocol, packet type
+// and packet ID
+static const uint64_t kInfoSizeMask = 0x7FFFFFFFull;
+static const uint64_t kInfoTcpToZmq = 1ull << 31;
+
+cISBridgeTraceRing::cISBridgeTraceRing(size_t capacity, int sampleEvery)
+    : m_sampleEvery(sampleEvery > 0 ? static_cast<uint64_t>(sampleEvery) : 1)
+    , m_sampleCounter(0)
+    , m_next(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots.reset(new sSlot[size]);
+    for (size_t i = 0; i < size; i++)
+    {
+        m_slots[i].id.store(0, std::memory_order_relaxed);
+        m_slots[i].info.store(0, std::memory_order_relaxed);
+        for (int stage = 0; stage < BRIDGE_TRACE_STAGE_COUNT; stage++)
+        {
+            m_slots[i].stageNs[stage].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t cISBridgeTraceRing::Begin(bool tcpToZmq, cISBridgeBuffer& buffer)
+{
+    uint64_t id = m_next.fetch_add(1, std::memory_order_relaxed) + 1;
+    sSlot& slot = m_slots[(id - 1) & m_mask];
+
+    // Seqlock write: invalidate, fill, publish
+    slot.id.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t size = std::min<uint64_t>(buffer.Size(), kInfoSizeMask);
+    slot.info.store(size | (tcpToZmq ? kInfoTcpToZmq : 0) |
+        (static_cast<uint64_t>(buffer.Protocol()) << 32) |
+        (static_cast<uint64_t>(buffer.PacketType()) << 40) |
+        (static_cast<uint64_t>(buffer.PacketId()) << 48), std::memory_order_relaxed);
+    for (int stage = 0; stage < BRIDGE_TRACE_STAGE_COUNT; stage++)
+    {
+        slot.stageNs[stage].store(0, std::memory_order_relaxed);
+    }
+    slot.id.store(id, std::memory_order_release);
+
+    buffer.SetTraceId(id);
+    return id;
+}
+
+void cISBridgeTraceRing::Stamp(uint64_t id, eISBridgeTraceStage stage, uint64_t ns)
+{
+    if (id == 0 || static_cast<unsigned>(stage) >= BRIDGE_TRACE_STAGE_COUNT)
+    {
+        return;
+    }
+    sSlot& slot = m_slots[(id - 1) & m_mask];
+    if (slot.id.load(std::memory_order_acquire) != id)
+    {
+        return;     // Overwritten by a newer record
+    }
+
+    std::atomic<uint64_t>& stamp = slot.stageNs[stage];
+    if (stage == BRIDGE_TRACE_TCP_FIRST_WRITE)
+    {
+        // Several shards may complete writes at once
+        uint64_t current = stamp.load(std::memory_order_relaxed);
+        while ((current == 0 || ns < current) && !stamp.compare_exchange_weak(current, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+    else if (stage == BRIDGE_TRACE_TCP_LAST_WRITE)
+    {
+        uint64_t current = stamp.load(std::memory_order_relaxed);
+        while (ns > current && !stamp.compare_exchange_weak(current, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+    else
+    {
+        stamp.store(ns, std::memory_order_relaxed);
+    }
+}
+
+void cISBridgeTraceRing::Snapshot(std::vector<sISBridgeTraceRecord>& records) const
+{
+    records.clear();
+    for (size_t i = 0; i <= m_mask; i++)
+    {
+        const sSlot& slot = m_slots[i];
+        uint64_t id = slot.id.load(std::memory_order_acquire);
+        if (id == 0)
+        {
+            continue;
+        }
+
+        sISBridgeTraceRecord record;
+        record.id = id;
+        uint64_t info = slot.info.load(std::memory_order_relaxed);
+        for (int stage = 0; stage < BRIDGE_TRACE_STAGE_COUNT; stage++)
+        {
+            record.stageNs[stage] = slot.stageNs[stage].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.id.load(std::memory_order_relaxed) != id)
+        {
+            continue;   // Rewritten while copying
+        }
+
+        record.size = static_cast<uint32_t>(info & kInfoSizeMask);
+        record.tcpToZmq = (info & kInfoTcpToZmq) != 0;
+        record.protocol = static_cast<uint8_t>(info >> 32);
+        record.type = static_cast<uint8_t>(info >> 40);
+        record.packetId = static_cast<uint16_t>(info >> 48);
+        records.push_back(record);
+    }
+    std::sort(records.begin(), records.end(), [](const sISBridgeTraceRecord& a, const sISBridgeTraceRecord& b)
+    {
+        return a.id < b.id;
+    });
+}
+
+const char* cISBridgeTraceRing::StageName(eISBridgeTraceStage stage)
+{
+    switch (stage)
+    {
+    case BRIDGE_TRACE_ZMQ_RECEIVED:     return "zmq_received";
+    case BRIDGE_TRACE_BATCHED:          return "batched";
+    case BRIDGE_TRACE_FANOUT:           return "fanout";
+    case BRIDGE_TRACE_TCP_FIRST_WRITE:  return "tcp_first_write";
+    case BRIDGE_TRACE_TCP_LAST_WRITE:   return "tcp_last_write";
+    case BRIDGE_TRACE_ZMQ_QUEUED:       return "zmq_queued";
+    case BRIDGE_TRACE_ZMQ_PUBLISHED:    return "zmq_published";
+    default:                            return "unknown";
+    }
+}
+
+void cISBridgeTraceRing::FormatJson(const std::vector<sISBridgeTraceRecord>& records, std::string& out)
+{
+    for (const sISBridgeTraceRecord& record : records)
+    {
+        out += "{\"id\":" + std::to_string(record.id);
+        out += record.tcpToZmq ? ",\"direction\":\"tcp_to_zmq\"" : ",\"direction\":\"zmq_to_tcp\"";
+        out += ",\"size\":" + std::to_string(record.size);
+        out += ",\"protocol\":" + std::to_string(record.protocol);
+        out += ",\"type\":" + std::to_string(record.type);
+        out += ",\"packet_id\":" + std::to_string(record.packetId);
+        for (int stage = 0; stage < BRIDGE_TRACE_STAGE_COUNT; stage++)
+        {
+            if (record.stageNs[stage] != 0)
+            {
+                out += ",\"";
+                out += StageName(static_cast<eISBridgeTraceStage>(stage));
+                out += "_ns\":" + std::to_string(record.stageNs[stage]);
+            }
+        }
+        out += "}\n";
+    }
+}
@@ -0,0 +1,140 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeTxScheduler.h"
+#include "ISBridgeSocket.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#endif
+
+cISBridgeTxScheduler::cISBridgeTxScheduler()
+    : m_deadlineNs(0)
+    , m_nextSampleNs(0)
+    , m_lastSampleNs(0)
+    , m_messages(0)
+    , m_bytes(0)
+{
+}
+
+void cISBridgeTxScheduler::SetOptions(const sISBridgeTxOptions& options)
+{
+    m_options = options;
+#if !defined(__linux__)
+    m_options.adaptive = false;
+#endif
+    m_stats = sISBridgeTxStats();
+    m_deadlineNs = 0;
+    m_nextSampleNs = 0;
+    m_lastSampleNs = 0;
+    m_messages = 0;
+    m_bytes = 0;
+}
+
+bool cISBridgeTxScheduler::OnQueued(int messages, size_t bytes, size_t queuedBytes, uint64_t nowNs)
+{
+    m_messages += static_cast<uint64_t>(messages);
+    m_bytes += bytes;
+    if (m_stats.mode == BRIDGE_TX_IMMEDIATE)
+    {
+        return true;
+    }
+    if (m_deadlineNs == 0)
+    {
+        m_deadlineNs = nowNs + static_cast<uint64_t>(m_options.flushUs) * 1000ULL;
+    }
+    return queuedBytes >= static_cast<size_t>(m_options.flushBytes) || nowNs >= m_deadlineNs;
+}
+
+void cISBridgeTxScheduler::Sample(int socket, bool writeBlocked, uint64_t nowNs)
+{
+    m_nextSampleNs = nowNs + static_cast<uint64_t>(m_options.sampleMs) * 1000000ULL;
+    if (m_lastSampleNs == 0)
+    {
+        // First sample only starts the measurement window
+        m_lastSampleNs = nowNs;
+        m_messages = 0;
+        m_bytes = 0;
+        return;
+    }
+    double elapsedSec = static_cast<double>(nowNs - m_lastSampleNs) / 1e9;
+    double byteRate = static_cast<double>(m_bytes) / elapsedSec;
+    m_stats.messageRate = static_cast<double>(m_messages) / elapsedSec;
+    m_lastSampleNs = nowNs;
+    m_messages = 0;
+    m_bytes = 0;
+
+#if defined(__linux__)
+    tcp_info info;
+    socklen_t infoLength = sizeof(info);
+    if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &infoLength) == 0)
+    {
+        m_stats.rttUs = info.tcpi_rtt;
+    }
+    int notSent = 0;
+    if (ioctl(socket, SIOCOUTQNSD, &notSent) == 0)
+    {
+        m_stats.notSentBytes = notSent > 0 ? static_cast<uint32_t>(notSent) : 0;
+    }
+
+    eISBridgeTxMode mode = m_stats.mode;
+    if (m_stats.messageRate >= m_options.coalesceRate || m_stats.notSentBytes > 0 || writeBlocked)
+    {
+        mode = BRIDGE_TX_COALESCE;
+    }
+    else if (m_stats.messageRate < m_options.coalesceRate / 2.0)
+    {
+        mode = BRIDGE_TX_IMMEDIATE;
+    }
+    if (mode != m_stats.mode)
+    {
+        m_stats.mode = mode;
+        m_stats.modeSwitches++;
+    }
+
+    if (m_options.maxSndbuf > 0)
+    {
+        double delaySec = static_cast<double>(m_stats.rttUs + static_cast<uint32_t>(m_options.flushUs)) / 1e6;
+        double bdp = std::min(2.0 * byteRate * delaySec, static_cast<double>(m_options.maxSndbuf));
+        int target = std::max(static_cast<int>(bdp), m_options.minSndbuf);
+        int current = m_stats.sndbuf;
+        // Resize only on a change of more than a quarter, so a steady client costs no
+        // setsockopt() calls
+        if (current == 0 || target > current + current / 4 || target < current - current / 4)
+        {
+            if (setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &target, sizeof(target)) == 0)
+            {
+                m_stats.sndbuf = target;
+            }
+        }
+    }
+#else
+    (void)socket;
+    (void)writeBlocked;
+    (void)byteRate;
+#endif
+}
+
+int cISBridgeTxScheduler::SendFlags(bool more) const
+{
+#if defined(MSG_MORE)
+    return (more && m_stats.mode == BRIDGE_TX_COALESCE) ? MSG_MORE : 0;
+#else
+    (void)more;
+    return 0;
+#endif
+}
@@ -0,0 +1,538 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeUring.h"
+
+#include <atomic>
+#include <errno.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ISBRIDGE_HAVE_IO_URING 1
+#endif
+#endif
+
+#if ISBRIDGE_HAVE_IO_URING
+#include <endian.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static int uringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags, const void* arg, size_t argSize)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+static int uringRegister(int fd, unsigned opcode, const void* arg, unsigned count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+static void* mapShared(size_t size, int fd, off_t offset)
+{
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+static void* mapAnonymous(size_t size)
+{
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+#endif
+
+cISBridgeUring::cISBridgeUring()
+    : m_fd(-1)
+    , m_sqRing(NULL)
+    , m_sqRingSize(0)
+    , m_sqes(NULL)
+    , m_sqesSize(0)
+    , m_sqHead(NULL)
+    , m_sqTail(NULL)
+    , m_sqFlags(NULL)
+    , m_sqMask(0)
+    , m_sqEntries(0)
+    , m_sqLocalTail(0)
+    , m_cqRing(NULL)
+    , m_cqRingSize(0)
+    , m_cqHead(NULL)
+    , m_cqTail(NULL)
+    , m_cqMask(0)
+    , m_cqes(NULL)
+    , m_bufRing(NULL)
+    , m_bufRingSize(0)
+    , m_buffers(NULL)
+    , m_buffersSize(0)
+    , m_bufferSize(0)
+    , m_bufferCount(0)
+    , m_bufTail(0)
+{
+}
+
+cISBridgeUring::~cISBridgeUring()
+{
+    Close();
+}
+
+int cISBridgeUring::Open(unsigned entries, unsigned bufferCount, unsigned bufferSize)
+{
+    Close();
+
+#if ISBRIDGE_HAVE_IO_URING
+    if (bufferCount == 0 || (bufferCount & (bufferCount - 1)) != 0 || bufferCount > 32768)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4;
+    m_fd = uringSetup(entries, &params);
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+
+    // Poll-driven retries, no dropped completions and timed waits are all relied on
+    const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required)
+    {
+        Close();
+        errno = ENOSYS;
+        return -1;
+    }
+
+    // Multishot receive arrived in Linux 6.0 together with IORING_OP_SEND_ZC, which
+    // unlike the receive flag can be probed
+    std::vector<uint8_t> probeMemory(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeMemory.data());
+    if (uringRegister(m_fd, IORING_REGISTER_PROBE, probe, 256) != 0 ||
+        probe->last_op < IORING_OP_SEND_ZC ||
+        !(probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED))
+    {
+        Close();
+        errno = ENOSYS;
+        return -1;
+    }
+
+    // One mapping holds both rings (IORING_FEAT_SINGLE_MMAP)
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    m_sqRingSize = m_cqRingSize = (m_sqRingSize > m_cqRingSize ? m_sqRingSize : m_cqRingSize);
+    m_sqRing = mapShared(m_sqRingSize, m_fd, IORING_OFF_SQ_RING);
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = static_cast<io_uring_sqe*>(mapShared(m_sqesSize, m_fd, IORING_OFF_SQES));
+    if (m_sqRing == NULL || m_sqes == NULL)
+    {
+        Close();
+        return -1;
+    }
+    m_cqRing = m_sqRing;
+
+    uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+    m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_sqFlags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+    m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_sqEntries = params.sq_entries;
+    m_sqLocalTail = *m_sqTail;
+
+    // Entries are always consumed in order, so the index array is the identity
+    unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < m_sqEntries; i++)
+    {
+        array[i] = i;
+    }
+
+    uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+    m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Register the receive buffers as provided-buffer group 0
+    m_bufferCount = bufferCount;
+    m_bufferSize = bufferSize;
+    m_bufRingSize = bufferCount * sizeof(io_uring_buf);
+    m_bufRing = static_cast<io_uring_buf*>(mapAnonymous(m_bufRingSize));
+    m_buffersSize = static_cast<size_t>(bufferCount) * bufferSize;
+    m_buffers = static_cast<uint8_t*>(mapAnonymous(m_buffersSize));
+    if (m_bufRing == NULL || m_buffers == NULL)
+    {
+        Close();
+        return -1;
+    }
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_bufRing);
+    reg.ring_entries = bufferCount;
+    reg.bgid = 0;
+    if (uringRegister(m_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        Close();
+        return -1;
+    }
+    for (unsigned i = 0; i < bufferCount; i++)
+    {
+        RecycleBuffer(static_cast<uint16_t>(i));
+    }
+    return 0;
+#else
+    (void)entries;
+    (void)bufferCount;
+    (void)bufferSize;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+void cISBridgeUring::Close()
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+    if (m_sqRing)
+    {
+        munmap(m_sqRing, m_sqRingSize);
+    }
+    if (m_sqes)
+    {
+        munmap(m_sqes, m_sqesSize);
+    }
+    if (m_bufRing)
+    {
+        munmap(m_bufRing, m_bufRingSize);
+    }
+    if (m_buffers)
+    {
+        munmap(m_buffers, m_buffersSize);
+    }
+#endif
+    m_fd = -1;
+    m_sqRing = NULL;
+    m_sqes = NULL;
+    m_cqRing = NULL;
+    m_cqes = NULL;
+    m_bufRing = NULL;
+    m_buffers = NULL;
+    m_bufTail = 0;
+}
+
+unsigned cISBridgeUring::SqSpace()
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+
+    unsigned used = m_sqLocalTail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire);
+    if (used >= m_sqEntries / 2)
+    {
+        SubmitLocked();
+        used = m_sqLocalTail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire);
+    }
+    return m_sqEntries - used;
+#else
+    return 0;
+#endif
+}
+
+io_uring_sqe* cISBridgeUring::GetSqe()
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (SqSpace() == 0)
+    {
+        errno = EBUSY;
+        return NULL;
+    }
+
+    io_uring_sqe* sqe = &m_sqes[m_sqLocalTail & m_sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    m_sqLocalTail++;
+    return sqe;
+#else
+    return NULL;
+#endif
+}
+
+int cISBridgeUring::PrepAccept(int fd, uint64_t userData)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == NULL)
+    {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = userData;
+    return 0;
+#else
+    (void)fd;
+    (void)userData;
+    return -1;
+#endif
+}
+
+int cISBridgeUring::PrepRecv(int fd, uint64_t userData)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == NULL)
+    {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = userData;
+    return 0;
+#else
+    (void)fd;
+    (void)userData;
+    return -1;
+#endif
+}
+
+int cISBridgeUring::PrepSendmsgChain(int fd, const msghdr* msgs, int count, int flags, uint64_t userData)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    // A chain cut short would link its last entry to whatever is queued next
+    if (count <= 0 || SqSpace() < static_cast<unsigned>(count))
+    {
+        errno = EBUSY;
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        io_uring_sqe* sqe = GetSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&msgs[i]);
+        sqe->len = 1;
+        sqe->msg_flags = static_cast<uint32_t>(flags);
+        sqe->flags = (i + 1 < count) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = userData;
+    }
+    return 0;
+#else
+    (void)fd;
+    (void)msgs;
+    (void)count;
+    (void)flags;
+    (void)userData;
+    return -1;
+#endif
+}
+
+int cISBridgeUring::PrepPoll(int fd, uint64_t userData)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == NULL)
+    {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    sqe->poll32_events = (POLLIN << 16) | (POLLIN >> 16);
+#else
+    sqe->poll32_events = POLLIN;
+#endif
+    sqe->user_data = userData;
+    return 0;
+#else
+    (void)fd;
+    (void)userData;
+    return -1;
+#endif
+}
+
+int cISBridgeUring::PrepCancelAll(uint64_t userData)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    io_uring_sqe* sqe = GetSqe();
+    if (sqe == NULL)
+    {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = userData;
+    return 0;
+#else
+    (void)userData;
+    return -1;
+#endif
+}
+
+int cISBridgeUring::Submit()
+{
+    std::lock_guard<std::mutex> lock(m_submitMutex);
+    return SubmitLocked();
+}
+
+int cISBridgeUring::SubmitLocked()
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+
+    std::atomic_ref<unsigned>(*m_sqTail).store(m_sqLocalTail, std::memory_order_release);
+    unsigned pending = m_sqLocalTail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire);
+    if (pending == 0)
+    {
+        return 0;
+    }
+
+    int n;
+    do
+    {
+        n = uringEnter(m_fd, pending, 0, 0, NULL, 0);
+    } while (n < 0 && errno == EINTR);
+    // EBUSY/EAGAIN: the completion queue backlog is full; entries stay queued and go
+    // out with the next Submit() once completions have been reaped
+    return n;
+#else
+    return -1;
+#endif
+}
+
+int cISBridgeUring::Wait(int timeoutMs)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+
+    unsigned head = *m_cqHead;
+    if (head != std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    int n;
+    if (timeoutMs == 0)
+    {
+        // Completions only need a syscall when the kernel is holding overflowed ones
+        if (!(std::atomic_ref<unsigned>(*m_sqFlags).load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW))
+        {
+            return 0;
+        }
+        n = uringEnter(m_fd, 0, 0, IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+    else if (timeoutMs < 0)
+    {
+        n = uringEnter(m_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+    else
+    {
+        __kernel_timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000LL;
+        io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        n = uringEnter(m_fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    }
+
+    if (n < 0 && errno != EINTR && errno != ETIME)
+    {
+        return -1;
+    }
+    return 0;
+#else
+    (void)timeoutMs;
+    return -1;
+#endif
+}
+
+bool cISBridgeUring::Next(sISBridgeUringCompletion& completion)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    unsigned head = *m_cqHead;
+    if (head == std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+    completion.userData = cqe.user_data;
+    completion.result = cqe.res;
+    completion.more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+    completion.hasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+    completion.bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    std::atomic_ref<unsigned>(*m_cqHead).store(head + 1, std::memory_order_release);
+    return true;
+#else
+    (void)completion;
+    return false;
+#endif
+}
+
+void cISBridgeUring::RecycleBuffer(uint16_t bufferId)
+{
+#if ISBRIDGE_HAVE_IO_URING
+    if (m_bufRing == NULL)
+    {
+        return;
+    }
+
+    // Indexed as a plain array: in C++ the header's io_uring_buf_ring::bufs sits 8 bytes
+    // late because its empty placeholder struct has size 1
+    io_uring_buf& buf = m_bufRing[m_bufTail & (m_bufferCount - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(Buffer(bufferId));
+    buf.len = m_bufferSize;
+    buf.bid = bufferId;
+    m_bufTail++;
+    std::atomic_ref<uint16_t>(m_bufRing[0].resv).store(m_bufTail, std::memory_order_release);
+#else
+    (void)bufferId;
+#endif
+}
@@ -0,0 +1,199 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgeWakeup.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+#if defined(_WIN32)
+/**
+ * Connect two TCP sockets over loopback; Windows has no pipe that zmq_poll() can watch
+ */
+static int loopbackPair(is_socket_t fds[2])
+{
+    if (bridgeSocketStartup() != 0)
+    {
+        return -1;
+    }
+
+    is_socket_t listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (!bridgeSocketValid(listener))
+    {
+        return -1;
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    fds[0] = fds[1] = static_cast<is_socket_t>(-1);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+        getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) == 0 &&
+        listen(listener, 1) == 0)
+    {
+        fds[1] = socket(AF_INET, SOCK_STREAM, 0);
+        if (bridgeSocketValid(fds[1]) && connect(fds[1], reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+        {
+            fds[0] = accept(listener, NULL, NULL);
+        }
+    }
+    bridgeSocketClose(listener);
+    if (!bridgeSocketValid(fds[0]))
+    {
+        if (bridgeSocketValid(fds[1]))
+        {
+            bridgeSocketClose(fds[1]);
+        }
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fds[1], IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    return 0;
+}
+#endif
+
+cISBridgeWakeup::cISBridgeWakeup()
+    : m_readFd(-1)
+    , m_writeFd(-1)
+{
+}
+
+cISBridgeWakeup::~cISBridgeWakeup()
+{
+    Close();
+}
+
+int cISBridgeWakeup::Open()
+{
+    if (IsOpen())
+    {
+        return 0;
+    }
+
+#if defined(__linux__)
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    m_readFd = fd;
+    m_writeFd = fd;
+#elif defined(_WIN32)
+    is_socket_t fds[2];
+    if (loopbackPair(fds) != 0)
+    {
+        return -1;
+    }
+    for (is_socket_t fd : fds)
+    {
+        bridgeSocketSetNonBlocking(fd, true);
+    }
+    m_readFd = fds[0];
+    m_writeFd = fds[1];
+#else
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return -1;
+    }
+    for (int fd : fds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    m_readFd = fds[0];
+    m_writeFd = fds[1];
+#endif
+    return 0;
+}
+
+void cISBridgeWakeup::Close()
+{
+#if defined(_WIN32)
+    if (bridgeSocketValid(m_writeFd))
+    {
+        bridgeSocketClose(m_writeFd);
+    }
+    if (bridgeSocketValid(m_readFd))
+    {
+        bridgeSocketClose(m_readFd);
+    }
+#else
+    if (m_writeFd >= 0 && m_writeFd != m_readFd)
+    {
+        close(m_writeFd);
+    }
+    if (m_readFd >= 0)
+    {
+        close(m_readFd);
+    }
+#endif
+    m_readFd = -1;
+    m_writeFd = -1;
+}
+
+void cISBridgeWakeup::Signal()
+{
+    if (!bridgeSocketValid(m_writeFd))
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    uint64_t one = 1;
+    ssize_t n = write(m_writeFd, &one, sizeof(one));
+#elif defined(_WIN32)
+    char one = 1;
+    int n = send(m_writeFd, &one, sizeof(one), 0);
+#else
+    uint8_t one = 1;
+    ssize_t n = write(m_writeFd, &one, sizeof(one));
+#endif
+    // EAGAIN means the counter/pipe is already signalled, which is all we need
+    (void)n;
+}
+
+void cISBridgeWakeup::Drain()
+{
+    if (!bridgeSocketValid(m_readFd))
+    {
+        return;
+    }
+
+    uint8_t buf[64];
+#if defined(_WIN32)
+    while (bridgeSocketRecv(m_readFd, buf, sizeof(buf), 0) > 0)
+    {
+    }
+#else
+    while (read(m_readFd, buf, sizeof(buf)) > 0)
+    {
+#if defined(__linux__)
+        // eventfd reads reset the counter in one go
+        break;
+#endif
+    }
+#endif
+}
@@ -11,24 +11,113 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include "ISZmqTcpBridge.h"
-#include "ISTcpServer.h"
+#include "ISBridgeAsync.h"
 #include <zmq.hpp>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <cstring>
+#include <algorithm>
 #include <errno.h>
+#include <new>
+#include <sstream>
+
+static_assert(sizeof(zmq_msg_t) <= cISBridgeBuffer::kStorageSize, "zmq_msg_t must fit in cISBridgeBuffer storage");
+
+/**
+ * Release hook for pooled buffers wrapping a received zmq_msg_t
+ */
+static void closeZmqMessage(cISBridgeBuffer* buffer)
+{
+    zmq_msg_close(static_cast<zmq_msg_t*>(buffer->Storage()));
+}
+
+/**
+ * Wait until every monitored socket reports its first connection
+ * @param monitors PAIR sockets connected to zmq_socket_monitor() endpoints
+ * @param timeoutMs longest wait
+ * @return number of sockets still not connected
+ */
+static int waitForZmqConnections(std::vector<std::unique_ptr<zmq::socket_t>>& monitors, int timeoutMs)
+{
+    std::vector<bool> connected(monitors.size(), false);
+    int pending = static_cast<int>(monitors.size());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (pending > 0)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            break;
+        }
+
+        std::vector<zmq::pollitem_t> items;
+        for (std::unique_ptr<zmq::socket_t>& monitor : monitors)
+        {
+            items.push_back({ monitor->handle(), 0, ZMQ_POLLIN, 0 });
+        }
+        zmq::poll(items, remaining);
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if ((items[i].revents & ZMQ_POLLIN) == 0)
+            {
+                continue;
+            }
+            // Event frame, then the endpoint frame
+            zmq::message_t event;
+            zmq::message_t endpoint;
+            if (monitors[i]->recv(event, zmq::recv_flags::dontwait) && event.more())
+            {
+                monitors[i]->recv(endpoint, zmq::recv_flags::dontwait);
+            }
+            if (!connected[i])
+            {
+                connected[i] = true;
+                pending--;
+            }
+        }
+    }
+    return pending;
+}
+
+/**
+ * libzmq free callback for messages built on pooled buffers; returns the buffer to its
+ * pool. May run on a libzmq I/O thread.
+ */
+static void releaseBufferToPool(void* data, void* hint)
+{
+    (void)data;
+    static_cast<cISBridgeBuffer*>(hint)->Release();
+}
+
+/**
+ * Largest message copied into libzmq instead of referenced. libzmq stores messages
+ * this small inside zmq_msg_t itself, whereas zmq_msg_init_data() mallocs a
+ * reference-counted header for every message.
+ */
+static const size_t BRIDGE_ZMQ_INLINE_SIZE = 32;
 
 cISZmqTcpBridge::cISZmqTcpBridge()
     : m_zmqContext(nullptr)
-    , m_zmqRecvSocket(nullptr)
+    , m_context(nullptr)
     , m_zmqSendSocket(nullptr)
-    , m_tcpServer(nullptr)
     , m_zmqToTcpThread(nullptr)
-    , m_tcpToZmqThread(nullptr)
     , m_isRunning(false)
+    , m_injectsInFlight(0)
+    , m_busyPolling(false)
+    , m_threaded(false)
+    , m_zmqSendSignalled(false)
+    , m_bulkTokens(0)
+    , m_bulkRefillNs(0)
+    , m_batchDeadlineNs(0)
+    , m_zmqRecvPending(false)
+    , m_hasConsumers(false)
+    , m_merging(false)
+    , m_nextClientId(0)
+    , m_subscriptionsDirty(false)
     , m_tcpPort(0)
 {
+    m_releaseHandler = [this](cISBridgeBufferRef& buffer) { AppendBatch(buffer); };
 }
 
 cISZmqTcpBridge::~cISZmqTcpBridge()
@@ -38,118 +127,330 @@ cISZmqTcpBridge::~cISZmqTcpBridge()
 
 int cISZmqTcpBridge::Start(const std::string& zmqRecvEndpoint, const std::string& zmqSendEndpoint, int tcpPort)
 {
-    if (m_isRunning)
+    return Start(std::vector<std::string>(1, zmqRecvEndpoint), zmqSendEndpoint, tcpPort);
+}
+
+int cISZmqTcpBridge::Start(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort)
+{
+    if (OpenInternal(zmqRecvEndpoints, zmqSendEndpoint, tcpPort, NULL, std::max(1, m_options.tcpShards), m_options.handoffPath) != 0)
     {
-        std::cerr << "Bridge is already running" << std::endl;
         return -1;
     }
 
     try
     {
-        // Create ZMQ context
-        m_zmqContext = std::make_unique<zmq::context_t>(1);
+        if (StartThreads() == 0)
+        {
+            return 0;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error starting bridge threads: " << e.what() << std::endl;
+    }
 
-        // Create ZMQ receive socket (SUB) for receiving data from ZMQ publisher
-        m_zmqRecvSocket = std::make_unique<zmq::socket_t>(*m_zmqContext, zmq::socket_type::sub);
-        m_zmqRecvSocket->connect(zmqRecvEndpoint);
-        m_zmqRecvSocket->set(zmq::sockopt::subscribe, "");  // Subscribe to all messages
-        m_zmqRecvSocket->set(zmq::sockopt::rcvtimeo, 100);  // 100ms timeout for polling
+    // Ensure any partially initialized resources are cleaned up.
+    m_isRunning = false;
+    ReleaseResources("start failure");
+    return -1;
+}
 
-        // Create ZMQ send socket (PUB) for sending data to ZMQ subscriber
-        m_zmqSendSocket = std::make_unique<zmq::socket_t>(*m_zmqContext, zmq::socket_type::pub);
-        m_zmqSendSocket->connect(zmqSendEndpoint);
+int cISZmqTcpBridge::StartThreads()
+{
+    // Hosted bridges never busy-poll: their worker blocks in zmq_poll() and relies on
+    // the wakeup
+    m_busyPolling = m_options.busyPoll;
+    m_threaded = true;
 
-        // Create TCP server with this as the delegate to receive TCP data
-        m_tcpServer = std::make_unique<cISTcpServer>(this);
-        if (m_tcpServer->Open("", tcpPort) != 0)
+    // Fresh executors each time, so nothing a hand-off left behind runs again. Each
+    // service covers what its thread owns: the ZMQ sockets, or one shard's reactor.
+    m_zmqExecutor = std::make_unique<cISBridgePollExecutor>();
+    m_zmqService = std::make_unique<cISBridgeService>(*this, *m_zmqExecutor, cISBridgeService::kServiceZmq);
+    if (m_zmqService->Open() != 0)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < m_tcpShards.size(); i++)
+    {
+        sTcpShard& shard = *m_tcpShards[i];
+        shard.executor = std::make_unique<cISBridgePollExecutor>();
+        shard.service = std::make_unique<cISBridgeService>(*this, *shard.executor, static_cast<int>(i));
+        if (shard.service->Open() != 0)
         {
-            std::cerr << "Failed to open TCP server on port " << tcpPort << std::endl;
-            // Clean up ZMQ resources
-            m_zmqRecvSocket->close();
-            m_zmqSendSocket->close();
-            m_zmqRecvSocket.reset();
-            m_zmqSendSocket.reset();
-            m_zmqContext->close();
-            m_zmqContext.reset();
-            m_tcpServer.reset();
             return -1;
         }
+    }
 
-        // Store configuration
-        m_zmqRecvEndpoint = zmqRecvEndpoint;
-        m_zmqSendEndpoint = zmqSendEndpoint;
-        m_tcpPort = tcpPort;
+    m_zmqToTcpThread = std::make_unique<std::thread>(&cISZmqTcpBridge::ZmqToTcpForwardingThread, this);
+    for (size_t i = 0; i < m_tcpShards.size(); i++)
+    {
+        m_tcpShards[i]->thread = std::make_unique<std::thread>(&cISZmqTcpBridge::TcpToZmqForwardingThread, this, static_cast<int>(i));
+    }
+    return 0;
+}
 
-        // Set running flag before starting forwarding threads
-        m_isRunning = true;
+void cISZmqTcpBridge::JoinThreads()
+{
+    if (m_zmqToTcpThread && m_zmqToTcpThread->joinable())
+    {
+        m_zmqToTcpThread->join();
+    }
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        if (shard->thread && shard->thread->joinable())
+        {
+            shard->thread->join();
+        }
+        shard->thread.reset();
+        shard->service.reset();
+        shard->executor.reset();
+    }
+    m_zmqToTcpThread.reset();
+    m_zmqService.reset();
+    m_zmqExecutor.reset();
+    m_threaded = false;
+}
 
-        // Start forwarding threads
-        m_zmqToTcpThread = std::make_unique<std::thread>(&cISZmqTcpBridge::ZmqToTcpForwardingThread, this);
-        m_tcpToZmqThread = std::make_unique<std::thread>(&cISZmqTcpBridge::TcpToZmqForwardingThread, this);
+int cISZmqTcpBridge::Open(const std::string& zmqRecvEndpoint, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext)
+{
+    return Open(std::vector<std::string>(1, zmqRecvEndpoint), zmqSendEndpoint, tcpPort, sharedContext);
+}
 
-        std::cout << "ZMQ-to-TCP Bridge started:" << std::endl;
-        std::cout << "  ZMQ Recv: " << zmqRecvEndpoint << std::endl;
-        std::cout << "  ZMQ Send: " << zmqSendEndpoint << std::endl;
-        std::cout << "  TCP Port: " << tcpPort << std::endl;
+int cISZmqTcpBridge::Open(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort, zmq::context_t* sharedContext)
+{
+    // The host services one TCP descriptor from its own thread
+    return OpenInternal(zmqRecvEndpoints, zmqSendEndpoint, tcpPort, sharedContext, 1, "");
+}
 
-        return 0;
+int cISZmqTcpBridge::OpenInternal(const std::vector<std::string>& zmqRecvEndpoints, const std::string& zmqSendEndpoint, int tcpPort,
+                                  zmq::context_t* sharedContext, int shardCount, const std::string& handoffPath)
+{
+    if (m_isRunning)
+    {
+        std::cerr << "Bridge is already running" << std::endl;
+        return -1;
     }
-    catch (const zmq::error_t& e)
+    if (zmqRecvEndpoints.empty())
     {
-        std::cerr << "ZMQ error: " << e.what() << std::endl;
+        std::cerr << "No ZMQ receive endpoint" << std::endl;
+        return -1;
+    }
 
-        // Ensure any partially initialized resources are cleaned up.
-        m_isRunning = false;
+    try
+    {
+        // Create the wakeup used to interrupt zmq_poll() when stopping
+        if (m_zmqWakeup.Open() != 0)
+        {
+            std::cerr << "Failed to create bridge wakeup descriptor" << std::endl;
+            return -1;
+        }
+
+        m_batch.reserve(static_cast<size_t>(std::max(1, m_options.maxBatchMessages)));
+        m_nextClientId = 0;
+        m_lastValueCache.Configure(m_options.lastValueDids, m_options.lastValueMaxBytes);
+
+        if (!m_options.capturePath.empty() &&
+            m_capture.Open(m_options.capturePath, m_options.captureSegmentBytes, m_options.captureRingBytes) != 0)
+        {
+            std::cerr << "Failed to open capture " << m_options.capturePath << std::endl;
+            ReleaseResources("start failure");
+            return -1;
+        }
 
-        // Join any threads that may have been started.
-        if (m_zmqToTcpThread && m_zmqToTcpThread->joinable())
+        // Allocate buffer pools up front so forwarding never touches the heap
         {
-            m_zmqToTcpThread->join();
+            std::lock_guard<std::mutex> lock(m_resourcesMutex);
+            m_dataPool.reset(new cISBridgeBufferPool(m_options.poolBlockSize, m_options.poolBlockCount));
+            m_messagePool.reset(new cISBridgeBufferPool(0, m_options.poolMessageCount));
+            m_zmqSendQueue = std::make_unique<cISBridgeMpscQueue>(m_options.zmqSendQueueCapacity);
+            if (m_options.zmqControlLane)
+            {
+                m_zmqControlQueue = std::make_unique<cISBridgeMpscQueue>(m_options.zmqControlQueueCapacity);
+            }
         }
-        if (m_tcpToZmqThread && m_tcpToZmqThread->joinable())
+        m_zmqSendSignalled = false;
+        m_trace.reset();
+        if (m_options.traceSampleEvery > 0)
         {
-            m_tcpToZmqThread->join();
+            m_trace = std::make_unique<cISBridgeTraceRing>(m_options.traceRecords, m_options.traceSampleEvery);
         }
+        m_controlLatency.Reset();
+        m_bulkTokens = static_cast<int64_t>(m_options.bulkBytesPerTick);
+        m_bulkRefillNs = bridgeClockNs();
+        m_busyPolling = false;
+        m_threaded = false;
 
-        // Clean up resources similar to Stop(), but without relying on m_isRunning.
-        try
+        // Create ZMQ context, unless the host shares one across bridges
+        if (sharedContext)
+        {
+            m_context = sharedContext;
+        }
+        else
+        {
+            m_zmqContext = std::make_unique<zmq::context_t>(1);
+            m_context = m_zmqContext.get();
+        }
+
+        // Before taking over from a running bridge, watch each ZMQ socket until it has
+        // connected so data flows as soon as the old bridge lets go
+        std::vector<std::unique_ptr<zmq::socket_t>> monitors;
+        auto prepare = [&](zmq::socket_t& socket)
         {
-            if (m_tcpServer)
+            socket.set(zmq::sockopt::reconnect_ivl, m_options.zmqReconnectIvlMs);
+            socket.set(zmq::sockopt::reconnect_ivl_max, m_options.zmqReconnectIvlMaxMs);
+            if (handoffPath.empty())
+            {
+                return;
+            }
+            std::ostringstream address;
+            address << "inproc://isb-monitor-" << static_cast<const void*>(this) << "-" << monitors.size();
+            if (zmq_socket_monitor(socket.handle(), address.str().c_str(), ZMQ_EVENT_CONNECTED) == 0)
             {
-                m_tcpServer->Close();
-                m_tcpServer.reset();
+                monitors.push_back(std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::pair));
+                monitors.back()->connect(address.str());
             }
+        };
+
+        // Create a ZMQ receive socket (SUB) per publisher endpoint. A single socket
+        // connected to all of them would fair-queue them without saying which sent what.
+        // No receive timeout: the forwarding thread waits in zmq_poll() instead.
+        std::vector<std::unique_ptr<sZmqSource>> sources;
+        for (const std::string& endpoint : zmqRecvEndpoints)
+        {
+            std::unique_ptr<sZmqSource> source(new sZmqSource());
+            source->endpoint = endpoint;
+            source->framer.reset(new cISBridgePacketFramer(&m_zmqFramerCounters));
+            source->socket = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::sub);
+            prepare(*source->socket);
+            source->socket->connect(endpoint);
+            source->socket->set(zmq::sockopt::subscribe, "");  // Subscribe to all messages until clients filter
+            sources.push_back(std::move(source));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_resourcesMutex);
+            m_zmqSources.swap(sources);
+            m_reorder.Configure(static_cast<int>(m_zmqSources.size()), static_cast<uint64_t>(std::max(0, m_options.mergeWindowUs)) * 1000,
+                                m_options.mergeMaxMessages);
+        }
+        sources.clear();
+        m_merging = m_zmqSources.size() > 1 && m_options.zmqTimestampFrame && m_options.mergeWindowUs > 0;
+        m_zmqSubscriptions = sISBridgeDidSet();
+        m_subscriptionsDirty = false;
 
-            if (m_zmqRecvSocket)
+        // Create ZMQ send socket (PUB) for sending data to ZMQ subscriber
+        m_zmqSendSocket = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::pub);
+        prepare(*m_zmqSendSocket);
+        m_zmqSendSocket->connect(zmqSendEndpoint);
+
+        // Take the running bridge's TCP sockets instead of opening new ones
+        sISBridgeHandoffState handoff;
+        int handoffSocket = -1;
+        if (!handoffPath.empty())
+        {
+            int unconnected = waitForZmqConnections(monitors, m_options.handoffTimeoutMs);
+            for (std::unique_ptr<sZmqSource>& source : m_zmqSources)
             {
-                m_zmqRecvSocket->close();
-                m_zmqRecvSocket.reset();
+                zmq_socket_monitor(source->socket->handle(), NULL, 0);
             }
+            zmq_socket_monitor(m_zmqSendSocket->handle(), NULL, 0);
+            monitors.clear();
 
-            // Protect ZMQ send socket with mutex
+            handoffSocket = bridgeHandoffConnect(handoffPath);
+            if (handoffSocket >= 0)
             {
-                std::lock_guard<std::mutex> lock(m_zmqSendMutex);
-                if (m_zmqSendSocket)
+                if (unconnected > 0)
                 {
-                    m_zmqSendSocket->close();
-                    m_zmqSendSocket.reset();
+                    std::cerr << unconnected << " ZMQ socket(s) not connected after " << m_options.handoffTimeoutMs
+                              << " ms, taking over anyway" << std::endl;
+                }
+                if (bridgeHandoffReceive(handoffSocket, handoff, m_options.handoffTimeoutMs) != 0)
+                {
+                    std::cerr << "Failed to take over from the bridge at " << handoffPath << std::endl;
+                    bridgeHandoffClose(handoffSocket);
+                    ReleaseResources("start failure");
+                    return -1;
                 }
             }
+        }
 
-            if (m_zmqContext)
+        // Create a TCP reactor per shard with this as the delegate to receive TCP data.
+        // Shards listen on the same port; the first one's port is used for the rest so
+        // port 0 works too.
+        {
+            std::lock_guard<std::mutex> lock(m_resourcesMutex);
+            m_tcpShards.clear();
+        }
+        if (handoffSocket >= 0)
+        {
+            // The old bridge keeps its copies, and resumes with them, until acknowledged
+            size_t listenCount = handoff.listenSockets.size();
+            size_t clientCount = handoff.clients.size();
+            int result = TakeOver(tcpPort, shardCount, handoff);
+            if (result == 0 && bridgeHandoffAcknowledge(handoffSocket, listenCount, clientCount) != 0)
+            {
+                std::cerr << "Failed to acknowledge the hand-off, the old bridge keeps serving" << std::endl;
+                result = -1;
+            }
+            bridgeHandoffClose(handoffSocket);
+            if (result != 0)
+            {
+                ReleaseResources("start failure");
+                return -1;
+            }
+        }
+        else
+        {
+            int shardPort = tcpPort;
+            for (int i = 0; i < shardCount; i++)
             {
-                m_zmqContext->close();
-                m_zmqContext.reset();
+                cISBridgeTcpReactor& reactor = AddTcpShard(shardCount > 1);
+                if (reactor.Open("", shardPort) != 0)
+                {
+                    std::cerr << "Failed to open TCP server on port " << shardPort << std::endl;
+                    ReleaseResources("start failure");
+                    return -1;
+                }
+                shardPort = reactor.Port();
             }
         }
-        catch (const zmq::error_t& cleanupError)
+        if (m_tcpShards.size() > 1)
+        {
+            std::lock_guard<std::mutex> lock(m_resourcesMutex);
+            m_broadcastRing = std::make_unique<cISBridgeBroadcastRing>(m_options.shardRingMessages, static_cast<int>(m_tcpShards.size()));
+        }
+
+        // Store configuration
+        m_zmqSendEndpoint = zmqSendEndpoint;
+        m_tcpPort = m_tcpShards[0]->reactor->Port();
+
+        // Set running flag before starting forwarding
+        m_isRunning = true;
+
+        std::cout << "ZMQ-to-TCP Bridge started:" << std::endl;
+        for (const std::string& endpoint : zmqRecvEndpoints)
+        {
+            std::cout << "  ZMQ Recv: " << endpoint << std::endl;
+        }
+        if (m_merging)
+        {
+            std::cout << "  Merge window: " << m_options.mergeWindowUs << " us" << std::endl;
+        }
+        std::cout << "  ZMQ Send: " << zmqSendEndpoint << std::endl;
+        std::cout << "  TCP Port: " << m_tcpPort << std::endl;
+        if (m_tcpShards.size() > 1)
         {
-            std::cerr << "Error during cleanup after ZMQ error: " << cleanupError.what() << std::endl;
+            std::cout << "  TCP Shards: " << m_tcpShards.size() << std::endl;
         }
 
-        m_zmqToTcpThread.reset();
-        m_tcpToZmqThread.reset();
+        return 0;
+    }
+    catch (const zmq::error_t& e)
+    {
+        std::cerr << "ZMQ error: " << e.what() << std::endl;
 
+        // Ensure any partially initialized resources are cleaned up.
+        m_isRunning = false;
+        ReleaseResources("ZMQ error");
         return -1;
     }
     catch (const std::exception& e)
@@ -158,195 +459,1244 @@ int cISZmqTcpBridge::Start(const std::string& zmqRecvEndpoint, const std::string
 
         // Ensure any partially initialized resources are cleaned up.
         m_isRunning = false;
+        ReleaseResources("start failure");
+        return -1;
+    }
+}
+
+cISBridgeTcpReactor& cISZmqTcpBridge::AddTcpShard(bool reusePort)
+{
+    std::unique_ptr<sTcpShard> shard(new sTcpShard(this));
+    shard->reactor = std::make_unique<cISBridgeTcpReactor>(&shard->delegate);
+    shard->reactor->SetClientQueueLimits(m_options.clientQueue);
+    shard->reactor->SetClientRateLimits(m_options.clientRateLimits);
+    shard->reactor->SetBusyPoll(m_options.busyPoll ? m_options.busyPollUs : 0);
+    shard->reactor->SetBackend(m_options.tcpBackend);
+    shard->reactor->SetTxOptions(m_options.tx);
+    shard->reactor->SetReusePort(reusePort);
+    shard->reactor->SetTraceRing(m_trace.get());
+    shard->ringBatch.resize(static_cast<size_t>(std::max(1, m_options.maxBatchMessages)));
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    m_tcpShards.push_back(std::move(shard));
+    return *m_tcpShards.back()->reactor;
+}
 
-        // Join any threads that may have been started.
-        if (m_zmqToTcpThread && m_zmqToTcpThread->joinable())
+int cISZmqTcpBridge::TakeOver(int tcpPort, int shardCount, sISBridgeHandoffState& handoff)
+{
+    std::vector<is_socket_t> listenSockets;
+    listenSockets.swap(handoff.listenSockets);
+    int result = 0;
+    for (size_t i = 0; i < listenSockets.size(); i++)
+    {
+        if (result == 0 && i < static_cast<size_t>(shardCount))
         {
-            m_zmqToTcpThread->join();
+            // Takes ownership, also on failure
+            result = AddTcpShard(false).Open(listenSockets[i]);
         }
-        if (m_tcpToZmqThread && m_tcpToZmqThread->joinable())
+        else
         {
-            m_tcpToZmqThread->join();
+            // No shard for it: connections still in its accept queue are reset
+            bridgeSocketClose(listenSockets[i]);
         }
+    }
+    if (result != 0)
+    {
+        std::cerr << "Failed to serve the listening socket handed over: " << strerror(errno) << std::endl;
+        handoff.Close();
+        return -1;
+    }
 
-        // Clean up resources similar to Stop(), but without relying on m_isRunning.
-        try
-        {
-            if (m_tcpServer)
-            {
-                m_tcpServer->Close();
-                m_tcpServer.reset();
-            }
-
-            if (m_zmqRecvSocket)
-            {
-                m_zmqRecvSocket->close();
-                m_zmqRecvSocket.reset();
-            }
-
-            // Protect ZMQ send socket with mutex
-            {
-                std::lock_guard<std::mutex> lock(m_zmqSendMutex);
-                if (m_zmqSendSocket)
-                {
-                    m_zmqSendSocket->close();
-                    m_zmqSendSocket.reset();
-                }
-            }
-
-            if (m_zmqContext)
-            {
-                m_zmqContext->close();
-                m_zmqContext.reset();
-            }
-        }
-        catch (const zmq::error_t& cleanupError)
+    // Shards beyond the old bridge's can only join if its sockets have SO_REUSEPORT,
+    // i.e. it ran several shards too; otherwise run with fewer rather than drop clients
+    int port = m_tcpShards[0]->reactor->Port();
+    while (m_tcpShards.size() < static_cast<size_t>(shardCount))
+    {
+        if (AddTcpShard(true).Open("", port) != 0)
         {
-            std::cerr << "Error during cleanup after start failure: " << cleanupError.what() << std::endl;
+            std::lock_guard<std::mutex> lock(m_resourcesMutex);
+            m_tcpShards.pop_back();
+            std::cerr << "Cannot add TCP shards to the port handed over, running " << m_tcpShards.size() << std::endl;
+            break;
         }
+    }
+    if (tcpPort != 0 && port != tcpPort)
+    {
+        std::cerr << "Serving TCP port " << port << " handed over instead of " << tcpPort << std::endl;
+    }
 
-        m_zmqToTcpThread.reset();
-        m_tcpToZmqThread.reset();
-        return -1;
+    for (size_t i = 0; i < handoff.clients.size(); i++)
+    {
+        m_tcpShards[i % m_tcpShards.size()]->reactor->AdoptClient(handoff.clients[i].socket, handoff.clients[i].filter);
     }
+    std::cout << "Took over " << handoff.clients.size() << " TCP clients" << std::endl;
+    handoff.clients.clear();
+    return 0;
 }
 
-int cISZmqTcpBridge::Stop()
+int cISZmqTcpBridge::ServiceZmq()
 {
     if (!m_isRunning)
     {
         return 0;
     }
+    m_zmqWakeup.Drain();
+    return ForwardZmq();
+}
 
-    std::cout << "Stopping ZMQ-to-TCP Bridge..." << std::endl;
-
-    // Signal threads to stop
-    m_isRunning = false;
-
-    // Wait for threads to finish
-    if (m_zmqToTcpThread && m_zmqToTcpThread->joinable())
+int cISZmqTcpBridge::ServiceTcp(int shard)
+{
+    if (!m_isRunning || shard < 0 || static_cast<size_t>(shard) >= m_tcpShards.size())
     {
-        m_zmqToTcpThread->join();
+        return 0;
     }
-    if (m_tcpToZmqThread && m_tcpToZmqThread->joinable())
+    int events = ForwardTcp(shard, 0);
+
+    // With Start(), the ZMQ thread publishes; QueueToZmq() and MarkSubscriptionsDirty()
+    // have woken it. Otherwise both sockets are serviced from this thread, so apply
+    // subscription changes and publish what the TCP callbacks queued right away.
+    if (m_threaded)
     {
-        m_tcpToZmqThread->join();
+        return events;
     }
-
-    // Clean up resources
     try
     {
-        if (m_tcpServer)
-        {
-            m_tcpServer->Close();
-            m_tcpServer.reset();
-        }
-
-        if (m_zmqRecvSocket)
-        {
-            m_zmqRecvSocket->close();
-            m_zmqRecvSocket.reset();
-        }
-
-        // Protect ZMQ send socket with mutex since it may be accessed from callback
-        {
-            std::lock_guard<std::mutex> lock(m_zmqSendMutex);
-            if (m_zmqSendSocket)
-            {
-                m_zmqSendSocket->close();
-                m_zmqSendSocket.reset();
-            }
-        }
-
-        if (m_zmqContext)
-        {
-            m_zmqContext->close();
-            m_zmqContext.reset();
-        }
+        UpdateZmqSubscriptions();
+        DrainZmqSendQueue();
     }
     catch (const zmq::error_t& e)
     {
-        std::cerr << "Error during cleanup: " << e.what() << std::endl;
+        std::cerr << "ZMQ subscribe error: " << e.what() << std::endl;
     }
-
-    m_zmqToTcpThread.reset();
-    m_tcpToZmqThread.reset();
-
-    std::cout << "Bridge stopped" << std::endl;
-    return 0;
+    return events;
 }
 
-std::string cISZmqTcpBridge::GetStatus() const
+void* cISZmqTcpBridge::ZmqRecvHandle(int source) const
 {
-    if (m_isRunning)
+    if (source < 0 || static_cast<size_t>(source) >= m_zmqSources.size())
     {
-        return "Running";
+        return NULL;
     }
-    return "Stopped";
+    return m_zmqSources[source]->socket ? m_zmqSources[source]->socket->handle() : NULL;
 }
 
-void cISZmqTcpBridge::ZmqToTcpForwardingThread()
+is_socket_t cISZmqTcpBridge::ZmqRecvFd(int source) const
 {
-    while (m_isRunning)
+    void* handle = ZmqRecvHandle(source);
+    is_socket_t fd = -1;
+    size_t size = sizeof(fd);
+    if (handle == NULL || zmq_getsockopt(handle, ZMQ_FD, &fd, &size) != 0)
     {
-        try
-        {
-            // Receive from ZMQ (non-blocking with timeout)
-            zmq::message_t message;
-            zmq::recv_result_t result = m_zmqRecvSocket->recv(message, zmq::recv_flags::none);
-
-            if (result.has_value() && message.size() > 0)
-            {
-                // Forward to all connected TCP clients
-                if (m_tcpServer && m_tcpServer->IsOpen())
-                {
-                    m_tcpServer->Write(message.data(), static_cast<int>(message.size()));
-                }
-            }
-        }
-        catch (const zmq::error_t& e)
-        {
-            if (e.num() != EAGAIN && e.num() != EINTR)
-            {
-                std::cerr << "ZMQ receive error: " << e.what() << std::endl;
-            }
-            // Continue even on error (timeout is expected)
-        }
-
-        // Small sleep to prevent busy-waiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return -1;
     }
+    return fd;
 }
 
-void cISZmqTcpBridge::TcpToZmqForwardingThread()
+int cISZmqTcpBridge::ZmqTimeoutMs() const
 {
-    while (m_isRunning)
-    {
-        try
-        {
-            // Update TCP server to accept new connections and handle disconnections
-            if (m_tcpServer && m_tcpServer->IsOpen())
-            {
-                m_tcpServer->Update();
-            }
+    int64_t timeoutNs = ZmqTimeoutNs();
+    // zmq_poll() takes milliseconds; round up so the deadline has passed on wakeup
+    return (timeoutNs < 0) ? -1 : static_cast<int>((timeoutNs + 999999) / 1000000);
+}
 
-            // TCP → ZMQ forwarding is handled in the OnClientDataReceived callback,
-            // which is called by the TCP server when data is received from clients.
+int64_t cISZmqTcpBridge::ZmqTimeoutNs() const
+{
+    if (m_zmqRecvPending)
+    {
+        return 0;
+    }
+    uint64_t deadline = m_merging ? m_reorder.NextDeadlineNs() : 0;
+    if (m_batchDeadlineNs != 0 && (deadline == 0 || m_batchDeadlineNs < deadline))
+    {
+        deadline = m_batchDeadlineNs;
+    }
 
-            // Small sleep to prevent busy-waiting
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-        catch (const std::exception& e)
+    // Paced bulk that ran out of budget goes out on the next refill, which no socket
+    // event would report
+    if (m_options.bulkBytesPerTick > 0 && m_bulkTokens <= 0 && m_zmqSendQueue && m_zmqSendQueue->Size() > 0)
+    {
+        uint64_t refill = m_bulkRefillNs + static_cast<uint64_t>(m_options.bulkTickUs) * 1000;
+        if (deadline == 0 || refill < deadline)
         {
-            std::cerr << "TCP forwarding error: " << e.what() << std::endl;
+            deadline = refill;
         }
     }
+    if (deadline == 0)
+    {
+        return -1;
+    }
+    uint64_t now = bridgeClockNs();
+    return (deadline <= now) ? 0 : static_cast<int64_t>(deadline - now);
+}
+
+int cISZmqTcpBridge::TcpFd(int shard) const
+{
+    if (shard < 0 || static_cast<size_t>(shard) >= m_tcpShards.size())
+    {
+        return -1;
+    }
+    return m_tcpShards[shard]->reactor->Fd();
+}
+
+int cISZmqTcpBridge::TcpTimeoutMs(int shard) const
+{
+    if (shard < 0 || static_cast<size_t>(shard) >= m_tcpShards.size())
+    {
+        return -1;
+    }
+    return m_tcpShards[shard]->reactor->TimeoutMs();
+}
+
+is_socket_t cISZmqTcpBridge::WakeupFd() const
+{
+    return m_zmqWakeup.Fd();
+}
+
+int cISZmqTcpBridge::Stop()
+{
+    if (!m_isRunning)
+    {
+        return 0;
+    }
+
+    std::cout << "Stopping ZMQ-to-TCP Bridge..." << std::endl;
+
+    // Signal threads to stop and wake them out of their polls
+    m_isRunning = false;
+    m_zmqWakeup.Signal();
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        shard->reactor->Wakeup();
+    }
+
+    ReleaseResources("stop");
+
+    std::cout << "Bridge stopped" << std::endl;
+    return 0;
+}
+
+int cISZmqTcpBridge::HandOff(int socket)
+{
+    if (!m_isRunning || !m_zmqToTcpThread)
+    {
+        return -1;
+    }
+
+    std::cout << "Handing over to the new bridge..." << std::endl;
+
+    // Stop forwarding but keep every socket open
+    m_isRunning = false;
+    m_zmqWakeup.Signal();
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        shard->reactor->Wakeup();
+    }
+    JoinThreads();
+
+    // Whatever a client sends from here on stays in its socket for the new bridge. The
+    // reactors pause with every client intact, so a failed hand-off loses nothing.
+    sISBridgeHandoffState state;
+    int result = 0;
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        is_socket_t listenSocket;
+        std::vector<sISBridgeTcpHandoffClient> clients;
+        if (shard->reactor->HandOff(listenSocket, clients) != 0)
+        {
+            result = -1;
+        }
+        if (listenSocket >= 0)
+        {
+            state.listenSockets.push_back(listenSocket);
+        }
+        state.clients.insert(state.clients.end(), clients.begin(), clients.end());
+    }
+    if (result == 0)
+    {
+        result = bridgeHandoffSend(socket, state);
+    }
+    if (result == 0)
+    {
+        result = bridgeHandoffWaitAcknowledge(socket, state, m_options.handoffTimeoutMs);
+    }
+
+    // Our duplicates: the new bridge holds its own, or ours are served again
+    size_t handedOver = state.clients.size();
+    state.Close();
+
+    if (result == 0)
+    {
+        std::cout << "Handed over " << handedOver << " TCP clients" << std::endl;
+        ReleaseResources("hand-off");
+        return 0;
+    }
+
+    // Serve the same sockets again, with each client's framer, queue, rate limits and
+    // transmit state as they were
+    std::cerr << "Hand-off failed, resuming" << std::endl;
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        if (shard->reactor->Resume() != 0)
+        {
+            std::cerr << "Failed to resume TCP shard: " << strerror(errno) << std::endl;
+            ReleaseResources("hand-off failure");
+            return -1;
+        }
+    }
+    m_isRunning = true;
+    try
+    {
+        if (StartThreads() == 0)
+        {
+            return -1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error restarting bridge threads: " << e.what() << std::endl;
+    }
+    m_isRunning = false;
+    ReleaseResources("hand-off failure");
+    return -1;
+}
+
+void cISZmqTcpBridge::ReleaseResources(const char* context)
+{
+    // m_isRunning is already false, so no new Inject() gets through; let those past
+    // the check finish queuing (never blocks) before the queues go
+    while (m_injectsInFlight.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    // Wake and join any threads that may have been started; their executors go with them
+    m_zmqWakeup.Signal();
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        shard->reactor->Wakeup();
+    }
+    JoinThreads();
+
+    // A hosted bridge may still hold a partial batch
+    FlushBatch();
+
+    // Clean up resources. Statistics readers may be looking at them from other threads.
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    try
+    {
+        for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+        {
+            shard->reactor->Close();
+        }
+        m_tcpShards.clear();
+        m_broadcastRing.reset();
+
+        // Held packets reference received messages; drop them before their sockets
+        m_reorder.Clear();
+        for (std::unique_ptr<sZmqSource>& source : m_zmqSources)
+        {
+            if (source->socket)
+            {
+                source->socket->close();
+                source->socket.reset();
+            }
+        }
+
+        // Every producer has stopped: publish what clients sent last, then close
+        if (m_zmqSendSocket)
+        {
+            DrainZmqSendQueue(false);
+            m_zmqSendSocket->close();
+            m_zmqSendSocket.reset();
+        }
+
+        // A shared context belongs to the host
+        if (m_zmqContext)
+        {
+            m_zmqContext->close();
+            m_zmqContext.reset();
+        }
+        m_context = nullptr;
+    }
+    catch (const zmq::error_t& e)
+    {
+        std::cerr << "Error during cleanup (" << context << "): " << e.what() << std::endl;
+    }
+
+    // The bridge's own buffer references (client queues, batch) are gone now. libzmq
+    // drops its references when the context terminates, which for a shared context
+    // happens after Stop(), and consumers release theirs when they like; each pool is
+    // freed once its last buffer comes back.
+    m_batch.clear();
+    m_batchDeadlineNs = 0;
+    m_lastValueCache.Clear();
+    m_zmqSendQueue.reset();
+    m_zmqControlQueue.reset();
+    m_dataPool.reset();
+    m_messagePool.reset();
+    m_zmqWakeup.Close();
+
+    // Forwarding has stopped, so the writer can flush what is left
+    m_capture.Close();
+}
+
+std::string cISZmqTcpBridge::GetStatus() const
+{
+    if (!m_isRunning)
+    {
+        return "Stopped";
+    }
+
+    sISZmqTcpBridgeStats stats;
+    GetStats(stats);
+    std::ostringstream status;
+    status << "Running: " << stats.clients.size() << " clients"
+           << ", ZMQ->TCP " << stats.zmqRxMessages << " msgs"
+           << ", TCP->ZMQ " << stats.zmqTxMessages << " msgs"
+           << ", " << stats.tcp.droppedMessages << " dropped"
+           << ", p99 " << (stats.latency.p99Ns / 1000) << " us";
+    return status.str();
+}
+
+void cISZmqTcpBridge::GetStats(sISZmqTcpBridgeStats& stats) const
+{
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    stats = sISZmqTcpBridgeStats();
+    stats.running = m_isRunning;
+    stats.tcpPort = m_tcpPort;
+    stats.zmqRxMessages = m_counters.zmqRxMessages.load(std::memory_order_relaxed);
+    stats.zmqRxBytes = m_counters.zmqRxBytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < m_zmqSources.size(); i++)
+    {
+        sISBridgeZmqSourceStats source;
+        source.endpoint = m_zmqSources[i]->endpoint;
+        source.messages = m_zmqSources[i]->messages.load(std::memory_order_relaxed);
+        source.bytes = m_zmqSources[i]->bytes.load(std::memory_order_relaxed);
+        source.merge = m_reorder.GetSourceStats(static_cast<int>(i));
+        stats.zmqSources.push_back(source);
+    }
+    stats.merge = m_reorder.GetStats();
+    stats.zmqTxMessages = m_counters.zmqTxMessages.load(std::memory_order_relaxed);
+    stats.zmqTxBytes = m_counters.zmqTxBytes.load(std::memory_order_relaxed);
+    stats.zmqTxEagain = m_counters.zmqTxEagain.load(std::memory_order_relaxed);
+    stats.zmqTxErrors = m_counters.zmqTxErrors.load(std::memory_order_relaxed);
+    if (m_zmqSendQueue)
+    {
+        stats.zmqSendQueue = m_zmqSendQueue->GetStats();
+    }
+    if (m_zmqControlQueue)
+    {
+        stats.zmqControlQueue = m_zmqControlQueue->GetStats();
+    }
+    stats.zmqBulkDeferred = m_counters.zmqBulkDeferred.load(std::memory_order_relaxed);
+    stats.controlLatency = m_controlLatency.Stats();
+    if (m_tcpShards.size() == 1)
+    {
+        const cISBridgeTcpReactor& reactor = *m_tcpShards[0]->reactor;
+        stats.tcp = reactor.GetStats();
+        stats.latency = reactor.WriteLatency().Stats();
+    }
+    else if (!m_tcpShards.empty())
+    {
+        std::unique_ptr<cISBridgeHistogram> latency(new cISBridgeHistogram());
+        for (const std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+        {
+            sISBridgeTcpReactorStats tcp = shard->reactor->GetStats();
+            stats.tcp.accepts += tcp.accepts;
+            stats.tcp.disconnects += tcp.disconnects;
+            stats.tcp.reads += tcp.reads;
+            stats.tcp.bytesRead += tcp.bytesRead;
+            stats.tcp.writeCalls += tcp.writeCalls;
+            stats.tcp.messagesWritten += tcp.messagesWritten;
+            stats.tcp.bytesWritten += tcp.bytesWritten;
+            stats.tcp.writeBlocks += tcp.writeBlocks;
+            stats.tcp.droppedMessages += tcp.droppedMessages;
+            stats.tcp.rateSuppressed += tcp.rateSuppressed;
+            stats.tcp.conflatedMessages += tcp.conflatedMessages;
+            stats.tcp.txModeSwitches += tcp.txModeSwitches;
+            stats.tcp.txDeadlineFlushes += tcp.txDeadlineFlushes;
+            shard->reactor->WriteLatency().MergeInto(*latency);
+        }
+        stats.latency = latency->Stats();
+    }
+    if (!m_tcpShards.empty())
+    {
+        stats.tcpBackend = m_tcpShards[0]->reactor->Backend();
+        stats.tcpShards = static_cast<int>(m_tcpShards.size());
+        GetClientStatsLocked(stats.clients);
+    }
+    if (m_broadcastRing)
+    {
+        stats.shardRing = m_broadcastRing->GetStats();
+    }
+    stats.dataPool = m_dataPool ? m_dataPool->GetStats() : sISBridgeBufferPoolStats();
+    stats.messagePool = m_messagePool ? m_messagePool->GetStats() : sISBridgeBufferPoolStats();
+    GetFramerStats(stats.zmqFramer, stats.tcpFramer);
+    stats.capture = m_capture.GetStats();
+    stats.lastValueCache = m_lastValueCache.GetStats();
+}
+
+void cISZmqTcpBridge::FormatPrometheus(const std::vector<sISZmqTcpBridgeStats>& routes, std::string& out)
+{
+    struct sMetric
+    {
+        const char* name;
+        const char* type;
+        const char* help;
+        uint64_t (*value)(const sISZmqTcpBridgeStats&);
+    };
+    static const sMetric metrics[] = {
+        { "zmq_tcp_bridge_up", "gauge", "1 if the route is running",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.running ? 1 : 0; } },
+        { "zmq_tcp_bridge_clients", "gauge", "Connected TCP clients",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.clients.size(); } },
+        { "zmq_tcp_bridge_zmq_rx_messages_total", "counter", "Messages received from ZMQ",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqRxMessages; } },
+        { "zmq_tcp_bridge_zmq_rx_bytes_total", "counter", "Bytes received from ZMQ",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqRxBytes; } },
+        { "zmq_tcp_bridge_merge_held", "gauge", "Packets held to merge ZMQ endpoints in timestamp order",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.merge.held; } },
+        { "zmq_tcp_bridge_merge_deadline_releases_total", "counter", "Merged packets released by the window deadline rather than the watermarks",
+          [](const sISZmqTcpBridgeStats& s) { return s.merge.deadlineReleases; } },
+        { "zmq_tcp_bridge_tcp_tx_messages_total", "counter", "Messages written to TCP clients",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.messagesWritten; } },
+        { "zmq_tcp_bridge_tcp_tx_bytes_total", "counter", "Bytes written to TCP clients",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.bytesWritten; } },
+        { "zmq_tcp_bridge_tcp_write_blocked_total", "counter", "TCP writes that hit EAGAIN",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.writeBlocks; } },
+        { "zmq_tcp_bridge_tcp_dropped_messages_total", "counter", "Messages dropped by client queue policies",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.droppedMessages; } },
+        { "zmq_tcp_bridge_tcp_rate_suppressed_total", "counter", "ISB data packets withheld by client rate limits",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.rateSuppressed; } },
+        { "zmq_tcp_bridge_tcp_conflated_messages_total", "counter", "Queued packets replaced by a newer packet of the same data ID",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.conflatedMessages; } },
+        { "zmq_tcp_bridge_tcp_coalescing_clients", "gauge", "TCP clients the transmit scheduler currently coalesces",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t
+          {
+              return static_cast<uint64_t>(std::count_if(s.clients.begin(), s.clients.end(),
+                  [](const sISBridgeTcpClientStats& c) { return c.tx.mode == BRIDGE_TX_COALESCE; }));
+          } },
+        { "zmq_tcp_bridge_tcp_tx_mode_switches_total", "counter", "Transmit scheduler switches between immediate and coalescing writes",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.txModeSwitches; } },
+        { "zmq_tcp_bridge_tcp_tx_deadline_flushes_total", "counter", "Coalesced writes made at the flush deadline",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.txDeadlineFlushes; } },
+        { "zmq_tcp_bridge_shard_ring_dropped_total", "counter", "Messages not handed to the TCP shards because one was a full ring behind",
+          [](const sISZmqTcpBridgeStats& s) { return s.shardRing.dropped; } },
+        { "zmq_tcp_bridge_tcp_rx_bytes_total", "counter", "Bytes read from TCP clients",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.bytesRead; } },
+        { "zmq_tcp_bridge_tcp_accepts_total", "counter", "TCP client connections accepted",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.accepts; } },
+        { "zmq_tcp_bridge_tcp_disconnects_total", "counter", "TCP client disconnects",
+          [](const sISZmqTcpBridgeStats& s) { return s.tcp.disconnects; } },
+        { "zmq_tcp_bridge_zmq_tx_messages_total", "counter", "Messages published to ZMQ",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqTxMessages; } },
+        { "zmq_tcp_bridge_zmq_tx_bytes_total", "counter", "Bytes published to ZMQ",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqTxBytes; } },
+        { "zmq_tcp_bridge_zmq_tx_eagain_total", "counter", "ZMQ sends refused with EAGAIN",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqTxEagain; } },
+        { "zmq_tcp_bridge_zmq_tx_errors_total", "counter", "Other ZMQ send failures",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqTxErrors; } },
+        { "zmq_tcp_bridge_zmq_send_queue_depth", "gauge", "Messages waiting to be published to ZMQ",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.zmqSendQueue.queued; } },
+        { "zmq_tcp_bridge_zmq_send_queue_high_watermark", "gauge", "Most messages seen waiting to be published",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.zmqSendQueue.highWatermark; } },
+        { "zmq_tcp_bridge_zmq_send_queue_dropped_total", "counter", "Messages dropped because the ZMQ send queue was full",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqSendQueue.dropped; } },
+        { "zmq_tcp_bridge_zmq_control_queue_depth", "gauge", "Control packets waiting to be published to ZMQ",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.zmqControlQueue.queued; } },
+        { "zmq_tcp_bridge_zmq_control_queue_dropped_total", "counter", "Control packets dropped because the control queue was full",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqControlQueue.dropped; } },
+        { "zmq_tcp_bridge_zmq_bulk_deferred_total", "counter", "Drains that left bulk queued for the next pacing tick",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqBulkDeferred; } },
+        { "zmq_tcp_bridge_pool_heap_allocations_total", "counter", "Buffer pool heap fallbacks",
+          [](const sISZmqTcpBridgeStats& s) { return s.dataPool.heapAllocations + s.messagePool.heapAllocations; } },
+        { "zmq_tcp_bridge_framer_checksum_errors_total", "counter", "Frames dropped for a bad checksum",
+          [](const sISZmqTcpBridgeStats& s) { return s.zmqFramer.checksumErrors + s.tcpFramer.checksumErrors; } },
+        { "zmq_tcp_bridge_cache_entries", "gauge", "Data IDs held by the last-value cache",
+          [](const sISZmqTcpBridgeStats& s) -> uint64_t { return s.lastValueCache.entries; } },
+        { "zmq_tcp_bridge_cache_snapshot_messages_total", "counter", "Cached packets sent to new clients",
+          [](const sISZmqTcpBridgeStats& s) { return s.lastValueCache.snapshotMessages; } },
+        { "zmq_tcp_bridge_capture_records_total", "counter", "Records written to the capture",
+          [](const sISZmqTcpBridgeStats& s) { return s.capture.records; } },
+        { "zmq_tcp_bridge_capture_dropped_records_total", "counter", "Records the capture writer could not keep",
+          [](const sISZmqTcpBridgeStats& s) { return s.capture.droppedRecords; } },
+    };
+
+    for (const sMetric& metric : metrics)
+    {
+        out += std::string("# HELP ") + metric.name + " " + metric.help + "\n";
+        out += std::string("# TYPE ") + metric.name + " " + metric.type + "\n";
+        for (const sISZmqTcpBridgeStats& route : routes)
+        {
+            bridgeFormatPrometheusSample(metric.name, "route=\"" + std::to_string(route.tcpPort) + "\"", metric.value(route), out);
+        }
+    }
+
+    out += "# HELP zmq_tcp_bridge_zmq_source_watermark_ns Newest publisher timestamp received from each ZMQ endpoint\n";
+    out += "# TYPE zmq_tcp_bridge_zmq_source_watermark_ns gauge\n";
+    for (const sISZmqTcpBridgeStats& route : routes)
+    {
+        for (const sISBridgeZmqSourceStats& source : route.zmqSources)
+        {
+            bridgeFormatPrometheusSample("zmq_tcp_bridge_zmq_source_watermark_ns",
+                "route=\"" + std::to_string(route.tcpPort) + "\",endpoint=\"" + bridgePrometheusLabelValue(source.endpoint) + "\"", source.merge.watermarkNs, out);
+        }
+    }
+    out += "# HELP zmq_tcp_bridge_zmq_source_late_total Packets from each ZMQ endpoint that arrived behind the merged stream\n";
+    out += "# TYPE zmq_tcp_bridge_zmq_source_late_total counter\n";
+    for (const sISZmqTcpBridgeStats& route : routes)
+    {
+        for (const sISBridgeZmqSourceStats& source : route.zmqSources)
+        {
+            bridgeFormatPrometheusSample("zmq_tcp_bridge_zmq_source_late_total",
+                "route=\"" + std::to_string(route.tcpPort) + "\",endpoint=\"" + bridgePrometheusLabelValue(source.endpoint) + "\"", source.merge.lateMessages, out);
+        }
+    }
+
+    out += "# HELP zmq_tcp_bridge_latency_seconds ZMQ receive to TCP write completion\n";
+    out += "# TYPE zmq_tcp_bridge_latency_seconds summary\n";
+    for (const sISZmqTcpBridgeStats& route : routes)
+    {
+        bridgeFormatPrometheusSummary("zmq_tcp_bridge_latency_seconds", "route=\"" + std::to_string(route.tcpPort) + "\"", route.latency, out);
+    }
+
+    out += "# HELP zmq_tcp_bridge_control_latency_seconds TCP control packet queued to published on ZMQ\n";
+    out += "# TYPE zmq_tcp_bridge_control_latency_seconds summary\n";
+    for (const sISZmqTcpBridgeStats& route : routes)
+    {
+        bridgeFormatPrometheusSummary("zmq_tcp_bridge_control_latency_seconds", "route=\"" + std::to_string(route.tcpPort) + "\"", route.controlLatency, out);
+    }
+}
+
+void cISZmqTcpBridge::ZmqToTcpForwardingThread()
+{
+    bridgeApplyThreadProfile(m_options.zmqThread, "isb-zmq-to-tcp");
+    RunForwarding(*m_zmqExecutor, *m_zmqService);
+
+    // Stopping or handing off: a held batch still goes to the clients
+    FlushBatch();
+}
+
+void cISZmqTcpBridge::RunForwarding(cISBridgePollExecutor& executor, cISBridgeService& service)
+{
+    while (m_isRunning)
+    {
+        try
+        {
+            // Block until a socket has work, Stop() signals a wakeup or a merged
+            // packet, held batch or paced send is due. With busyPoll, spin instead:
+            // producers skip the wakeups, so service everything on every round.
+            if (m_busyPolling)
+            {
+                executor.RunOnce(0);
+                service.ServiceAll();
+            }
+            else
+            {
+                executor.RunOnce(-1);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Bridge forwarding error: " << e.what() << std::endl;
+        }
+    }
+}
+
+int cISZmqTcpBridge::ForwardZmq()
+{
+    try
+    {
+        UpdateZmqSubscriptions();
+        DrainZmqSendQueue();
+        return DrainZmqRecvSockets();
+    }
+    catch (const zmq::error_t& e)
+    {
+        if (e.num() != EAGAIN && e.num() != EINTR && e.num() != ETERM)
+        {
+            std::cerr << "ZMQ receive error: " << e.what() << std::endl;
+        }
+        return 0;
+    }
+}
+
+int cISZmqTcpBridge::DrainZmqRecvSockets()
+{
+    // A batch from each socket in turn, so no publisher starves the others, and what
+    // clients queued meanwhile goes out before the next round
+    int batch = std::max(1, m_options.maxBatchMessages);
+    int budget = std::max(1, m_options.zmqRecvBudget);
+    int count = 0;
+    bool more = true;
+    while (more && count < budget && m_isRunning)
+    {
+        if (count > 0)
+        {
+            DrainZmqSendQueue();
+        }
+        more = false;
+        for (size_t i = 0; i < m_zmqSources.size(); i++)
+        {
+            int received = DrainZmqRecvSocket(i, batch);
+            count += received;
+            more = more || received == batch;
+        }
+    }
+    m_zmqRecvPending = more && m_isRunning;
+    ReleaseMerged();
+
+    // A partial batch may wait for more messages to share its writes, but never in
+    // here: commands and the other sockets are serviced meanwhile
+    if (m_batchDeadlineNs == 0 || bridgeClockNs() >= m_batchDeadlineNs)
+    {
+        FlushBatch();
+    }
+    return count;
+}
+
+void cISZmqTcpBridge::ReleaseMerged()
+{
+    if (m_merging)
+    {
+        m_reorder.Release(bridgeClockNs(), m_releaseHandler);
+    }
+}
+
+int cISZmqTcpBridge::DrainZmqRecvSocket(size_t index, int maxMessages)
+{
+    sZmqSource& source = *m_zmqSources[index];
+    zmq::socket_t& socket = *source.socket;
+    int count = 0;
+
+    while (m_isRunning && count < maxMessages)
+    {
+        // Receive straight into a zmq_msg_t living inside a pooled buffer; every client
+        // queue then references that buffer, so the payload is never copied
+        cISBridgeBufferRef buffer = m_messagePool->Acquire(0);
+        if (!buffer)
+        {
+            break;
+        }
+        zmq_msg_t* msg = new (buffer->Storage()) zmq_msg_t;
+        zmq_msg_init(msg);
+        buffer->SetReleaseHook(closeZmqMessage);
+
+        if (zmq_msg_recv(msg, socket.handle(), ZMQ_DONTWAIT) < 0)
+        {
+            if (zmq_errno() != EAGAIN)
+            {
+                throw zmq::error_t();
+            }
+            break;
+        }
+        // Counted before anything is skipped, so empty messages use up the budget too
+        // and cannot keep the pass from yielding
+        count++;
+
+        // Skip the topic and timestamp frames; the packet is the last frame and the
+        // timestamp, when sent, the one right before it
+        int frames = 1;
+        uint64_t publisherNs = 0;
+        while ((!m_options.zmqDidTopicPrefix.empty() || m_options.zmqTimestampFrame) && zmq_msg_more(msg))
+        {
+            publisherNs = 0;
+            if (zmq_msg_size(msg) == sizeof(uint64_t))
+            {
+                const uint8_t* p = static_cast<const uint8_t*>(zmq_msg_data(msg));
+                for (int i = 7; i >= 0; i--)
+                {
+                    publisherNs = (publisherNs << 8) | p[i];
+                }
+            }
+            zmq_msg_close(msg);
+            zmq_msg_init(msg);
+            if (zmq_msg_recv(msg, socket.handle(), 0) < 0)
+            {
+                throw zmq::error_t();
+            }
+            frames++;
+        }
+        if (!m_options.zmqTimestampFrame || frames != (m_options.zmqDidTopicPrefix.empty() ? 2 : 3))
+        {
+            publisherNs = 0;
+        }
+
+        if (zmq_msg_size(msg) == 0)
+        {
+            continue;  // Skip empty frames
+        }
+        buffer->SetExternal(static_cast<uint8_t*>(zmq_msg_data(msg)), zmq_msg_size(msg));
+        buffer->SetTimestamp(bridgeClockNs());
+        BRIDGE_TRACE2(zmq_receive, index, buffer->Size());
+        if (m_capture.IsOpen())
+        {
+            m_capture.Record(BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, buffer->Data(), buffer->Size(), buffer->Timestamp());
+        }
+        bridgeCounterAdd(m_counters.zmqRxMessages, 1);
+        bridgeCounterAdd(m_counters.zmqRxBytes, buffer->Size());
+        bridgeCounterAdd(source.messages, 1);
+        bridgeCounterAdd(source.bytes, buffer->Size());
+        BatchMessage(index, publisherNs, buffer);
+    }
+    return count;
+}
+
+void cISZmqTcpBridge::BatchMessage(size_t source, uint64_t publisherNs, cISBridgeBufferRef& buffer)
+{
+    if (!m_options.frameZmqToTcp && !m_options.filterByDid && !m_options.lastValueCache &&
+        !m_options.clientQueue.conflate && m_options.clientRateLimits.Empty())
+    {
+        ForwardPacket(source, publisherNs, buffer);
+        return;
+    }
+
+    const uint8_t* begin = buffer->Data();
+    const uint8_t* end = begin + buffer->Size();
+    m_zmqSources[source]->framer->Feed(begin, buffer->Size(), [&](const sISBridgePacket& packet)
+    {
+        cISBridgeBufferRef out;
+        if (packet.data >= begin && packet.data + packet.size <= end)
+        {
+            // Packet lies inside the message: reference it in place
+            out = m_messagePool->Slice(buffer, static_cast<size_t>(packet.data - begin), packet.size);
+        }
+        else
+        {
+            // Reassembled across messages: copy out of the framer
+            out = m_dataPool->Acquire(packet.size);
+            if (out)
+            {
+                memcpy(out->Data(), packet.data, packet.size);
+                out->SetSize(packet.size);
+            }
+        }
+        if (!out)
+        {
+            return;
+        }
+        out->SetPacketInfo(static_cast<uint8_t>(packet.protocol), packet.type, packet.id);
+        out->SetTimestamp(buffer->Timestamp());
+        ForwardPacket(source, publisherNs, out);
+    });
+}
+
+void cISZmqTcpBridge::ForwardPacket(size_t source, uint64_t publisherNs, cISBridgeBufferRef& buffer)
+{
+    if (m_merging && publisherNs != 0)
+    {
+        m_reorder.Push(static_cast<int>(source), publisherNs, buffer->Timestamp(), buffer, m_releaseHandler);
+        return;
+    }
+    AppendBatch(buffer);
+}
+
+void cISZmqTcpBridge::AppendBatch(cISBridgeBufferRef& buffer)
+{
+    if (m_options.lastValueCache)
+    {
+        // Before the broadcast, so a client accepted meanwhile never gets an older value after this one
+        m_lastValueCache.Update(*buffer.Get());
+    }
+    if (m_trace && m_trace->Sample())
+    {
+        uint64_t id = m_trace->Begin(false, *buffer.Get());
+        m_trace->Stamp(id, BRIDGE_TRACE_ZMQ_RECEIVED, buffer->Timestamp());
+        m_trace->Stamp(id, BRIDGE_TRACE_BATCHED, bridgeClockNs());
+    }
+    if (m_batch.empty() && m_options.maxBatchHoldUs > 0)
+    {
+        // Each partial batch gets its own hold time
+        m_batchDeadlineNs = bridgeClockNs() + static_cast<uint64_t>(m_options.maxBatchHoldUs) * 1000;
+    }
+    m_batch.push_back(std::move(buffer));
+    if (m_batch.size() >= static_cast<size_t>(std::max(1, m_options.maxBatchMessages)))
+    {
+        FlushBatch();
+    }
+}
+
+void cISZmqTcpBridge::FlushBatch()
+{
+    if (m_batch.empty())
+    {
+        return;
+    }
+    BRIDGE_TRACE1(batch_flush, m_batch.size());
+
+    if (m_hasConsumers.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(m_consumersMutex);
+        for (iISBridgeConsumer* consumer : m_consumers)
+        {
+            consumer->OnBridgeMessages(m_batch.data(), static_cast<int>(m_batch.size()));
+        }
+    }
+    if (m_trace)
+    {
+        // Before the fan-out, which may already complete writes
+        uint64_t now = bridgeClockNs();
+        for (const cISBridgeBufferRef& buffer : m_batch)
+        {
+            m_trace->Stamp(buffer->TraceId(), BRIDGE_TRACE_FANOUT, now);
+        }
+    }
+
+    // Fan out to every client's send queue; slow clients keep their backlog without
+    // delaying the others
+    if (m_broadcastRing)
+    {
+        // Each shard writes to its own clients. A shard already signalled has not
+        // drained yet and will see these too.
+        m_broadcastRing->Publish(m_batch.data(), static_cast<int>(m_batch.size()));
+        for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+        {
+            if (!shard->ringSignalled.exchange(true) && !m_busyPolling)
+            {
+                shard->reactor->Wakeup();
+            }
+        }
+    }
+    else if (!m_tcpShards.empty() && m_tcpShards[0]->reactor->IsOpen())
+    {
+        m_tcpShards[0]->reactor->Broadcast(m_batch.data(), static_cast<int>(m_batch.size()));
+    }
+    m_batch.clear();
+    m_batchDeadlineNs = 0;
+}
+
+int cISZmqTcpBridge::AddConsumer(iISBridgeConsumer* consumer)
+{
+    if (consumer == nullptr)
+    {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_consumersMutex);
+    if (std::find(m_consumers.begin(), m_consumers.end(), consumer) != m_consumers.end())
+    {
+        return -1;
+    }
+
+    if (m_options.lastValueCache)
+    {
+        // Under the lock, like a TCP client's snapshot under the client list lock: the
+        // cache is updated before each batch is dispatched, so no live message can
+        // arrive ahead of an older cached one
+        std::vector<cISBridgeBufferRef> snapshot;
+        m_lastValueCache.Snapshot(snapshot);
+        if (!snapshot.empty())
+        {
+            consumer->OnBridgeMessages(snapshot.data(), static_cast<int>(snapshot.size()));
+        }
+    }
+
+    m_consumers.push_back(consumer);
+    m_hasConsumers = true;
+    return 0;
+}
+
+int cISZmqTcpBridge::RemoveConsumer(iISBridgeConsumer* consumer)
+{
+    std::lock_guard<std::mutex> lock(m_consumersMutex);
+    auto it = std::find(m_consumers.begin(), m_consumers.end(), consumer);
+    if (it == m_consumers.end())
+    {
+        return -1;
+    }
+    m_consumers.erase(it);
+    m_hasConsumers = !m_consumers.empty();
+    return 0;
+}
+
+int cISZmqTcpBridge::Inject(const uint8_t* data, size_t size, eISBridgeZmqLane lane)
+{
+    if (data == nullptr || size == 0)
+    {
+        return -1;
+    }
+
+    // Announce the call before checking m_isRunning. Stop() clears m_isRunning before
+    // ReleaseResources() waits for the count, so either this call sees the bridge
+    // stopped or the queues outlive it (both sequentially consistent).
+    m_injectsInFlight.fetch_add(1);
+    if (!m_isRunning)
+    {
+        m_injectsInFlight.fetch_sub(1);
+        return -1;
+    }
+
+    // Client 0 in a capture is the embedding process
+    if (m_capture.IsOpen())
+    {
+        CaptureTcp(BRIDGE_CAPTURE_TCP_TO_ZMQ, 0, data, size);
+    }
+    int result = QueueToZmq(data, size, lane);
+    m_injectsInFlight.fetch_sub(1);
+    return result;
+}
+
+int cISZmqTcpBridge::SetClientRateLimits(is_socket_t socket, const sISBridgeRateLimits& limits)
+{
+    if (!m_isRunning)
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    // The shard that accepted the client knows it
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        if (shard->reactor->SetClientRateLimits(socket, limits) == 0)
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int cISZmqTcpBridge::SetClientConflate(is_socket_t socket, bool conflate)
+{
+    if (!m_isRunning)
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        if (shard->reactor->SetClientConflate(socket, conflate) == 0)
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int cISZmqTcpBridge::WriteTcpClients(const uint8_t* data, int dataLength)
+{
+    if (!m_isRunning)
+    {
+        return -1;
+    }
+    if (data == NULL || dataLength <= 0)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    if (!m_dataPool)
+    {
+        return -1;
+    }
+
+    // One pooled copy shared by every shard's clients
+    cISBridgeBufferRef buffer = m_dataPool->Acquire(static_cast<size_t>(dataLength));
+    if (!buffer)
+    {
+        return 0;
+    }
+    memcpy(buffer->Data(), data, static_cast<size_t>(dataLength));
+    buffer->SetSize(static_cast<size_t>(dataLength));
+
+    int queued = 0;
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        queued += shard->reactor->Broadcast(&buffer, 1);
+    }
+    return queued;
+}
+
+void cISZmqTcpBridge::GetBufferPoolStats(sISBridgeBufferPoolStats& dataPool, sISBridgeBufferPoolStats& messagePool) const
+{
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    dataPool = m_dataPool ? m_dataPool->GetStats() : sISBridgeBufferPoolStats();
+    messagePool = m_messagePool ? m_messagePool->GetStats() : sISBridgeBufferPoolStats();
+}
+
+void cISZmqTcpBridge::GetFramerStats(sISBridgeFramerStats& zmqToTcp, sISBridgeFramerStats& tcpToZmq) const
+{
+    zmqToTcp = m_zmqFramerCounters.Snapshot();
+    tcpToZmq = m_tcpFramerCounters.Snapshot();
+}
+
+int cISZmqTcpBridge::GetTraceRecords(std::vector<sISBridgeTraceRecord>& records) const
+{
+    records.clear();
+    if (!m_trace)
+    {
+        return -1;
+    }
+    m_trace->Snapshot(records);
+    return 0;
+}
+
+void cISZmqTcpBridge::GetClientStats(std::vector<sISBridgeTcpClientStats>& stats) const
+{
+    std::lock_guard<std::mutex> lock(m_resourcesMutex);
+    GetClientStatsLocked(stats);
+}
+
+void cISZmqTcpBridge::GetClientStatsLocked(std::vector<sISBridgeTcpClientStats>& stats) const
+{
+    stats.clear();
+    std::vector<sISBridgeTcpClientStats> shardStats;
+    for (const std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        shard->reactor->GetClientStats(shardStats);
+        stats.insert(stats.end(), shardStats.begin(), shardStats.end());
+    }
+}
+
+void cISZmqTcpBridge::TcpToZmqForwardingThread(int shardIndex)
+{
+    // Shards scale across cores: shard i goes to the next CPU after shard i - 1
+    sISBridgeThreadProfile profile = m_options.tcpThread;
+    if (profile.cpu >= 0)
+    {
+        profile.cpu += shardIndex;
+    }
+    char name[16];
+    snprintf(name, sizeof(name), (m_tcpShards.size() > 1) ? "isb-tcp-%d" : "isb-tcp-to-zmq", shardIndex);
+    bridgeApplyThreadProfile(profile, name);
+    sTcpShard& shard = *m_tcpShards[shardIndex];
+    RunForwarding(*shard.executor, *shard.service);
+}
+
+int cISZmqTcpBridge::ForwardTcp(int shardIndex, int timeoutMs)
+{
+    // TCP → ZMQ forwarding happens in the OnClientDataReceived callback
+    sTcpShard& shard = *m_tcpShards[shardIndex];
+    int events = shard.reactor->Run(timeoutMs);
+    if (events < 0 || !m_broadcastRing)
+    {
+        return events;
+    }
+
+    // Cleared before reading so a publish after the last read signals again
+    shard.ringSignalled.store(false);
+    std::vector<cISBridgeBufferRef>& batch = shard.ringBatch;
+    int count;
+    while ((count = m_broadcastRing->Read(shardIndex, batch.data(), static_cast<int>(batch.size()))) > 0)
+    {
+        shard.reactor->Broadcast(batch.data(), count);
+        for (int i = 0; i < count; i++)
+        {
+            batch[i].Reset();
+        }
+    }
+    return events;
+}
+
+// Out of line: the executor and service are incomplete types in the header
+cISZmqTcpBridge::sTcpShard::sTcpShard(cISZmqTcpBridge* bridge)
+    : delegate(bridge, this)
+{
+}
+
+cISZmqTcpBridge::sTcpShard::~sTcpShard() = default;
+
+thread_local cISZmqTcpBridge::sTcpShard* cISZmqTcpBridge::s_dispatchShard = NULL;
+
+void cISZmqTcpBridge::cShardDelegate::OnClientConnected(cISBridgeTcpReactor* reactor, is_socket_t socket)
+{
+    (void)reactor;
+    sTcpShard* previous = s_dispatchShard;
+    s_dispatchShard = m_shard;
+    m_bridge->OnClientConnecting(NULL);
+    m_bridge->OnClientConnected(NULL, socket);
+    s_dispatchShard = previous;
+}
+
+void cISZmqTcpBridge::cShardDelegate::OnClientConnectFailed(cISBridgeTcpReactor* reactor)
+{
+    (void)reactor;
+    sTcpShard* previous = s_dispatchShard;
+    s_dispatchShard = m_shard;
+    m_bridge->OnClientConnectFailed(NULL);
+    s_dispatchShard = previous;
+}
+
+void cISZmqTcpBridge::cShardDelegate::OnClientAccepting(cISBridgeTcpReactor* reactor, is_socket_t socket, std::vector<cISBridgeBufferRef>& initial)
+{
+    (void)reactor;
+    (void)socket;
+    m_bridge->QueueSnapshot(initial);
+}
+
+void cISZmqTcpBridge::cShardDelegate::OnClientDataReceived(cISBridgeTcpReactor* reactor, is_socket_t socket, uint8_t* data, int dataLength)
+{
+    (void)reactor;
+    sTcpShard* previous = s_dispatchShard;
+    s_dispatchShard = m_shard;
+    m_bridge->OnClientDataReceived(NULL, socket, data, dataLength);
+    s_dispatchShard = previous;
+}
+
+void cISZmqTcpBridge::cShardDelegate::OnClientDisconnected(cISBridgeTcpReactor* reactor, is_socket_t socket)
+{
+    (void)reactor;
+    sTcpShard* previous = s_dispatchShard;
+    s_dispatchShard = m_shard;
+    m_bridge->OnClientDisconnected(NULL, socket);
+    s_dispatchShard = previous;
+}
+
+cISZmqTcpBridge::sTcpShard& cISZmqTcpBridge::DispatchShard()
+{
+    return s_dispatchShard ? *s_dispatchShard : *m_tcpShards[0];
+}
+
+void cISZmqTcpBridge::OnClientConnected(cISTcpServer* server, is_socket_t socket)
+{
+    (void)server;
+    sTcpShard& shard = DispatchShard();
+    shard.clientIds[socket] = ++m_nextClientId;
+    CaptureClient(shard, BRIDGE_CAPTURE_CLIENT_CONNECT, socket, NULL, 0);
+
+    if (m_options.frameTcpToZmq || m_options.zmqControlLane || m_options.filterByDid)
+    {
+        shard.clientFramers[socket] = std::make_unique<cISBridgePacketFramer>(&m_tcpFramerCounters);
+    }
+
+    // A new client is unfiltered until it sends get-data
+    MarkSubscriptionsDirty();
+}
+
+void cISZmqTcpBridge::QueueSnapshot(std::vector<cISBridgeBufferRef>& initial)
+{
+    if (m_options.lastValueCache)
+    {
+        m_lastValueCache.Snapshot(initial);
+    }
+}
+
+void cISZmqTcpBridge::OnClientDisconnected(cISTcpServer* server, is_socket_t socket)
+{
+    (void)server;
+    sTcpShard& shard = DispatchShard();
+    CaptureClient(shard, BRIDGE_CAPTURE_CLIENT_DISCONNECT, socket, NULL, 0);
+    shard.clientIds.erase(socket);
+    shard.clientFramers.erase(socket);
+    MarkSubscriptionsDirty();
+}
+
+void cISZmqTcpBridge::CaptureClient(sTcpShard& shard, eISBridgeCaptureDirection direction, is_socket_t socket, const uint8_t* data, size_t size)
+{
+    if (!m_capture.IsOpen())
+    {
+        return;
+    }
+    auto id = shard.clientIds.find(socket);
+    CaptureTcp(direction, (id != shard.clientIds.end()) ? id->second : 0, data, size);
+}
+
+void cISZmqTcpBridge::CaptureTcp(eISBridgeCaptureDirection direction, uint32_t clientId, const uint8_t* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_captureTcpMutex);
+    m_capture.Record(direction, clientId, data, size, bridgeClockNs());
 }
 
 void cISZmqTcpBridge::OnClientDataReceived(cISTcpServer* server, is_socket_t socket, uint8_t* data, int dataLength)
 {
     (void)server;
-    (void)socket;
 
     // Check if bridge is still running before forwarding
     if (!m_isRunning)
@@ -354,28 +1704,324 @@ void cISZmqTcpBridge::OnClientDataReceived(cISTcpServer* server, is_socket_t soc
         return;
     }
 
-    try
+    // Forward TCP client data to ZMQ send socket
+    // Validate data parameters before forwarding
+    if (data != nullptr && dataLength > 0)
+    {
+        sTcpShard& shard = DispatchShard();
+        CaptureClient(shard, BRIDGE_CAPTURE_TCP_TO_ZMQ, socket, data, static_cast<size_t>(dataLength));
+
+        // ZMQ sockets are not thread-safe: queue for the thread that owns the send socket
+        auto framer = shard.clientFramers.find(socket);
+        if (framer == shard.clientFramers.end())
+        {
+            QueueToZmq(data, static_cast<size_t>(dataLength));
+            return;
+        }
+
+        // Watch the client's get-data / stop-broadcast commands for its subscription
+        cISBridgeDidFilter* filter = m_options.filterByDid ? shard.reactor->ClientFilter(socket) : NULL;
+        bool framed = m_options.frameTcpToZmq || m_options.zmqControlLane;
+        if (!framed)
+        {
+            QueueToZmq(data, static_cast<size_t>(dataLength));
+        }
+        framer->second->Feed(data, static_cast<size_t>(dataLength), [&](const sISBridgePacket& packet)
+        {
+            if (filter && filter->ApplyCommand(packet))
+            {
+                MarkSubscriptionsDirty();
+            }
+            if (framed)
+            {
+                // One ZMQ message per whole packet, however the client's writes were split
+                eISBridgeZmqLane lane = IsControlPacket(packet, m_options.controlMaxBytes) ? BRIDGE_ZMQ_LANE_CONTROL : BRIDGE_ZMQ_LANE_BULK;
+                QueueToZmq(packet.data, packet.size, lane);
+            }
+        });
+    }
+}
+
+void cISZmqTcpBridge::MarkSubscriptionsDirty()
+{
+    if (m_options.zmqDidTopicPrefix.empty() || !m_options.filterByDid)
+    {
+        return;
+    }
+    m_subscriptionsDirty = true;
+    m_zmqWakeup.Signal();
+}
+
+void cISZmqTcpBridge::UpdateZmqSubscriptions()
+{
+    if (!m_subscriptionsDirty.exchange(false) || m_tcpShards.empty() || m_zmqSources.empty() || !m_zmqSources[0]->socket)
+    {
+        return;
+    }
+
+    // Union over the shards; everything while no shard has a client
+    std::vector<cISBridgeTcpReactor*> reactors;
+    reactors.reserve(m_tcpShards.size());
+    for (std::unique_ptr<sTcpShard>& shard : m_tcpShards)
+    {
+        reactors.push_back(shard->reactor.get());
+    }
+    sISBridgeDidSet wanted;
+    cISBridgeTcpReactor::GetSubscriptions(reactors.data(), reactors.size(), wanted);
+    if (wanted == m_zmqSubscriptions)
+    {
+        return;
+    }
+
+    const std::string& prefix = m_options.zmqDidTopicPrefix;
+    auto didTopic = [&prefix](int did) { return prefix + static_cast<char>(did); };
+    auto subscribe = [this](const std::string& topic)
+    {
+        for (std::unique_ptr<sZmqSource>& source : m_zmqSources)
+        {
+            source->socket->set(zmq::sockopt::subscribe, topic);
+        }
+    };
+    auto unsubscribe = [this](const std::string& topic)
+    {
+        for (std::unique_ptr<sZmqSource>& source : m_zmqSources)
+        {
+            source->socket->set(zmq::sockopt::unsubscribe, topic);
+        }
+    };
+
+    // Subscribe to new topics before dropping old ones so wanted data is never missed
+    if (wanted.all)
+    {
+        subscribe("");
+    }
+    else
+    {
+        if (m_zmqSubscriptions.all)
+        {
+            for (const std::string& topic : m_options.zmqPassTopics)
+            {
+                subscribe(topic);
+            }
+        }
+        for (int did = 0; did < 256; did++)
+        {
+            if (wanted.Contains(static_cast<uint8_t>(did)) && (m_zmqSubscriptions.all || !m_zmqSubscriptions.Contains(static_cast<uint8_t>(did))))
+            {
+                subscribe(didTopic(did));
+            }
+        }
+    }
+
+    if (m_zmqSubscriptions.all)
     {
-        // Forward TCP client data to ZMQ send socket
-        // Validate data parameters before forwarding
-        if (data != nullptr && dataLength > 0)
+        unsubscribe("");
+    }
+    else
+    {
+        for (int did = 0; did < 256; did++)
+        {
+            if (m_zmqSubscriptions.Contains(static_cast<uint8_t>(did)) && (wanted.all || !wanted.Contains(static_cast<uint8_t>(did))))
+            {
+                unsubscribe(didTopic(did));
+            }
+        }
+        if (wanted.all)
         {
-            // Lock mutex to protect ZMQ socket access (ZMQ sockets are not thread-safe)
-            std::lock_guard<std::mutex> lock(m_zmqSendMutex);
-            
-            // Check again after acquiring lock in case Stop() was called
-            if (m_zmqSendSocket && m_isRunning)
+            for (const std::string& topic : m_options.zmqPassTopics)
             {
-                zmq::message_t message(data, dataLength);
-                m_zmqSendSocket->send(message, zmq::send_flags::dontwait);
+                unsubscribe(topic);
             }
         }
     }
-    catch (const zmq::error_t& e)
+
+    m_zmqSubscriptions = wanted;
+}
+
+bool cISZmqTcpBridge::IsControlPacket(const sISBridgePacket& packet, size_t maxBytes)
+{
+    if (packet.size > maxBytes)
+    {
+        return false;
+    }
+    switch (packet.protocol)
+    {
+    case BRIDGE_PROTOCOL_ISB:
+        // Get-data, set-data, stop-broadcast and acks; DATA carries bulk payloads
+        // such as firmware chunks
+        return packet.type != BRIDGE_ISB_PKT_TYPE_DATA;
+    case BRIDGE_PROTOCOL_NMEA:
+        // $ASCB, $STPB and friends
+        return true;
+    default:
+        // RTCM3 and UBX are correction streams
+        return false;
+    }
+}
+
+int cISZmqTcpBridge::QueueToZmq(const uint8_t* data, size_t size, eISBridgeZmqLane lane)
+{
+    // Copy into a pooled buffer; it is later handed to libzmq without another copy
+    cISBridgeBufferRef buffer = m_dataPool->Acquire(size);
+    if (!buffer)
+    {
+        bridgeCounterAdd(m_counters.zmqTxErrors, 1);
+        return -1;
+    }
+    memcpy(buffer->Data(), data, size);
+    buffer->SetSize(size);
+    if (m_trace && m_trace->Sample())
+    {
+        m_trace->Stamp(m_trace->Begin(true, *buffer.Get()), BRIDGE_TRACE_ZMQ_QUEUED, bridgeClockNs());
+    }
+
+    cISBridgeMpscQueue* queue = m_zmqSendQueue.get();
+    if (lane == BRIDGE_ZMQ_LANE_CONTROL && m_zmqControlQueue)
     {
-        if (e.num() != EAGAIN)
+        buffer->SetTimestamp(bridgeClockNs());
+        queue = m_zmqControlQueue.get();
+    }
+    if (!queue->Push(buffer))
+    {
+        return -1;      // Full; counted by the queue
+    }
+    BRIDGE_TRACE2(zmq_queue, size, lane);
+
+    // Only the first message after a drain needs to wake the owning thread, and a
+    // busy-polling thread needs no wakeup at all
+    if (!m_busyPolling && !m_zmqSendSignalled.exchange(true, std::memory_order_acq_rel))
+    {
+        m_zmqWakeup.Signal();
+    }
+    return 0;
+}
+
+int cISZmqTcpBridge::DrainZmqSendQueue(bool paced)
+{
+    if (!m_zmqSendQueue)
+    {
+        return 0;
+    }
+
+    // Clear the flag before draining: a message queued after this point either is
+    // drained below or signals again
+    m_zmqSendSignalled.exchange(false, std::memory_order_acq_rel);
+
+    int count = DrainZmqControlQueue();
+
+    // Token bucket for bulk: refill once per tick, never beyond one tick's budget, so an
+    // idle period does not turn into a burst that delays the next command
+    paced = paced && m_options.bulkBytesPerTick > 0;
+    if (paced)
+    {
+        uint64_t now = bridgeClockNs();
+        uint64_t tickNs = static_cast<uint64_t>(m_options.bulkTickUs) * 1000;
+        if (now - m_bulkRefillNs >= tickNs)
+        {
+            m_bulkTokens = static_cast<int64_t>(m_options.bulkBytesPerTick);
+            m_bulkRefillNs = now;
+        }
+    }
+
+    cISBridgeBufferRef buffer;
+    while ((!paced || m_bulkTokens > 0) && m_zmqSendQueue->Pop(buffer))
+    {
+        if (paced)
+        {
+            m_bulkTokens -= static_cast<int64_t>(buffer->Size());
+        }
+        if (m_zmqSendSocket)
+        {
+            SendToZmq(buffer);
+        }
+        buffer.Reset();
+        count++;
+
+        // A command that arrived meanwhile waits for one bulk message at most
+        if (m_zmqControlQueue && m_zmqControlQueue->Size() > 0)
+        {
+            count += DrainZmqControlQueue();
+        }
+    }
+    if (paced && m_bulkTokens <= 0 && m_zmqSendQueue->Size() > 0)
+    {
+        bridgeCounterAdd(m_counters.zmqBulkDeferred, 1);
+    }
+    return count;
+}
+
+int cISZmqTcpBridge::DrainZmqControlQueue()
+{
+    if (!m_zmqControlQueue)
+    {
+        return 0;
+    }
+
+    int count = 0;
+    cISBridgeBufferRef buffer;
+    while (m_zmqControlQueue->Pop(buffer))
+    {
+        m_controlLatency.Record(bridgeClockNs() - buffer->Timestamp());
+        if (m_zmqSendSocket)
+        {
+            SendToZmq(buffer);
+        }
+        buffer.Reset();
+        count++;
+    }
+    return count;
+}
+
+int cISZmqTcpBridge::SendToZmq(cISBridgeBufferRef& buffer)
+{
+    // Small messages are copied inline and the buffer goes back to its pool right away;
+    // otherwise libzmq returns it through the free callback once sent
+    size_t size = buffer->Size();
+    uint64_t traceId = buffer->TraceId();
+    zmq_msg_t message;
+    if (size <= BRIDGE_ZMQ_INLINE_SIZE)
+    {
+        if (zmq_msg_init_size(&message, size) != 0)
+        {
+            bridgeCounterAdd(m_counters.zmqTxErrors, 1);
+            std::cerr << "ZMQ send error: " << zmq_strerror(zmq_errno()) << std::endl;
+            return -1;
+        }
+        memcpy(zmq_msg_data(&message), buffer->Data(), size);
+        buffer.Reset();
+    }
+    else
+    {
+        if (zmq_msg_init_data(&message, buffer->Data(), size, releaseBufferToPool, buffer.Get()) != 0)
+        {
+            bridgeCounterAdd(m_counters.zmqTxErrors, 1);
+            std::cerr << "ZMQ send error: " << zmq_strerror(zmq_errno()) << std::endl;
+            return -1;
+        }
+        buffer.Detach();  // The reference now belongs to the message
+    }
+
+    if (zmq_msg_send(&message, m_zmqSendSocket->handle(), ZMQ_DONTWAIT) < 0)
+    {
+        int err = zmq_errno();
+        zmq_msg_close(&message);
+        if (err == EAGAIN)
+        {
+            bridgeCounterAdd(m_counters.zmqTxEagain, 1);
+        }
+        else
         {
-            std::cerr << "ZMQ send error: " << e.what() << std::endl;
+            bridgeCounterAdd(m_counters.zmqTxErrors, 1);
+            std::cerr << "ZMQ send error: " << zmq_strerror(err) << std::endl;
         }
+        return -1;
+    }
+    bridgeCounterAdd(m_counters.zmqTxMessages, 1);
+    bridgeCounterAdd(m_counters.zmqTxBytes, size);
+    BRIDGE_TRACE1(zmq_publish, size);
+    if (m_trace && traceId != 0)
+    {
+        m_trace->Stamp(traceId, BRIDGE_TRACE_ZMQ_PUBLISHED, bridgeClockNs());
     }
+    return 0;
 }
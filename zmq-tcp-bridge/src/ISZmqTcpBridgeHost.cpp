@@ -0,0 +1,323 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISZmqTcpBridgeHost.h"
+#include <zmq.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+cISZmqTcpBridgeHost::cISZmqTcpBridgeHost()
+    : m_isRunning(false)
+{
+}
+
+cISZmqTcpBridgeHost::~cISZmqTcpBridgeHost()
+{
+    Stop();
+}
+
+int cISZmqTcpBridgeHost::AddRoute(const sISZmqTcpBridgeRoute& route)
+{
+    if (m_isRunning)
+    {
+        std::cerr << "Cannot add routes while the bridge host is running" << std::endl;
+        return -1;
+    }
+    if (route.zmqRecvEndpoint.empty() || route.zmqSendEndpoint.empty() || route.tcpPort < 0 || route.tcpPort > 65535)
+    {
+        std::cerr << "Invalid bridge route" << std::endl;
+        return -1;
+    }
+    for (const sISZmqTcpBridgeRoute& existing : m_routes)
+    {
+        if (route.tcpPort != 0 && existing.tcpPort == route.tcpPort)
+        {
+            std::cerr << "TCP port " << route.tcpPort << " is used by more than one route" << std::endl;
+            return -1;
+        }
+    }
+
+    m_routes.push_back(route);
+    return 0;
+}
+
+int cISZmqTcpBridgeHost::LoadRoutes(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open route file: " << path << std::endl;
+        return -1;
+    }
+
+    std::vector<sISZmqTcpBridgeRoute> routes;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        sISZmqTcpBridgeRoute route;
+        std::string extra;
+        if (!(fields >> route.zmqRecvEndpoint >> route.zmqSendEndpoint >> route.tcpPort) || (fields >> extra))
+        {
+            std::cerr << path << ":" << lineNumber << ": expected \"<zmq-recv> <zmq-send> <tcp-port>\"" << std::endl;
+            return -1;
+        }
+        routes.push_back(route);
+    }
+
+    size_t added = m_routes.size();
+    for (const sISZmqTcpBridgeRoute& route : routes)
+    {
+        if (AddRoute(route) != 0)
+        {
+            m_routes.resize(added);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int cISZmqTcpBridgeHost::Start(int threadCount)
+{
+    if (m_isRunning)
+    {
+        std::cerr << "Bridge host is already running" << std::endl;
+        return -1;
+    }
+    if (m_routes.empty())
+    {
+        std::cerr << "Bridge host has no routes" << std::endl;
+        return -1;
+    }
+
+    try
+    {
+        // One context for every route; a single I/O thread handles the ZMQ traffic of
+        // all of them
+        m_zmqContext = std::make_unique<zmq::context_t>(1);
+
+        for (size_t i = 0; i < m_routes.size(); i++)
+        {
+            const sISZmqTcpBridgeRoute& route = m_routes[i];
+            std::unique_ptr<cISZmqTcpBridge> bridge = std::make_unique<cISZmqTcpBridge>();
+            sISZmqTcpBridgeOptions options = m_options;
+            if (!options.capturePath.empty())
+            {
+                // One capture per route, named by its TCP port, or its index for a free port
+                options.capturePath += "." + ((route.tcpPort != 0) ? std::to_string(route.tcpPort) : "route" + std::to_string(i));
+            }
+            bridge->SetOptions(options);
+            if (bridge->Open(route.zmqRecvEndpoint, route.zmqSendEndpoint, route.tcpPort, m_zmqContext.get()) != 0)
+            {
+                Stop();
+                return -1;
+            }
+            m_bridges.push_back(std::move(bridge));
+        }
+
+        // Spread routes round-robin across the workers
+        size_t workerCount = static_cast<size_t>(std::max(1, threadCount));
+        workerCount = std::min(workerCount, m_bridges.size());
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            std::unique_ptr<sWorker> worker = std::make_unique<sWorker>();
+            if (worker->wakeup.Open() != 0)
+            {
+                std::cerr << "Failed to create bridge host wakeup descriptor" << std::endl;
+                Stop();
+                return -1;
+            }
+            m_workers.push_back(std::move(worker));
+        }
+        for (size_t i = 0; i < m_bridges.size(); i++)
+        {
+            m_workers[i % workerCount]->bridges.push_back(m_bridges[i].get());
+        }
+
+        m_isRunning = true;
+        for (std::unique_ptr<sWorker>& worker : m_workers)
+        {
+            worker->thread = std::make_unique<std::thread>(&cISZmqTcpBridgeHost::WorkerThread, this, worker.get());
+        }
+
+        std::cout << "Bridge host serving " << m_bridges.size() << " routes on " << workerCount << " threads" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error starting bridge host: " << e.what() << std::endl;
+        Stop();
+        return -1;
+    }
+}
+
+int cISZmqTcpBridgeHost::Stop()
+{
+    // Workers first: route sockets may only be closed once nothing polls them
+    m_isRunning = false;
+    for (std::unique_ptr<sWorker>& worker : m_workers)
+    {
+        worker->wakeup.Signal();
+    }
+    for (std::unique_ptr<sWorker>& worker : m_workers)
+    {
+        if (worker->thread && worker->thread->joinable())
+        {
+            worker->thread->join();
+        }
+    }
+    m_workers.clear();
+
+    for (std::unique_ptr<cISZmqTcpBridge>& bridge : m_bridges)
+    {
+        bridge->Stop();
+    }
+
+    // Terminating the context releases the messages libzmq still queues, which are
+    // built on the bridges' buffer pools; only then may the bridges go
+    if (m_zmqContext)
+    {
+        try
+        {
+            m_zmqContext->close();
+        }
+        catch (const zmq::error_t& e)
+        {
+            std::cerr << "Error closing bridge host context: " << e.what() << std::endl;
+        }
+        m_zmqContext.reset();
+    }
+    m_bridges.clear();
+    return 0;
+}
+
+void cISZmqTcpBridgeHost::WorkerThread(sWorker* worker)
+{
+    // Poll set: the wakeup, then each route's SUB socket, send queue wakeup and TCP
+    // reactor descriptor
+    std::vector<zmq::pollitem_t> items;
+    std::vector<int> zmqItem(worker->bridges.size(), -1);
+    std::vector<int> tcpItem(worker->bridges.size(), -1);
+    items.push_back({ nullptr, worker->wakeup.Fd(), ZMQ_POLLIN, 0 });
+    long timeoutMs = -1;
+    for (size_t i = 0; i < worker->bridges.size(); i++)
+    {
+        cISZmqTcpBridge* bridge = worker->bridges[i];
+        zmqItem[i] = static_cast<int>(items.size());
+        items.push_back({ bridge->ZmqRecvHandle(), 0, ZMQ_POLLIN, 0 });
+        items.push_back({ nullptr, bridge->WakeupFd(), ZMQ_POLLIN, 0 });
+        int tcpFd = bridge->TcpFd();
+        if (tcpFd >= 0)
+        {
+            tcpItem[i] = static_cast<int>(items.size());
+            items.push_back({ nullptr, tcpFd, ZMQ_POLLIN, 0 });
+        }
+        else
+        {
+            // No pollable descriptor (poll() reactor fallback): service TCP periodically
+            timeoutMs = kFallbackPollMs;
+        }
+    }
+
+    size_t first = 0;
+    while (m_isRunning)
+    {
+        // Routes pacing TCP → ZMQ bulk, holding a batch or stopped at their receive
+        // budget need servicing again even when nothing else happens
+        long waitMs = timeoutMs;
+        for (cISZmqTcpBridge* bridge : worker->bridges)
+        {
+            int due = bridge->ZmqTimeoutMs();
+            if (due >= 0 && (waitMs < 0 || due < waitMs))
+            {
+                waitMs = due;
+            }
+        }
+
+        try
+        {
+            zmq::poll(items.data(), items.size(), waitMs);
+        }
+        catch (const zmq::error_t& e)
+        {
+            if (e.num() != EINTR && e.num() != ETERM)
+            {
+                std::cerr << "Bridge host poll error: " << e.what() << std::endl;
+            }
+            continue;
+        }
+
+        if (items[0].revents & ZMQ_POLLIN)
+        {
+            worker->wakeup.Drain();
+        }
+
+        // Each ServiceZmq() stops at the route's receive budget. Starting every pass at
+        // the next route keeps the order from favouring the first ones.
+        size_t count = worker->bridges.size();
+        for (size_t n = 0; n < count; n++)
+        {
+            size_t i = (first + n) % count;
+            cISZmqTcpBridge* bridge = worker->bridges[i];
+            if (((items[zmqItem[i]].revents | items[zmqItem[i] + 1].revents) & ZMQ_POLLIN) || bridge->ZmqTimeoutMs() == 0)
+            {
+                bridge->ServiceZmq();
+            }
+            if (tcpItem[i] < 0 || (items[tcpItem[i]].revents & ZMQ_POLLIN))
+            {
+                bridge->ServiceTcp();
+            }
+        }
+        first = (first + 1) % count;
+    }
+}
+
+std::string cISZmqTcpBridgeHost::GetStatus() const
+{
+    std::ostringstream status;
+    status << (m_isRunning ? "Running" : "Stopped") << ": " << m_routes.size() << " routes, " << m_workers.size() << " threads";
+    for (const sISZmqTcpBridgeRoute& route : m_routes)
+    {
+        status << std::endl << "  " << route.zmqRecvEndpoint << " / " << route.zmqSendEndpoint << " <-> TCP " << route.tcpPort;
+    }
+    return status.str();
+}
+
+void cISZmqTcpBridgeHost::GetStats(std::vector<sISZmqTcpBridgeStats>& stats) const
+{
+    stats.clear();
+    stats.resize(m_bridges.size());
+    for (size_t i = 0; i < m_bridges.size(); i++)
+    {
+        m_bridges[i]->GetStats(stats[i]);
+    }
+}
+
+std::string cISZmqTcpBridgeHost::FormatPrometheus() const
+{
+    std::vector<sISZmqTcpBridgeStats> stats;
+    GetStats(stats);
+    std::string out;
+    cISZmqTcpBridge::FormatPrometheus(stats, out);
+    return out;
+}
@@ -0,0 +1,1240 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+ * zmq_tcp_bridge_bench
+ *
+ * Runs a cISZmqTcpBridge in-process and drives it from a local ZMQ PUB socket at a
+ * configurable message size and rate, with N TCP clients attached (some of them
+ * deliberately slow) and optional client uploads toward a local ZMQ SUB socket.
+ * Messages are ISB data packets whose payload carries a sequence number and a send
+ * timestamp, so every receiver measures one-way latency and gaps. Results are printed
+ * as one JSON object.
+ *
+ * With --soak the bench instead runs for hours while injecting faults (client churn,
+ * resets, half-closed and stalled connections, publisher restarts), samples RSS, open
+ * file descriptors, thread count, pool buffers in use and latency at a fixed interval,
+ * prints one JSON line per sample and exits non-zero as soon as any of them drifts past
+ * its threshold, or if pool buffers are still in use once every client has gone.
+ */
+
+#include "ISZmqTcpBridge.h"
+#include "ISBridgePacketFramer.h"
+#include "ISBridgeMetrics.h"
+#include <zmq.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BENCH_DID               1       // Data ID carried by published packets
+#define BENCH_WARMUP_SEQ        0       // Sequence number of warm-up packets, not measured
+#define BENCH_MIN_PACKET_SIZE   (BRIDGE_ISB_HEADER_SIZE + 16 + 2)
+
+struct sBenchConfig
+{
+    std::string zmqPubEndpoint = "tcp://127.0.0.1:17115";  // Bench PUB, bridge SUB connects here; port * for any free port
+    std::string zmqSubEndpoint = "tcp://127.0.0.1:17116";  // Bench SUB, bridge PUB connects here; port * for any free port
+    int tcpPort = 18000;                // 0 for any free port
+    int messageSize = 256;              // Whole ISB packet size in bytes
+    int rate = 10000;                   // Published messages per second, 0 for as fast as possible
+    int durationSec = 10;
+    int clients = 4;
+    int slowClients = 1;                // Of clients, how many read slowly
+    int slowClientBps = 100000;         // Read rate of a slow client
+    int upstreamRate = 0;               // Messages per second each fast client sends toward ZMQ
+    std::string outputPath;             // JSON output file, empty for stdout
+    sISZmqTcpBridgeOptions bridge;
+
+    // Soak mode (--soak): durationSec is the soak time after warm-up
+    bool soak = false;
+    int soakIntervalSec = 10;           // Sample interval
+    int soakWarmupSec = 60;             // Settling time before the baseline sample
+    int soakChurnMs = 100;              // Interval between injected client faults, 0 for none
+    int soakRestartSec = 300;           // Publisher restart interval, 0 for none
+    int soakMaxRssGrowthMb = 64;        // Allowed RSS growth over the baseline
+    int soakMaxFdGrowth = 16;           // Allowed open descriptor growth, excluding the harness's own sockets
+    int soakMaxThreadGrowth = 0;        // Allowed thread count growth
+    int soakMaxPoolGrowth = 4096;       // Allowed growth of data and message pool buffers in use
+    int soakMaxP99Pct = 300;            // Allowed window p99 as a percentage of the warm-up p99
+};
+
+/**
+ * Per-receiver results
+ */
+struct sBenchReceiver
+{
+    std::atomic<uint64_t> messages = { 0 };
+    std::atomic<uint64_t> bytes = { 0 };
+    std::atomic<uint64_t> gaps = { 0 };         // Messages missing between consecutive sequence numbers
+    uint64_t firstSeq = 0;                      // First measured sequence number received
+    uint64_t lastSeq = 0;
+    uint64_t lastTransitNs = 0;
+    cISBridgeHistogram latency;
+    cISBridgeHistogram jitter;                  // Change in one-way latency between consecutive messages
+    cISBridgeHistogram* window = NULL;          // Soak mode: latency since the last sample, shared by fast clients
+    uint64_t cpuNs = 0;
+    bool slow = false;
+    int port = 0;                               // Client's local port, how the bridge's GetClientStats() sees it
+    sISBridgeSendQueueStats queueStart;         // Bridge's queue counters for this client when measuring starts
+    sISBridgeSendQueueStats queueEnd;           // ... and when it ends
+};
+
+static std::atomic<bool> g_running(true);
+static std::atomic<uint64_t> g_benchThreadCpuNs(0);
+static std::atomic<int> g_soakSockets(0);           // Fault-injection sockets currently open
+static std::atomic<uint64_t> g_soakFaults(0);
+static std::atomic<uint64_t> g_soakRestarts(0);
+
+static uint64_t threadCpuNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static uint64_t processCpuNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * Fill buf with an ISB data packet of exactly size bytes carrying seq and the current time
+ */
+static void buildPacket(uint8_t* buf, size_t size, uint64_t seq)
+{
+    size_t payloadSize = size - BRIDGE_ISB_HEADER_SIZE - 2;
+    buf[0] = BRIDGE_ISB_PREAMBLE0;
+    buf[1] = BRIDGE_ISB_PREAMBLE1;
+    buf[2] = BRIDGE_ISB_PKT_TYPE_DATA;
+    buf[3] = BENCH_DID;
+    buf[4] = static_cast<uint8_t>(payloadSize);
+    buf[5] = static_cast<uint8_t>(payloadSize >> 8);
+    uint64_t now = bridgeClockNs();
+    memcpy(buf + BRIDGE_ISB_HEADER_SIZE, &seq, sizeof(seq));
+    memcpy(buf + BRIDGE_ISB_HEADER_SIZE + 8, &now, sizeof(now));
+    for (size_t i = 16; i < payloadSize; i++)
+    {
+        buf[BRIDGE_ISB_HEADER_SIZE + i] = static_cast<uint8_t>(i);
+    }
+
+    uint8_t a = 0;
+    uint8_t b = 0;
+    for (size_t i = 0; i < size - 2; i++)
+    {
+        a = static_cast<uint8_t>(a + buf[i]);
+        b = static_cast<uint8_t>(b + a);
+    }
+    buf[size - 2] = a;
+    buf[size - 1] = b;
+}
+
+/**
+ * Account one received packet
+ */
+static void recordPacket(sBenchReceiver& receiver, const sISBridgePacket& packet)
+{
+    if (packet.protocol != BRIDGE_PROTOCOL_ISB || packet.size < BENCH_MIN_PACKET_SIZE)
+    {
+        return;
+    }
+    uint64_t seq;
+    uint64_t sentNs;
+    memcpy(&seq, packet.data + BRIDGE_ISB_HEADER_SIZE, sizeof(seq));
+    memcpy(&sentNs, packet.data + BRIDGE_ISB_HEADER_SIZE + 8, sizeof(sentNs));
+    if (seq == BENCH_WARMUP_SEQ)
+    {
+        return;
+    }
+
+    uint64_t now = bridgeClockNs();
+    uint64_t transit = now > sentNs ? now - sentNs : 0;
+    receiver.latency.Record(transit);
+    if (receiver.window != NULL)
+    {
+        receiver.window->Record(transit);
+    }
+    if (receiver.lastTransitNs != 0)
+    {
+        // Packet delay variation (RFC 3393): how much this message's latency differs
+        // from the previous one's
+        receiver.jitter.Record(transit > receiver.lastTransitNs ? transit - receiver.lastTransitNs : receiver.lastTransitNs - transit);
+    }
+    receiver.lastTransitNs = transit;
+    if (receiver.firstSeq == 0)
+    {
+        receiver.firstSeq = seq;
+    }
+    receiver.messages.fetch_add(1, std::memory_order_relaxed);
+    receiver.bytes.fetch_add(packet.size, std::memory_order_relaxed);
+    if (receiver.lastSeq != 0 && seq > receiver.lastSeq + 1)
+    {
+        receiver.gaps.fetch_add(seq - receiver.lastSeq - 1, std::memory_order_relaxed);
+    }
+    receiver.lastSeq = seq;
+}
+
+/**
+ * Wait until a schedule slot; sleeps for long waits and spins for short ones so high
+ * rates stay accurate
+ */
+static void waitUntil(std::chrono::steady_clock::time_point when)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (when - now > std::chrono::microseconds(200))
+    {
+        std::this_thread::sleep_until(when - std::chrono::microseconds(100));
+    }
+    while (std::chrono::steady_clock::now() < when)
+    {
+    }
+}
+
+/**
+ * Bind the bench PUB socket, retrying while a just-closed socket still holds the port
+ */
+static bool bindPublisher(zmq::socket_t& pub, const std::string& endpoint)
+{
+    pub.set(zmq::sockopt::sndhwm, 0);
+    pub.set(zmq::sockopt::linger, 0);
+    for (int attempt = 0; ; attempt++)
+    {
+        try
+        {
+            pub.bind(endpoint);
+            return true;
+        }
+        catch (const zmq::error_t& e)
+        {
+            if (e.num() != EADDRINUSE || attempt >= 100)
+            {
+                std::cerr << "ZMQ error: " << e.what() << std::endl;
+                return false;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+static void publisherThread(zmq::context_t* context, zmq::socket_t* pub, const sBenchConfig& config, std::atomic<uint64_t>* published, const std::atomic<bool>* measuring)
+{
+    std::vector<uint8_t> packet(static_cast<size_t>(config.messageSize));
+    auto start = std::chrono::steady_clock::now();
+    auto interval = std::chrono::nanoseconds(config.rate > 0 ? 1000000000LL / config.rate : 0);
+    auto restartInterval = std::chrono::seconds(config.soak ? config.soakRestartSec : 0);
+    auto nextRestart = start + restartInterval;
+    uint64_t seq = 0;
+    for (uint64_t i = 0; g_running; i++)
+    {
+        if (config.rate > 0)
+        {
+            waitUntil(start + interval * static_cast<int64_t>(i));
+        }
+        if (restartInterval.count() > 0 && std::chrono::steady_clock::now() >= nextRestart)
+        {
+            // Simulate the device's publisher going away and coming back on the same
+            // endpoint; the bridge's SUB socket has to reconnect on its own
+            *pub = zmq::socket_t(*context, zmq::socket_type::pub);
+            if (!bindPublisher(*pub, config.zmqPubEndpoint))
+            {
+                g_running = false;
+                break;
+            }
+            g_soakRestarts.fetch_add(1, std::memory_order_relaxed);
+            nextRestart = std::chrono::steady_clock::now() + restartInterval;
+        }
+        uint64_t thisSeq = *measuring ? ++seq : BENCH_WARMUP_SEQ;
+        buildPacket(packet.data(), packet.size(), thisSeq);
+        zmq::message_t message(packet.data(), packet.size());
+        if (pub->send(message, zmq::send_flags::dontwait) && thisSeq != BENCH_WARMUP_SEQ)
+        {
+            published->store(seq, std::memory_order_relaxed);
+        }
+    }
+    g_benchThreadCpuNs += threadCpuNs();
+}
+
+static void clientReaderThread(int socket, bool slow, int slowBps, sBenchReceiver* receiver)
+{
+    cISBridgePacketFramer framer;
+    std::vector<uint8_t> buffer(slow ? 4096 : 65536);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    while (g_running)
+    {
+        ssize_t n = recv(socket, buffer.data(), buffer.size(), 0);
+        if (n <= 0)
+        {
+            if (n < 0 && (errno == EAGAIN || errno == EINTR))
+            {
+                continue;   // Receive timeout, check g_running
+            }
+            break;
+        }
+        framer.Feed(buffer.data(), static_cast<size_t>(n), [receiver](const sISBridgePacket& packet) { recordPacket(*receiver, packet); });
+
+        if (slow && slowBps > 0)
+        {
+            // Pace reads so the client drains at slowBps and the bridge queue backs up
+            total += static_cast<uint64_t>(n);
+            waitUntil(start + std::chrono::microseconds(total * 1000000ULL / static_cast<uint64_t>(slowBps)));
+        }
+    }
+    receiver->cpuNs = threadCpuNs();
+    g_benchThreadCpuNs += receiver->cpuNs;
+}
+
+static void clientWriterThread(int socket, const sBenchConfig& config, std::atomic<uint64_t>* sent, const std::atomic<bool>* measuring)
+{
+    std::vector<uint8_t> packet(static_cast<size_t>(config.messageSize));
+    auto start = std::chrono::steady_clock::now();
+    auto interval = std::chrono::nanoseconds(1000000000LL / config.upstreamRate);
+    uint64_t seq = 0;
+    for (uint64_t i = 0; g_running; i++)
+    {
+        waitUntil(start + interval * static_cast<int64_t>(i));
+        if (!*measuring)
+        {
+            continue;
+        }
+        buildPacket(packet.data(), packet.size(), ++seq);
+        if (send(socket, packet.data(), packet.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(packet.size()))
+        {
+            break;
+        }
+        sent->fetch_add(1, std::memory_order_relaxed);
+    }
+    g_benchThreadCpuNs += threadCpuNs();
+}
+
+static void subscriberThread(zmq::socket_t* sub, sBenchReceiver* receiver)
+{
+    // One whole packet per message: the bench enables TCP → ZMQ framing
+    while (g_running)
+    {
+        zmq::message_t message;
+        if (!sub->recv(message))
+        {
+            continue;   // Receive timeout
+        }
+        sISBridgePacket packet;
+        if (cISBridgePacketFramer::ParseFrame(static_cast<const uint8_t*>(message.data()), message.size(), packet, NULL) > 0)
+        {
+            // Senders are independent, so gaps are not meaningful here
+            receiver->lastSeq = 0;
+            recordPacket(*receiver, packet);
+        }
+    }
+    g_benchThreadCpuNs += threadCpuNs();
+}
+
+static int connectClient(int port, bool slow)
+{
+    int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket < 0)
+    {
+        return -1;
+    }
+    if (slow)
+    {
+        // Small receive window so backpressure reaches the bridge quickly
+        int rcvbuf = 16384;
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    timeval timeout = { 0, 200000 };
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int one = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+/**
+ * @return the local port of a connected socket, or the peer port with peer set, 0 on error
+ */
+static int socketPort(int socket, bool peer)
+{
+    sockaddr_in addr;
+    socklen_t size = sizeof(addr);
+    int result = peer ? getpeername(socket, reinterpret_cast<sockaddr*>(&addr), &size) : getsockname(socket, reinterpret_cast<sockaddr*>(&addr), &size);
+    return (result == 0 && addr.sin_family == AF_INET) ? ntohs(addr.sin_port) : 0;
+}
+
+/**
+ * Copy the bridge's send queue counters for each bench client into queueStart or
+ * queueEnd. Clients are matched by port, since the bridge only knows its own socket.
+ * @return the number of bench clients the bridge currently has
+ */
+static int snapshotClientQueues(const cISZmqTcpBridge& bridge, std::vector<std::unique_ptr<sBenchReceiver>>& receivers, bool end)
+{
+    std::vector<sISBridgeTcpClientStats> stats;
+    bridge.GetClientStats(stats);
+    int found = 0;
+    for (const sISBridgeTcpClientStats& client : stats)
+    {
+        int port = socketPort(client.socket, true);
+        for (std::unique_ptr<sBenchReceiver>& receiver : receivers)
+        {
+            if (port != 0 && receiver->port == port)
+            {
+                (end ? receiver->queueEnd : receiver->queueStart) = client.queue;
+                found++;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Close a fault-injection socket, with an RST instead of a FIN if reset is set
+ */
+static void closeSoakSocket(int socket, bool reset)
+{
+    if (reset)
+    {
+        linger abort = { 1, 0 };
+        setsockopt(socket, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+    }
+    close(socket);
+    g_soakSockets.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * Read and discard whatever arrives for duration, or until the bridge closes the connection
+ */
+static void drainFor(int socket, std::chrono::milliseconds duration, std::vector<uint8_t>& buffer)
+{
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (g_running && std::chrono::steady_clock::now() < end)
+    {
+        ssize_t n = recv(socket, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            break;
+        }
+        if (n < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+/**
+ * Soak mode: every soakChurnMs open one short-lived connection that misbehaves in
+ * turn - read briefly and close, reset at once, half-close, or stall without reading.
+ * Stalled connections have a small receive window, are held for a few seconds so the
+ * bridge's per-client queue fills, and are then reset.
+ */
+static void soakFaultThread(const sBenchConfig& config)
+{
+    static const size_t kMaxStalled = 8;
+    static const std::chrono::seconds kStallHold(5);
+    std::vector<std::pair<int, std::chrono::steady_clock::time_point>> stalled;
+    std::vector<uint8_t> buffer(65536);
+    for (uint64_t i = 0; g_running; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.soakChurnMs));
+        auto now = std::chrono::steady_clock::now();
+        stalled.erase(std::remove_if(stalled.begin(), stalled.end(), [now](const std::pair<int, std::chrono::steady_clock::time_point>& entry)
+        {
+            if (now < entry.second)
+            {
+                return false;
+            }
+            closeSoakSocket(entry.first, true);
+            return true;
+        }), stalled.end());
+
+        int fault = static_cast<int>(i % 4);
+        int socket = connectClient(config.tcpPort, fault == 3);
+        if (socket < 0)
+        {
+            continue;
+        }
+        g_soakSockets.fetch_add(1, std::memory_order_relaxed);
+        switch (fault)
+        {
+        case 0:     // Ordinary short-lived client
+            drainFor(socket, std::chrono::milliseconds(static_cast<int64_t>(i % 50)), buffer);
+            closeSoakSocket(socket, false);
+            break;
+        case 1:     // Connect and reset
+            closeSoakSocket(socket, true);
+            break;
+        case 2:     // Half-closed: sends FIN but keeps reading
+            shutdown(socket, SHUT_WR);
+            drainFor(socket, std::chrono::milliseconds(20), buffer);
+            closeSoakSocket(socket, false);
+            break;
+        default:    // Stalled reader
+            if (stalled.size() < kMaxStalled)
+            {
+                stalled.emplace_back(socket, now + kStallHold);
+            }
+            else
+            {
+                closeSoakSocket(socket, true);
+            }
+            break;
+        }
+        g_soakFaults.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (const std::pair<int, std::chrono::steady_clock::time_point>& entry : stalled)
+    {
+        closeSoakSocket(entry.first, true);
+    }
+    g_benchThreadCpuNs += threadCpuNs();
+}
+
+/**
+ * @return the numeric value of a /proc/self/status field (kB for memory fields), -1 if missing
+ */
+static long readProcStatus(const char* key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t keyLength = strlen(key);
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, keyLength, key) == 0 && line.size() > keyLength && line[keyLength] == ':')
+        {
+            return std::strtol(line.c_str() + keyLength + 1, NULL, 10);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @return open file descriptors in this process, -1 if /proc is unavailable
+ */
+static int countOpenFds()
+{
+    DIR* dir = opendir("/proc/self/fd");
+    if (dir == NULL)
+    {
+        return -1;
+    }
+    int count = 0;
+    while (dirent* entry = readdir(dir))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count - 1;   // The directory's own descriptor
+}
+
+static void appendLatency(std::ostringstream& json, const sISBridgeHistogramStats& stats)
+{
+    json << "{\"count\":" << stats.count
+         << ",\"p50_us\":" << stats.p50Ns / 1000.0
+         << ",\"p99_us\":" << stats.p99Ns / 1000.0
+         << ",\"p999_us\":" << stats.p999Ns / 1000.0
+         << ",\"max_us\":" << stats.maxNs / 1000.0 << "}";
+}
+
+/**
+ * One soak-mode resource and latency sample
+ */
+struct sSoakSample
+{
+    long rssKb = 0;
+    int fds = 0;                        // Excluding fault-injection sockets
+    long threads = 0;
+    size_t dataPoolInUse = 0;
+    size_t messagePoolInUse = 0;
+    sISBridgeHistogramStats latency;    // Fast clients, since the previous sample
+
+    long PoolInUse() const { return static_cast<long>(dataPoolInUse + messagePoolInUse); }
+};
+
+static sSoakSample takeSoakSample(cISZmqTcpBridge& bridge, cISBridgeHistogram& window)
+{
+    sSoakSample sample;
+    sISBridgeBufferPoolStats dataPool;
+    sISBridgeBufferPoolStats messagePool;
+    bridge.GetBufferPoolStats(dataPool, messagePool);
+    sample.dataPoolInUse = dataPool.blocksInUse;
+    sample.messagePoolInUse = messagePool.blocksInUse;
+    sample.rssKb = readProcStatus("VmRSS");
+    sample.threads = readProcStatus("Threads");
+    sample.fds = countOpenFds() - g_soakSockets.load(std::memory_order_relaxed);
+    sample.latency = window.Stats();
+    window.Reset();
+    return sample;
+}
+
+static void writeSoakSample(std::ostream& out, int index, double elapsedSec, const sSoakSample& sample, cISZmqTcpBridge& bridge, uint64_t published)
+{
+    sISZmqTcpBridgeStats stats;
+    bridge.GetStats(stats);
+    std::ostringstream json;
+    json.setf(std::ios::fixed);
+    json.precision(3);
+    json << "{\"sample\":" << index
+         << ",\"t_s\":" << elapsedSec
+         << ",\"rss_kb\":" << sample.rssKb
+         << ",\"fds\":" << sample.fds
+         << ",\"threads\":" << sample.threads
+         << ",\"published\":" << published
+         << ",\"faults\":" << g_soakFaults.load()
+         << ",\"publisher_restarts\":" << g_soakRestarts.load()
+         << ",\"bridge_clients\":" << stats.clients.size()
+         << ",\"bridge_accepts\":" << stats.tcp.accepts
+         << ",\"bridge_dropped\":" << stats.tcp.droppedMessages
+         << ",\"data_pool_in_use\":" << sample.dataPoolInUse
+         << ",\"message_pool_in_use\":" << sample.messagePoolInUse
+         << ",\"pool_heap_allocations\":" << stats.dataPool.heapAllocations + stats.messagePool.heapAllocations
+         << ",\"latency\":";
+    appendLatency(json, sample.latency);
+    json << "}";
+    out << json.str() << std::endl;
+}
+
+/**
+ * Soak mode measurement: settle for soakWarmupSec, take the baseline, then sample every
+ * soakIntervalSec for durationSec and fail on the first sample that drifts past a limit.
+ * Latency must stay over its limit (or stop entirely) for kSoakLatencyWindows samples in
+ * a row, so one publisher restart or scheduler hiccup does not fail the run.
+ * @return 0 if every sample stayed within limits, 1 otherwise
+ */
+static int runSoak(const sBenchConfig& config, cISZmqTcpBridge& bridge, cISBridgeHistogram& window, const std::atomic<uint64_t>& published, std::ostream& out)
+{
+    static const int kSoakLatencyWindows = 3;
+    static const uint64_t kSoakLatencyFloorNs = 1000000;   // Never fail on p99 growth below 1 ms
+    auto sleepUntil = [](std::chrono::steady_clock::time_point when)
+    {
+        while (g_running && std::chrono::steady_clock::now() < when)
+        {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(when - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+        }
+    };
+
+    // Pools, client queues and the allocator grow to their working size during warm-up;
+    // latency over the whole warm-up is the baseline
+    auto start = std::chrono::steady_clock::now();
+    window.Reset();
+    sleepUntil(start + std::chrono::seconds(config.soakWarmupSec));
+    sSoakSample baseline = takeSoakSample(bridge, window);
+    writeSoakSample(out, 0, 0.0, baseline, bridge, published.load());
+    bool checkLatency = baseline.latency.count > 0;
+    uint64_t p99LimitNs = std::max(baseline.latency.p99Ns * static_cast<uint64_t>(config.soakMaxP99Pct) / 100, baseline.latency.p99Ns + kSoakLatencyFloorNs);
+
+    std::string failure;
+    int slowWindows = 0;
+    int samples = std::max(1, config.durationSec / config.soakIntervalSec);
+    int index = 1;
+    start = std::chrono::steady_clock::now();
+    for (; index <= samples && failure.empty(); index++)
+    {
+        sleepUntil(start + std::chrono::seconds(static_cast<int64_t>(config.soakIntervalSec) * index));
+        if (!g_running)
+        {
+            failure = "harness stopped early";
+            break;
+        }
+        sSoakSample sample = takeSoakSample(bridge, window);
+        writeSoakSample(out, index, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), sample, bridge, published.load());
+
+        std::ostringstream reason;
+        if (sample.rssKb - baseline.rssKb > static_cast<long>(config.soakMaxRssGrowthMb) * 1024)
+        {
+            reason << "RSS grew from " << baseline.rssKb << " to " << sample.rssKb << " kB";
+        }
+        else if (sample.fds - baseline.fds > config.soakMaxFdGrowth)
+        {
+            reason << "open descriptors grew from " << baseline.fds << " to " << sample.fds;
+        }
+        else if (sample.threads - baseline.threads > config.soakMaxThreadGrowth)
+        {
+            reason << "threads grew from " << baseline.threads << " to " << sample.threads;
+        }
+        else if (sample.PoolInUse() - baseline.PoolInUse() > config.soakMaxPoolGrowth)
+        {
+            reason << "pool buffers in use grew from " << baseline.PoolInUse() << " to " << sample.PoolInUse();
+        }
+        else if (checkLatency)
+        {
+            slowWindows = (sample.latency.count == 0 || sample.latency.p99Ns > p99LimitNs) ? slowWindows + 1 : 0;
+            if (slowWindows >= kSoakLatencyWindows)
+            {
+                reason << "p99 latency over " << p99LimitNs / 1000 << " us (baseline " << baseline.latency.p99Ns / 1000
+                       << " us) for " << slowWindows << " samples, last " << sample.latency.p99Ns / 1000 << " us";
+            }
+        }
+        failure = reason.str();
+    }
+
+    std::ostringstream json;
+    json << "{\"soak\":{\"pass\":" << (failure.empty() ? "true" : "false")
+         << ",\"failure\":\"" << failure << "\""
+         << ",\"samples\":" << index - 1
+         << ",\"faults\":" << g_soakFaults.load()
+         << ",\"publisher_restarts\":" << g_soakRestarts.load()
+         << ",\"baseline\":{\"rss_kb\":" << baseline.rssKb
+         << ",\"fds\":" << baseline.fds
+         << ",\"threads\":" << baseline.threads
+         << ",\"pool_in_use\":" << baseline.PoolInUse()
+         << ",\"p99_us\":" << baseline.latency.p99Ns / 1000.0 << "}"
+         << ",\"limits\":{\"rss_growth_mb\":" << config.soakMaxRssGrowthMb
+         << ",\"fd_growth\":" << config.soakMaxFdGrowth
+         << ",\"thread_growth\":" << config.soakMaxThreadGrowth
+         << ",\"pool_growth\":" << config.soakMaxPoolGrowth
+         << ",\"p99_us\":" << (checkLatency ? p99LimitNs / 1000.0 : 0.0) << "}}}";
+    out << json.str() << std::endl;
+    if (!failure.empty())
+    {
+        std::cerr << "Soak failed: " << failure << std::endl;
+    }
+    return failure.empty() ? 0 : 1;
+}
+
+/**
+ * Soak mode leak check once the load has stopped and every harness socket is closed:
+ * the bridge must see its clients go and hand every pool buffer back within kDrainMs.
+ * Buffers still held then are owned by nothing the harness can reach.
+ * @return 0 if the bridge drained, 1 otherwise
+ */
+static int checkSoakDrained(cISZmqTcpBridge& bridge, std::ostream& out)
+{
+    static const int kDrainMs = 5000;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kDrainMs);
+    sISZmqTcpBridgeStats stats;
+    bool drained = false;
+    while (true)
+    {
+        bridge.GetStats(stats);
+        drained = stats.clients.empty() && stats.dataPool.blocksInUse == 0 && stats.messagePool.blocksInUse == 0;
+        if (drained || std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    out << "{\"soak_drain\":{\"pass\":" << (drained ? "true" : "false")
+        << ",\"bridge_clients\":" << stats.clients.size()
+        << ",\"data_pool_in_use\":" << stats.dataPool.blocksInUse
+        << ",\"message_pool_in_use\":" << stats.messagePool.blocksInUse << "}}" << std::endl;
+    if (!drained)
+    {
+        std::cerr << "Soak failed: " << stats.dataPool.blocksInUse << " data and " << stats.messagePool.blocksInUse
+                  << " message pool buffers still in use with " << stats.clients.size() << " clients left" << std::endl;
+    }
+    return drained ? 0 : 1;
+}
+
+static void printUsage(const char* progName)
+{
+    std::cout << "Usage: " << progName << " [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Benchmark the ZMQ-to-TCP bridge in-process and print JSON results" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --size <bytes>           Packet size (default: 256, min: " << BENCH_MIN_PACKET_SIZE << ")" << std::endl;
+    std::cout << "  --rate <msgs/s>          Publish rate, 0 for as fast as possible (default: 10000)" << std::endl;
+    std::cout << "  --duration <s>           Measured run time (default: 10)" << std::endl;
+    std::cout << "  --clients <n>            TCP clients (default: 4)" << std::endl;
+    std::cout << "  --slow-clients <n>       Of those, clients that read slowly (default: 1)" << std::endl;
+    std::cout << "  --slow-bps <bytes/s>     Slow client read rate (default: 100000)" << std::endl;
+    std::cout << "  --upstream-rate <msgs/s> Messages per second each fast client sends to ZMQ (default: 0)" << std::endl;
+    std::cout << "  --tcp-port <port>        Bridge TCP port, 0 for any free port (default: 18000)" << std::endl;
+    std::cout << "  --zmq-pub <endpoint>     Bench PUB endpoint, port * for any free port (default: tcp://127.0.0.1:17115)" << std::endl;
+    std::cout << "  --zmq-sub <endpoint>     Bench SUB endpoint, port * for any free port (default: tcp://127.0.0.1:17116)" << std::endl;
+    std::cout << "  --batch-max <count>      Bridge --batch-max (default: 64)" << std::endl;
+    std::cout << "  --zmq-cpu <cpu>          Bridge --zmq-cpu (default: unpinned)" << std::endl;
+    std::cout << "  --tcp-cpu <cpu>          Bridge --tcp-cpu (default: unpinned)" << std::endl;
+    std::cout << "  --fifo-priority <1-99>   Bridge --fifo-priority (default: off)" << std::endl;
+    std::cout << "  --busy-poll              Bridge --busy-poll" << std::endl;
+    std::cout << "  --tcp-backend <backend>  Bridge --tcp-backend: epoll or io_uring (default: epoll)" << std::endl;
+    std::cout << "  --tcp-shards <n>         Bridge --tcp-shards (default: 1)" << std::endl;
+    std::cout << "  --tx-adaptive            Bridge --tx-adaptive" << std::endl;
+    std::cout << "  --output <file>          Write JSON to <file> instead of stdout" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Soak mode (one JSON line per sample, exit status 1 on drift):" << std::endl;
+    std::cout << "  --soak                   Run for --duration seconds with fault injection and resource checks" << std::endl;
+    std::cout << "  --soak-interval <s>      Sample interval (default: 10)" << std::endl;
+    std::cout << "  --soak-warmup <s>        Settling time before the baseline sample (default: 60)" << std::endl;
+    std::cout << "  --soak-churn-ms <ms>     Interval between injected client faults, 0 for none (default: 100)" << std::endl;
+    std::cout << "  --soak-restart-s <s>     Publisher restart interval, 0 for none (default: 300)" << std::endl;
+    std::cout << "  --soak-rss-mb <MB>       Allowed RSS growth over the baseline (default: 64)" << std::endl;
+    std::cout << "  --soak-fds <n>           Allowed open descriptor growth (default: 16)" << std::endl;
+    std::cout << "  --soak-threads <n>       Allowed thread count growth (default: 0)" << std::endl;
+    std::cout << "  --soak-pool-blocks <n>   Allowed growth of pool buffers in use (default: 4096)" << std::endl;
+    std::cout << "  --soak-p99-pct <pct>     Allowed p99 latency as a percentage of the baseline (default: 300)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  -h, --help               Show this help message" << std::endl;
+}
+
+static bool parseIntArg(const char* name, const char* value, int minValue, int maxValue, int& result)
+{
+    try
+    {
+        int parsed = std::stoi(value);
+        if (parsed < minValue || parsed > maxValue)
+        {
+            std::cerr << "Invalid " << name << ": " << parsed << " (must be " << minValue << "-" << maxValue << ")" << std::endl;
+            return false;
+        }
+        result = parsed;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Invalid " << name << " value: " << value << std::endl;
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    sBenchConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        bool ok = true;
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("size", argv[++i], BENCH_MIN_PACKET_SIZE, static_cast<int>(cISBridgePacketFramer::kMaxFrameSize), config.messageSize);
+        }
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("rate", argv[++i], 0, INT_MAX, config.rate);
+        }
+        else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("duration", argv[++i], 1, 7 * 86400, config.durationSec);
+        }
+        else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("client count", argv[++i], 0, 1024, config.clients);
+        }
+        else if (strcmp(argv[i], "--slow-clients") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("slow client count", argv[++i], 0, 1024, config.slowClients);
+        }
+        else if (strcmp(argv[i], "--slow-bps") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("slow client rate", argv[++i], 1, INT_MAX, config.slowClientBps);
+        }
+        else if (strcmp(argv[i], "--upstream-rate") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("upstream rate", argv[++i], 0, 1000000, config.upstreamRate);
+        }
+        else if (strcmp(argv[i], "--tcp-port") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("TCP port", argv[++i], 0, 65535, config.tcpPort);
+        }
+        else if (strcmp(argv[i], "--zmq-pub") == 0 && i + 1 < argc)
+        {
+            config.zmqPubEndpoint = argv[++i];
+        }
+        else if (strcmp(argv[i], "--zmq-sub") == 0 && i + 1 < argc)
+        {
+            config.zmqSubEndpoint = argv[++i];
+        }
+        else if (strcmp(argv[i], "--batch-max") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("batch size", argv[++i], 1, INT_MAX, config.bridge.maxBatchMessages);
+        }
+        else if (strcmp(argv[i], "--zmq-cpu") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("ZMQ thread CPU", argv[++i], 0, 4095, config.bridge.zmqThread.cpu);
+        }
+        else if (strcmp(argv[i], "--tcp-cpu") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("TCP thread CPU", argv[++i], 0, 4095, config.bridge.tcpThread.cpu);
+        }
+        else if (strcmp(argv[i], "--fifo-priority") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("SCHED_FIFO priority", argv[++i], 1, 99, config.bridge.zmqThread.fifoPriority);
+            config.bridge.tcpThread.fifoPriority = config.bridge.zmqThread.fifoPriority;
+        }
+        else if (strcmp(argv[i], "--busy-poll") == 0)
+        {
+            config.bridge.busyPoll = true;
+        }
+        else if (strcmp(argv[i], "--tcp-backend") == 0 && i + 1 < argc)
+        {
+            const char* backend = argv[++i];
+            ok = (strcmp(backend, "epoll") == 0 || strcmp(backend, "io_uring") == 0);
+            config.bridge.tcpBackend = (strcmp(backend, "io_uring") == 0) ? BRIDGE_TCP_BACKEND_IO_URING : BRIDGE_TCP_BACKEND_EPOLL;
+            if (!ok)
+            {
+                std::cerr << "Invalid TCP backend: " << backend << std::endl;
+            }
+        }
+        else if (strcmp(argv[i], "--tcp-shards") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("TCP shard count", argv[++i], 1, 64, config.bridge.tcpShards);
+        }
+        else if (strcmp(argv[i], "--tx-adaptive") == 0)
+        {
+            config.bridge.tx.adaptive = true;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            config.outputPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--soak") == 0)
+        {
+            config.soak = true;
+        }
+        else if (strcmp(argv[i], "--soak-interval") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("soak interval", argv[++i], 1, 86400, config.soakIntervalSec);
+        }
+        else if (strcmp(argv[i], "--soak-warmup") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("soak warm-up", argv[++i], 0, 86400, config.soakWarmupSec);
+        }
+        else if (strcmp(argv[i], "--soak-churn-ms") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("soak churn interval", argv[++i], 0, 3600000, config.soakChurnMs);
+        }
+        else if (strcmp(argv[i], "--soak-restart-s") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("publisher restart interval", argv[++i], 0, 86400, config.soakRestartSec);
+        }
+        else if (strcmp(argv[i], "--soak-rss-mb") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("RSS growth limit", argv[++i], 0, 1048576, config.soakMaxRssGrowthMb);
+        }
+        else if (strcmp(argv[i], "--soak-fds") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("descriptor growth limit", argv[++i], 0, 1048576, config.soakMaxFdGrowth);
+        }
+        else if (strcmp(argv[i], "--soak-threads") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("thread growth limit", argv[++i], 0, 4096, config.soakMaxThreadGrowth);
+        }
+        else if (strcmp(argv[i], "--soak-pool-blocks") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("pool growth limit", argv[++i], 0, INT_MAX, config.soakMaxPoolGrowth);
+        }
+        else if (strcmp(argv[i], "--soak-p99-pct") == 0 && i + 1 < argc)
+        {
+            ok = parseIntArg("p99 limit", argv[++i], 100, 100000, config.soakMaxP99Pct);
+        }
+        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!ok)
+        {
+            return 1;
+        }
+    }
+    config.slowClients = std::min(config.slowClients, config.clients);
+    if (config.upstreamRate > 0)
+    {
+        // Upstream latency is read from whole packets, one per ZMQ message
+        config.bridge.frameTcpToZmq = true;
+    }
+
+    std::ofstream outputFile;
+    if (!config.outputPath.empty())
+    {
+        outputFile.open(config.outputPath);
+        if (!outputFile)
+        {
+            std::cerr << "Failed to open " << config.outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.outputPath.empty() ? std::cout : outputFile;
+
+    // Bench side of ZMQ: bind first so the bridge connects to live endpoints
+    zmq::context_t context(1);
+    zmq::socket_t pub(context, zmq::socket_type::pub);
+    zmq::socket_t sub(context, zmq::socket_type::sub);
+    if (!bindPublisher(pub, config.zmqPubEndpoint))
+    {
+        return 1;
+    }
+    try
+    {
+        sub.set(zmq::sockopt::rcvtimeo, 200);
+        sub.set(zmq::sockopt::subscribe, "");
+        sub.bind(config.zmqSubEndpoint);
+
+        // Resolve wildcard ports; publisher restarts rebind the same one
+        config.zmqPubEndpoint = pub.get(zmq::sockopt::last_endpoint);
+        config.zmqSubEndpoint = sub.get(zmq::sockopt::last_endpoint);
+    }
+    catch (const zmq::error_t& e)
+    {
+        std::cerr << "ZMQ error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    uint64_t cpuStart = processCpuNs();
+    cISZmqTcpBridge bridge;
+    bridge.SetOptions(config.bridge);
+    if (bridge.Start(config.zmqPubEndpoint, config.zmqSubEndpoint, config.tcpPort) != 0)
+    {
+        std::cerr << "Failed to start bridge" << std::endl;
+        return 1;
+    }
+    if (config.tcpPort == 0)
+    {
+        sISZmqTcpBridgeStats stats;
+        bridge.GetStats(stats);
+        config.tcpPort = stats.tcpPort;
+    }
+
+    std::vector<int> sockets;
+    std::vector<std::unique_ptr<sBenchReceiver>> receivers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> measuring(false);
+    std::atomic<uint64_t> published(0);
+    std::atomic<uint64_t> upstreamSent(0);
+    sBenchReceiver upstream;
+    cISBridgeHistogram soakWindow;
+
+    auto connectClients = [&](bool slow, int count)
+    {
+        for (int i = 0; i < count && g_running; i++)
+        {
+            int socket = connectClient(config.tcpPort, slow);
+            if (socket < 0)
+            {
+                std::cerr << "Failed to connect client " << receivers.size() << ": " << strerror(errno) << std::endl;
+                g_running = false;
+                break;
+            }
+            sockets.push_back(socket);
+            receivers.push_back(std::make_unique<sBenchReceiver>());
+            receivers.back()->slow = slow;
+            receivers.back()->port = socketPort(socket, false);
+            if (config.soak && !slow)
+            {
+                receivers.back()->window = &soakWindow;
+            }
+            threads.emplace_back(clientReaderThread, socket, slow, config.slowClientBps, receivers.back().get());
+            if (!slow && config.upstreamRate > 0)
+            {
+                threads.emplace_back(clientWriterThread, socket, std::cref(config), &upstreamSent, &measuring);
+            }
+        }
+    };
+    connectClients(false, config.clients - config.slowClients);
+    threads.emplace_back(subscriberThread, &sub, &upstream);
+    threads.emplace_back(publisherThread, &context, &pub, std::cref(config), &published, &measuring);
+    if (config.soak && config.soakChurnMs > 0)
+    {
+        threads.emplace_back(soakFaultThread, std::cref(config));
+    }
+
+    // Warm up until ZMQ subscriptions have propagated, then measure. Slow clients join
+    // only now: one that saw the warm-up would spend the measured window reading its
+    // backlog of warm-up packets.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    connectClients(true, config.slowClients);
+    auto accepted = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (snapshotClientQueues(bridge, receivers, false) < static_cast<int>(receivers.size()) && std::chrono::steady_clock::now() < accepted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    measuring = true;
+    auto measureStart = std::chrono::steady_clock::now();
+    int soakResult = 0;
+    if (config.soak)
+    {
+        soakResult = runSoak(config, bridge, soakWindow, published, out);
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(config.durationSec));
+    }
+    measuring = false;
+    double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+
+    // Let queues drain, then stop
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    sISZmqTcpBridgeStats bridgeStats;
+    bridge.GetStats(bridgeStats);
+    snapshotClientQueues(bridge, receivers, true);
+    g_running = false;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (int socket : sockets)
+    {
+        close(socket);
+    }
+    if (config.soak && soakResult == 0)
+    {
+        soakResult = checkSoakDrained(bridge, out);
+    }
+    bridge.Stop();
+    uint64_t cpuNs = processCpuNs() - cpuStart;
+    uint64_t benchCpuNs = g_benchThreadCpuNs.load() + threadCpuNs();
+    uint64_t bridgeCpuNs = cpuNs > benchCpuNs ? cpuNs - benchCpuNs : 0;
+    if (config.soak)
+    {
+        return soakResult;
+    }
+
+    // Aggregate clients
+    cISBridgeHistogram fastLatency;
+    cISBridgeHistogram fastJitter;
+    cISBridgeHistogram slowLatency;
+    uint64_t fastMessages = 0;
+    uint64_t fastBytes = 0;
+    uint64_t fastMissing = 0;
+    uint64_t slowMessages = 0;
+    uint64_t slowDropped = 0;
+    uint64_t slowConflated = 0;
+    uint64_t slowQueued = 0;
+    std::ostringstream perClient;
+    for (size_t i = 0; i < receivers.size(); i++)
+    {
+        sBenchReceiver& receiver = *receivers[i];
+        uint64_t messages = receiver.messages.load();
+        // Drops come from the bridge's own counters over the measured window; what a
+        // slow client has not read yet is still queued, not lost
+        uint64_t dropped = receiver.queueEnd.droppedMessages - std::min(receiver.queueEnd.droppedMessages, receiver.queueStart.droppedMessages);
+        uint64_t conflated = receiver.queueEnd.conflatedMessages - std::min(receiver.queueEnd.conflatedMessages, receiver.queueStart.conflatedMessages);
+        receiver.latency.MergeInto(receiver.slow ? slowLatency : fastLatency);
+        if (receiver.slow)
+        {
+            slowMessages += messages;
+            slowDropped += dropped;
+            slowConflated += conflated;
+            slowQueued += receiver.queueEnd.queuedMessages;
+        }
+        else
+        {
+            receiver.jitter.MergeInto(fastJitter);
+            fastMessages += messages;
+            fastBytes += receiver.bytes.load();
+            fastMissing += published > messages ? published - messages : 0;
+        }
+        perClient << (i ? "," : "") << "{\"slow\":" << (receiver.slow ? "true" : "false")
+                  << ",\"received\":" << messages
+                  << ",\"first_seq\":" << receiver.firstSeq
+                  << ",\"dropped\":" << dropped
+                  << ",\"conflated\":" << conflated
+                  << ",\"queued\":" << receiver.queueEnd.queuedMessages << "}";
+    }
+
+    uint64_t forwarded = bridgeStats.zmqRxMessages + bridgeStats.zmqTxMessages;
+    std::ostringstream json;
+    json.setf(std::ios::fixed);
+    json.precision(3);
+    json << "{\"config\":{\"size\":" << config.messageSize
+         << ",\"rate\":" << config.rate
+         << ",\"duration_s\":" << elapsedSec
+         << ",\"clients\":" << config.clients
+         << ",\"slow_clients\":" << config.slowClients
+         << ",\"slow_bps\":" << config.slowClientBps
+         << ",\"upstream_rate\":" << config.upstreamRate
+         << ",\"batch_max\":" << config.bridge.maxBatchMessages
+         << ",\"zmq_cpu\":" << config.bridge.zmqThread.cpu
+         << ",\"tcp_cpu\":" << config.bridge.tcpThread.cpu
+         << ",\"fifo_priority\":" << config.bridge.zmqThread.fifoPriority
+         << ",\"busy_poll\":" << (config.bridge.busyPoll ? "true" : "false")
+         << ",\"tcp_backend\":\"" << (bridgeStats.tcpBackend == BRIDGE_TCP_BACKEND_IO_URING ? "io_uring" : "epoll") << "\""
+         << ",\"tcp_shards\":" << bridgeStats.tcpShards
+         << ",\"tx_adaptive\":" << (config.bridge.tx.adaptive ? "true" : "false")
+         << ",\"shard_ring_dropped\":" << bridgeStats.shardRing.dropped << "}";
+
+    json << ",\"zmq_to_tcp\":{\"published\":" << published.load()
+         << ",\"throughput_msgs_per_s\":" << published.load() / elapsedSec
+         << ",\"fast_clients\":{\"received\":" << fastMessages
+         << ",\"missing\":" << fastMissing
+         << ",\"mb_per_s\":" << fastBytes / elapsedSec / 1e6
+         << ",\"latency\":";
+    appendLatency(json, fastLatency.Stats());
+    json << ",\"jitter\":";
+    appendLatency(json, fastJitter.Stats());
+    json << "},\"slow_clients\":{\"received\":" << slowMessages
+         << ",\"dropped\":" << slowDropped
+         << ",\"conflated\":" << slowConflated
+         << ",\"queued\":" << slowQueued
+         << ",\"latency\":";
+    appendLatency(json, slowLatency.Stats());
+    json << "},\"clients\":[" << perClient.str() << "]"
+         << ",\"bridge_dropped\":" << bridgeStats.tcp.droppedMessages
+         << ",\"bridge_write_blocks\":" << bridgeStats.tcp.writeBlocks
+         << ",\"bridge_write_calls\":" << bridgeStats.tcp.writeCalls
+         << ",\"bridge_tx_deadline_flushes\":" << bridgeStats.tcp.txDeadlineFlushes
+         << ",\"bridge_latency\":";
+    appendLatency(json, bridgeStats.latency);
+    json << "}";
+
+    json << ",\"tcp_to_zmq\":{\"sent\":" << upstreamSent.load()
+         << ",\"received\":" << upstream.messages.load()
+         << ",\"missing\":" << (upstreamSent > upstream.messages ? upstreamSent - upstream.messages : 0)
+         << ",\"throughput_msgs_per_s\":" << upstream.messages.load() / elapsedSec
+         << ",\"bridge_eagain\":" << bridgeStats.zmqTxEagain
+         << ",\"bridge_errors\":" << bridgeStats.zmqTxErrors
+         << ",\"latency\":";
+    appendLatency(json, upstream.latency.Stats());
+    json << "}";
+
+    json << ",\"cpu\":{\"bridge_ms\":" << bridgeCpuNs / 1e6
+         << ",\"bench_ms\":" << benchCpuNs / 1e6
+         << ",\"ns_per_message\":" << (forwarded ? static_cast<double>(bridgeCpuNs) / static_cast<double>(forwarded) : 0.0) << "}";
+
+    json << ",\"pools\":{\"data_heap_allocations\":" << bridgeStats.dataPool.heapAllocations
+         << ",\"message_heap_allocations\":" << bridgeStats.messagePool.heapAllocations << "}}";
+
+    out << json.str() << std::endl;
+    if (!out)
+    {
+        std::cerr << "Failed to write " << config.outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -11,24 +11,236 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include "ISZmqTcpBridge.h"
+#include "ISZmqTcpBridgeHost.h"
+#include "ISBridgeMetricsServer.h"
+#include "ISBridgeReplay.h"
+#include "ISBridgeHandoff.h"
 #include <iostream>
 #include <csignal>
 #include <string>
+#include <vector>
 #include <cstring>
+#include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <climits>
+#include <fstream>
 
-static cISZmqTcpBridge* g_bridge = nullptr;
 static volatile std::sig_atomic_t g_interrupted = 0;
+static volatile std::sig_atomic_t g_dumpTrace = 0;
 
 void signalHandler(int signum)
 {
     std::cout << "\nInterrupt signal (" << signum << ") received." << std::endl;
+
+    // Only set the flag; main() stops the bridge so threads are joined outside signal
+    // context and the metrics server is stopped first
     g_interrupted = 1;
-    if (g_bridge)
+}
+
+void traceSignalHandler(int)
+{
+    g_dumpTrace = 1;
+}
+
+/**
+ * Write the bridge's sampled trace records as JSON lines
+ * @param bridge the bridge
+ * @param path file to overwrite, or empty for stdout
+ */
+static void dumpTrace(const cISZmqTcpBridge& bridge, const std::string& path)
+{
+    std::vector<sISBridgeTraceRecord> records;
+    if (bridge.GetTraceRecords(records) != 0)
+    {
+        std::cerr << "Trace sampling is off (--trace-sample)" << std::endl;
+        return;
+    }
+    std::string text;
+    cISBridgeTraceRing::FormatJson(records, text);
+    if (path.empty())
+    {
+        std::cout << text << std::flush;
+        return;
+    }
+    std::ofstream file(path, std::ios::trunc);
+    file << text;
+    if (!file)
+    {
+        std::cerr << "Failed to write trace " << path << std::endl;
+        return;
+    }
+    std::cout << "Wrote " << records.size() << " trace records to " << path << std::endl;
+}
+
+/**
+ * Parse an integer command line value
+ * @param name description used in error messages
+ * @param value the argument text
+ * @param minValue smallest accepted value
+ * @param maxValue largest accepted value
+ * @param result receives the value on success
+ * @return true if the value parsed and is in range
+ */
+static bool parseIntArg(const char* name, const char* value, int minValue, int maxValue, int& result)
+{
+    try
+    {
+        int parsed = std::stoi(value);
+        if (parsed < minValue || parsed > maxValue)
+        {
+            std::cerr << "Invalid " << name << ": " << parsed << " (must be " << minValue << "-" << maxValue << ")" << std::endl;
+            return false;
+        }
+        result = parsed;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Invalid " << name << " value: " << value << std::endl;
+        return false;
+    }
+}
+
+/**
+ * Parse a comma separated list of data IDs, or "all"
+ * @param value the argument text
+ * @param result receives the set on success
+ * @return true if every entry is a data ID 0-255
+ */
+static bool parseDidList(const char* value, sISBridgeDidSet& result)
+{
+    sISBridgeDidSet set;
+    if (strcmp(value, "all") != 0)
+    {
+        set.all = false;
+        std::string list = value;
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            int did;
+            if (!parseIntArg("data ID", list.substr(start, end - start).c_str(), 0, 255, did))
+            {
+                return false;
+            }
+            set.words[did >> 6] |= 1ULL << (did & 63);
+            start = end + 1;
+        }
+    }
+    result = set;
+    return true;
+}
+
+/**
+ * Parse a comma separated list of <data ID>:<Hz> rate limits
+ * @param value the argument text
+ * @param result receives the limits on success; IDs not listed are unchanged
+ * @return true if every entry is a data ID 0-255 and a positive rate
+ */
+static bool parseRateList(const char* value, sISBridgeRateLimits& result)
+{
+    sISBridgeRateLimits limits = result;
+    std::string list = value;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = list.size();
+        }
+        std::string entry = list.substr(start, end - start);
+        size_t colon = entry.find(':');
+        int did;
+        if (colon == std::string::npos || !parseIntArg("data ID", entry.substr(0, colon).c_str(), 0, 255, did))
+        {
+            std::cerr << "Invalid rate limit: " << entry << " (expected <data ID>:<Hz>)" << std::endl;
+            return false;
+        }
+        char* rateEnd = NULL;
+        double hz = strtod(entry.c_str() + colon + 1, &rateEnd);
+        if (rateEnd == entry.c_str() + colon + 1 || *rateEnd != '\0' || !(hz > 0.0) || hz > 1e6)
+        {
+            std::cerr << "Invalid rate limit: " << entry << " (expected <data ID>:<Hz>)" << std::endl;
+            return false;
+        }
+        limits.maxHz[did] = static_cast<float>(hz);
+        start = end + 1;
+    }
+    result = limits;
+    return true;
+}
+
+/**
+ * Serve every route in a route file from one process until interrupted
+ * @return process exit code
+ */
+static int runHost(const std::string& routesPath, int threads, const sISZmqTcpBridgeOptions& options, int metricsPort)
+{
+    cISZmqTcpBridgeHost host;
+    host.SetOptions(options);
+    if (host.LoadRoutes(routesPath) != 0)
+    {
+        return 1;
+    }
+
+    std::cout << "Starting ZMQ-to-TCP Bridge host..." << std::endl;
+    if (host.Start(threads) != 0)
+    {
+        std::cerr << "Failed to start bridge host" << std::endl;
+        return 1;
+    }
+
+    cISBridgeMetricsServer metrics;
+    if (metricsPort > 0 && metrics.Start(metricsPort, [&host]() { return host.FormatPrometheus(); }) != 0)
+    {
+        host.Stop();
+        return 1;
+    }
+
+    std::cout << host.GetStatus() << std::endl;
+    std::cout << "Bridge host is running. Press Ctrl+C to stop." << std::endl;
+
+    // The signal handler only sets the flag; stop from here so worker threads are
+    // joined outside signal context
+    while (!g_interrupted)
     {
-        g_bridge->Stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
+
+    metrics.Stop();
+    host.Stop();
+    return 0;
+}
+
+/**
+ * Serve a capture to TCP clients until it finishes or is interrupted
+ * @return process exit code
+ */
+static int runReplay(const std::string& capturePath, int tcpPort, const sISBridgeReplayOptions& options)
+{
+    cISBridgeReplay replay;
+    replay.SetOptions(options);
+    if (replay.Start(capturePath, tcpPort) != 0)
+    {
+        std::cerr << "Failed to start replay" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Waiting for " << options.waitClients << " client(s) on TCP port " << tcpPort << std::endl;
+    while (replay.IsRunning() && !g_interrupted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::cout << replay.GetStatus() << std::endl;
+    replay.Stop();
+    return 0;
 }
 
 void printUsage(const char* progName)
@@ -39,31 +251,98 @@ void printUsage(const char* progName)
     std::cout << "Forwards data between ZMQ sockets and TCP connections" << std::endl;
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  --zmq-recv <endpoint>    ZMQ endpoint to receive from (default: tcp://127.0.0.1:7115)" << std::endl;
+    std::cout << "  --zmq-recv <endpoint>    ZMQ endpoint to receive from; repeat to merge several publishers" << std::endl;
+    std::cout << "                           (default: tcp://127.0.0.1:7115)" << std::endl;
     std::cout << "  --zmq-send <endpoint>    ZMQ endpoint to send to (default: tcp://127.0.0.1:7116)" << std::endl;
     std::cout << "  --tcp-port <port>        TCP port for SDK clients (default: 8000)" << std::endl;
+    std::cout << "  --routes <file>          Serve every route in <file> from one process (one" << std::endl;
+    std::cout << "                           \"<zmq-recv> <zmq-send> <tcp-port>\" per line); replaces" << std::endl;
+    std::cout << "                           --zmq-recv, --zmq-send and --tcp-port" << std::endl;
+    std::cout << "  --threads <count>        Worker threads shared by all routes with --routes (default: 2)" << std::endl;
+    std::cout << "  --batch-max <count>      Max ZMQ messages per vectored TCP write (default: 64)" << std::endl;
+    std::cout << "  --recv-budget <count>    ZMQ messages received per pass before serving commands again (default: 1024)" << std::endl;
+    std::cout << "  --batch-hold-us <us>     Max time to hold a partial batch (default: 0, flush immediately)" << std::endl;
+    std::cout << "  --client-queue-msgs <n>  Max messages queued per TCP client (default: 4096)" << std::endl;
+    std::cout << "  --client-queue-bytes <n> Max bytes queued per TCP client (default: 4194304)" << std::endl;
+    std::cout << "  --zmq-send-queue <n>     Max TCP->ZMQ messages waiting to be published (default: 4096)" << std::endl;
+    std::cout << "  --drop-policy <policy>   Full client queue policy: oldest, newest or disconnect (default: oldest)" << std::endl;
+    std::cout << "  --framing <mode>         Packet framing: none, zmq (ZMQ->TCP), tcp (TCP->ZMQ) or both (default: none)" << std::endl;
+    std::cout << "  --control-lane           Publish TCP->ZMQ commands ahead of bulk traffic (implies tcp framing)" << std::endl;
+    std::cout << "  --control-max-bytes <n>  Largest packet the control lane takes (default: 512)" << std::endl;
+    std::cout << "  --bulk-bytes-per-tick <n> TCP->ZMQ bulk bytes published per tick, 0 for unpaced (default: 0)" << std::endl;
+    std::cout << "  --bulk-tick-us <us>      Bulk pacing interval (default: 1000)" << std::endl;
+    std::cout << "  --filter-dids            Send each client only the ISB data IDs it requested" << std::endl;
+    std::cout << "  --did-topic-prefix <p>   Publisher tags ISB data with topic <p> + DID byte; subscribe only to" << std::endl;
+    std::cout << "                           the DIDs clients want (with --filter-dids)" << std::endl;
+    std::cout << "  --pass-topic <topic>     Topic always subscribed with --did-topic-prefix (repeatable)" << std::endl;
+    std::cout << "  --timestamp-frame        Publishers send an 8-byte LE nanosecond timestamp frame before each packet" << std::endl;
+    std::cout << "  --merge-window-us <us>   Hold packets up to <us> to merge several --zmq-recv endpoints in" << std::endl;
+    std::cout << "                           timestamp order (with --timestamp-frame, default: 0, arrival order)" << std::endl;
+    std::cout << "  --rate-limit <did:hz,..> Send each client at most <hz> packets/s of each listed ISB data ID" << std::endl;
+    std::cout << "                           (repeatable, default: off)" << std::endl;
+    std::cout << "  --conflate               Keep only the newest queued packet of each data ID for a client" << std::endl;
+    std::cout << "                           whose socket is backed up" << std::endl;
+    std::cout << "  --zmq-cpu <cpu>          Pin the ZMQ-to-TCP thread to <cpu> (default: unpinned)" << std::endl;
+    std::cout << "  --tcp-cpu <cpu>          Pin the TCP reactor thread to <cpu> (default: unpinned)" << std::endl;
+    std::cout << "  --fifo-priority <1-99>   Run both forwarding threads SCHED_FIFO at this priority (default: off)" << std::endl;
+    std::cout << "  --busy-poll              Spin on ZMQ/TCP readiness instead of sleeping; uses a core per thread" << std::endl;
+    std::cout << "  --tcp-backend <backend>  TCP socket I/O: epoll or io_uring (default: epoll)" << std::endl;
+    std::cout << "  --busy-poll-us <us>      SO_BUSY_POLL time on TCP client sockets with --busy-poll (default: 50)" << std::endl;
+    std::cout << "  --tcp-shards <n>         TCP reactor threads sharing the port with SO_REUSEPORT (default: 1)" << std::endl;
+    std::cout << "  --tx-adaptive            Coalesce writes and size SO_SNDBUF per client for bulk clients (Linux)" << std::endl;
+    std::cout << "  --tx-coalesce-rate <n>   Messages per second from which a client is bulk (default: 2000)" << std::endl;
+    std::cout << "  --tx-flush-us <us>       Longest a bulk client's data is held with --tx-adaptive (default: 2000)" << std::endl;
+    std::cout << "  --tx-max-sndbuf <bytes>  Largest SO_SNDBUF set with --tx-adaptive, 0 to leave it to the kernel" << std::endl;
+    std::cout << "                           (default: 4194304)" << std::endl;
+    std::cout << "  --handoff <path>         Take over clients from the bridge listening on Unix socket <path>," << std::endl;
+    std::cout << "                           then listen there to hand them to the next one (default: off)" << std::endl;
+    std::cout << "  --zmq-reconnect-ms <ms>  ZMQ reconnect interval (default: 10)" << std::endl;
+    std::cout << "  --zmq-reconnect-max-ms <ms> Longest ZMQ reconnect interval with backoff, 0 for none (default: 1000)" << std::endl;
+    std::cout << "  --cache-dids <ids>       Send new clients the latest packet of each data ID first: a comma" << std::endl;
+    std::cout << "                           separated list or all (default: off)" << std::endl;
+    std::cout << "  --cache-bytes <n>        Last-value cache memory limit (default: 262144)" << std::endl;
+    std::cout << "  --metrics-port <port>    Serve Prometheus metrics on 127.0.0.1:<port> (default: off)" << std::endl;
+    std::cout << "  --trace-sample <n>       Trace one of every <n> messages through each stage; SIGUSR1 dumps" << std::endl;
+    std::cout << "                           the records (default: 0, off)" << std::endl;
+    std::cout << "  --trace-records <n>      Sampled trace records kept (default: 4096)" << std::endl;
+    std::cout << "  --trace-dump <path>      Write trace records to <path> on SIGUSR1 instead of stdout" << std::endl;
+    std::cout << "  --capture <path>         Record all traffic to <path>.000, <path>.001, ... (default: off)" << std::endl;
+    std::cout << "  --capture-segment-mb <n> Capture segment file size in MiB (default: 64)" << std::endl;
+    std::cout << "  --replay <path>          Serve a capture to TCP clients on --tcp-port instead of bridging" << std::endl;
+    std::cout << "  --replay-speed <speed>   Replay rate: 1 for real time, N for N times faster, or max (default: 1)" << std::endl;
+    std::cout << "  --replay-wait-clients <n> Clients to wait for before replay starts (default: 1)" << std::endl;
     std::cout << "  -h, --help               Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << progName << std::endl;
     std::cout << "  " << progName << " --tcp-port 9000" << std::endl;
     std::cout << "  " << progName << " --zmq-recv tcp://127.0.0.1:7115 --zmq-send tcp://127.0.0.1:7116 --tcp-port 8000" << std::endl;
+    std::cout << "  " << progName << " --routes bridge_routes.txt --threads 2" << std::endl;
+    std::cout << "  " << progName << " --capture /var/tmp/bridge" << std::endl;
+    std::cout << "  " << progName << " --replay /var/tmp/bridge --replay-speed 10" << std::endl;
     std::cout << std::endl;
 }
 
 int main(int argc, char* argv[])
 {
     // Default configuration
-    std::string zmqRecvEndpoint = "tcp://127.0.0.1:7115";
+    std::vector<std::string> zmqRecvEndpoints;
     std::string zmqSendEndpoint = "tcp://127.0.0.1:7116";
     int tcpPort = 8000;
+    std::string routesPath;
+    int hostThreads = 2;
+    int metricsPort = 0;
+    std::string replayPath;
+    std::string traceDumpPath;
+    sISBridgeReplayOptions replayOptions;
+    sISZmqTcpBridgeOptions options;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++)
     {
         if (strcmp(argv[i], "--zmq-recv") == 0 && i + 1 < argc)
         {
-            zmqRecvEndpoint = argv[++i];
+            zmqRecvEndpoints.push_back(argv[++i]);
         }
         else if (strcmp(argv[i], "--zmq-send") == 0 && i + 1 < argc)
         {
@@ -86,6 +365,346 @@ int main(int argc, char* argv[])
                 return 1;
             }
         }
+        else if (strcmp(argv[i], "--routes") == 0 && i + 1 < argc)
+        {
+            routesPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("thread count", argv[++i], 1, 256, hostThreads))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--batch-max") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("batch size", argv[++i], 1, INT_MAX, options.maxBatchMessages))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--recv-budget") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("receive budget", argv[++i], 1, INT_MAX, options.zmqRecvBudget))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--batch-hold-us") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("batch hold time", argv[++i], 0, INT_MAX, options.maxBatchHoldUs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--client-queue-msgs") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("client queue message limit", argv[++i], 1, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.clientQueue.maxMessages = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--client-queue-bytes") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("client queue byte limit", argv[++i], 1, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.clientQueue.maxBytes = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--zmq-send-queue") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("ZMQ send queue size", argv[++i], 1, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.zmqSendQueueCapacity = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--drop-policy") == 0 && i + 1 < argc)
+        {
+            const char* policy = argv[++i];
+            if (strcmp(policy, "oldest") == 0)
+            {
+                options.clientQueue.dropPolicy = BRIDGE_DROP_OLDEST;
+            }
+            else if (strcmp(policy, "newest") == 0)
+            {
+                options.clientQueue.dropPolicy = BRIDGE_DROP_NEWEST;
+            }
+            else if (strcmp(policy, "disconnect") == 0)
+            {
+                options.clientQueue.dropPolicy = BRIDGE_DROP_DISCONNECT;
+            }
+            else
+            {
+                std::cerr << "Invalid drop policy: " << policy << " (must be oldest, newest or disconnect)" << std::endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--framing") == 0 && i + 1 < argc)
+        {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "none") != 0 && strcmp(mode, "zmq") != 0 && strcmp(mode, "tcp") != 0 && strcmp(mode, "both") != 0)
+            {
+                std::cerr << "Invalid framing mode: " << mode << " (must be none, zmq, tcp or both)" << std::endl;
+                return 1;
+            }
+            options.frameZmqToTcp = (strcmp(mode, "zmq") == 0 || strcmp(mode, "both") == 0);
+            options.frameTcpToZmq = (strcmp(mode, "tcp") == 0 || strcmp(mode, "both") == 0);
+        }
+        else if (strcmp(argv[i], "--control-lane") == 0)
+        {
+            options.zmqControlLane = true;
+        }
+        else if (strcmp(argv[i], "--control-max-bytes") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("control packet size", argv[++i], 1, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.controlMaxBytes = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--bulk-bytes-per-tick") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("bulk byte budget", argv[++i], 0, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.bulkBytesPerTick = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--bulk-tick-us") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("bulk pacing interval", argv[++i], 100, 1000000, options.bulkTickUs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--filter-dids") == 0)
+        {
+            options.filterByDid = true;
+        }
+        else if (strcmp(argv[i], "--timestamp-frame") == 0)
+        {
+            options.zmqTimestampFrame = true;
+        }
+        else if (strcmp(argv[i], "--merge-window-us") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("merge window", argv[++i], 0, 10000000, options.mergeWindowUs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--rate-limit") == 0 && i + 1 < argc)
+        {
+            if (!parseRateList(argv[++i], options.clientRateLimits))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--conflate") == 0)
+        {
+            options.clientQueue.conflate = true;
+        }
+        else if (strcmp(argv[i], "--did-topic-prefix") == 0 && i + 1 < argc)
+        {
+            options.zmqDidTopicPrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--pass-topic") == 0 && i + 1 < argc)
+        {
+            options.zmqPassTopics.push_back(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--zmq-cpu") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("ZMQ thread CPU", argv[++i], 0, 4095, options.zmqThread.cpu))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tcp-cpu") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("TCP thread CPU", argv[++i], 0, 4095, options.tcpThread.cpu))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--fifo-priority") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("SCHED_FIFO priority", argv[++i], 1, 99, options.zmqThread.fifoPriority))
+            {
+                return 1;
+            }
+            options.tcpThread.fifoPriority = options.zmqThread.fifoPriority;
+        }
+        else if (strcmp(argv[i], "--busy-poll") == 0)
+        {
+            options.busyPoll = true;
+        }
+        else if (strcmp(argv[i], "--tcp-backend") == 0 && i + 1 < argc)
+        {
+            const char* backend = argv[++i];
+            if (strcmp(backend, "epoll") == 0)
+            {
+                options.tcpBackend = BRIDGE_TCP_BACKEND_EPOLL;
+            }
+            else if (strcmp(backend, "io_uring") == 0)
+            {
+                options.tcpBackend = BRIDGE_TCP_BACKEND_IO_URING;
+            }
+            else
+            {
+                std::cerr << "Invalid TCP backend: " << backend << " (must be epoll or io_uring)" << std::endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--busy-poll-us") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("busy-poll time", argv[++i], 0, 1000000, options.busyPollUs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tcp-shards") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("TCP shard count", argv[++i], 1, 64, options.tcpShards))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tx-adaptive") == 0)
+        {
+            options.tx.adaptive = true;
+        }
+        else if (strcmp(argv[i], "--tx-coalesce-rate") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("coalescing rate", argv[++i], 1, 10000000, options.tx.coalesceRate))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tx-flush-us") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("flush deadline", argv[++i], 1, 1000000, options.tx.flushUs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--tx-max-sndbuf") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("maximum send buffer", argv[++i], 0, 1 << 30, options.tx.maxSndbuf))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--handoff") == 0 && i + 1 < argc)
+        {
+            options.handoffPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace-sample") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("trace sample interval", argv[++i], 0, INT_MAX, options.traceSampleEvery))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--trace-records") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("trace record count", argv[++i], 1, 1 << 24, value))
+            {
+                return 1;
+            }
+            options.traceRecords = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--trace-dump") == 0 && i + 1 < argc)
+        {
+            traceDumpPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--zmq-reconnect-ms") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("ZMQ reconnect interval", argv[++i], 1, 60000, options.zmqReconnectIvlMs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--zmq-reconnect-max-ms") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("ZMQ reconnect interval", argv[++i], 0, 600000, options.zmqReconnectIvlMaxMs))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--cache-dids") == 0 && i + 1 < argc)
+        {
+            if (!parseDidList(argv[++i], options.lastValueDids))
+            {
+                return 1;
+            }
+            options.lastValueCache = true;
+        }
+        else if (strcmp(argv[i], "--cache-bytes") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("cache size", argv[++i], 1, INT_MAX, value))
+            {
+                return 1;
+            }
+            options.lastValueMaxBytes = static_cast<size_t>(value);
+        }
+        else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("metrics port", argv[++i], 1, 65535, metricsPort))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            options.capturePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture-segment-mb") == 0 && i + 1 < argc)
+        {
+            int value;
+            if (!parseIntArg("capture segment size", argv[++i], 1, 65536, value))
+            {
+                return 1;
+            }
+            options.captureSegmentBytes = static_cast<size_t>(value) * 1024 * 1024;
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc)
+        {
+            const char* speed = argv[++i];
+            if (strcmp(speed, "max") == 0)
+            {
+                replayOptions.speed = 0;
+            }
+            else
+            {
+                char* end = NULL;
+                replayOptions.speed = strtod(speed, &end);
+                if (end == speed || (*end != '\0' && strcmp(end, "x") != 0) || !(replayOptions.speed > 0))
+                {
+                    std::cerr << "Invalid replay speed: " << speed << " (must be a positive number or max)" << std::endl;
+                    return 1;
+                }
+            }
+        }
+        else if (strcmp(argv[i], "--replay-wait-clients") == 0 && i + 1 < argc)
+        {
+            if (!parseIntArg("replay client count", argv[++i], 0, 1024, replayOptions.waitClients))
+            {
+                return 1;
+            }
+        }
         else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
         {
             printUsage(argv[0]);
@@ -99,17 +718,46 @@ int main(int argc, char* argv[])
         }
     }
 
+    if (!options.zmqDidTopicPrefix.empty() && !options.filterByDid)
+    {
+        std::cerr << "--did-topic-prefix requires --filter-dids" << std::endl;
+        return 1;
+    }
+    if (options.mergeWindowUs > 0 && !options.zmqTimestampFrame)
+    {
+        std::cerr << "--merge-window-us requires --timestamp-frame" << std::endl;
+        return 1;
+    }
+    if (zmqRecvEndpoints.empty())
+    {
+        zmqRecvEndpoints.push_back("tcp://127.0.0.1:7115");
+    }
+
     // Register signal handlers
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+#if defined(SIGUSR1)
+    signal(SIGUSR1, traceSignalHandler);
+#endif
+
+    if (!replayPath.empty())
+    {
+        replayOptions.clientQueue = options.clientQueue;
+        return runReplay(replayPath, tcpPort, replayOptions);
+    }
+
+    if (!routesPath.empty())
+    {
+        return runHost(routesPath, hostThreads, options, metricsPort);
+    }
 
     // Create and start bridge
     cISZmqTcpBridge bridge;
-    g_bridge = &bridge;
+    bridge.SetOptions(options);
 
     std::cout << "Starting ZMQ-to-TCP Bridge..." << std::endl;
     
-    if (bridge.Start(zmqRecvEndpoint, zmqSendEndpoint, tcpPort) != 0)
+    if (bridge.Start(zmqRecvEndpoints, zmqSendEndpoint, tcpPort) != 0)
     {
         std::cerr << "Failed to start bridge" << std::endl;
         return 1;
@@ -119,12 +767,73 @@ int main(int argc, char* argv[])
     std::cout << "SDK clients can connect to TCP port " << tcpPort << std::endl;
     std::cout << "Connection string example: TCP:IS:127.0.0.1:" << tcpPort << std::endl;
 
-    // Keep running until interrupted
-    while (bridge.IsRunning())
+    cISBridgeMetricsServer metrics;
+    auto render = [&bridge]()
     {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::vector<sISZmqTcpBridgeStats> stats(1);
+        bridge.GetStats(stats[0]);
+        std::string out;
+        cISZmqTcpBridge::FormatPrometheus(stats, out);
+        return out;
+    };
+    if (metricsPort > 0)
+    {
+        if (metrics.Start(metricsPort, render) != 0)
+        {
+            bridge.Stop();
+            return 1;
+        }
+        std::cout << "Metrics at http://127.0.0.1:" << metricsPort << "/metrics" << std::endl;
     }
 
-    g_bridge = nullptr;
+    // Wait for the next bridge to take over, if asked to
+    int handoffSocket = -1;
+    if (!options.handoffPath.empty())
+    {
+        handoffSocket = bridgeHandoffListen(options.handoffPath);
+        if (handoffSocket >= 0)
+        {
+            std::cout << "Hand-off socket: " << options.handoffPath << std::endl;
+        }
+    }
+
+    // Keep running until interrupted or handed over
+    bool handedOff = false;
+    while (bridge.IsRunning() && !g_interrupted)
+    {
+        if (g_dumpTrace)
+        {
+            g_dumpTrace = 0;
+            dumpTrace(bridge, traceDumpPath);
+        }
+        if (handoffSocket < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+
+        int connection = bridgeHandoffAccept(handoffSocket, 200);
+        if (connection < 0)
+        {
+            continue;
+        }
+
+        // Free the metrics port for the new bridge before it starts
+        metrics.Stop();
+        handedOff = bridge.HandOff(connection) == 0;
+        bridgeHandoffClose(connection);
+        if (!handedOff && metricsPort > 0)
+        {
+            metrics.Start(metricsPort, render);
+        }
+    }
+
+    if (handoffSocket >= 0)
+    {
+        // After a hand-off the path belongs to the new bridge
+        bridgeHandoffClose(handoffSocket, handedOff ? std::string() : options.handoffPath);
+    }
+    metrics.Stop();
+    bridge.Stop();
     return 0;
 }
@@ -0,0 +1,256 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __BRIDGE_TEST_FIXTURE__H__
+#define __BRIDGE_TEST_FIXTURE__H__
+
+#include "ISZmqTcpBridge.h"
+#include "ISBridgeConsumer.h"
+#include "ISBridgeSocket.h"
+#include <gtest/gtest.h>
+#include <zmq.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BRIDGE_TEST_TIMEOUT_MS      2000
+
+/**
+ * Consumer that takes its time over every batch, so a bridge receives slower than a
+ * publisher sends and its SUB socket never runs dry
+ */
+class cSlowConsumer : public iISBridgeConsumer
+{
+public:
+    void OnBridgeMessages(const cISBridgeBufferRef* messages, int count) override
+    {
+        (void)messages;
+        (void)count;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+};
+
+/**
+ * The ZMQ side of a bridge under test: a PUB the bridge receives from and a SUB it
+ * publishes to, bound to free loopback ports so tests can run alongside each other.
+ * Start the bridge with StartBridge(), which lets it pick a free TCP port too.
+ */
+class BridgeTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_context = zmq_ctx_new();
+        m_pub = zmq_socket(m_context, ZMQ_PUB);
+        m_sub = zmq_socket(m_context, ZMQ_SUB);
+        int timeout = BRIDGE_TEST_TIMEOUT_MS;
+        zmq_setsockopt(m_sub, ZMQ_SUBSCRIBE, "", 0);
+        zmq_setsockopt(m_sub, ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+        ASSERT_EQ(0, zmq_bind(m_pub, "tcp://127.0.0.1:*"));
+        ASSERT_EQ(0, zmq_bind(m_sub, "tcp://127.0.0.1:*"));
+        m_pubEndpoint = LastEndpoint(m_pub);
+        m_subEndpoint = LastEndpoint(m_sub);
+    }
+
+    void TearDown() override
+    {
+        StopFlood();
+        m_bridge.Stop();
+        zmq_close(m_pub);
+        zmq_close(m_sub);
+        zmq_ctx_term(m_context);
+    }
+
+    /**
+     * Start m_bridge between the test sockets on a free TCP port, stored in m_tcpPort
+     * @return 0 if success
+     */
+    int StartBridge(const sISZmqTcpBridgeOptions& options = sISZmqTcpBridgeOptions())
+    {
+        m_bridge.SetOptions(options);
+        if (m_bridge.Start(m_pubEndpoint, m_subEndpoint, 0) != 0)
+        {
+            return -1;
+        }
+        sISZmqTcpBridgeStats stats;
+        m_bridge.GetStats(stats);
+        m_tcpPort = stats.tcpPort;
+        return 0;
+    }
+
+    /**
+     * Inject a probe until the bridge's PUB is connected and it arrives on m_sub, then
+     * discard whatever else arrived
+     * @return true once joined
+     */
+    bool JoinBridgePublisher(eISBridgeZmqLane lane = BRIDGE_ZMQ_LANE_BULK)
+    {
+        const uint8_t probe[1] = { 0 };
+        bool joined = false;
+        for (int i = 0; i < 100 && !joined; i++)
+        {
+            if (m_bridge.Inject(probe, sizeof(probe), lane) != 0)
+            {
+                return false;
+            }
+            zmq_pollitem_t item = { m_sub, 0, ZMQ_POLLIN, 0 };
+            joined = zmq_poll(&item, 1, 50) > 0;
+        }
+        uint8_t discard[16];
+        while (zmq_recv(m_sub, discard, sizeof(discard), ZMQ_DONTWAIT) >= 0)
+        {
+        }
+        return joined;
+    }
+
+    /**
+     * Receive count messages published by the bridge
+     * @return the messages, fewer on timeout
+     */
+    std::vector<std::string> Receive(int count)
+    {
+        std::vector<std::string> messages;
+        uint8_t data[1024];
+        for (int i = 0; i < count; i++)
+        {
+            int size = zmq_recv(m_sub, data, sizeof(data), 0);
+            if (size < 0)
+            {
+                break;
+            }
+            messages.push_back(std::string(reinterpret_cast<const char*>(data), static_cast<size_t>(size)));
+        }
+        return messages;
+    }
+
+    /**
+     * Publish on m_pub from another thread as fast as it goes, to a bridge slowed down
+     * by a cSlowConsumer, until StopFlood(). m_pub belongs to that thread meanwhile.
+     * @param messageSize bytes per message
+     * @param bridge the bridge receiving from m_pub, NULL for m_bridge
+     * @return true once the bridge receives the flood
+     */
+    bool StartFlood(int messageSize = 400, cISZmqTcpBridge* bridge = NULL)
+    {
+        m_floodBridge = bridge ? bridge : &m_bridge;
+        if (m_floodBridge->AddConsumer(&m_slowConsumer) != 0)
+        {
+            return false;
+        }
+        sISZmqTcpBridgeStats stats;
+        m_floodBridge->GetStats(stats);
+        uint64_t received = stats.zmqRxMessages;
+        m_flooding = true;
+        m_flood = std::thread([this, messageSize]()
+        {
+            std::vector<uint8_t> data(static_cast<size_t>(messageSize), 0);
+            while (m_flooding)
+            {
+                zmq_send(m_pub, data.data(), data.size(), ZMQ_DONTWAIT);
+            }
+        });
+        for (int i = 0; i < 200 && stats.zmqRxMessages == received; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            m_floodBridge->GetStats(stats);
+        }
+        return stats.zmqRxMessages != received;
+    }
+
+    /**
+     * Stop the flood and remove its consumer
+     */
+    void StopFlood()
+    {
+        if (m_flood.joinable())
+        {
+            m_flooding = false;
+            m_flood.join();
+            m_floodBridge->RemoveConsumer(&m_slowConsumer);
+        }
+    }
+
+    /**
+     * @return a TCP client connected to the bridge, invalid on failure
+     */
+    is_socket_t ConnectClient()
+    {
+        is_socket_t client = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(m_tcpPort));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bridgeSocketValid(client) && connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            bridgeSocketClose(client);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+        return client;
+    }
+
+    /**
+     * Read exactly size bytes from a client. Does not allocate.
+     * @return false on timeout or disconnect
+     */
+    static bool ReadClient(is_socket_t client, uint8_t* data, size_t size, int timeoutMs)
+    {
+        size_t received = 0;
+        while (received < size)
+        {
+            pollfd item = { client, POLLIN, 0 };
+            if (bridgeSocketPoll(&item, 1, timeoutMs) <= 0)
+            {
+                return false;
+            }
+            int n = static_cast<int>(bridgeSocketRecv(client, data + received, size - received, 0));
+            if (n <= 0)
+            {
+                return false;
+            }
+            received += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @return the endpoint a socket bound with a wildcard port ended up on
+     */
+    static std::string LastEndpoint(void* socket)
+    {
+        char endpoint[256];
+        size_t size = sizeof(endpoint);
+        if (zmq_getsockopt(socket, ZMQ_LAST_ENDPOINT, endpoint, &size) != 0 || size == 0)
+        {
+            return "";
+        }
+        return std::string(endpoint, size - 1);
+    }
+
+    cISZmqTcpBridge m_bridge;
+    void* m_context = nullptr;
+    void* m_pub = nullptr;             // The bridge receives from this
+    void* m_sub = nullptr;             // The bridge publishes to this
+    std::string m_pubEndpoint;
+    std::string m_subEndpoint;
+    int m_tcpPort = 0;
+    cSlowConsumer m_slowConsumer;
+    std::thread m_flood;
+    cISZmqTcpBridge* m_floodBridge = nullptr;
+    std::atomic<bool> m_flooding = { false };
+};
+
+#endif // __BRIDGE_TEST_FIXTURE__H__
@@ -0,0 +1,241 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+/*
+ * Counts heap allocations across warmed-up forwarding in both directions. Global
+ * operator new and, on glibc, malloc and friends are replaced for the whole process;
+ * only allocations made while counting is enabled are recorded.
+ *
+ * Payloads stay within libzmq's inline message size: libzmq itself allocates a content
+ * header for larger messages, which no bridge change can avoid.
+ */
+
+#include "bridge_test_fixture.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#define ALLOC_TEST_MESSAGE_SIZE     24
+#define ALLOC_TEST_WARMUP           2000
+#define ALLOC_TEST_MEASURED         2000
+
+static std::atomic<bool> s_counting(false);
+static std::atomic<uint64_t> s_allocations(0);
+
+static void countAllocation()
+{
+    if (s_counting.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__GLIBC__)
+
+// operator new below lands here too, so it is counted once
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    countAllocation();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+extern "C" void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+#define ALLOC_TEST_COUNT_NEW()
+
+#else
+
+#define ALLOC_TEST_COUNT_NEW()      countAllocation()
+
+#endif
+
+void* operator new(size_t size)
+{
+    ALLOC_TEST_COUNT_NEW();
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ALLOC_TEST_COUNT_NEW();
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace
+{
+
+class AllocationTest : public BridgeTest
+{
+protected:
+    void SetUp() override
+    {
+        BridgeTest::SetUp();
+        ASSERT_EQ(0, StartBridge());
+        m_client = ConnectClient();
+        ASSERT_TRUE(bridgeSocketValid(m_client));
+
+        // Publish until the bridge's subscription is up and the client sees a message
+        bool joined = false;
+        for (int i = 0; i < 100 && !joined; i++)
+        {
+            uint8_t probe[ALLOC_TEST_MESSAGE_SIZE] = {};
+            zmq_send(m_pub, probe, sizeof(probe), 0);
+            joined = ReadClient(m_client, probe, sizeof(probe), 50);
+        }
+        ASSERT_TRUE(joined);
+        while (ReadClientAny(50))
+        {
+        }
+
+        // The bridge's PUB drops what it publishes before m_sub's subscription arrives
+        ASSERT_TRUE(JoinBridgePublisher());
+    }
+
+    void TearDown() override
+    {
+        if (bridgeSocketValid(m_client))
+        {
+            bridgeSocketClose(m_client);
+        }
+        BridgeTest::TearDown();
+    }
+
+    /** Discard whatever the client has pending, false once nothing arrives */
+    bool ReadClientAny(int timeoutMs)
+    {
+        uint8_t data[256];
+        pollfd item = { m_client, POLLIN, 0 };
+        return bridgeSocketPoll(&item, 1, timeoutMs) > 0 && bridgeSocketRecv(m_client, data, sizeof(data), 0) > 0;
+    }
+
+    /** One message ZMQ -> TCP and one TCP -> ZMQ, false if either does not arrive */
+    bool RoundTrip(uint32_t sequence)
+    {
+        uint8_t out[ALLOC_TEST_MESSAGE_SIZE];
+        uint8_t in[ALLOC_TEST_MESSAGE_SIZE + 8];
+        memset(out, 0, sizeof(out));
+        memcpy(out, &sequence, sizeof(sequence));
+
+        if (zmq_send(m_pub, out, sizeof(out), 0) != static_cast<int>(sizeof(out)) ||
+            !ReadClient(m_client, in, sizeof(out), BRIDGE_TEST_TIMEOUT_MS) ||
+            memcmp(in, out, sizeof(out)) != 0)
+        {
+            return false;
+        }
+
+        out[sizeof(out) - 1] = 0xA5;
+        if (send(m_client, reinterpret_cast<const char*>(out), sizeof(out), MSG_NOSIGNAL) != static_cast<int>(sizeof(out)))
+        {
+            return false;
+        }
+        return zmq_recv(m_sub, in, sizeof(in), 0) == static_cast<int>(sizeof(out)) && memcmp(in, out, sizeof(out)) == 0;
+    }
+
+    is_socket_t m_client = -1;
+};
+
+TEST_F(AllocationTest, SteadyStateForwardingDoesNotAllocate)
+{
+    uint32_t sequence = 1;
+    for (int i = 0; i < ALLOC_TEST_WARMUP; i++)
+    {
+        ASSERT_TRUE(RoundTrip(sequence++));
+    }
+
+    // No gtest assertions inside the window; they may allocate
+    int failed = 0;
+    s_allocations = 0;
+    s_counting = true;
+    for (int i = 0; i < ALLOC_TEST_MEASURED; i++)
+    {
+        failed += RoundTrip(sequence++) ? 0 : 1;
+    }
+    s_counting = false;
+
+    EXPECT_EQ(0, failed);
+    EXPECT_EQ(0u, s_allocations.load());
+}
+
+}  // namespace
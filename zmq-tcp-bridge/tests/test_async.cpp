@@ -0,0 +1,278 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeAsync.h"
+#include "ISBridgeMetrics.h"
+#include "bridge_test_fixture.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * Run the executor until done() holds or a second passes
+ * @return true if done() held
+ */
+template <typename Done>
+bool runUntil(cISBridgePollExecutor& executor, Done done)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        executor.RunOnce(10);
+    }
+    return true;
+}
+
+/**
+ * Receive one message and record it
+ */
+sISBridgeTask receiveOne(cISBridgeAsync& async, bool& done, cISBridgeBufferRef& message)
+{
+    message = co_await async.Receive();
+    done = true;
+}
+
+/**
+ * Send one message and record the result
+ */
+sISBridgeTask sendOne(cISBridgeAsync& async, const std::string& data, bool& done, int& result)
+{
+    result = co_await async.Send(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    done = true;
+}
+
+/**
+ * Publish every message received back to ZMQ until closed
+ */
+sISBridgeTask echo(cISBridgeAsync& async, std::vector<std::string>& received, bool& done)
+{
+    while (cISBridgeBufferRef message = co_await async.Receive())
+    {
+        received.push_back(std::string(reinterpret_cast<const char*>(message->Data()), message->Size()));
+        co_await async.Send(message->Data(), message->Size());
+    }
+    done = true;
+}
+
+}  // namespace
+
+TEST(PollExecutor, PostedTasksRunInOrderOnTheLoop)
+{
+    cISBridgePollExecutor executor;
+    std::string order;
+    executor.Post([&] { order += 'a'; });
+    executor.Post([&] { order += 'b'; });
+    executor.Post([&] { order += 'c'; });
+    EXPECT_TRUE(order.empty());
+    EXPECT_EQ(executor.RunOnce(0), 3);
+    EXPECT_EQ(order, "abc");
+    EXPECT_EQ(executor.RunOnce(0), 0);
+}
+
+TEST(PollExecutor, PostFromAnotherThreadWakesTheLoop)
+{
+    cISBridgePollExecutor executor;
+    bool ran = false;
+    std::thread poster([&]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        executor.Post([&] { ran = true; });
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(runUntil(executor, [&] { return ran; }));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    poster.join();
+}
+
+TEST(PollExecutor, TimersRunOnceDue)
+{
+    cISBridgePollExecutor executor;
+    int soon = 0;
+    int later = 0;
+    uint64_t start = bridgeClockNs();
+    uint64_t laterNs = 0;
+    executor.PostAfter(50, [&] { later++; laterNs = bridgeClockNs(); });
+    executor.PostAfter(0, [&] { soon++; });
+    executor.RunOnce(0);
+    EXPECT_EQ(soon, 1);
+    EXPECT_EQ(later, 0);
+
+    // A blocking round wakes for the timer
+    executor.RunOnce(-1);
+    EXPECT_EQ(later, 1);
+    EXPECT_GE(laterNs - start, 50000000u);
+}
+
+#if defined(__linux__)
+TEST(PollExecutor, NanosecondTimersAreNotRoundedUp)
+{
+    cISBridgePollExecutor executor;
+    int soon = 0;
+    int later = 0;
+    uint64_t start = bridgeClockNs();
+    uint64_t soonNs = 0;
+    executor.PostAfterNs(100000, [&] { soon++; soonNs = bridgeClockNs(); });
+    executor.PostAfter(5, [&] { later++; });
+
+    // ppoll() wakes for the 100 us timer, well before the millisecond one
+    executor.RunOnce(-1);
+    EXPECT_EQ(soon, 1);
+    EXPECT_EQ(later, 0);
+    EXPECT_GE(soonNs - start, 100000u);
+}
+#endif
+
+TEST(PollExecutor, WatchIsLevelTriggeredUntilUnwatched)
+{
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    cISBridgePollExecutor executor;
+    int calls = 0;
+    executor.Watch(pair[0], [&] { calls++; });
+    executor.RunOnce(0);
+    EXPECT_EQ(calls, 0);
+
+    ASSERT_EQ(write(pair[1], "x", 1), 1);
+    executor.RunOnce(0);
+    executor.RunOnce(0);
+    EXPECT_EQ(calls, 2);
+
+    executor.Unwatch(pair[0]);
+    executor.RunOnce(0);
+    EXPECT_EQ(calls, 2);
+    close(pair[0]);
+    close(pair[1]);
+}
+
+TEST(PollExecutor, StopEndsRun)
+{
+    cISBridgePollExecutor executor;
+    std::thread loop([&] { executor.Run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    executor.Stop();
+    loop.join();
+}
+
+TEST(Async, CloseCompletesPendingAwaits)
+{
+    cISZmqTcpBridge bridge;
+    cISBridgePollExecutor executor;
+    cISBridgeAsync async(bridge, executor);
+    ASSERT_EQ(async.Attach(), 0);
+    EXPECT_EQ(async.Attach(), -1);
+
+    bool received = false;
+    cISBridgeBufferRef message;
+    receiveOne(async, received, message);
+    executor.RunOnce(0);
+    EXPECT_FALSE(received);
+
+    // The bridge is not running, so a send fails without waiting
+    bool sent = false;
+    int result = 0;
+    sendOne(async, "data", sent, result);
+    EXPECT_TRUE(runUntil(executor, [&] { return sent; }));
+    EXPECT_EQ(result, -1);
+
+    // Coroutines resume from the executor, not from inside Close()
+    async.Close();
+    EXPECT_FALSE(received);
+    EXPECT_TRUE(runUntil(executor, [&] { return received; }));
+    EXPECT_FALSE(message);
+    EXPECT_FALSE(async.IsOpen());
+
+    sent = false;
+    result = 0;
+    sendOne(async, "data", sent, result);
+    EXPECT_TRUE(sent);
+    EXPECT_EQ(result, -1);
+}
+
+TEST_F(BridgeTest, StartBusyPollsEveryShardThread)
+{
+    sISZmqTcpBridgeOptions options;
+    options.busyPoll = true;
+    options.tcpShards = 2;
+    ASSERT_EQ(0, StartBridge(options));
+    is_socket_t client = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(client));
+
+    // Nothing signals the busy-polling threads: they find the message, the client and
+    // its data by servicing their part of the bridge on every round
+    const uint8_t message[4] = { 'b', 'u', 's', 'y' };
+    uint8_t in[16];
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub, message, sizeof(message), 0);
+        joined = ReadClient(client, in, sizeof(message), 50);
+    }
+    ASSERT_TRUE(joined);
+    EXPECT_EQ(memcmp(in, message, sizeof(message)), 0);
+
+    ASSERT_TRUE(JoinBridgePublisher());
+    ASSERT_EQ(send(client, reinterpret_cast<const char*>(message), sizeof(message), MSG_NOSIGNAL), static_cast<int>(sizeof(message)));
+    ASSERT_EQ(zmq_recv(m_sub, in, sizeof(in), 0), static_cast<int>(sizeof(message)));
+    EXPECT_EQ(memcmp(in, message, sizeof(message)), 0);
+
+    bridgeSocketClose(client);
+    EXPECT_EQ(m_bridge.Stop(), 0);
+}
+
+TEST_F(BridgeTest, AsyncOpenRunsTheBridgeOnTheExecutor)
+{
+    cISBridgePollExecutor executor;
+    cISBridgeAsync async(m_bridge, executor);
+    ASSERT_EQ(async.Open({ m_pubEndpoint }, m_subEndpoint, 0), 0);
+    std::vector<std::string> received;
+    bool done = false;
+    echo(async, received, done);
+
+    // No forwarding threads: messages only move while the executor runs. Publish until
+    // the bridge's subscription is up, then until the echo makes it back.
+    const std::string message = "echo me";
+    uint8_t in[64];
+    int size = -1;
+    for (int i = 0; i < 100 && size < 0; i++)
+    {
+        zmq_send(m_pub, message.data(), message.size(), 0);
+        runUntil(executor, [&] { return !received.empty(); });
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        while (size < 0 && std::chrono::steady_clock::now() < deadline)
+        {
+            executor.RunOnce(1);
+            size = zmq_recv(m_sub, in, sizeof(in), ZMQ_DONTWAIT);
+        }
+    }
+    ASSERT_FALSE(received.empty());
+    EXPECT_EQ(received[0], message);
+    ASSERT_EQ(size, static_cast<int>(message.size()));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(in), static_cast<size_t>(size)), message);
+
+    async.Close();
+    EXPECT_FALSE(m_bridge.IsRunning());
+    EXPECT_TRUE(runUntil(executor, [&] { return done; }));
+}
+
+#endif
@@ -0,0 +1,232 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISZmqTcpBridgeHost.h"
+#include "bridge_test_fixture.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define HOST_TEST_LATENCY_MS        250                        // Loose: the publisher shares the CPU
+
+namespace
+{
+
+/**
+ * A route file in the test temp directory, removed afterwards
+ */
+class cRouteFile
+{
+public:
+    explicit cRouteFile(const std::string& text)
+        : path(::testing::TempDir() + "bridge_routes_" + ::testing::UnitTest::GetInstance()->current_test_info()->name())
+    {
+        std::ofstream(path) << text;
+    }
+
+    ~cRouteFile()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+std::vector<int> ports(const cISZmqTcpBridgeHost& host)
+{
+    std::vector<int> ports;
+    for (const sISZmqTcpBridgeRoute& route : host.Routes())
+    {
+        ports.push_back(route.tcpPort);
+    }
+    return ports;
+}
+
+/**
+ * Two routes served by one worker: route 0 between the fixture's sockets, route 1
+ * between a second PUB/SUB pair
+ */
+class HostTest : public BridgeTest
+{
+protected:
+    void SetUp() override
+    {
+        BridgeTest::SetUp();
+        m_pub1 = zmq_socket(m_context, ZMQ_PUB);
+        m_sub1 = zmq_socket(m_context, ZMQ_SUB);
+        int timeout = BRIDGE_TEST_TIMEOUT_MS;
+        zmq_setsockopt(m_sub1, ZMQ_SUBSCRIBE, "", 0);
+        zmq_setsockopt(m_sub1, ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+        ASSERT_EQ(0, zmq_bind(m_pub1, "tcp://127.0.0.1:*"));
+        ASSERT_EQ(0, zmq_bind(m_sub1, "tcp://127.0.0.1:*"));
+
+        ASSERT_EQ(0, m_host.AddRoute({ m_pubEndpoint, m_subEndpoint, 0 }));
+        ASSERT_EQ(0, m_host.AddRoute({ LastEndpoint(m_pub1), LastEndpoint(m_sub1), 0 }));
+        ASSERT_EQ(0, m_host.Start(1));
+    }
+
+    void TearDown() override
+    {
+        // The flood's consumer belongs to a route bridge
+        StopFlood();
+        m_host.Stop();
+        zmq_close(m_pub1);
+        zmq_close(m_sub1);
+        BridgeTest::TearDown();
+    }
+
+    cISZmqTcpBridgeHost m_host;
+    void* m_pub1 = nullptr;
+    void* m_sub1 = nullptr;
+};
+
+}  // namespace
+
+TEST(BridgeHost, LoadsRoutesSkippingCommentsAndBlankLines)
+{
+    cRouteFile file("# recv send port\n"
+                    "\n"
+                    "tcp://127.0.0.1:7115 tcp://127.0.0.1:7116 8000\n"
+                    "   \t\n"
+                    "  # indented comment\n"
+                    "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 8001\r\n");
+    cISZmqTcpBridgeHost host;
+    ASSERT_EQ(0, host.LoadRoutes(file.path));
+    ASSERT_EQ(host.Routes().size(), 2u);
+    EXPECT_EQ(host.Routes()[0].zmqRecvEndpoint, "tcp://127.0.0.1:7115");
+    EXPECT_EQ(host.Routes()[0].zmqSendEndpoint, "tcp://127.0.0.1:7116");
+    EXPECT_EQ(ports(host), std::vector<int>({ 8000, 8001 }));
+}
+
+TEST(BridgeHost, ParseErrorsAddNothing)
+{
+    const char* bad[] =
+    {
+        "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136\n",
+        "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 port\n",
+        "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 8001 extra\n",
+        "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 70000\n",
+        "tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 -1\n",
+    };
+    for (const char* line : bad)
+    {
+        cISZmqTcpBridgeHost host;
+        ASSERT_EQ(0, host.AddRoute({ "tcp://127.0.0.1:7115", "tcp://127.0.0.1:7116", 8000 }));
+        cRouteFile file(std::string("tcp://127.0.0.1:7155 tcp://127.0.0.1:7156 8002\n") + line);
+        EXPECT_EQ(host.LoadRoutes(file.path), -1) << line;
+        EXPECT_EQ(ports(host), std::vector<int>({ 8000 })) << line;
+    }
+
+    cISZmqTcpBridgeHost host;
+    EXPECT_EQ(host.LoadRoutes(::testing::TempDir() + "bridge_routes_missing"), -1);
+    EXPECT_TRUE(host.Routes().empty());
+}
+
+TEST(BridgeHost, DuplicatePortsRollBackTheWholeFile)
+{
+    cISZmqTcpBridgeHost host;
+    ASSERT_EQ(0, host.AddRoute({ "tcp://127.0.0.1:7115", "tcp://127.0.0.1:7116", 8000 }));
+
+    // Within the file
+    cRouteFile within("tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 8001\n"
+                      "tcp://127.0.0.1:7155 tcp://127.0.0.1:7156 8002\n"
+                      "tcp://127.0.0.1:7175 tcp://127.0.0.1:7176 8001\n");
+    EXPECT_EQ(host.LoadRoutes(within.path), -1);
+    EXPECT_EQ(ports(host), std::vector<int>({ 8000 }));
+
+    // With a route added before
+    cRouteFile existing("tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 8001\n"
+                        "tcp://127.0.0.1:7155 tcp://127.0.0.1:7156 8000\n");
+    EXPECT_EQ(host.LoadRoutes(existing.path), -1);
+    EXPECT_EQ(ports(host), std::vector<int>({ 8000 }));
+
+    // Free ports never clash
+    cRouteFile free("tcp://127.0.0.1:7135 tcp://127.0.0.1:7136 0\n"
+                    "tcp://127.0.0.1:7155 tcp://127.0.0.1:7156 0\n");
+    EXPECT_EQ(host.LoadRoutes(free.path), 0);
+    EXPECT_EQ(ports(host), std::vector<int>({ 8000, 0, 0 }));
+}
+
+TEST_F(HostTest, RoutesAreNotAddedWhileRunning)
+{
+    EXPECT_EQ(m_host.AddRoute({ "tcp://127.0.0.1:7135", "tcp://127.0.0.1:7136", 0 }), -1);
+    EXPECT_EQ(m_host.Routes().size(), 2u);
+}
+
+TEST_F(HostTest, FloodedRouteDoesNotStarveItsNeighbour)
+{
+    cISZmqTcpBridge* quiet = m_host.Bridge(1);
+    ASSERT_NE(quiet, nullptr);
+    sISZmqTcpBridgeStats stats;
+    quiet->GetStats(stats);
+    m_tcpPort = stats.tcpPort;
+    ASSERT_NE(m_tcpPort, 0);
+    is_socket_t client = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(client));
+
+    // Publish on the quiet route until its subscription is up and the client is served
+    uint8_t message[8] = { 'q', 'u', 'i', 'e', 't', 0, 0, 0 };
+    uint8_t data[sizeof(message)];
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub1, message, sizeof(message), 0);
+        joined = ReadClient(client, data, sizeof(data), 50);
+    }
+    ASSERT_TRUE(joined);
+    while (ReadClient(client, data, sizeof(data), 100))
+    {
+    }
+
+    // Flood the other route on the same worker; the quiet one still forwards promptly
+    // both ways
+    ASSERT_TRUE(StartFlood(400, m_host.Bridge(0)));
+    std::chrono::steady_clock::duration worst(0);
+    for (int i = 0; i < 20; i++)
+    {
+        message[7] = static_cast<uint8_t>(i);
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(zmq_send(m_pub1, message, sizeof(message), 0), static_cast<int>(sizeof(message)));
+        ASSERT_TRUE(ReadClient(client, data, sizeof(data), BRIDGE_TEST_TIMEOUT_MS));
+        EXPECT_EQ(memcmp(data, message, sizeof(message)), 0);
+
+        ASSERT_EQ(0, quiet->Inject(message, sizeof(message)));
+        if (i == 0)
+        {
+            // The route's PUB may still be connecting
+            zmq_pollitem_t item = { m_sub1, 0, ZMQ_POLLIN, 0 };
+            for (int retry = 0; retry < 100 && zmq_poll(&item, 1, 50) == 0; retry++)
+            {
+                ASSERT_EQ(0, quiet->Inject(message, sizeof(message)));
+            }
+        }
+        else
+        {
+            worst = std::max(worst, std::chrono::steady_clock::now() - start);
+        }
+        ASSERT_EQ(zmq_recv(m_sub1, data, sizeof(data), 0), static_cast<int>(sizeof(message)));
+        while (zmq_recv(m_sub1, data, sizeof(data), ZMQ_DONTWAIT) >= 0)
+        {
+        }
+    }
+    EXPECT_LT(worst, std::chrono::milliseconds(HOST_TEST_LATENCY_MS));
+
+    m_host.Bridge(0)->GetStats(stats);
+    EXPECT_GT(stats.zmqRxMessages, 0u);
+    bridgeSocketClose(client);
+}
@@ -0,0 +1,166 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeBroadcastRing.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return messages tagged first, first + 1, ... in their first byte, taken from a pool
+ */
+std::vector<cISBridgeBufferRef> messages(cISBridgeBufferPool& pool, uint8_t first, int count)
+{
+    std::vector<cISBridgeBufferRef> result;
+    for (int i = 0; i < count; i++)
+    {
+        cISBridgeBufferRef buffer = pool.Acquire(4);
+        buffer->Data()[0] = static_cast<uint8_t>(first + i);
+        buffer->SetSize(4);
+        result.push_back(buffer);
+    }
+    return result;
+}
+
+/**
+ * @return the tags of everything a reader can take right now
+ */
+std::vector<uint8_t> readTags(cISBridgeBroadcastRing& ring, int reader)
+{
+    std::vector<uint8_t> tags;
+    cISBridgeBufferRef batch[4];
+    int n;
+    while ((n = ring.Read(reader, batch, 4)) > 0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            tags.push_back(batch[i]->Data()[0]);
+            batch[i].Reset();
+        }
+    }
+    return tags;
+}
+
+}  // namespace
+
+TEST(BroadcastRing, EveryReaderSeesEveryMessageInOrder)
+{
+    cISBridgeBufferPool pool(4, 16);
+    cISBridgeBroadcastRing ring(8, 3);
+    std::vector<cISBridgeBufferRef> batch = messages(pool, 10, 5);
+    EXPECT_EQ(ring.Publish(batch.data(), 5), 5);
+
+    std::vector<uint8_t> expected = { 10, 11, 12, 13, 14 };
+    for (int reader = 0; reader < 3; reader++)
+    {
+        EXPECT_EQ(readTags(ring, reader), expected) << "reader " << reader;
+    }
+    EXPECT_TRUE(readTags(ring, 0).empty());
+}
+
+TEST(BroadcastRing, LastReaderReleasesTheBuffer)
+{
+    cISBridgeBufferPool pool(4, 4);
+    cISBridgeBroadcastRing ring(4, 2);
+    {
+        std::vector<cISBridgeBufferRef> batch = messages(pool, 0, 2);
+        ring.Publish(batch.data(), 2);
+    }
+    EXPECT_EQ(pool.GetStats().blocksInUse, 2u);
+
+    readTags(ring, 0);
+    EXPECT_EQ(pool.GetStats().blocksInUse, 2u);
+    readTags(ring, 1);
+    EXPECT_EQ(pool.GetStats().blocksInUse, 0u);
+}
+
+TEST(BroadcastRing, DropsWhenTheSlowestReaderIsAFullRingBehind)
+{
+    cISBridgeBufferPool pool(4, 16);
+    cISBridgeBroadcastRing ring(3, 2);
+    EXPECT_EQ(ring.GetStats().capacity, 4u);
+
+    std::vector<cISBridgeBufferRef> batch = messages(pool, 0, 6);
+    EXPECT_EQ(ring.Publish(batch.data(), 6), 4);
+
+    // The fast reader frees nothing while the slow one still holds every slot
+    EXPECT_EQ(readTags(ring, 0).size(), 4u);
+    EXPECT_EQ(ring.Publish(batch.data() + 4, 2), 0);
+
+    std::vector<uint8_t> expected = { 0, 1, 2, 3 };
+    EXPECT_EQ(readTags(ring, 1), expected);
+    EXPECT_EQ(ring.Publish(batch.data() + 4, 2), 2);
+
+    sISBridgeBroadcastRingStats stats = ring.GetStats();
+    EXPECT_EQ(stats.published, 6u);
+    EXPECT_EQ(stats.dropped, 4u);
+}
+
+TEST(BroadcastRing, ConcurrentReadersSeeTheSameSequence)
+{
+    const int kReaders = 3;
+    const int kMessages = 20000;
+    cISBridgeBroadcastRing ring(64, kReaders);
+    std::vector<std::vector<uint8_t>> received(kReaders);
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < kReaders; reader++)
+    {
+        readers.emplace_back([&ring, &received, reader]
+        {
+            cISBridgeBufferRef batch[16];
+            while (received[reader].size() < static_cast<size_t>(kMessages))
+            {
+                int n = ring.Read(reader, batch, 16);
+                for (int i = 0; i < n; i++)
+                {
+                    received[reader].push_back(batch[i]->Data()[0]);
+                    batch[i].Reset();
+                }
+                if (n == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int sent = 0; sent < kMessages; )
+    {
+        cISBridgeBufferRef buffer(cISBridgeBuffer::Create(1));
+        buffer->Data()[0] = static_cast<uint8_t>(sent);
+        buffer->SetSize(1);
+        if (ring.Publish(&buffer, 1) == 1)
+        {
+            sent++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    for (int reader = 0; reader < kReaders; reader++)
+    {
+        ASSERT_EQ(received[reader].size(), static_cast<size_t>(kMessages));
+        for (int i = 0; i < kMessages; i++)
+        {
+            ASSERT_EQ(received[reader][i], static_cast<uint8_t>(i)) << "reader " << reader;
+        }
+    }
+}
@@ -0,0 +1,219 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeCapture.h"
+#include "ISBridgeReplay.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * A capture path in the test temp directory whose segments are removed afterwards
+ */
+class cCapturePath
+{
+public:
+    explicit cCapturePath(const char* name) : path(::testing::TempDir() + name + "_" + std::to_string(getpid())) {}
+
+    ~cCapturePath()
+    {
+        for (uint32_t i = 0; std::remove(cISBridgeCaptureWriter::SegmentPath(path, i).c_str()) == 0; i++)
+        {
+        }
+    }
+
+    std::string path;
+};
+
+std::string text(const sISBridgeCaptureRecord& record)
+{
+    return std::string(reinterpret_cast<const char*>(record.data), record.size);
+}
+
+void record(cISBridgeCaptureWriter& writer, eISBridgeCaptureDirection direction, uint32_t clientId, const std::string& payload, uint64_t timestampNs)
+{
+    writer.Record(direction, clientId, reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), timestampNs);
+}
+
+}  // namespace
+
+TEST(Capture, ReaderReturnsRecordsInTimestampOrder)
+{
+    cCapturePath capture("capture_order");
+    cISBridgeCaptureWriter writer;
+    ASSERT_EQ(writer.Open(capture.path, 64 * 1024, 16 * 1024), 0);
+
+    // The two rings are merged by timestamp
+    record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, "zmq-1", 100);
+    record(writer, BRIDGE_CAPTURE_CLIENT_CONNECT, 7, "", 150);
+    record(writer, BRIDGE_CAPTURE_TCP_TO_ZMQ, 7, "tcp-1", 200);
+    record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, "zmq-2", 300);
+    record(writer, BRIDGE_CAPTURE_CLIENT_DISCONNECT, 7, "", 400);
+    writer.Close();
+
+    sISBridgeCaptureStats stats = writer.GetStats();
+    EXPECT_EQ(stats.records, 5u);
+    EXPECT_EQ(stats.bytes, 15u);
+    EXPECT_EQ(stats.droppedRecords, 0u);
+    EXPECT_EQ(stats.segments, 1u);
+
+    cISBridgeCaptureReader reader;
+    ASSERT_EQ(reader.Open(capture.path), 0);
+    EXPECT_EQ(std::string(reader.Header().magic, 8), BRIDGE_CAPTURE_MAGIC);
+    EXPECT_EQ(reader.Header().version, static_cast<uint32_t>(BRIDGE_CAPTURE_VERSION));
+
+    const eISBridgeCaptureDirection directions[] = { BRIDGE_CAPTURE_ZMQ_TO_TCP, BRIDGE_CAPTURE_CLIENT_CONNECT, BRIDGE_CAPTURE_TCP_TO_ZMQ,
+                                                     BRIDGE_CAPTURE_ZMQ_TO_TCP, BRIDGE_CAPTURE_CLIENT_DISCONNECT };
+    const char* payloads[] = { "zmq-1", "", "tcp-1", "zmq-2", "" };
+    sISBridgeCaptureRecord next;
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(reader.Next(next)) << "record " << i;
+        EXPECT_EQ(next.direction, directions[i]);
+        EXPECT_EQ(text(next), payloads[i]);
+        EXPECT_EQ(next.clientId, (directions[i] == BRIDGE_CAPTURE_ZMQ_TO_TCP) ? 0u : 7u);
+    }
+    EXPECT_FALSE(reader.Next(next));
+
+    reader.Rewind();
+    ASSERT_TRUE(reader.Next(next));
+    EXPECT_EQ(text(next), "zmq-1");
+}
+
+TEST(Capture, RecordsSpanSegments)
+{
+    cCapturePath capture("capture_segments");
+    cISBridgeCaptureWriter writer;
+    // Segments are at least large enough for the biggest record the ring accepts
+    ASSERT_EQ(writer.Open(capture.path, 4096, 4096), 0);
+    std::string payload(1000, 'x');
+    for (int i = 0; i < 20; i++)
+    {
+        payload[0] = static_cast<char>('a' + i);
+        record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, payload, 1000 + i);
+
+        // Let the writer drain the small ring before the next record
+        while (writer.GetStats().records < static_cast<uint64_t>(i + 1))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    writer.Close();
+    EXPECT_GT(writer.GetStats().segments, 1u);
+
+    cISBridgeCaptureReader reader;
+    ASSERT_EQ(reader.Open(capture.path), 0);
+    sISBridgeCaptureRecord next;
+    int count = 0;
+    while (reader.Next(next))
+    {
+        ASSERT_EQ(next.size, payload.size());
+        EXPECT_EQ(next.data[0], static_cast<uint8_t>('a' + count));
+        EXPECT_EQ(next.timestampNs, static_cast<uint64_t>(1000 + count));
+        count++;
+    }
+    EXPECT_EQ(count, 20);
+}
+
+TEST(Capture, DropsRecordsLargerThanTheRing)
+{
+    cCapturePath capture("capture_drop");
+    cISBridgeCaptureWriter writer;
+    ASSERT_EQ(writer.Open(capture.path, 64 * 1024, 4096), 0);
+    record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, std::string(8192, 'x'), 1);
+    record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, "kept", 2);
+    writer.Close();
+
+    sISBridgeCaptureStats stats = writer.GetStats();
+    EXPECT_EQ(stats.records, 1u);
+    EXPECT_EQ(stats.droppedRecords, 1u);
+    EXPECT_EQ(stats.droppedBytes, 8192u);
+
+    cISBridgeCaptureReader reader;
+    ASSERT_EQ(reader.Open(capture.path), 0);
+    sISBridgeCaptureRecord next;
+    ASSERT_TRUE(reader.Next(next));
+    EXPECT_EQ(text(next), "kept");
+    EXPECT_FALSE(reader.Next(next));
+}
+
+TEST(Replay, ServesTheCapturedZmqStream)
+{
+    cCapturePath capture("capture_replay");
+    cISBridgeCaptureWriter writer;
+    ASSERT_EQ(writer.Open(capture.path, 64 * 1024, 16 * 1024), 0);
+    std::string expected;
+    for (int i = 0; i < 100; i++)
+    {
+        std::string payload = "message " + std::to_string(i) + ";";
+        record(writer, BRIDGE_CAPTURE_ZMQ_TO_TCP, 0, payload, 1000 * i);
+        expected += payload;
+        if (i % 10 == 0)
+        {
+            // Client traffic is not replayed
+            record(writer, BRIDGE_CAPTURE_TCP_TO_ZMQ, 1, "command", 1000 * i + 1);
+        }
+    }
+    writer.Close();
+
+    sISBridgeReplayOptions options;
+    options.speed = 0;
+    options.waitClients = 1;
+    cISBridgeReplay replay;
+    replay.SetOptions(options);
+    ASSERT_EQ(replay.Start(capture.path, 0), 0);
+
+    int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(replay.Port()));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    timeval timeout = { 2, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string received;
+    char buffer[4096];
+    while (received.size() < expected.size())
+    {
+        ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        received.append(buffer, static_cast<size_t>(n));
+    }
+    EXPECT_EQ(received, expected);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (replay.IsRunning() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(replay.IsRunning());
+    close(client);
+    EXPECT_EQ(replay.Stop(), 0);
+}
+
+#endif
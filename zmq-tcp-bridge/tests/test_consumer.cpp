@@ -0,0 +1,297 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeConsumer.h"
+#include "bridge_test_fixture.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return a message of size bytes, all set to tag
+ */
+cISBridgeBufferRef message(uint8_t tag, size_t size = 10)
+{
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(size));
+    memset(buffer->Data(), tag, size);
+    buffer->SetSize(size);
+    return buffer;
+}
+
+/**
+ * @return true if the queue's descriptor becomes readable within timeoutMs
+ */
+bool readable(const cISBridgeConsumerQueue& queue, int timeoutMs)
+{
+    pollfd item = { queue.Fd(), POLLIN, 0 };
+    return bridgeSocketPoll(&item, 1, timeoutMs) > 0;
+}
+
+/**
+ * Echoes what a TCP client sends to every TCP client, as a delegate override would
+ */
+class cEchoBridge : public cISZmqTcpBridge
+{
+public:
+    std::atomic<int> servers = { 0 };   // Non-NULL server arguments seen
+
+protected:
+    void OnClientDataReceived(cISTcpServer* server, is_socket_t socket, uint8_t* data, int dataLength) override
+    {
+        if (server != NULL)
+        {
+            servers++;
+        }
+        WriteTcpClients(data, dataLength);
+        cISZmqTcpBridge::OnClientDataReceived(server, socket, data, dataLength);
+    }
+};
+
+}  // namespace
+
+TEST(ConsumerQueue, HandsOverTheSameBuffersInOrder)
+{
+    cISBridgeConsumerQueue queue(16);
+    cISBridgeBufferRef messages[3] = { message(1), message(2), message(3) };
+    queue.OnBridgeMessages(messages, 3);
+
+    cISBridgeBufferRef popped;
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(queue.Pop(popped));
+        EXPECT_EQ(popped.Get(), messages[i].Get());
+    }
+    EXPECT_FALSE(queue.Pop(popped));
+}
+
+TEST(ConsumerQueue, FdIsReadableUntilTheReaderRunsDry)
+{
+    cISBridgeConsumerQueue queue(16);
+    EXPECT_FALSE(readable(queue, 0));
+
+    cISBridgeBufferRef first = message(1);
+    queue.OnBridgeMessages(&first, 1);
+    EXPECT_TRUE(readable(queue, BRIDGE_TEST_TIMEOUT_MS));
+
+    cISBridgeBufferRef popped;
+    ASSERT_TRUE(queue.Pop(popped));
+    EXPECT_FALSE(queue.Pop(popped));
+    EXPECT_FALSE(readable(queue, 0));
+
+    // The next push after running dry signals again
+    cISBridgeBufferRef second = message(2);
+    queue.OnBridgeMessages(&second, 1);
+    EXPECT_TRUE(readable(queue, BRIDGE_TEST_TIMEOUT_MS));
+    ASSERT_TRUE(queue.Pop(popped));
+    EXPECT_EQ(popped->Data()[0], 2);
+}
+
+TEST(ConsumerQueue, DropsNewMessagesWhenFull)
+{
+    cISBridgeConsumerQueue queue(4);
+    std::vector<cISBridgeBufferRef> messages;
+    for (int i = 0; i < 6; i++)
+    {
+        messages.push_back(message(static_cast<uint8_t>(i)));
+    }
+    queue.OnBridgeMessages(messages.data(), 6);
+
+    sISBridgeMpscQueueStats stats = queue.GetStats();
+    EXPECT_EQ(stats.pushed, 4u);
+    EXPECT_EQ(stats.dropped, 2u);
+
+    cISBridgeBufferRef popped;
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(queue.Pop(popped));
+        EXPECT_EQ(popped->Data()[0], i);
+    }
+    EXPECT_FALSE(queue.Pop(popped));
+}
+
+TEST(ConsumerQueue, QueuedMessagesOutliveTheSender)
+{
+    cISBridgeConsumerQueue queue(16);
+    {
+        cISBridgeBufferRef sent = message(7);
+        queue.OnBridgeMessages(&sent, 1);
+    }
+    cISBridgeBufferRef popped;
+    ASSERT_TRUE(queue.Pop(popped));
+    EXPECT_FALSE(popped->IsShared());
+    EXPECT_EQ(popped->Data()[0], 7);
+}
+
+TEST(Bridge, ConsumersRegisterOnce)
+{
+    cISZmqTcpBridge bridge;
+    cISBridgeConsumerQueue queue;
+    EXPECT_EQ(bridge.AddConsumer(nullptr), -1);
+    EXPECT_EQ(bridge.AddConsumer(&queue), 0);
+    EXPECT_EQ(bridge.AddConsumer(&queue), -1);
+    EXPECT_EQ(bridge.RemoveConsumer(&queue), 0);
+    EXPECT_EQ(bridge.RemoveConsumer(&queue), -1);
+}
+
+TEST(Bridge, InjectFailsWhileStopped)
+{
+    cISZmqTcpBridge bridge;
+    const uint8_t data[4] = { 1, 2, 3, 4 };
+    EXPECT_EQ(bridge.Inject(data, sizeof(data)), -1);
+    EXPECT_EQ(bridge.Inject(nullptr, 4), -1);
+}
+
+TEST(Bridge, WriteTcpClientsFailsWhileStopped)
+{
+    cISZmqTcpBridge bridge;
+    const uint8_t data[4] = { 1, 2, 3, 4 };
+    EXPECT_EQ(bridge.WriteTcpClients(data, sizeof(data)), -1);
+}
+
+TEST_F(BridgeTest, DelegateWritesToEveryTcpClient)
+{
+    sISZmqTcpBridgeOptions options;
+    options.tcpShards = 2;
+    cEchoBridge bridge;
+    bridge.SetOptions(options);
+    ASSERT_EQ(0, bridge.Start(m_pubEndpoint, m_subEndpoint, 0));
+    sISZmqTcpBridgeStats stats;
+    bridge.GetStats(stats);
+    m_tcpPort = stats.tcpPort;
+
+    // Wait until both clients are registered, whichever shard accepted them
+    is_socket_t sender = ConnectClient();
+    is_socket_t listener = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(sender));
+    ASSERT_TRUE(bridgeSocketValid(listener));
+    std::vector<sISBridgeTcpClientStats> clients;
+    for (int i = 0; i < 200 && clients.size() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        bridge.GetClientStats(clients);
+    }
+    ASSERT_EQ(clients.size(), 2u);
+
+    const uint8_t ping[4] = { 'p', 'i', 'n', 'g' };
+    ASSERT_EQ(send(sender, reinterpret_cast<const char*>(ping), sizeof(ping), MSG_NOSIGNAL), static_cast<int>(sizeof(ping)));
+    uint8_t in[4];
+    ASSERT_TRUE(ReadClient(listener, in, sizeof(in), BRIDGE_TEST_TIMEOUT_MS));
+    EXPECT_EQ(memcmp(in, ping, sizeof(ping)), 0);
+    ASSERT_TRUE(ReadClient(sender, in, sizeof(in), BRIDGE_TEST_TIMEOUT_MS));
+    EXPECT_EQ(memcmp(in, ping, sizeof(ping)), 0);
+    EXPECT_EQ(bridge.servers, 0);
+
+    bridgeSocketClose(sender);
+    bridgeSocketClose(listener);
+    bridge.Stop();
+    EXPECT_EQ(bridge.WriteTcpClients(ping, sizeof(ping)), -1);
+}
+
+TEST_F(BridgeTest, ConsumerAndInjectBypassTcp)
+{
+    cISBridgeConsumerQueue queue;
+    ASSERT_EQ(0, m_bridge.AddConsumer(&queue));
+    ASSERT_EQ(0, StartBridge());
+
+    // Publish until the bridge's subscription is up and the consumer sees a message
+    const uint8_t published[8] = { 'p', 'u', 'b', 'l', 'i', 's', 'h', 0 };
+    cISBridgeBufferRef received;
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub, published, sizeof(published), 0);
+        joined = readable(queue, 50) && queue.Pop(received);
+    }
+    ASSERT_TRUE(joined);
+    ASSERT_EQ(received->Size(), sizeof(published));
+    EXPECT_EQ(memcmp(received->Data(), published, sizeof(published)), 0);
+
+    // Injected data reaches ZMQ as one message; retry until the bridge's PUB is connected
+    const uint8_t injected[6] = { 'i', 'n', 'j', 'e', 'c', 't' };
+    uint8_t in[16];
+    int size = -1;
+    for (int i = 0; i < 20 && size < 0; i++)
+    {
+        ASSERT_EQ(0, m_bridge.Inject(injected, sizeof(injected)));
+        size = zmq_recv(m_sub, in, sizeof(in), ZMQ_DONTWAIT);
+        if (size < 0)
+        {
+            zmq_pollitem_t item = { m_sub, 0, ZMQ_POLLIN, 0 };
+            if (zmq_poll(&item, 1, 100) > 0)
+            {
+                size = zmq_recv(m_sub, in, sizeof(in), 0);
+            }
+        }
+    }
+    ASSERT_EQ(size, static_cast<int>(sizeof(injected)));
+    EXPECT_EQ(memcmp(in, injected, sizeof(injected)), 0);
+
+    // Nothing more reaches a removed consumer
+    EXPECT_EQ(0, m_bridge.RemoveConsumer(&queue));
+    while (queue.Pop(received))
+    {
+    }
+    zmq_send(m_pub, published, sizeof(published), 0);
+    EXPECT_FALSE(readable(queue, 100));
+
+    m_bridge.Stop();
+    EXPECT_EQ(m_bridge.Inject(injected, sizeof(injected)), -1);
+}
+
+TEST_F(BridgeTest, HeldBatchDoesNotDelayCommands)
+{
+    const int holdUs = 300000;
+    sISZmqTcpBridgeOptions options;
+    options.maxBatchHoldUs = holdUs;
+    cISBridgeConsumerQueue queue;
+    ASSERT_EQ(0, m_bridge.AddConsumer(&queue));
+    ASSERT_EQ(0, StartBridge(options));
+    ASSERT_TRUE(JoinBridgePublisher());
+
+    // Publish until the bridge's subscription is up, then let every held batch go out
+    const uint8_t published[4] = { 'h', 'e', 'l', 'd' };
+    cISBridgeBufferRef received;
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub, published, sizeof(published), 0);
+        joined = readable(queue, 50);
+    }
+    ASSERT_TRUE(joined);
+    std::this_thread::sleep_for(std::chrono::microseconds(2 * holdUs));
+    while (queue.Pop(received))
+    {
+    }
+
+    // One message starts a held batch; a command injected meanwhile goes out right away
+    auto start = std::chrono::steady_clock::now();
+    zmq_send(m_pub, published, sizeof(published), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const uint8_t command[3] = { 'c', 'm', 'd' };
+    ASSERT_EQ(0, m_bridge.Inject(command, sizeof(command)));
+    std::vector<std::string> messages = Receive(1);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0], "cmd");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::microseconds(holdUs / 2));
+    EXPECT_FALSE(queue.Pop(received));
+
+    // The held message follows at its deadline
+    ASSERT_TRUE(readable(queue, BRIDGE_TEST_TIMEOUT_MS));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(holdUs * 9 / 10));
+    ASSERT_TRUE(queue.Pop(received));
+    EXPECT_EQ(memcmp(received->Data(), published, sizeof(published)), 0);
+}
@@ -0,0 +1,283 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "ISBridgeDidFilter.h"
+#include "ISComm.h"
+#include <gtest/gtest.h>
+
+// The filter's wire constants must match the SDK encoder's
+static_assert(BRIDGE_ISB_PKT_TYPE_GET_DATA == PKT_TYPE_GET_DATA, "get-data type");
+static_assert(BRIDGE_ISB_PKT_TYPE_SET_DATA == PKT_TYPE_SET_DATA, "set-data type");
+static_assert(BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_ALL == PKT_TYPE_STOP_BROADCASTS_ALL_PORTS, "stop-all type");
+static_assert(BRIDGE_ISB_PKT_TYPE_STOP_DID_BROADCAST == PKT_TYPE_STOP_DID_BROADCAST, "stop-DID type");
+static_assert(BRIDGE_ISB_PKT_TYPE_STOP_BROADCASTS_PORT == PKT_TYPE_STOP_BROADCASTS_CURRENT_PORT, "stop-port type");
+static_assert(BRIDGE_ISB_FLAGS_PAYLOAD_W_OFFSET == ISB_FLAGS_PAYLOAD_W_OFFSET, "offset flag");
+static_assert(BRIDGE_ISB_DID_RMC == DID_RMC, "RMC data ID");
+
+namespace
+{
+
+/**
+ * Encodes commands with the SDK, frames them like the bridge does and applies them to a filter
+ */
+class cSdkClient
+{
+public:
+    cSdkClient() : m_comm(), m_framer(&m_counters) {}
+
+    bool GetData(uint16_t did, uint32_t period)
+    {
+        return Apply(is_comm_get_data_to_buf(m_buffer, sizeof(m_buffer), &m_comm, did, 0, 0, period));
+    }
+
+    bool Send(uint8_t type, uint16_t did, void* data = NULL, uint16_t size = 0, uint16_t offset = 0)
+    {
+        return Apply(is_comm_write_to_buf(m_buffer, sizeof(m_buffer), &m_comm, type, did, size, offset, data));
+    }
+
+    bool StopDid(uint16_t did) { return Send(PKT_TYPE_STOP_DID_BROADCAST, did); }
+    bool StopAll() { return Send(PKT_TYPE_STOP_BROADCASTS_ALL_PORTS, 0); }
+
+    bool SetRmc(uint64_t bits)
+    {
+        rmc_t rmc = {};
+        rmc.bits = bits;
+        return Send(PKT_TYPE_SET_DATA, DID_RMC, &rmc, sizeof(rmc));
+    }
+
+    cISBridgeDidFilter filter;
+
+private:
+    bool Apply(int size)
+    {
+        EXPECT_GT(size, 0);
+        int packets = 0;
+        bool changed = false;
+        m_framer.Feed(m_buffer, static_cast<size_t>(size), [&](const sISBridgePacket& packet)
+        {
+            packets++;
+            changed = filter.ApplyCommand(packet) || changed;
+        });
+        EXPECT_EQ(1, packets);
+        return changed;
+    }
+
+    uint8_t m_buffer[256];
+    is_comm_instance_t m_comm;
+    sISBridgeFramerCounters m_counters;
+    cISBridgePacketFramer m_framer;
+};
+
+/**
+ * Holds one buffer relabelled for each packet offered to a filter
+ */
+class cFilterHarness
+{
+public:
+    cFilterHarness() : m_buffer(cISBridgeBuffer::Create(16)) { m_buffer->SetSize(16); }
+
+    bool Accepts(const cISBridgeDidFilter& filter, uint8_t did, uint8_t type = BRIDGE_ISB_PKT_TYPE_DATA, uint8_t protocol = BRIDGE_PROTOCOL_ISB)
+    {
+        m_buffer->SetPacketInfo(protocol, type, did);
+        return filter.Accepts(*m_buffer.Get());
+    }
+
+private:
+    cISBridgeBufferRef m_buffer;
+};
+
+}  // namespace
+
+TEST(DidFilter, InactiveFilterAcceptsEverything)
+{
+    cISBridgeDidFilter filter;
+    cFilterHarness harness;
+    EXPECT_FALSE(filter.IsActive());
+    for (int did = 0; did < 256; did++)
+    {
+        EXPECT_TRUE(harness.Accepts(filter, static_cast<uint8_t>(did)));
+    }
+}
+
+TEST(DidFilter, GetDataSubscribesToThePayloadDid)
+{
+    cSdkClient client;
+    cFilterHarness harness;
+    EXPECT_TRUE(client.GetData(DID_INS_1, 1));
+    EXPECT_TRUE(client.filter.IsActive());
+
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_INS_1));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_NULL));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_GPS1_POS));
+
+    // Replies and other protocols always pass
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_GPS1_POS, BRIDGE_ISB_PKT_TYPE_ACK));
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_GPS1_POS, 0, BRIDGE_PROTOCOL_NMEA));
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_GPS1_POS, 0, BRIDGE_PROTOCOL_RTCM3));
+}
+
+TEST(DidFilter, OneShotGetDataDoesNotStartFiltering)
+{
+    cSdkClient client;
+    cFilterHarness harness;
+    EXPECT_FALSE(client.GetData(DID_DEV_INFO, 0));
+    EXPECT_FALSE(client.filter.IsActive());
+
+    // Once filtering, the one-shot reply still has to get through
+    client.GetData(DID_INS_1, 1);
+    EXPECT_TRUE(client.GetData(DID_DEV_INFO, 0));
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_DEV_INFO));
+}
+
+TEST(DidFilter, StopCommandsUnsubscribe)
+{
+    cSdkClient client;
+    cFilterHarness harness;
+    client.GetData(DID_INS_1, 1);
+    client.GetData(DID_GPS1_POS, 5);
+
+    EXPECT_TRUE(client.StopDid(DID_INS_1));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_INS_1));
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_GPS1_POS));
+
+    // Stopping everything ends filtering until the client asks for data again
+    EXPECT_TRUE(client.StopAll());
+    EXPECT_FALSE(client.filter.IsActive());
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_GPS1_POS));
+
+    client.GetData(DID_INS_1, 1);
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_INS_1));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_GPS1_POS));
+}
+
+TEST(DidFilter, StopAllThenRmcForwardsEverything)
+{
+    // The SDK's stream setup: stop all broadcasts, then enable messages through DID_RMC
+    cSdkClient client;
+    cFilterHarness harness;
+    client.GetData(DID_GPS1_POS, 1);
+    client.StopAll();
+    client.SetRmc(RMC_BITS_INS1);
+    EXPECT_FALSE(client.filter.IsActive());
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_INS_1));
+
+    // Get-data on top of RMC streams must not hide them
+    EXPECT_FALSE(client.GetData(DID_GPS1_POS, 1));
+    EXPECT_FALSE(client.filter.IsActive());
+    EXPECT_TRUE(harness.Accepts(client.filter, DID_INS_1));
+
+    // Once RMC is stopped, get-data filters again
+    client.StopAll();
+    EXPECT_TRUE(client.GetData(DID_GPS1_POS, 1));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_INS_1));
+}
+
+TEST(DidFilter, ClearingRmcBitsAllowsFiltering)
+{
+    cSdkClient client;
+    cFilterHarness harness;
+    client.SetRmc(RMC_BITS_INS1);
+    EXPECT_FALSE(client.filter.IsActive());
+    client.SetRmc(0);
+    EXPECT_TRUE(client.GetData(DID_GPS1_POS, 1));
+    EXPECT_FALSE(harness.Accepts(client.filter, DID_INS_1));
+
+    // Other set-data commands leave the subscription alone
+    uint32_t value = 1;
+    EXPECT_FALSE(client.Send(PKT_TYPE_SET_DATA, DID_INS_1, &value, sizeof(value)));
+    EXPECT_TRUE(client.filter.IsActive());
+}
+
+TEST(DidFilter, ReportsOnlyChanges)
+{
+    cSdkClient client;
+    EXPECT_FALSE(client.Send(PKT_TYPE_STOP_BROADCASTS_CURRENT_PORT, 0));
+    EXPECT_TRUE(client.GetData(DID_INS_1, 1));
+    EXPECT_FALSE(client.GetData(DID_INS_1, 2));
+    EXPECT_FALSE(client.StopDid(DID_GPS1_POS));
+
+    // Anything that is not an ISB subscription command is ignored
+    EXPECT_FALSE(client.Send(PKT_TYPE_DATA, DID_GPS1_POS));
+    sISBridgePacket nmea = {};
+    nmea.protocol = BRIDGE_PROTOCOL_NMEA;
+    EXPECT_FALSE(client.filter.ApplyCommand(nmea));
+}
+
+TEST(DidFilter, MergeBuildsTheUnionOfClients)
+{
+    cSdkClient a;
+    cSdkClient b;
+    a.GetData(DID_INS_1, 1);
+    b.GetData(130, 1);
+
+    sISBridgeDidSet set;
+    set.all = false;
+    a.filter.MergeInto(set);
+    b.filter.MergeInto(set);
+    EXPECT_TRUE(set.Contains(DID_INS_1));
+    EXPECT_TRUE(set.Contains(130));
+    EXPECT_FALSE(set.Contains(DID_GPS1_POS));
+}
+
+TEST(DidFilter, ExportImportRoundTrip)
+{
+    cSdkClient source;
+    sISBridgeDidSet set;
+    source.filter.Export(set);
+    EXPECT_TRUE(set.all);
+
+    source.GetData(64, 1);
+    source.filter.Export(set);
+    EXPECT_FALSE(set.all);
+
+    cISBridgeDidFilter copy;
+    cFilterHarness harness;
+    copy.Import(set);
+    EXPECT_TRUE(copy.IsActive());
+    EXPECT_TRUE(harness.Accepts(copy, 64));
+    EXPECT_FALSE(harness.Accepts(copy, 63));
+
+    sISBridgeDidSet exported;
+    copy.Export(exported);
+    EXPECT_EQ(set, exported);
+}
+
+TEST(DidFilter, HandOffKeepsRmcClientsUnfiltered)
+{
+    // A client streaming through DID_RMC is handed over to another bridge
+    cSdkClient source;
+    source.StopAll();
+    source.SetRmc(RMC_BITS_INS1);
+    sISBridgeDidSet set;
+    source.filter.Export(set);
+    EXPECT_TRUE(set.all);
+    EXPECT_TRUE(set.rmc);
+
+    cSdkClient copy;
+    cFilterHarness harness;
+    copy.filter.Import(set);
+    EXPECT_FALSE(copy.filter.IsActive());
+
+    // Its next get-data must not hide the RMC streams it still receives
+    EXPECT_FALSE(copy.GetData(DID_GPS1_POS, 1));
+    EXPECT_FALSE(copy.filter.IsActive());
+    for (int did = 0; did < 256; did++)
+    {
+        EXPECT_TRUE(harness.Accepts(copy.filter, static_cast<uint8_t>(did)));
+    }
+
+    sISBridgeDidSet exported;
+    copy.filter.Export(exported);
+    EXPECT_EQ(set, exported);
+}
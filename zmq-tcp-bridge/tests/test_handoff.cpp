@@ -0,0 +1,312 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeHandoff.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * Records data read by a reactor
+ */
+class cReadRecorder : public iISBridgeTcpReactorDelegate
+{
+public:
+    std::string received;
+
+protected:
+    void OnClientDataReceived(cISBridgeTcpReactor* reactor, is_socket_t socket, uint8_t* data, int dataLength) override
+    {
+        (void)reactor;
+        (void)socket;
+        received.append((const char*)data, dataLength);
+    }
+};
+
+std::string handoffPath()
+{
+    return ::testing::TempDir() + "bridge_handoff_" + std::to_string(getpid()) + ".sock";
+}
+
+int connectLoopback(int port)
+{
+    int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (socket >= 0 && connect(socket, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+/**
+ * Run the reactor until done() holds or a second passes
+ * @return true if done() held
+ */
+template <typename Done>
+bool runUntil(cISBridgeTcpReactor& reactor, Done done)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        reactor.Run(10);
+    }
+    return true;
+}
+
+/**
+ * @return up to size bytes read from a socket, fewer if it stays idle for a second
+ */
+std::string readBytes(int socket, size_t size)
+{
+    timeval timeout = { 1, 0 };
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string data;
+    char buffer[256];
+    while (data.size() < size)
+    {
+        ssize_t n = recv(socket, buffer, std::min(sizeof(buffer), size - data.size()), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    return data;
+}
+
+/**
+ * @return an ISB data packet of a data ID holding text
+ */
+cISBridgeBufferRef dataPacket(uint8_t did, const char* text)
+{
+    size_t size = strlen(text);
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(size));
+    memcpy(buffer->Data(), text, size);
+    buffer->SetSize(size);
+    buffer->SetPacketInfo(BRIDGE_PROTOCOL_ISB, BRIDGE_ISB_PKT_TYPE_DATA, did);
+    return buffer;
+}
+
+sISBridgeDidSet didSet(uint8_t did)
+{
+    sISBridgeDidSet set;
+    set.all = false;
+    set.words[did >> 6] |= 1ULL << (did & 63);
+    return set;
+}
+
+}  // namespace
+
+TEST(Handoff, TransfersSocketsAndSubscriptionsInSeveralMessages)
+{
+    std::string path = handoffPath();
+    int listener = bridgeHandoffListen(path);
+    ASSERT_GE(listener, 0);
+    int newBridge = bridgeHandoffConnect(path);
+    ASSERT_GE(newBridge, 0);
+    int oldBridge = bridgeHandoffAccept(listener, 1000);
+    ASSERT_GE(oldBridge, 0);
+
+    // More clients than fit in one message
+    sISBridgeHandoffState sent;
+    std::vector<int> peers;
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    sent.listenSockets.push_back(pair[0]);
+    peers.push_back(pair[1]);
+    for (int i = 0; i < 70; i++)
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        sISBridgeTcpHandoffClient client;
+        client.socket = pair[0];
+        if (i % 2)
+        {
+            client.filter = didSet(static_cast<uint8_t>(i));
+        }
+        else if (i % 4 == 0)
+        {
+            client.filter.rmc = true;
+        }
+        sent.clients.push_back(client);
+        peers.push_back(pair[1]);
+    }
+    ASSERT_EQ(bridgeHandoffSend(oldBridge, sent), 0);
+
+    sISBridgeHandoffState received;
+    ASSERT_EQ(bridgeHandoffReceive(newBridge, received, 1000), 0);
+    ASSERT_EQ(received.listenSockets.size(), 1u);
+    ASSERT_EQ(received.clients.size(), sent.clients.size());
+    for (size_t i = 0; i < sent.clients.size(); i++)
+    {
+        EXPECT_EQ(received.clients[i].filter, sent.clients[i].filter) << "client " << i;
+    }
+
+    ASSERT_EQ(bridgeHandoffAcknowledge(newBridge, received.listenSockets.size(), received.clients.size()), 0);
+    EXPECT_EQ(bridgeHandoffWaitAcknowledge(oldBridge, sent, 1000), 0);
+
+    // Each received descriptor is a duplicate of the one sent, in order
+    sent.Close();
+    ASSERT_EQ(write(received.listenSockets[0], "L", 1), 1);
+    EXPECT_EQ(readBytes(peers[0], 1), "L");
+    for (size_t i = 0; i < received.clients.size(); i++)
+    {
+        std::string tag = std::to_string(i);
+        ASSERT_EQ(write(received.clients[i].socket, tag.data(), tag.size()), static_cast<ssize_t>(tag.size()));
+        EXPECT_EQ(readBytes(peers[i + 1], tag.size()), tag);
+    }
+
+    received.Close();
+    for (int peer : peers)
+    {
+        close(peer);
+    }
+    bridgeHandoffClose(newBridge);
+    bridgeHandoffClose(oldBridge);
+    bridgeHandoffClose(listener, path);
+}
+
+TEST(Handoff, NewReactorServesTheHandedOverClients)
+{
+    cReadRecorder oldRecorder;
+    cISBridgeTcpReactor oldReactor(&oldRecorder);
+    ASSERT_EQ(oldReactor.Open("127.0.0.1", 0), 0);
+    int port = oldReactor.Port();
+
+    // One unfiltered TCP client and one subscribed to a single data ID
+    int tcpPeer = connectLoopback(port);
+    ASSERT_GE(tcpPeer, 0);
+    ASSERT_TRUE(runUntil(oldReactor, [&] { return oldReactor.ClientCount() == 1; }));
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    ASSERT_EQ(oldReactor.AdoptClient(pair[0], didSet(4)), 0);
+    int filteredPeer = pair[1];
+
+    std::string path = handoffPath();
+    int listener = bridgeHandoffListen(path);
+    ASSERT_GE(listener, 0);
+    int newBridge = bridgeHandoffConnect(path);
+    ASSERT_GE(newBridge, 0);
+    int oldBridge = bridgeHandoffAccept(listener, 1000);
+    ASSERT_GE(oldBridge, 0);
+
+    sISBridgeHandoffState sent;
+    is_socket_t listenSocket;
+    ASSERT_EQ(oldReactor.HandOff(listenSocket, sent.clients), 0);
+    sent.listenSockets.push_back(listenSocket);
+    ASSERT_EQ(bridgeHandoffSend(oldBridge, sent), 0);
+
+    sISBridgeHandoffState received;
+    ASSERT_EQ(bridgeHandoffReceive(newBridge, received, 1000), 0);
+    cReadRecorder newRecorder;
+    cISBridgeTcpReactor newReactor(&newRecorder);
+    ASSERT_EQ(newReactor.Open(received.listenSockets[0]), 0);
+    for (const sISBridgeTcpHandoffClient& client : received.clients)
+    {
+        ASSERT_EQ(newReactor.AdoptClient(client.socket, client.filter), 0);
+    }
+    ASSERT_EQ(bridgeHandoffAcknowledge(newBridge, received.listenSockets.size(), received.clients.size()), 0);
+    ASSERT_EQ(bridgeHandoffWaitAcknowledge(oldBridge, sent, 1000), 0);
+    sent.Close();
+    EXPECT_EQ(oldReactor.Close(), 0);
+    EXPECT_EQ(newReactor.ClientCount(), 2);
+    EXPECT_EQ(newReactor.Port(), port);
+
+    // Reads, writes and subscriptions carry over; closing the old copies hung up nobody
+    ASSERT_EQ(write(tcpPeer, "after", 5), 5);
+    EXPECT_TRUE(runUntil(newReactor, [&] { return newRecorder.received == "after"; }));
+    cISBridgeBufferRef packets[2] = { dataPacket(4, "four;"), dataPacket(5, "five;") };
+    EXPECT_EQ(newReactor.Broadcast(packets, 2), 2);
+    EXPECT_EQ(readBytes(tcpPeer, 10), "four;five;");
+    EXPECT_EQ(readBytes(filteredPeer, 5), "four;");
+    EXPECT_TRUE(oldRecorder.received.empty());
+
+    // New connections reach the new reactor
+    int latePeer = connectLoopback(port);
+    ASSERT_GE(latePeer, 0);
+    EXPECT_TRUE(runUntil(newReactor, [&] { return newReactor.ClientCount() == 3; }));
+
+    close(latePeer);
+    close(tcpPeer);
+    close(filteredPeer);
+    newReactor.Close();
+    bridgeHandoffClose(newBridge);
+    bridgeHandoffClose(oldBridge);
+    bridgeHandoffClose(listener, path);
+}
+
+TEST(Handoff, OldReactorResumesWithoutAnAcknowledgement)
+{
+    cReadRecorder recorder;
+    cISBridgeTcpReactor reactor(&recorder);
+    ASSERT_EQ(reactor.Open("127.0.0.1", 0), 0);
+    int peer = connectLoopback(reactor.Port());
+    ASSERT_GE(peer, 0);
+    ASSERT_TRUE(runUntil(reactor, [&] { return reactor.ClientCount() == 1; }));
+
+    std::string path = handoffPath();
+    int listener = bridgeHandoffListen(path);
+    ASSERT_GE(listener, 0);
+    int newBridge = bridgeHandoffConnect(path);
+    ASSERT_GE(newBridge, 0);
+    int oldBridge = bridgeHandoffAccept(listener, 1000);
+    ASSERT_GE(oldBridge, 0);
+
+    sISBridgeHandoffState sent;
+    is_socket_t listenSocket;
+    ASSERT_EQ(reactor.HandOff(listenSocket, sent.clients), 0);
+    sent.listenSockets.push_back(listenSocket);
+    ASSERT_EQ(bridgeHandoffSend(oldBridge, sent), 0);
+
+    // The new bridge receives the sockets, then gives up without acknowledging
+    sISBridgeHandoffState received;
+    ASSERT_EQ(bridgeHandoffReceive(newBridge, received, 1000), 0);
+    received.Close();
+    bridgeHandoffClose(newBridge);
+    EXPECT_EQ(bridgeHandoffWaitAcknowledge(oldBridge, sent, 1000), -1);
+
+    ASSERT_EQ(reactor.Resume(), 0);
+    sent.Close();
+    ASSERT_EQ(write(peer, "still", 5), 5);
+    EXPECT_TRUE(runUntil(reactor, [&] { return recorder.received == "still"; }));
+    int latePeer = connectLoopback(reactor.Port());
+    ASSERT_GE(latePeer, 0);
+    EXPECT_TRUE(runUntil(reactor, [&] { return reactor.ClientCount() == 2; }));
+
+    close(latePeer);
+    close(peer);
+    reactor.Close();
+    bridgeHandoffClose(oldBridge);
+    bridgeHandoffClose(listener, path);
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeLastValueCache.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return an ISB packet of a type and data ID, all bytes set to tag
+ */
+cISBridgeBufferRef packet(uint8_t type, uint8_t did, uint8_t tag, size_t size = 10)
+{
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(size));
+    memset(buffer->Data(), tag, size);
+    buffer->SetSize(size);
+    buffer->SetPacketInfo(BRIDGE_PROTOCOL_ISB, type, did);
+    buffer->SetTimestamp(1000);
+    return buffer;
+}
+
+cISBridgeBufferRef dataPacket(uint8_t did, uint8_t tag, size_t size = 10)
+{
+    return packet(BRIDGE_ISB_PKT_TYPE_DATA, did, tag, size);
+}
+
+void update(cISBridgeLastValueCache& cache, const cISBridgeBufferRef& buffer)
+{
+    cache.Update(*buffer.Get());
+}
+
+sISBridgeDidSet didSet(std::initializer_list<uint8_t> dids)
+{
+    sISBridgeDidSet set;
+    set.all = false;
+    for (uint8_t did : dids)
+    {
+        set.words[did >> 6] |= 1ULL << (did & 63);
+    }
+    return set;
+}
+
+}  // namespace
+
+TEST(LastValueCache, SnapshotHoldsTheLatestPacketPerDidInDidOrder)
+{
+    cISBridgeLastValueCache cache;
+    cache.Configure(sISBridgeDidSet(), cISBridgeLastValueCache::kDefaultMaxBytes);
+    update(cache, dataPacket(5, 1));
+    update(cache, dataPacket(2, 2));
+    update(cache, dataPacket(5, 3, 20));
+
+    std::vector<cISBridgeBufferRef> snapshot;
+    ASSERT_EQ(cache.Snapshot(snapshot), 2);
+    EXPECT_EQ(snapshot[0]->PacketId(), 2);
+    EXPECT_EQ(snapshot[0]->Data()[0], 2);
+    EXPECT_EQ(snapshot[1]->PacketId(), 5);
+    EXPECT_EQ(snapshot[1]->Data()[0], 3);
+    EXPECT_EQ(snapshot[1]->Size(), 20u);
+    EXPECT_EQ(snapshot[1]->PacketType(), BRIDGE_ISB_PKT_TYPE_DATA);
+
+    // Cached state is not live data
+    EXPECT_EQ(snapshot[0]->Timestamp(), 0u);
+
+    sISBridgeLastValueCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.updates, 3u);
+    EXPECT_EQ(stats.snapshots, 1u);
+    EXPECT_EQ(stats.snapshotMessages, 2u);
+}
+
+TEST(LastValueCache, StoresOnlyDataForConfiguredDids)
+{
+    cISBridgeLastValueCache cache;
+    cache.Configure(didSet({ 5 }), cISBridgeLastValueCache::kDefaultMaxBytes);
+    update(cache, dataPacket(6, 1));
+    update(cache, packet(BRIDGE_ISB_PKT_TYPE_GET_DATA, 5, 2));
+    cISBridgeBufferRef unframed(cISBridgeBuffer::Create(10));
+    unframed->SetSize(10);
+    update(cache, unframed);
+
+    std::vector<cISBridgeBufferRef> snapshot;
+    EXPECT_EQ(cache.Snapshot(snapshot), 0);
+
+    update(cache, dataPacket(5, 3));
+    EXPECT_EQ(cache.Snapshot(snapshot), 1);
+    EXPECT_EQ(cache.GetStats().updates, 1u);
+}
+
+TEST(LastValueCache, RejectsPacketsOverTheByteBudget)
+{
+    cISBridgeLastValueCache cache;
+    cache.Configure(sISBridgeDidSet(), 128);
+    update(cache, dataPacket(1, 1, 100));
+    update(cache, dataPacket(2, 2, 10));
+
+    sISBridgeLastValueCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, 128u);
+    EXPECT_EQ(stats.rejected, 1u);
+
+    // Replacing a cached value reuses its share of the budget
+    update(cache, dataPacket(1, 3, 120));
+    std::vector<cISBridgeBufferRef> snapshot;
+    ASSERT_EQ(cache.Snapshot(snapshot), 1);
+    EXPECT_EQ(snapshot[0]->Data()[0], 3);
+}
+
+TEST(LastValueCache, NeverOverwritesAPacketAClientStillHolds)
+{
+    cISBridgeLastValueCache cache;
+    cache.Configure(sISBridgeDidSet(), cISBridgeLastValueCache::kDefaultMaxBytes);
+    update(cache, dataPacket(7, 1));
+
+    std::vector<cISBridgeBufferRef> held;
+    ASSERT_EQ(cache.Snapshot(held), 1);
+    update(cache, dataPacket(7, 2));
+    EXPECT_EQ(held[0]->Data()[0], 1);
+
+    // Once released, the next update is written in place
+    std::vector<cISBridgeBufferRef> snapshot;
+    ASSERT_EQ(cache.Snapshot(snapshot), 1);
+    cISBridgeBuffer* current = snapshot[0].Get();
+    EXPECT_EQ(current->Data()[0], 2);
+    held.clear();
+    snapshot.clear();
+    update(cache, dataPacket(7, 3));
+    ASSERT_EQ(cache.Snapshot(snapshot), 1);
+    EXPECT_EQ(snapshot[0].Get(), current);
+    EXPECT_EQ(snapshot[0]->Data()[0], 3);
+}
+
+TEST(LastValueCache, ClearDropsEverything)
+{
+    cISBridgeLastValueCache cache;
+    cache.Configure(sISBridgeDidSet(), cISBridgeLastValueCache::kDefaultMaxBytes);
+    update(cache, dataPacket(1, 1));
+    update(cache, dataPacket(2, 2));
+    cache.Clear();
+
+    std::vector<cISBridgeBufferRef> snapshot;
+    EXPECT_EQ(cache.Snapshot(snapshot), 0);
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+    EXPECT_EQ(cache.GetStats().bytes, 0u);
+}
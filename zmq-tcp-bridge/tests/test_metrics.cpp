@@ -0,0 +1,404 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeMetrics.h"
+#include "ISBridgeMetricsServer.h"
+#include "ISZmqTcpBridge.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+/**
+ * Two routes with known counters, latencies and a ZMQ endpoint that needs escaping
+ */
+std::vector<sISZmqTcpBridgeStats> knownRoutes()
+{
+    std::vector<sISZmqTcpBridgeStats> routes(2);
+    routes[0].running = true;
+    routes[0].tcpPort = 8000;
+    routes[0].zmqRxMessages = 42;
+    routes[0].zmqSources.resize(2);
+    routes[0].zmqSources[0].endpoint = "tcp://127.0.0.1:7000";
+    routes[0].zmqSources[0].merge.lateMessages = 5;
+    routes[0].zmqSources[1].endpoint = "ipc://a\"b\\c\nd";
+    routes[0].zmqSources[1].merge.lateMessages = 3;
+    routes[0].latency.count = 4;
+    routes[0].latency.sumNs = 2500000000ULL;
+    routes[0].latency.p50Ns = 511;
+    routes[0].latency.p90Ns = 927;
+    routes[0].latency.p99Ns = 991;
+    routes[0].latency.p999Ns = 1000;
+    routes[1].tcpPort = 8001;
+    return routes;
+}
+
+std::string formatKnownRoutes()
+{
+    std::string out;
+    cISZmqTcpBridge::FormatPrometheus(knownRoutes(), out);
+    return out;
+}
+
+#if !defined(_WIN32)
+
+/**
+ * Send an HTTP request to a loopback port and read until the server closes
+ * @return everything the server sent, empty on failure
+ */
+std::string scrapeLoopback(int port)
+{
+    int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (socket < 0 || connect(socket, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (socket >= 0)
+        {
+            close(socket);
+        }
+        return std::string();
+    }
+
+    const std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\nAccept: text/plain\r\n\r\n";
+    if (send(socket, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size())
+    {
+        close(socket);
+        return std::string();
+    }
+
+    std::string response;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        pollfd pfd = { socket, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0)
+        {
+            continue;
+        }
+        char in[4096];
+        ssize_t n = recv(socket, in, sizeof(in), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        response.append(in, static_cast<size_t>(n));
+    }
+    close(socket);
+    return response;
+}
+
+#endif
+
+}
+
+TEST(Histogram, SmallValuesHaveExactBuckets)
+{
+    for (uint64_t value = 0; value < static_cast<uint64_t>(cISBridgeHistogram::kSubBucketCount); value++)
+    {
+        EXPECT_EQ(cISBridgeHistogram::BucketIndex(value), static_cast<int>(value));
+        EXPECT_EQ(cISBridgeHistogram::BucketUpperBound(static_cast<int>(value)), value);
+    }
+
+    // The first power of two above the exact range still has buckets one wide
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(16), 16);
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(31), 31);
+    EXPECT_EQ(cISBridgeHistogram::BucketUpperBound(31), 31u);
+
+    // Then each power of two doubles the bucket width
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(32), 32);
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(33), 32);
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(34), 33);
+    EXPECT_EQ(cISBridgeHistogram::BucketUpperBound(32), 33u);
+}
+
+TEST(Histogram, BucketEdgesAreContiguous)
+{
+    // The upper bound of every bucket falls in that bucket and the next value starts the next one
+    for (int i = 0; i < cISBridgeHistogram::kBucketCount - 1; i++)
+    {
+        uint64_t bound = cISBridgeHistogram::BucketUpperBound(i);
+        ASSERT_EQ(cISBridgeHistogram::BucketIndex(bound), i) << "bucket " << i;
+        ASSERT_EQ(cISBridgeHistogram::BucketIndex(bound + 1), i + 1) << "bucket " << i;
+    }
+    EXPECT_EQ(cISBridgeHistogram::BucketUpperBound(cISBridgeHistogram::kBucketCount - 1), UINT64_MAX);
+    EXPECT_EQ(cISBridgeHistogram::BucketIndex(UINT64_MAX), cISBridgeHistogram::kBucketCount - 1);
+}
+
+TEST(Histogram, BucketsStayWithinRelativeError)
+{
+    for (uint64_t value = 16; value < (1ULL << 40); value = value * 3 / 2 + 7)
+    {
+        uint64_t bound = cISBridgeHistogram::BucketUpperBound(cISBridgeHistogram::BucketIndex(value));
+        ASSERT_GE(bound, value);
+        ASSERT_LE(static_cast<double>(bound - value), static_cast<double>(value) / cISBridgeHistogram::kSubBucketCount) << value;
+    }
+}
+
+TEST(Histogram, PercentilesOfKnownSamples)
+{
+    cISBridgeHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; value++)
+    {
+        histogram.Record(value);
+    }
+
+    sISBridgeHistogramStats stats = histogram.Stats();
+    EXPECT_EQ(stats.count, 1000u);
+    EXPECT_EQ(stats.sumNs, 500500u);
+    EXPECT_EQ(stats.maxNs, 1000u);
+
+    // Each percentile is the upper bound of the bucket holding its rank
+    EXPECT_EQ(stats.p50Ns, 511u);     // 500 is in [496, 511]
+    EXPECT_EQ(stats.p90Ns, 927u);     // 900 is in [896, 927]
+    EXPECT_EQ(stats.p99Ns, 991u);     // 990 is in [960, 991]
+    EXPECT_EQ(stats.p999Ns, 1000u);   // 999 is in [992, 1023], capped at the max
+    EXPECT_EQ(stats.p50Ns, cISBridgeHistogram::BucketUpperBound(cISBridgeHistogram::BucketIndex(500)));
+    EXPECT_EQ(stats.p90Ns, cISBridgeHistogram::BucketUpperBound(cISBridgeHistogram::BucketIndex(900)));
+}
+
+TEST(Histogram, PercentilesAtBucketEdges)
+{
+    cISBridgeHistogram histogram;
+
+    // 511 is the last value of its bucket and 512 the first of the next
+    for (int i = 0; i < 500; i++)
+    {
+        histogram.Record(511);
+    }
+    for (int i = 0; i < 500; i++)
+    {
+        histogram.Record(512);
+    }
+
+    sISBridgeHistogramStats stats = histogram.Stats();
+    EXPECT_EQ(stats.p50Ns, 511u);
+    EXPECT_EQ(stats.p90Ns, 512u);
+    EXPECT_EQ(stats.p99Ns, 512u);
+    EXPECT_EQ(stats.p999Ns, 512u);
+
+    histogram.Reset();
+    EXPECT_EQ(histogram.Stats().count, 0u);
+    EXPECT_EQ(histogram.Stats().p50Ns, 0u);
+
+    // A single value at an edge reports itself, not the bucket above
+    histogram.Record(16);
+    stats = histogram.Stats();
+    EXPECT_EQ(stats.p50Ns, 16u);
+    EXPECT_EQ(stats.p999Ns, 16u);
+}
+
+TEST(Histogram, MergeIntoAddsCountsAndKeepsMax)
+{
+    cISBridgeHistogram a;
+    cISBridgeHistogram b;
+    a.Record(100);
+    a.Record(200);
+    b.Record(5000);
+
+    a.MergeInto(b);
+    sISBridgeHistogramStats stats = b.Stats();
+    EXPECT_EQ(stats.count, 3u);
+    EXPECT_EQ(stats.sumNs, 5300u);
+    EXPECT_EQ(stats.maxNs, 5000u);
+    EXPECT_EQ(stats.p50Ns, cISBridgeHistogram::BucketUpperBound(cISBridgeHistogram::BucketIndex(200)));
+}
+
+TEST(Prometheus, LabelValuesAreEscaped)
+{
+    EXPECT_EQ(bridgePrometheusLabelValue("tcp://127.0.0.1:7000"), "tcp://127.0.0.1:7000");
+    EXPECT_EQ(bridgePrometheusLabelValue("a\"b"), "a\\\"b");
+    EXPECT_EQ(bridgePrometheusLabelValue("a\\b"), "a\\\\b");
+    EXPECT_EQ(bridgePrometheusLabelValue("a\nb"), "a\\nb");
+    EXPECT_EQ(bridgePrometheusLabelValue(""), "");
+}
+
+TEST(Prometheus, SummaryHasQuantilesSumAndCount)
+{
+    sISBridgeHistogramStats stats;
+    stats.count = 3;
+    stats.sumNs = 1500000000ULL;
+    stats.p50Ns = 1000;
+    stats.p90Ns = 2000000;
+    stats.p99Ns = 3000000000ULL;
+    stats.p999Ns = 3000000000ULL;
+
+    std::string out;
+    bridgeFormatPrometheusSummary("latency_seconds", "route=\"1\"", stats, out);
+    EXPECT_EQ(out,
+        "latency_seconds{route=\"1\",quantile=\"0.5\"} 0.000001000\n"
+        "latency_seconds{route=\"1\",quantile=\"0.9\"} 0.002000000\n"
+        "latency_seconds{route=\"1\",quantile=\"0.99\"} 3.000000000\n"
+        "latency_seconds{route=\"1\",quantile=\"0.999\"} 3.000000000\n"
+        "latency_seconds_sum{route=\"1\"} 1.500000000\n"
+        "latency_seconds_count{route=\"1\"} 3\n");
+
+    out.clear();
+    bridgeFormatPrometheusSummary("latency_seconds", "", sISBridgeHistogramStats(), out);
+    EXPECT_NE(out.find("latency_seconds{quantile=\"0.5\"} 0.000000000\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_seconds_sum 0.000000000\n"), std::string::npos);
+    EXPECT_NE(out.find("latency_seconds_count 0\n"), std::string::npos);
+}
+
+TEST(Prometheus, FormatHasNamesLabelsAndValues)
+{
+    std::string out = formatKnownRoutes();
+
+    EXPECT_NE(out.find("# TYPE zmq_tcp_bridge_up gauge\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_up{route=\"8000\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_up{route=\"8001\"} 0\n"), std::string::npos);
+    EXPECT_NE(out.find("# TYPE zmq_tcp_bridge_zmq_rx_messages_total counter\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_zmq_rx_messages_total{route=\"8000\"} 42\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_zmq_rx_messages_total{route=\"8001\"} 0\n"), std::string::npos);
+
+    // Endpoint labels carry the escaped endpoint
+    EXPECT_NE(out.find("zmq_tcp_bridge_zmq_source_late_total{route=\"8000\",endpoint=\"tcp://127.0.0.1:7000\"} 5\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_zmq_source_late_total{route=\"8000\",endpoint=\"ipc://a\\\"b\\\\c\\nd\"} 3\n"), std::string::npos);
+
+    // Latency is a summary in seconds
+    EXPECT_NE(out.find("# TYPE zmq_tcp_bridge_latency_seconds summary\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds{route=\"8000\",quantile=\"0.5\"} 0.000000511\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds{route=\"8000\",quantile=\"0.9\"} 0.000000927\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds{route=\"8000\",quantile=\"0.99\"} 0.000000991\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds{route=\"8000\",quantile=\"0.999\"} 0.000001000\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds_sum{route=\"8000\"} 2.500000000\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_latency_seconds_count{route=\"8000\"} 4\n"), std::string::npos);
+    EXPECT_NE(out.find("# TYPE zmq_tcp_bridge_control_latency_seconds summary\n"), std::string::npos);
+    EXPECT_NE(out.find("zmq_tcp_bridge_control_latency_seconds_count{route=\"8001\"} 0\n"), std::string::npos);
+}
+
+TEST(Prometheus, FormatFollowsTheTextExposition)
+{
+    std::string out = formatKnownRoutes();
+    ASSERT_FALSE(out.empty());
+    ASSERT_EQ(out.back(), '\n');
+
+    const std::regex help("# HELP ([a-zA-Z_:][a-zA-Z0-9_:]*) [^\\n]+");
+    const std::regex type("# TYPE ([a-zA-Z_:][a-zA-Z0-9_:]*) (counter|gauge|summary)");
+    const std::regex sample("([a-zA-Z_:][a-zA-Z0-9_:]*)"
+                            "(\\{[a-zA-Z_][a-zA-Z0-9_]*=\"([^\"\\\\\\n]|\\\\[\"\\\\n])*\""
+                            "(,[a-zA-Z_][a-zA-Z0-9_]*=\"([^\"\\\\\\n]|\\\\[\"\\\\n])*\")*\\})?"
+                            " [0-9]+(\\.[0-9]+)?");
+
+    std::set<std::string> typed;
+    std::set<std::string> helped;
+    std::string currentType;
+    std::string currentKind;
+    std::istringstream lines(out);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        std::smatch match;
+        if (std::regex_match(line, match, help))
+        {
+            EXPECT_TRUE(helped.insert(match[1]).second) << "HELP repeated: " << line;
+            continue;
+        }
+        if (std::regex_match(line, match, type))
+        {
+            currentType = match[1];
+            currentKind = match[2];
+            EXPECT_TRUE(typed.insert(currentType).second) << "TYPE repeated: " << line;
+            EXPECT_TRUE(helped.count(currentType)) << "TYPE without HELP: " << line;
+            if (currentKind == "counter")
+            {
+                EXPECT_EQ(currentType.substr(currentType.size() - 6), "_total") << line;
+            }
+            continue;
+        }
+        ASSERT_TRUE(std::regex_match(line, match, sample)) << "not a sample: " << line;
+
+        // Samples follow the TYPE of their family; summaries add _sum and _count
+        std::string name = match[1];
+        if (currentKind == "summary" && name != currentType)
+        {
+            EXPECT_TRUE(name == currentType + "_sum" || name == currentType + "_count") << line;
+        }
+        else
+        {
+            EXPECT_EQ(name, currentType) << line;
+        }
+        EXPECT_EQ(name.rfind("zmq_tcp_bridge_", 0), 0u) << line;
+    }
+    EXPECT_GT(typed.size(), 30u);
+}
+
+#if !defined(_WIN32)
+
+TEST(MetricsServer, LoopbackScrapeReturnsTheSeries)
+{
+    cISBridgeMetricsServer server;
+    EXPECT_EQ(server.Port(), -1);
+    ASSERT_EQ(server.Start(0, formatKnownRoutes), 0);
+    ASSERT_TRUE(server.IsRunning());
+    ASSERT_GT(server.Port(), 0);
+
+    // Scrape twice; the server answers one request per connection
+    for (int scrape = 0; scrape < 2; scrape++)
+    {
+        std::string response = scrapeLoopback(server.Port());
+        size_t headEnd = response.find("\r\n\r\n");
+        ASSERT_NE(headEnd, std::string::npos) << response;
+        std::string head = response.substr(0, headEnd + 2);
+        std::string body = response.substr(headEnd + 4);
+
+        EXPECT_EQ(head.rfind("HTTP/1.0 200 OK\r\n", 0), 0u) << head;
+        EXPECT_NE(head.find("\r\nContent-Type: text/plain; version=0.0.4\r\n"), std::string::npos) << head;
+        EXPECT_NE(head.find("\r\nContent-Length: " + std::to_string(body.size()) + "\r\n"), std::string::npos) << head;
+        EXPECT_EQ(body, formatKnownRoutes());
+        EXPECT_NE(body.find("zmq_tcp_bridge_up{route=\"8000\"} 1\n"), std::string::npos);
+        EXPECT_NE(body.find("zmq_tcp_bridge_zmq_source_late_total{route=\"8000\",endpoint=\"ipc://a\\\"b\\\\c\\nd\"} 3\n"), std::string::npos);
+        EXPECT_NE(body.find("zmq_tcp_bridge_latency_seconds{route=\"8000\",quantile=\"0.99\"} 0.000000991\n"), std::string::npos);
+    }
+
+    server.Stop();
+    EXPECT_FALSE(server.IsRunning());
+    EXPECT_EQ(server.Port(), -1);
+}
+
+TEST(MetricsServer, StalledClientDoesNotBlockTheNextScrape)
+{
+    cISBridgeMetricsServer server;
+    ASSERT_EQ(server.Start(0, formatKnownRoutes), 0);
+
+    // Connect and never send a request; the server gives up after its request timeout
+    int stalled = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)server.Port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(connect(stalled, (const sockaddr*)&address, sizeof(address)), 0);
+
+    std::string response = scrapeLoopback(server.Port());
+    EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+    close(stalled);
+    server.Stop();
+}
+
+#endif
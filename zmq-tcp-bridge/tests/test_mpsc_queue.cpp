@@ -0,0 +1,184 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "ISBridgeMpscQueue.h"
+#include "bridge_test_fixture.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return a message carrying a producer number and a sequence number
+ */
+cISBridgeBufferRef message(uint32_t producer, uint32_t seq)
+{
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(8));
+    memcpy(buffer->Data(), &producer, 4);
+    memcpy(buffer->Data() + 4, &seq, 4);
+    buffer->SetSize(8);
+    return buffer;
+}
+
+void readMessage(const cISBridgeBufferRef& buffer, uint32_t& producer, uint32_t& seq)
+{
+    memcpy(&producer, buffer->Data(), 4);
+    memcpy(&seq, buffer->Data() + 4, 4);
+}
+
+}  // namespace
+
+TEST(MpscQueue, FifoUpToTheRoundedUpCapacity)
+{
+    cISBridgeMpscQueue queue(3);
+    for (uint32_t seq = 0; seq < 4; seq++)
+    {
+        cISBridgeBufferRef buffer = message(0, seq);
+        ASSERT_TRUE(queue.Push(buffer));
+        EXPECT_FALSE(buffer);
+    }
+
+    // A refused push leaves the message with the producer
+    cISBridgeBufferRef refused = message(0, 4);
+    EXPECT_FALSE(queue.Push(refused));
+    EXPECT_TRUE(refused);
+
+    sISBridgeMpscQueueStats stats = queue.GetStats();
+    EXPECT_EQ(4u, stats.capacity);
+    EXPECT_EQ(4u, stats.queued);
+    EXPECT_EQ(4u, stats.pushed);
+    EXPECT_EQ(1u, stats.dropped);
+
+    cISBridgeBufferRef buffer;
+    for (uint32_t expected = 0; expected < 4; expected++)
+    {
+        ASSERT_TRUE(queue.Pop(buffer));
+        uint32_t producer;
+        uint32_t seq;
+        readMessage(buffer, producer, seq);
+        EXPECT_EQ(expected, seq);
+    }
+    EXPECT_FALSE(queue.Pop(buffer));
+    EXPECT_EQ(0u, queue.Size());
+    EXPECT_EQ(4u, queue.GetStats().highWatermark);
+}
+
+TEST(MpscQueue, ClearReleasesQueuedReferences)
+{
+    cISBridgeMpscQueue queue(8);
+    cISBridgeBufferRef kept = message(0, 0);
+    cISBridgeBufferRef pushed = kept;
+    ASSERT_TRUE(queue.Push(pushed));
+    EXPECT_TRUE(kept->IsShared());
+
+    queue.Clear();
+    EXPECT_FALSE(kept->IsShared());
+    EXPECT_EQ(0u, queue.Size());
+}
+
+TEST(MpscQueue, ConcurrentProducersKeepTheirOwnOrder)
+{
+    const uint32_t kProducers = 4;
+    const uint32_t kMessages = 20000;
+    cISBridgeMpscQueue queue(256);
+
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < kProducers; p++)
+    {
+        producers.emplace_back([&queue, p, kMessages]()
+        {
+            for (uint32_t seq = 0; seq < kMessages; seq++)
+            {
+                cISBridgeBufferRef buffer = message(p, seq);
+                while (!queue.Push(buffer))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int64_t> last(kProducers, -1);
+    uint64_t received = 0;
+    bool ordered = true;
+    cISBridgeBufferRef buffer;
+    while (received < static_cast<uint64_t>(kProducers) * kMessages)
+    {
+        if (!queue.Pop(buffer))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t producer;
+        uint32_t seq;
+        readMessage(buffer, producer, seq);
+        ASSERT_LT(producer, kProducers);
+        ordered = ordered && static_cast<int64_t>(seq) == last[producer] + 1;
+        last[producer] = seq;
+        received++;
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_FALSE(queue.Pop(buffer));
+    sISBridgeMpscQueueStats stats = queue.GetStats();
+    EXPECT_EQ(static_cast<uint64_t>(kProducers) * kMessages, stats.pushed);
+    EXPECT_LE(stats.highWatermark, stats.capacity);
+}
+
+TEST_F(BridgeTest, ClientDataGetsThroughASaturatingPublisher)
+{
+    sISZmqTcpBridgeOptions options;
+    options.zmqSendQueueCapacity = 16;
+    ASSERT_EQ(0, StartBridge(options));
+    ASSERT_TRUE(JoinBridgePublisher());
+    is_socket_t client = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(client));
+    ASSERT_TRUE(StartFlood());
+
+    // Many more spaced-out writes than the queue holds; each is queued on its own, so
+    // the queue must be published while the flood is still being received
+    std::string sent;
+    for (int i = 0; i < 100; i++)
+    {
+        std::string chunk(32, static_cast<char>('a' + i % 26));
+        ASSERT_EQ(send(client, chunk.data(), chunk.size(), MSG_NOSIGNAL), static_cast<int>(chunk.size()));
+        sent += chunk;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    std::string received;
+    uint8_t data[1024];
+    while (received.size() < sent.size())
+    {
+        int size = zmq_recv(m_sub, data, sizeof(data), 0);
+        if (size < 0)
+        {
+            break;
+        }
+        received.append(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+    }
+    EXPECT_EQ(received, sent);
+
+    sISZmqTcpBridgeStats stats;
+    m_bridge.GetStats(stats);
+    EXPECT_EQ(stats.zmqSendQueue.dropped, 0u);
+    bridgeSocketClose(client);
+}
@@ -0,0 +1,363 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "ISBridgePacketFramer.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+typedef std::vector<uint8_t> bytes_t;
+
+bytes_t isbPacket(uint8_t did, size_t payloadSize)
+{
+    bytes_t p = { BRIDGE_ISB_PREAMBLE0, BRIDGE_ISB_PREAMBLE1, BRIDGE_ISB_PKT_TYPE_DATA, did,
+                  static_cast<uint8_t>(payloadSize), static_cast<uint8_t>(payloadSize >> 8) };
+    for (size_t i = 0; i < payloadSize; i++)
+    {
+        p.push_back(static_cast<uint8_t>(i * 7 + did));
+    }
+    uint8_t a = 0;
+    uint8_t b = 0;
+    for (uint8_t c : p)
+    {
+        a = static_cast<uint8_t>(a + c);
+        b = static_cast<uint8_t>(b + a);
+    }
+    p.push_back(a);
+    p.push_back(b);
+    return p;
+}
+
+bytes_t ubxPacket(size_t payloadSize)
+{
+    bytes_t p = { 0xB5, 0x62, 0x01, 0x07, static_cast<uint8_t>(payloadSize), static_cast<uint8_t>(payloadSize >> 8) };
+    for (size_t i = 0; i < payloadSize; i++)
+    {
+        p.push_back(static_cast<uint8_t>(i));
+    }
+    uint8_t a = 0;
+    uint8_t b = 0;
+    for (size_t i = 2; i < p.size(); i++)
+    {
+        a = static_cast<uint8_t>(a + p[i]);
+        b = static_cast<uint8_t>(b + a);
+    }
+    p.push_back(a);
+    p.push_back(b);
+    return p;
+}
+
+bytes_t rtcmPacket(size_t payloadSize)
+{
+    bytes_t p = { 0xD3, static_cast<uint8_t>(payloadSize >> 8), static_cast<uint8_t>(payloadSize), 0x43, 0x50 };
+    for (size_t i = 2; i < payloadSize; i++)
+    {
+        p.push_back(static_cast<uint8_t>(i * 3));
+    }
+    uint32_t crc = 0;
+    for (uint8_t c : p)
+    {
+        crc ^= static_cast<uint32_t>(c) << 16;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc <<= 1;
+            if (crc & 0x1000000)
+            {
+                crc ^= 0x1864CFB;
+            }
+        }
+    }
+    p.push_back(static_cast<uint8_t>(crc >> 16));
+    p.push_back(static_cast<uint8_t>(crc >> 8));
+    p.push_back(static_cast<uint8_t>(crc));
+    return p;
+}
+
+bytes_t nmeaSentence(const char* body)
+{
+    uint8_t checksum = 0;
+    for (const char* c = body; *c; c++)
+    {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    char line[128];
+    int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, checksum);
+    return bytes_t(line, line + n);
+}
+
+void append(bytes_t& stream, const bytes_t& packet)
+{
+    stream.insert(stream.end(), packet.begin(), packet.end());
+}
+
+/**
+ * Feeds a stream in chunks and records every packet reported
+ */
+class cFramerHarness
+{
+public:
+    cFramerHarness() : m_framer(&m_counters) {}
+
+    void Feed(const bytes_t& stream, const std::vector<size_t>& chunkSizes)
+    {
+        size_t pos = 0;
+        for (size_t i = 0; pos < stream.size(); i++)
+        {
+            size_t n = std::min(stream.size() - pos, chunkSizes.empty() ? stream.size() : chunkSizes[i % chunkSizes.size()]);
+            Feed(stream.data() + pos, n);
+            pos += n;
+        }
+    }
+
+    void Feed(const uint8_t* data, size_t size)
+    {
+        m_framer.Feed(data, size, [this](const sISBridgePacket& packet)
+        {
+            packets.push_back(bytes_t(packet.data, packet.data + packet.size));
+            protocols.push_back(packet.protocol);
+        });
+    }
+
+    sISBridgeFramerStats Stats() const { return m_counters.Snapshot(); }
+    size_t PendingBytes() const { return m_framer.PendingBytes(); }
+    void Reset() { m_framer.Reset(); }
+
+    std::vector<bytes_t> packets;
+    std::vector<eISBridgeProtocol> protocols;
+
+private:
+    sISBridgeFramerCounters m_counters;
+    cISBridgePacketFramer m_framer;
+};
+
+}  // namespace
+
+TEST(PacketFramer, FindsEveryProtocolInOneChunk)
+{
+    std::vector<bytes_t> sent = { isbPacket(1, 20), nmeaSentence("GPGGA,123519,4807.038,N"), rtcmPacket(19), ubxPacket(8) };
+    bytes_t stream;
+    for (const bytes_t& packet : sent)
+    {
+        append(stream, packet);
+    }
+
+    cFramerHarness harness;
+    harness.Feed(stream, {});
+
+    ASSERT_EQ(sent, harness.packets);
+    EXPECT_EQ(BRIDGE_PROTOCOL_ISB, harness.protocols[0]);
+    EXPECT_EQ(BRIDGE_PROTOCOL_NMEA, harness.protocols[1]);
+    EXPECT_EQ(BRIDGE_PROTOCOL_RTCM3, harness.protocols[2]);
+    EXPECT_EQ(BRIDGE_PROTOCOL_UBX, harness.protocols[3]);
+    sISBridgeFramerStats stats = harness.Stats();
+    for (int protocol = BRIDGE_PROTOCOL_ISB; protocol < BRIDGE_PROTOCOL_COUNT; protocol++)
+    {
+        EXPECT_EQ(1u, stats.packets[protocol]) << "protocol " << protocol;
+    }
+    EXPECT_EQ(0u, stats.discardedBytes);
+    EXPECT_EQ(0u, harness.PendingBytes());
+}
+
+TEST(PacketFramer, ReassemblesPacketsSplitAtEveryOffset)
+{
+    std::vector<bytes_t> sent = { isbPacket(2, 40), ubxPacket(16), rtcmPacket(12), nmeaSentence("GPRMC,A,4807.038,N") };
+    bytes_t stream;
+    for (const bytes_t& packet : sent)
+    {
+        append(stream, packet);
+    }
+
+    for (size_t split = 1; split < stream.size(); split++)
+    {
+        cFramerHarness harness;
+        harness.Feed(stream.data(), split);
+        harness.Feed(stream.data() + split, stream.size() - split);
+
+        ASSERT_EQ(sent, harness.packets) << "split at " << split;
+        sISBridgeFramerStats stats = harness.Stats();
+        EXPECT_EQ(1u, stats.packets[BRIDGE_PROTOCOL_ISB]) << "split at " << split;
+        EXPECT_EQ(1u, stats.packets[BRIDGE_PROTOCOL_UBX]) << "split at " << split;
+        EXPECT_EQ(1u, stats.packets[BRIDGE_PROTOCOL_RTCM3]) << "split at " << split;
+        EXPECT_EQ(1u, stats.packets[BRIDGE_PROTOCOL_NMEA]) << "split at " << split;
+        EXPECT_EQ(0u, stats.discardedBytes) << "split at " << split;
+    }
+}
+
+TEST(PacketFramer, ReassemblesOneByteAtATime)
+{
+    std::vector<bytes_t> sent = { isbPacket(3, 100), isbPacket(4, 0), nmeaSentence("GPGSA,A,3") };
+    bytes_t stream;
+    for (const bytes_t& packet : sent)
+    {
+        append(stream, packet);
+    }
+
+    cFramerHarness harness;
+    harness.Feed(stream, { 1 });
+
+    EXPECT_EQ(sent, harness.packets);
+    EXPECT_EQ(2u, harness.Stats().packets[BRIDGE_PROTOCOL_ISB]);
+    EXPECT_EQ(1u, harness.Stats().packets[BRIDGE_PROTOCOL_NMEA]);
+    EXPECT_EQ(0u, harness.PendingBytes());
+}
+
+TEST(PacketFramer, DropsCorruptedFrames)
+{
+    bytes_t badChecksum = isbPacket(5, 10);
+    badChecksum[8] ^= 0x01;
+    bytes_t badUbx = ubxPacket(4);
+    badUbx.back() ^= 0xFF;
+    bytes_t good = isbPacket(6, 10);
+
+    bytes_t stream;
+    append(stream, badChecksum);
+    append(stream, badUbx);
+    append(stream, good);
+
+    // Whole, and with the corrupted frames split across chunks
+    for (size_t chunk : { stream.size(), static_cast<size_t>(3), static_cast<size_t>(7) })
+    {
+        cFramerHarness harness;
+        harness.Feed(stream, { chunk });
+
+        ASSERT_EQ(1u, harness.packets.size()) << "chunk " << chunk;
+        EXPECT_EQ(good, harness.packets[0]) << "chunk " << chunk;
+        sISBridgeFramerStats stats = harness.Stats();
+        EXPECT_EQ(2u, stats.checksumErrors) << "chunk " << chunk;
+        EXPECT_EQ(badChecksum.size() + badUbx.size(), stats.discardedBytes) << "chunk " << chunk;
+        EXPECT_EQ(1u, stats.packets[BRIDGE_PROTOCOL_ISB]) << "chunk " << chunk;
+        EXPECT_EQ(0u, stats.packets[BRIDGE_PROTOCOL_UBX]) << "chunk " << chunk;
+    }
+}
+
+TEST(PacketFramer, ChecksumsFramesSplitAtEveryOffset)
+{
+    // One corrupted byte per protocol, placed late in the frame so the running checksum
+    // has already covered most of it when the frame is split
+    std::vector<bytes_t> bad = { isbPacket(8, 40), ubxPacket(24), rtcmPacket(30), nmeaSentence("GPGGA,123519,4807.038,N") };
+    bad[0][bad[0].size() - 3] ^= 0x10;
+    bad[1][bad[1].size() - 3] ^= 0x10;
+    bad[2][bad[2].size() - 4] ^= 0x10;
+    bad[3][bad[3].size() - 7] ^= 0x01;
+    bytes_t good = isbPacket(9, 12);
+
+    bytes_t stream;
+    size_t badBytes = 0;
+    for (const bytes_t& packet : bad)
+    {
+        append(stream, packet);
+        append(stream, good);
+        badBytes += packet.size();
+    }
+
+    for (size_t split = 1; split < stream.size(); split++)
+    {
+        cFramerHarness harness;
+        harness.Feed(stream.data(), split);
+        harness.Feed(stream.data() + split, stream.size() - split);
+
+        ASSERT_EQ(std::vector<bytes_t>(bad.size(), good), harness.packets) << "split at " << split;
+        sISBridgeFramerStats stats = harness.Stats();
+        EXPECT_EQ(bad.size(), stats.checksumErrors) << "split at " << split;
+        EXPECT_EQ(badBytes, stats.discardedBytes) << "split at " << split;
+    }
+}
+
+TEST(PacketFramer, ResetDropsTheRunningChecksum)
+{
+    bytes_t first = isbPacket(10, 30);
+    bytes_t second = isbPacket(11, 30);
+
+    cFramerHarness harness;
+    harness.Feed(first.data(), 20);
+    harness.Reset();
+    EXPECT_EQ(0u, harness.PendingBytes());
+    harness.Feed(second.data(), 20);
+    harness.Feed(second.data() + 20, second.size() - 20);
+
+    ASSERT_EQ(1u, harness.packets.size());
+    EXPECT_EQ(second, harness.packets[0]);
+    EXPECT_EQ(0u, harness.Stats().checksumErrors);
+}
+
+TEST(PacketFramer, DiscardsOversizeFrames)
+{
+    bytes_t oversize = { BRIDGE_ISB_PREAMBLE0, BRIDGE_ISB_PREAMBLE1, BRIDGE_ISB_PKT_TYPE_DATA, 1, 0xFF, 0xFF };
+    bytes_t good = isbPacket(7, 30);
+    bytes_t stream = oversize;
+    append(stream, good);
+
+    cFramerHarness harness;
+    harness.Feed(stream, {});
+
+    ASSERT_EQ(1u, harness.packets.size());
+    EXPECT_EQ(good, harness.packets[0]);
+    EXPECT_EQ(1u, harness.Stats().oversizeFrames);
+    EXPECT_EQ(oversize.size(), harness.Stats().discardedBytes);
+}
+
+TEST(PacketFramer, RecoversPacketsInterleavedWithGarbage)
+{
+    // Garbage includes the binary sync bytes, so false frame starts are exercised; "$"
+    // and newlines are left out so garbage never forms an unchecked NMEA sentence
+    std::mt19937 rng(7);
+    std::vector<bytes_t> sent;
+    bytes_t stream;
+    size_t garbage = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        switch (rng() % 5)
+        {
+        case 0: sent.push_back(isbPacket(static_cast<uint8_t>(i), rng() % 300)); break;
+        case 1: sent.push_back(nmeaSentence("GPGGA,123519,4807.038,N,01131.000,E")); break;
+        case 2: sent.push_back(rtcmPacket(rng() % 200 + 2)); break;
+        case 3: sent.push_back(ubxPacket(rng() % 100)); break;
+        default:
+        {
+            size_t n = rng() % 40;
+            for (size_t j = 0; j < n; j++)
+            {
+                uint8_t c = static_cast<uint8_t>(rng());
+                stream.push_back((c == '$' || c == '\n') ? 0 : c);
+            }
+            garbage += n;
+            continue;
+        }
+        }
+        append(stream, sent.back());
+    }
+
+    std::vector<size_t> chunkSizes;
+    for (int i = 0; i < 64; i++)
+    {
+        chunkSizes.push_back(1 + rng() % 700);
+    }
+    cFramerHarness harness;
+    harness.Feed(stream, chunkSizes);
+
+    ASSERT_EQ(sent.size(), harness.packets.size());
+    EXPECT_EQ(sent, harness.packets);
+    sISBridgeFramerStats stats = harness.Stats();
+    uint64_t total = 0;
+    for (int protocol = BRIDGE_PROTOCOL_ISB; protocol < BRIDGE_PROTOCOL_COUNT; protocol++)
+    {
+        total += stats.packets[protocol];
+    }
+    EXPECT_EQ(sent.size(), total);
+    EXPECT_EQ(garbage, stats.discardedBytes);
+}
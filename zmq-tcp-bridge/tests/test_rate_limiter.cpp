@@ -0,0 +1,134 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "ISBridgeRateLimiter.h"
+#include "ISBridgePacketFramer.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+const uint64_t kStartNs = 1000000000ULL;
+const uint64_t kMsNs = 1000000ULL;
+
+/**
+ * Holds one buffer relabelled for each packet offered to a limiter
+ */
+class cRateHarness
+{
+public:
+    cRateHarness() : m_buffer(cISBridgeBuffer::Create(16)) { m_buffer->SetSize(16); }
+
+    bool Offer(cISBridgeRateLimiter& limiter, uint8_t did, uint64_t timestampNs, uint8_t type = BRIDGE_ISB_PKT_TYPE_DATA, uint8_t protocol = BRIDGE_PROTOCOL_ISB)
+    {
+        m_buffer->SetPacketInfo(protocol, type, did);
+        m_buffer->SetTimestamp(timestampNs);
+        return limiter.Accept(*m_buffer.Get(), timestampNs);
+    }
+
+private:
+    cISBridgeBufferRef m_buffer;
+};
+
+cISBridgeRateLimiter makeLimiter(uint8_t did, float maxHz)
+{
+    sISBridgeRateLimits limits;
+    limits.maxHz[did] = maxHz;
+    cISBridgeRateLimiter limiter;
+    limiter.SetLimits(limits);
+    return limiter;
+}
+
+}  // namespace
+
+TEST(RateLimiter, InactiveWithoutLimits)
+{
+    cISBridgeRateLimiter limiter;
+    cRateHarness harness;
+    EXPECT_FALSE(limiter.Active());
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs + i));
+    }
+    EXPECT_EQ(0u, limiter.Suppressed());
+}
+
+TEST(RateLimiter, AverageRateIsTheLimit)
+{
+    // 1 kHz source limited to 30 Hz, which 1 kHz is not a multiple of
+    cISBridgeRateLimiter limiter = makeLimiter(5, 30.0f);
+    cRateHarness harness;
+    EXPECT_TRUE(limiter.Active());
+
+    int accepted = 0;
+    const int kPackets = 10000;
+    for (int i = 0; i < kPackets; i++)
+    {
+        accepted += harness.Offer(limiter, 5, kStartNs + i * kMsNs) ? 1 : 0;
+    }
+
+    EXPECT_NEAR(300, accepted, 1);
+    EXPECT_EQ(static_cast<uint64_t>(kPackets - accepted), limiter.Suppressed());
+}
+
+TEST(RateLimiter, AcceptsJitterOfAQuarterInterval)
+{
+    cISBridgeRateLimiter limiter = makeLimiter(5, 10.0f);
+    cRateHarness harness;
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs));
+    EXPECT_FALSE(harness.Offer(limiter, 5, kStartNs + 74 * kMsNs));
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs + 75 * kMsNs));
+
+    // The cadence is kept: the next one is due at 200 ms, not 175 ms
+    EXPECT_FALSE(harness.Offer(limiter, 5, kStartNs + 174 * kMsNs));
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs + 175 * kMsNs));
+}
+
+TEST(RateLimiter, GapDoesNotLetABurstCatchUp)
+{
+    cISBridgeRateLimiter limiter = makeLimiter(5, 10.0f);
+    cRateHarness harness;
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs));
+
+    uint64_t resumeNs = kStartNs + 5000 * kMsNs;
+    EXPECT_TRUE(harness.Offer(limiter, 5, resumeNs));
+    EXPECT_FALSE(harness.Offer(limiter, 5, resumeNs + 10 * kMsNs));
+    EXPECT_FALSE(harness.Offer(limiter, 5, resumeNs + 50 * kMsNs));
+    EXPECT_TRUE(harness.Offer(limiter, 5, resumeNs + 100 * kMsNs));
+}
+
+TEST(RateLimiter, OnlyLimitedIsbDataIsDecimated)
+{
+    cISBridgeRateLimiter limiter = makeLimiter(5, 1.0f);
+    cRateHarness harness;
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs));
+    EXPECT_FALSE(harness.Offer(limiter, 5, kStartNs + kMsNs));
+
+    EXPECT_TRUE(harness.Offer(limiter, 6, kStartNs + kMsNs));
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs + kMsNs, BRIDGE_ISB_PKT_TYPE_ACK));
+    EXPECT_TRUE(harness.Offer(limiter, 5, kStartNs + kMsNs, 0, BRIDGE_PROTOCOL_NMEA));
+    EXPECT_EQ(1u, limiter.Suppressed());
+}
+
+TEST(RateLimiter, UntimestampedPacketsUseTheCurrentTime)
+{
+    cISBridgeRateLimiter limiter = makeLimiter(5, 10.0f);
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(16));
+    buffer->SetSize(16);
+    buffer->SetPacketInfo(BRIDGE_PROTOCOL_ISB, BRIDGE_ISB_PKT_TYPE_DATA, 5);
+
+    EXPECT_TRUE(limiter.Accept(*buffer.Get(), kStartNs));
+    EXPECT_FALSE(limiter.Accept(*buffer.Get(), kStartNs + 10 * kMsNs));
+    EXPECT_TRUE(limiter.Accept(*buffer.Get(), kStartNs + 100 * kMsNs));
+}
@@ -0,0 +1,136 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "ISBridgeReorderBuffer.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+
+const uint64_t kWindowNs = 10000000;
+
+/**
+ * Feeds a reorder buffer and records the publisher timestamp of every packet released,
+ * carried in each packet's timestamp
+ */
+class cReorderHarness
+{
+public:
+    cReorderHarness(int sourceCount, size_t capacity = 64)
+    {
+        m_reorder.Configure(sourceCount, kWindowNs, capacity);
+        m_handler = [this](cISBridgeBufferRef& buffer) { released.push_back(buffer->Timestamp()); };
+    }
+
+    void Push(int source, uint64_t publisherNs, uint64_t arrivalNs)
+    {
+        cISBridgeBufferRef buffer(cISBridgeBuffer::Create(1));
+        buffer->SetTimestamp(publisherNs);
+        m_reorder.Push(source, publisherNs, arrivalNs, buffer, m_handler);
+    }
+
+    int Release(uint64_t nowNs) { return m_reorder.Release(nowNs, m_handler); }
+
+    cISBridgeReorderBuffer& Reorder() { return m_reorder; }
+
+    std::vector<uint64_t> released;
+
+private:
+    cISBridgeReorderBuffer m_reorder;
+    cISBridgeReorderBuffer::release_handler_t m_handler;
+};
+
+}  // namespace
+
+TEST(ReorderBuffer, ReleasesInTimestampOrderOnceEverySourceHasPassed)
+{
+    cReorderHarness harness(2);
+    harness.Push(0, 100, 1);
+    harness.Push(0, 300, 1);
+    harness.Push(1, 200, 1);
+
+    EXPECT_EQ(2, harness.Release(2));
+    EXPECT_EQ(std::vector<uint64_t>({ 100, 200 }), harness.released);
+    EXPECT_EQ(1u, harness.Reorder().GetStats().held);
+
+    harness.Push(1, 400, 2);
+    EXPECT_EQ(1, harness.Release(3));
+    EXPECT_EQ(std::vector<uint64_t>({ 100, 200, 300 }), harness.released);
+    EXPECT_EQ(3u, harness.Reorder().GetStats().watermarkReleases);
+    EXPECT_EQ(0u, harness.Reorder().GetStats().deadlineReleases);
+    EXPECT_EQ(300u, harness.Reorder().GetSourceStats(0).watermarkNs);
+    EXPECT_EQ(400u, harness.Reorder().GetSourceStats(1).watermarkNs);
+}
+
+TEST(ReorderBuffer, StalledSourceDelaysTheOthersByAtMostTheWindow)
+{
+    cReorderHarness harness(2);
+    harness.Push(1, 50, 1000);
+    harness.Push(0, 100, 1000);
+    harness.Push(0, 200, 1000);
+
+    EXPECT_EQ(1, harness.Release(1000));
+    EXPECT_EQ(1000 + kWindowNs, harness.Reorder().NextDeadlineNs());
+    EXPECT_EQ(0, harness.Release(1000 + kWindowNs - 1));
+
+    EXPECT_EQ(2, harness.Release(1000 + kWindowNs));
+    EXPECT_EQ(std::vector<uint64_t>({ 50, 100, 200 }), harness.released);
+    EXPECT_EQ(2u, harness.Reorder().GetStats().deadlineReleases);
+    EXPECT_EQ(0u, harness.Reorder().NextDeadlineNs());
+}
+
+TEST(ReorderBuffer, SourceThatNeverSentDoesNotHoldPacketsBack)
+{
+    cReorderHarness harness(3);
+    harness.Push(0, 100, 1);
+    harness.Push(1, 150, 1);
+
+    EXPECT_EQ(1, harness.Release(2));
+    EXPECT_EQ(std::vector<uint64_t>({ 100 }), harness.released);
+}
+
+TEST(ReorderBuffer, LatePacketIsForwardedAtOnce)
+{
+    cReorderHarness harness(2);
+    harness.Push(0, 300, 1);
+    harness.Push(1, 300, 1);
+    harness.Release(2);
+    ASSERT_EQ(2u, harness.released.size());
+
+    harness.Push(1, 150, 3);
+    EXPECT_EQ(std::vector<uint64_t>({ 300, 300, 150 }), harness.released);
+    EXPECT_EQ(1u, harness.Reorder().GetSourceStats(1).lateMessages);
+    EXPECT_EQ(0u, harness.Reorder().GetStats().held);
+}
+
+TEST(ReorderBuffer, FullBufferReleasesTheOldestEarly)
+{
+    cReorderHarness harness(2, 2);
+    harness.Push(0, 300, 1);
+    harness.Push(0, 100, 1);
+    harness.Push(0, 200, 1);
+
+    EXPECT_EQ(std::vector<uint64_t>({ 100 }), harness.released);
+    EXPECT_EQ(2u, harness.Reorder().GetStats().held);
+    EXPECT_EQ(1u, harness.Reorder().GetStats().deadlineReleases);
+}
+
+TEST(ReorderBuffer, PacketFromAnUnknownSourcePassesThrough)
+{
+    cReorderHarness harness(1);
+    harness.Push(5, 100, 1);
+    EXPECT_EQ(std::vector<uint64_t>({ 100 }), harness.released);
+    EXPECT_EQ(0u, harness.Reorder().GetStats().held);
+}
@@ -0,0 +1,245 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeRuntime.h"
+#include "ISBridgeSocket.h"
+#include "bridge_test_fixture.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#endif
+
+TEST(Runtime, DefaultProfileApplies)
+{
+    int result = -1;
+    std::thread thread([&]() { result = bridgeApplyThreadProfile(sISBridgeThreadProfile(), "isb-test"); });
+    thread.join();
+    EXPECT_EQ(result, 0);
+}
+
+#if defined(__linux__)
+
+TEST(Runtime, ProfilePinsAndNamesTheThread)
+{
+    // Pin to the last CPU this process may run on
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+    int cpu = -1;
+    for (int i = 0; i < CPU_SETSIZE; i++)
+    {
+        if (CPU_ISSET(i, &allowed))
+        {
+            cpu = i;
+        }
+    }
+    ASSERT_GE(cpu, 0);
+
+    int result = -1;
+    cpu_set_t applied;
+    CPU_ZERO(&applied);
+    char name[32] = {};
+    std::thread thread([&]()
+    {
+        sISBridgeThreadProfile profile;
+        profile.cpu = cpu;
+        result = bridgeApplyThreadProfile(profile, "isb-test-thread-name");
+        pthread_getaffinity_np(pthread_self(), sizeof(applied), &applied);
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+    });
+    thread.join();
+
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(CPU_COUNT(&applied), 1);
+    EXPECT_TRUE(CPU_ISSET(cpu, &applied));
+    EXPECT_STREQ(name, "isb-test-thread");
+}
+
+TEST(Runtime, UnusableCpuLeavesTheThreadAsItWas)
+{
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+    int cpu = -1;
+    for (int i = CPU_SETSIZE - 1; i >= 0 && cpu < 0; i--)
+    {
+        if (!CPU_ISSET(i, &allowed))
+        {
+            cpu = i;
+        }
+    }
+    ASSERT_GE(cpu, 0);
+
+    int result = 0;
+    cpu_set_t applied;
+    CPU_ZERO(&applied);
+    std::thread thread([&]()
+    {
+        sISBridgeThreadProfile profile;
+        profile.cpu = cpu;
+        result = bridgeApplyThreadProfile(profile, "isb-test");
+        pthread_getaffinity_np(pthread_self(), sizeof(applied), &applied);
+    });
+    thread.join();
+
+    EXPECT_EQ(result, -1);
+    EXPECT_TRUE(CPU_EQUAL(&applied, &allowed));
+}
+
+/**
+ * @return allowed CPUs of this process's threads named name, read from /proc; waits
+ * for count of them, since a thread names itself once it runs
+ */
+static std::vector<cpu_set_t> namedThreadAffinities(const std::string& name, size_t count)
+{
+    std::vector<cpu_set_t> sets;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(BRIDGE_TEST_TIMEOUT_MS);
+    do
+    {
+        sets.clear();
+        DIR* dir = opendir("/proc/self/task");
+        for (dirent* entry; dir != NULL && (entry = readdir(dir)) != NULL; )
+        {
+            std::string threadName;
+            std::ifstream comm(std::string("/proc/self/task/") + entry->d_name + "/comm");
+            if (entry->d_name[0] == '.' || !std::getline(comm, threadName) || threadName != name)
+            {
+                continue;
+            }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(atoi(entry->d_name), sizeof(set), &set) == 0)
+            {
+                sets.push_back(set);
+            }
+        }
+        if (dir != NULL)
+        {
+            closedir(dir);
+        }
+    } while (sets.size() < count && std::chrono::steady_clock::now() < deadline);
+    return sets;
+}
+
+/**
+ * Start() pins the ZMQ thread and the TCP reactor thread each to its own profile's CPU
+ */
+TEST_F(BridgeTest, StartPinsEachForwardingThread)
+{
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < CPU_SETSIZE; i++)
+    {
+        if (CPU_ISSET(i, &allowed))
+        {
+            first = (first < 0) ? i : first;
+            last = i;
+        }
+    }
+    ASSERT_GE(first, 0);
+
+    sISZmqTcpBridgeOptions options;
+    options.zmqThread.cpu = first;
+    options.tcpThread.cpu = last;
+    ASSERT_EQ(0, StartBridge(options));
+
+    std::vector<cpu_set_t> zmqThreads = namedThreadAffinities("isb-zmq-to-tcp", 1);
+    std::vector<cpu_set_t> tcpThreads = namedThreadAffinities("isb-tcp-to-zmq", 1);
+    ASSERT_EQ(zmqThreads.size(), 1u);
+    ASSERT_EQ(tcpThreads.size(), 1u);
+    EXPECT_EQ(CPU_COUNT(&zmqThreads[0]), 1);
+    EXPECT_TRUE(CPU_ISSET(first, &zmqThreads[0]));
+    EXPECT_EQ(CPU_COUNT(&tcpThreads[0]), 1);
+    EXPECT_TRUE(CPU_ISSET(last, &tcpThreads[0]));
+    EXPECT_EQ(m_bridge.Stop(), 0);
+}
+
+TEST_F(BridgeTest, StartPinsShardThreadsToConsecutiveCpus)
+{
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+    int base = -1;
+    for (int i = 0; i + 1 < CPU_SETSIZE && base < 0; i++)
+    {
+        if (CPU_ISSET(i, &allowed) && CPU_ISSET(i + 1, &allowed))
+        {
+            base = i;
+        }
+    }
+    if (base < 0)
+    {
+        GTEST_SKIP() << "needs two consecutive allowed CPUs";
+    }
+
+    sISZmqTcpBridgeOptions options;
+    options.tcpShards = 2;
+    options.tcpThread.cpu = base;
+    ASSERT_EQ(0, StartBridge(options));
+
+    std::vector<cpu_set_t> shard0 = namedThreadAffinities("isb-tcp-0", 1);
+    std::vector<cpu_set_t> shard1 = namedThreadAffinities("isb-tcp-1", 1);
+    ASSERT_EQ(shard0.size(), 1u);
+    ASSERT_EQ(shard1.size(), 1u);
+    EXPECT_EQ(CPU_COUNT(&shard0[0]), 1);
+    EXPECT_TRUE(CPU_ISSET(base, &shard0[0]));
+    EXPECT_EQ(CPU_COUNT(&shard1[0]), 1);
+    EXPECT_TRUE(CPU_ISSET(base + 1, &shard1[0]));
+    EXPECT_EQ(m_bridge.Stop(), 0);
+}
+
+TEST(Runtime, BusyPollIsSetOnTheSocket)
+{
+    is_socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_TRUE(bridgeSocketValid(fd));
+
+    // Disabling is always allowed; a time above net.core.busy_read may be refused
+    int usec = -1;
+    socklen_t size = sizeof(usec);
+    ASSERT_EQ(0, bridgeSetBusyPoll(fd, 0));
+    ASSERT_EQ(0, getsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, &size));
+    EXPECT_EQ(usec, 0);
+    if (bridgeSetBusyPoll(fd, 50) == 0)
+    {
+        ASSERT_EQ(0, getsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, &size));
+        EXPECT_EQ(usec, 50);
+    }
+    else
+    {
+        EXPECT_TRUE(errno == EPERM || errno == EINVAL);
+    }
+    bridgeSocketClose(fd);
+
+    EXPECT_EQ(bridgeSetBusyPoll(-1, 50), -1);
+}
+
+#else
+
+TEST(Runtime, PinningAndBusyPollAreUnsupported)
+{
+    sISBridgeThreadProfile profile;
+    profile.cpu = 0;
+    EXPECT_EQ(bridgeApplyThreadProfile(profile, "isb-test"), -1);
+
+    is_socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_TRUE(bridgeSocketValid(fd));
+    EXPECT_EQ(bridgeSetBusyPoll(fd, 50), -1);
+    bridgeSocketClose(fd);
+}
+
+#endif
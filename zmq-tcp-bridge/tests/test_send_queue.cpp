@@ -0,0 +1,201 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include "ISBridgeSendQueue.h"
+#include "ISBridgePacketFramer.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return a message of size bytes, all set to tag
+ */
+cISBridgeBufferRef message(uint8_t tag, size_t size = 10)
+{
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(size));
+    memset(buffer->Data(), tag, size);
+    buffer->SetSize(size);
+    return buffer;
+}
+
+/**
+ * @return an ISB data packet of a data ID, all bytes set to tag
+ */
+cISBridgeBufferRef dataPacket(uint8_t did, uint8_t tag)
+{
+    cISBridgeBufferRef buffer = message(tag);
+    buffer->SetPacketInfo(BRIDGE_PROTOCOL_ISB, BRIDGE_ISB_PKT_TYPE_DATA, did);
+    return buffer;
+}
+
+cISBridgeSendQueue makeQueue(size_t maxMessages, size_t maxBytes, eISBridgeDropPolicy policy, bool conflate = false)
+{
+    sISBridgeSendQueueLimits limits;
+    limits.maxMessages = maxMessages;
+    limits.maxBytes = maxBytes;
+    limits.dropPolicy = policy;
+    limits.conflate = conflate;
+    cISBridgeSendQueue queue;
+    queue.SetLimits(limits);
+    return queue;
+}
+
+/**
+ * @return the first byte of every queued message, head first
+ */
+std::vector<uint8_t> queuedTags(const cISBridgeSendQueue& queue)
+{
+    iovec iov[64];
+    int n = queue.Peek(iov, 64);
+    std::vector<uint8_t> tags;
+    for (int i = 0; i < n; i++)
+    {
+        tags.push_back(static_cast<const uint8_t*>(iov[i].iov_base)[0]);
+    }
+    return tags;
+}
+
+}  // namespace
+
+TEST(SendQueue, DropOldestKeepsTheNewestMessages)
+{
+    cISBridgeSendQueue queue = makeQueue(3, 1000, BRIDGE_DROP_OLDEST);
+    for (uint8_t tag = 0; tag < 5; tag++)
+    {
+        EXPECT_TRUE(queue.Push(message(tag)));
+    }
+
+    EXPECT_EQ(std::vector<uint8_t>({ 2, 3, 4 }), queuedTags(queue));
+    EXPECT_EQ(2u, queue.Stats().droppedMessages);
+    EXPECT_EQ(20u, queue.Stats().droppedBytes);
+    EXPECT_EQ(30u, queue.Stats().queuedBytes);
+    EXPECT_EQ(3u, queue.Stats().highWatermarkMessages);
+}
+
+TEST(SendQueue, DropOldestAppliesTheByteLimit)
+{
+    cISBridgeSendQueue queue = makeQueue(100, 25, BRIDGE_DROP_OLDEST);
+    for (uint8_t tag = 0; tag < 4; tag++)
+    {
+        queue.Push(message(tag));
+    }
+
+    EXPECT_EQ(std::vector<uint8_t>({ 2, 3 }), queuedTags(queue));
+    EXPECT_EQ(20u, queue.Stats().queuedBytes);
+    EXPECT_EQ(20u, queue.Stats().highWatermarkBytes);
+}
+
+TEST(SendQueue, DropOldestNeverDropsAPartiallyWrittenMessage)
+{
+    cISBridgeSendQueue queue = makeQueue(3, 1000, BRIDGE_DROP_OLDEST);
+    for (uint8_t tag = 0; tag < 3; tag++)
+    {
+        queue.Push(message(tag));
+    }
+    EXPECT_EQ(0u, queue.Consume(4));
+    queue.Push(message(3));
+
+    // The rest of message 0 still goes out first, so the stream stays packet aligned
+    iovec iov[8];
+    ASSERT_EQ(3, queue.Peek(iov, 8));
+    EXPECT_EQ(6u, iov[0].iov_len);
+    EXPECT_EQ(0, static_cast<const uint8_t*>(iov[0].iov_base)[0]);
+    EXPECT_EQ(std::vector<uint8_t>({ 0, 2, 3 }), queuedTags(queue));
+    EXPECT_EQ(1u, queue.Stats().droppedMessages);
+    EXPECT_EQ(26u, queue.Stats().queuedBytes);
+}
+
+TEST(SendQueue, DropOldestNeverDropsPinnedMessages)
+{
+    cISBridgeSendQueue queue = makeQueue(2, 1000, BRIDGE_DROP_OLDEST);
+    queue.Push(message(0));
+    queue.Push(message(1));
+    queue.Pin(2);
+
+    queue.Push(message(2));
+    EXPECT_EQ(std::vector<uint8_t>({ 0, 1 }), queuedTags(queue));
+    EXPECT_EQ(1u, queue.Stats().droppedMessages);
+
+    // Completing the write releases the pin
+    EXPECT_EQ(2u, queue.Consume(20));
+    queue.Push(message(3));
+    EXPECT_EQ(std::vector<uint8_t>({ 3 }), queuedTags(queue));
+}
+
+TEST(SendQueue, DropNewestKeepsTheQueuedMessages)
+{
+    cISBridgeSendQueue queue = makeQueue(3, 1000, BRIDGE_DROP_NEWEST);
+    for (uint8_t tag = 0; tag < 5; tag++)
+    {
+        EXPECT_TRUE(queue.Push(message(tag)));
+    }
+
+    EXPECT_EQ(std::vector<uint8_t>({ 0, 1, 2 }), queuedTags(queue));
+    EXPECT_EQ(2u, queue.Stats().droppedMessages);
+    EXPECT_EQ(20u, queue.Stats().droppedBytes);
+}
+
+TEST(SendQueue, DisconnectPolicyRefusesWithoutDropping)
+{
+    cISBridgeSendQueue queue = makeQueue(2, 1000, BRIDGE_DROP_DISCONNECT);
+    EXPECT_TRUE(queue.Push(message(0)));
+    EXPECT_TRUE(queue.Push(message(1)));
+    EXPECT_FALSE(queue.Push(message(2)));
+
+    // The owner disconnects the client and counts the drops
+    EXPECT_EQ(std::vector<uint8_t>({ 0, 1 }), queuedTags(queue));
+    EXPECT_EQ(0u, queue.Stats().droppedMessages);
+}
+
+TEST(SendQueue, ConsumeCountsWrittenMessages)
+{
+    cISBridgeSendQueue queue = makeQueue(8, 1000, BRIDGE_DROP_OLDEST);
+    for (uint8_t tag = 0; tag < 3; tag++)
+    {
+        queue.Push(message(tag));
+    }
+
+    EXPECT_EQ(1u, queue.Consume(15));
+    EXPECT_EQ(2u, queue.Consume(15));
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(3u, queue.Stats().sentMessages);
+    EXPECT_EQ(30u, queue.Stats().sentBytes);
+    EXPECT_EQ(0u, queue.Stats().queuedBytes);
+}
+
+TEST(SendQueue, ConflateReplacesTheQueuedPacketOfTheSameDid)
+{
+    cISBridgeSendQueue queue = makeQueue(8, 1000, BRIDGE_DROP_OLDEST, true);
+    queue.Push(dataPacket(5, 1));
+    queue.Push(dataPacket(6, 2));
+    queue.Push(dataPacket(5, 3));
+
+    EXPECT_EQ(std::vector<uint8_t>({ 3, 2 }), queuedTags(queue));
+    EXPECT_EQ(1u, queue.Stats().conflatedMessages);
+    EXPECT_EQ(20u, queue.Stats().queuedBytes);
+
+    // Not once it is being written
+    queue.Pin(1);
+    queue.Push(dataPacket(5, 4));
+    EXPECT_EQ(std::vector<uint8_t>({ 3, 2, 4 }), queuedTags(queue));
+
+    // Other traffic is never conflated
+    queue.Push(message(7));
+    queue.Push(message(8));
+    EXPECT_EQ(std::vector<uint8_t>({ 3, 2, 4, 7, 8 }), queuedTags(queue));
+    EXPECT_EQ(1u, queue.Stats().conflatedMessages);
+}
@@ -0,0 +1,389 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include "ISBridgeTcpReactor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * Records the reactor callbacks
+ */
+class cReactorRecorder : public iISBridgeTcpReactorDelegate
+{
+public:
+    std::string received;
+    int disconnects = 0;
+    int connectFailures = 0;
+
+protected:
+    void OnClientConnectFailed(cISBridgeTcpReactor* reactor) override
+    {
+        (void)reactor;
+        connectFailures++;
+    }
+
+    void OnClientDataReceived(cISBridgeTcpReactor* reactor, is_socket_t socket, uint8_t* data, int dataLength) override
+    {
+        (void)reactor;
+        (void)socket;
+        received.append((const char*)data, dataLength);
+    }
+
+    void OnClientDisconnected(cISBridgeTcpReactor* reactor, is_socket_t socket) override
+    {
+        (void)reactor;
+        (void)socket;
+        disconnects++;
+    }
+};
+
+/**
+ * @return a socket connected to the reactor's port on the loopback address, -1 on failure
+ */
+int connectLoopback(int port)
+{
+    int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (socket >= 0 && connect(socket, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+/**
+ * Run the reactor until done() holds or a second passes
+ * @return true if done() held
+ */
+template <typename Done>
+bool runUntil(cISBridgeTcpReactor& reactor, Done done)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        reactor.Run(10);
+    }
+    return true;
+}
+
+/**
+ * Accept a client while the reactor is paused by HandOff(), resume it, and check that
+ * the client is served and cleaned up like any other
+ */
+void acceptWhilePaused(eISBridgeTcpBackend backend)
+{
+    cReactorRecorder recorder;
+    cISBridgeTcpReactor reactor(&recorder);
+    reactor.SetBackend(backend);
+    ASSERT_EQ(reactor.Open("127.0.0.1", 0), 0);
+    if (reactor.Backend() != backend)
+    {
+        reactor.Close();
+        GTEST_SKIP() << "backend unavailable";
+    }
+
+    is_socket_t listenSocket;
+    std::vector<sISBridgeTcpHandoffClient> handoffClients;
+    ASSERT_EQ(reactor.HandOff(listenSocket, handoffClients), 0);
+    EXPECT_TRUE(handoffClients.empty());
+
+    int peer = connectLoopback(reactor.Port());
+    ASSERT_GE(peer, 0);
+    is_socket_t accepted = accept(listenSocket, NULL, NULL);
+    close(listenSocket);
+    ASSERT_GE(accepted, 0);
+    sISBridgeDidSet filter;
+    ASSERT_EQ(reactor.AdoptClient(accepted, filter), 0);
+    EXPECT_EQ(reactor.ClientCount(), 1);
+
+    ASSERT_EQ(reactor.Resume(), 0);
+    ASSERT_EQ(write(peer, "hello", 5), 5);
+    EXPECT_TRUE(runUntil(reactor, [&] { return recorder.received == "hello"; }));
+
+    close(peer);
+    EXPECT_TRUE(runUntil(reactor, [&] { return recorder.disconnects == 1; }));
+    EXPECT_EQ(reactor.ClientCount(), 0);
+
+    // Nothing is left in flight for Close() to wait out
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(reactor.Close(), 0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+/**
+ * @return true once the peer of a connected socket has reset or closed it
+ */
+bool peerClosed(int socket)
+{
+    char byte;
+    ssize_t n = recv(socket, &byte, 1, MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+/**
+ * Connect while the process is out of file descriptors and check that the connection
+ * is reset rather than left in the backlog, and that accepting carries on once
+ * descriptors are free again
+ */
+void acceptAtDescriptorLimit(eISBridgeTcpBackend backend)
+{
+    // Lowered before Open(), since io_uring takes the limit when the accept is armed
+    int probe = open("/dev/null", O_RDONLY);
+    ASSERT_GE(probe, 0);
+    rlimit saved;
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit lowered = saved;
+    lowered.rlim_cur = static_cast<rlim_t>(probe + 32);
+    close(probe);
+    if (setrlimit(RLIMIT_NOFILE, &lowered) != 0)
+    {
+        GTEST_SKIP() << "cannot lower RLIMIT_NOFILE";
+    }
+
+    cReactorRecorder recorder;
+    cISBridgeTcpReactor reactor(&recorder);
+    reactor.SetBackend(backend);
+    if (reactor.Open("127.0.0.1", 0) != 0 || reactor.Backend() != backend)
+    {
+        reactor.Close();
+        setrlimit(RLIMIT_NOFILE, &saved);
+        GTEST_SKIP() << "backend unavailable";
+    }
+
+    // The peer's socket exists before the limit is reached, so only accept() runs out
+    int refused = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(refused, 0);
+    std::vector<int> fillers;
+    for (int fd; (fd = open("/dev/null", O_RDONLY)) >= 0; )
+    {
+        fillers.push_back(fd);
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)reactor.Port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool connected = connect(refused, (const sockaddr*)&address, sizeof(address)) == 0;
+    bool failed = connected && runUntil(reactor, [&] { return recorder.connectFailures > 0; });
+    bool reset = connected && runUntil(reactor, [&] { return peerClosed(refused); });
+    int clients = reactor.ClientCount();
+
+    for (int fd : fillers)
+    {
+        close(fd);
+    }
+    setrlimit(RLIMIT_NOFILE, &saved);
+    close(refused);
+    ASSERT_TRUE(connected);
+    EXPECT_TRUE(failed);
+    EXPECT_TRUE(reset);
+    EXPECT_EQ(clients, 0);
+
+    int peer = connectLoopback(reactor.Port());
+    ASSERT_GE(peer, 0);
+    EXPECT_TRUE(runUntil(reactor, [&] { return reactor.ClientCount() == 1; }));
+    close(peer);
+    EXPECT_EQ(reactor.Close(), 0);
+}
+
+/**
+ * @return true if data is whole messages of messageSize bytes, each starting with 'M'
+ */
+bool wholeMessages(const std::string& data, size_t messageSize)
+{
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if ((data[i] == 'M') != (i % messageSize == 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(TcpReactor, EpollServesClientAcceptedWhilePaused)
+{
+    acceptWhilePaused(BRIDGE_TCP_BACKEND_EPOLL);
+}
+
+TEST(TcpReactor, UringServesClientAcceptedWhilePaused)
+{
+    acceptWhilePaused(BRIDGE_TCP_BACKEND_IO_URING);
+}
+
+TEST(TcpReactor, EpollResetsClientsAtTheDescriptorLimit)
+{
+    acceptAtDescriptorLimit(BRIDGE_TCP_BACKEND_EPOLL);
+}
+
+TEST(TcpReactor, UringResetsClientsAtTheDescriptorLimit)
+{
+    acceptAtDescriptorLimit(BRIDGE_TCP_BACKEND_IO_URING);
+}
+
+TEST(TcpReactor, SubscriptionsAreTheUnionOfShardsWithClients)
+{
+    cReactorRecorder recorder;
+    cISBridgeTcpReactor empty(&recorder);
+    cISBridgeTcpReactor first(&recorder);
+    cISBridgeTcpReactor second(&recorder);
+    cISBridgeTcpReactor* reactors[] = { &empty, &first, &second };
+    for (cISBridgeTcpReactor* reactor : reactors)
+    {
+        ASSERT_EQ(reactor->Open("127.0.0.1", 0), 0);
+    }
+
+    // No clients anywhere: everything
+    sISBridgeDidSet wanted;
+    cISBridgeTcpReactor::GetSubscriptions(reactors, 3, wanted);
+    EXPECT_TRUE(wanted.all);
+
+    // An empty first shard must not hide the others
+    std::vector<int> peers;
+    auto adopt = [&peers](cISBridgeTcpReactor& reactor, const sISBridgeDidSet& filter)
+    {
+        int pair[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        peers.push_back(pair[1]);
+        ASSERT_EQ(reactor.AdoptClient(pair[0], filter), 0);
+    };
+    sISBridgeDidSet five;
+    five.all = false;
+    five.words[0] = 1ULL << 5;
+    sISBridgeDidSet high;
+    high.all = false;
+    high.words[2] = 1ULL << 2;
+    adopt(first, five);
+    adopt(second, high);
+    cISBridgeTcpReactor::GetSubscriptions(reactors, 3, wanted);
+    EXPECT_FALSE(wanted.all);
+    EXPECT_TRUE(wanted.Contains(5));
+    EXPECT_TRUE(wanted.Contains(130));
+    EXPECT_FALSE(wanted.Contains(6));
+
+    // Any unfiltered client wants everything
+    adopt(second, sISBridgeDidSet());
+    cISBridgeTcpReactor::GetSubscriptions(reactors, 3, wanted);
+    EXPECT_TRUE(wanted.all);
+
+    for (cISBridgeTcpReactor* reactor : reactors)
+    {
+        EXPECT_EQ(reactor->Close(), 0);
+    }
+    for (int peer : peers)
+    {
+        close(peer);
+    }
+}
+
+/**
+ * Broadcast from another thread while clients connect, send and disconnect. Broadcast()
+ * writes to a snapshot of the clients, so a client closed meanwhile must be left alone:
+ * every new client, often given the descriptor just freed, sees whole messages from its
+ * first byte, and every client's data still reaches the delegate.
+ */
+TEST(TcpReactor, BroadcastRacesConnectsAndDisconnects)
+{
+    const size_t kMessageSize = 64;
+    const int kClients = 100;
+    cReactorRecorder recorder;
+    cISBridgeTcpReactor reactor(&recorder);
+    ASSERT_EQ(reactor.Open("127.0.0.1", 0), 0);
+
+    std::atomic<bool> broadcasting(true);
+    std::thread broadcaster([&]()
+    {
+        char message[kMessageSize];
+        memset(message, 'x', sizeof(message));
+        message[0] = 'M';
+        while (broadcasting)
+        {
+            reactor.Write(message, sizeof(message));
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    });
+
+    std::string expected;
+    int garbled = 0;
+    int reached = 0;
+    for (int i = 0; i < kClients; i++)
+    {
+        int peer = connectLoopback(reactor.Port());
+        ASSERT_GE(peer, 0);
+        ASSERT_EQ(write(peer, "ping", 4), 4);
+        expected += "ping";
+        runUntil(reactor, [&] { return recorder.received.size() == expected.size(); });
+
+        // Until some client has been reached, give the broadcast a moment to arrive,
+        // since on a busy or single-core host the broadcaster may not have run yet
+        std::string data;
+        char in[4096];
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(reached ? 0 : 50);
+        for (;;)
+        {
+            for (ssize_t n; (n = recv(peer, in, sizeof(in), MSG_DONTWAIT)) > 0; )
+            {
+                data.append(in, static_cast<size_t>(n));
+            }
+            if (!data.empty() || std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+            reactor.Run(1);
+        }
+        garbled += wholeMessages(data, kMessageSize) ? 0 : 1;
+        reached += data.empty() ? 0 : 1;
+        close(peer);
+        reactor.Run(0);
+    }
+    broadcasting = false;
+    broadcaster.join();
+
+    EXPECT_TRUE(runUntil(reactor, [&] { return recorder.disconnects == kClients; }));
+    EXPECT_EQ(recorder.received, expected);
+    EXPECT_EQ(garbled, 0);
+    EXPECT_GT(reached, 0);
+    EXPECT_EQ(reactor.ClientCount(), 0);
+    EXPECT_EQ(reactor.Close(), 0);
+}
+
+#endif
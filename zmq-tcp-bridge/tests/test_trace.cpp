@@ -0,0 +1,334 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeTrace.h"
+#include "ISBridgeMetrics.h"
+#include "bridge_test_fixture.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @return a buffer of size bytes carrying packet info derived from tag
+ */
+cISBridgeBufferRef message(size_t size, uint16_t tag)
+{
+    cISBridgeBufferRef buffer(cISBridgeBuffer::Create(size));
+    memset(buffer->Data(), 0, size);
+    buffer->SetSize(size);
+    buffer->SetPacketInfo(BRIDGE_PROTOCOL_ISB, static_cast<uint8_t>(tag & 0xFF), tag);
+    return buffer;
+}
+
+/**
+ * The stages a message passes in order, for its direction
+ */
+std::vector<eISBridgeTraceStage> stagesInOrder(bool tcpToZmq)
+{
+    if (tcpToZmq)
+    {
+        return { BRIDGE_TRACE_ZMQ_QUEUED, BRIDGE_TRACE_ZMQ_PUBLISHED };
+    }
+    return { BRIDGE_TRACE_ZMQ_RECEIVED, BRIDGE_TRACE_BATCHED, BRIDGE_TRACE_FANOUT,
+             BRIDGE_TRACE_TCP_FIRST_WRITE, BRIDGE_TRACE_TCP_LAST_WRITE };
+}
+
+/**
+ * @return true if the stages a record reached carry non-decreasing times, and no
+ * stage of the other direction is stamped
+ */
+bool stagesMonotonic(const sISBridgeTraceRecord& record)
+{
+    uint64_t last = 0;
+    for (eISBridgeTraceStage stage : stagesInOrder(record.tcpToZmq))
+    {
+        uint64_t ns = record.stageNs[stage];
+        if (ns == 0)
+        {
+            continue;
+        }
+        if (ns < last)
+        {
+            return false;
+        }
+        last = ns;
+    }
+    for (eISBridgeTraceStage stage : stagesInOrder(!record.tcpToZmq))
+    {
+        if (record.stageNs[stage] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TEST(TraceRing, SamplesOneInN)
+{
+    cISBridgeTraceRing ring(1024, 10);
+    int sampled = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        if (ring.Sample())
+        {
+            cISBridgeBufferRef buffer = message(16, static_cast<uint16_t>(i));
+            ring.Begin(false, *buffer.Get());
+            sampled++;
+        }
+    }
+    EXPECT_EQ(sampled, 100);
+
+    std::vector<sISBridgeTraceRecord> records;
+    ring.Snapshot(records);
+    ASSERT_EQ(records.size(), 100u);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        // The first message is sampled, then every tenth
+        EXPECT_EQ(records[i].id, i + 1);
+        EXPECT_EQ(records[i].packetId, i * 10);
+    }
+
+    // 0 and 1 both sample every message
+    cISBridgeTraceRing every(16, 0);
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_TRUE(every.Sample());
+    }
+}
+
+TEST(TraceRing, RecordsComeBackInOrderAfterWrap)
+{
+    // Rounded up to 8 records
+    cISBridgeTraceRing ring(5, 1);
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 21; i++)
+    {
+        cISBridgeBufferRef buffer = message(static_cast<size_t>(10 + i), static_cast<uint16_t>(i));
+        uint64_t id = ring.Begin(i % 2 == 0, *buffer.Get());
+        EXPECT_EQ(buffer->TraceId(), id);
+        ring.Stamp(id, (i % 2 == 0) ? BRIDGE_TRACE_ZMQ_QUEUED : BRIDGE_TRACE_ZMQ_RECEIVED, 1000 + i);
+        ids.push_back(id);
+    }
+
+    std::vector<sISBridgeTraceRecord> records;
+    ring.Snapshot(records);
+    ASSERT_EQ(records.size(), 8u);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        int message = 13 + static_cast<int>(i);
+        EXPECT_EQ(records[i].id, ids[message]);
+        EXPECT_EQ(records[i].size, static_cast<uint32_t>(10 + message));
+        EXPECT_EQ(records[i].packetId, message);
+        EXPECT_EQ(records[i].tcpToZmq, message % 2 == 0);
+        EXPECT_EQ(records[i].stageNs[records[i].tcpToZmq ? BRIDGE_TRACE_ZMQ_QUEUED : BRIDGE_TRACE_ZMQ_RECEIVED],
+                  static_cast<uint64_t>(1000 + message));
+    }
+
+    // A stamp for an overwritten record does not land on the one in its slot
+    ring.Stamp(ids[12], BRIDGE_TRACE_ZMQ_PUBLISHED, 5);
+    ring.Snapshot(records);
+    ASSERT_EQ(records.size(), 8u);
+    EXPECT_EQ(records[7].id, ids[20]);
+    EXPECT_EQ(records[7].stageNs[BRIDGE_TRACE_ZMQ_PUBLISHED], 0u);
+}
+
+TEST(TraceRing, WriteStagesKeepFirstAndLast)
+{
+    cISBridgeTraceRing ring(4, 1);
+    cISBridgeBufferRef buffer = message(8, 1);
+    uint64_t id = ring.Begin(false, *buffer.Get());
+
+    // Shards complete their writes in any order
+    for (uint64_t ns : { 300u, 100u, 500u, 200u })
+    {
+        ring.Stamp(id, BRIDGE_TRACE_TCP_FIRST_WRITE, ns);
+        ring.Stamp(id, BRIDGE_TRACE_TCP_LAST_WRITE, ns);
+    }
+    ring.Stamp(0, BRIDGE_TRACE_FANOUT, 7);
+    ring.Stamp(id, BRIDGE_TRACE_STAGE_COUNT, 7);
+
+    std::vector<sISBridgeTraceRecord> records;
+    ring.Snapshot(records);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].stageNs[BRIDGE_TRACE_TCP_FIRST_WRITE], 100u);
+    EXPECT_EQ(records[0].stageNs[BRIDGE_TRACE_TCP_LAST_WRITE], 500u);
+    EXPECT_EQ(records[0].stageNs[BRIDGE_TRACE_FANOUT], 0u);
+
+    std::string json;
+    cISBridgeTraceRing::FormatJson(records, json);
+    EXPECT_EQ(json, "{\"id\":1,\"direction\":\"zmq_to_tcp\",\"size\":8,\"protocol\":" + std::to_string(BRIDGE_PROTOCOL_ISB) +
+                    ",\"type\":1,\"packet_id\":1,\"tcp_first_write_ns\":100,\"tcp_last_write_ns\":500}\n");
+}
+
+TEST(TraceRing, SnapshotWhileProducing)
+{
+    // One thread samples and stamps as the forwarding thread does, another stamps the
+    // write stages as a shard does, and the test thread snapshots throughout. Run under
+    // ThreadSanitizer to check the seqlock.
+    const uint64_t kRecords = 200000;
+    cISBridgeTraceRing ring(64, 1);
+    std::atomic<uint64_t> begun(0);
+    std::atomic<bool> done(false);
+
+    std::thread producer([&]()
+    {
+        cISBridgeBufferRef buffer = message(1000, 0);
+        for (uint64_t i = 0; i < kRecords; i++)
+        {
+            buffer->SetSize(static_cast<size_t>(i % 1000 + 1));
+            uint64_t id = ring.Begin(false, *buffer.Get());
+            ring.Stamp(id, BRIDGE_TRACE_ZMQ_RECEIVED, bridgeClockNs());
+            ring.Stamp(id, BRIDGE_TRACE_BATCHED, bridgeClockNs());
+            ring.Stamp(id, BRIDGE_TRACE_FANOUT, bridgeClockNs());
+            begun.store(id, std::memory_order_release);
+        }
+        done = true;
+    });
+    std::thread writer([&]()
+    {
+        while (!done)
+        {
+            uint64_t id = begun.load(std::memory_order_acquire);
+            uint64_t now = bridgeClockNs();
+            ring.Stamp(id, BRIDGE_TRACE_TCP_FIRST_WRITE, now);
+            ring.Stamp(id, BRIDGE_TRACE_TCP_LAST_WRITE, now);
+        }
+    });
+
+    std::vector<sISBridgeTraceRecord> records;
+    int snapshots = 0;
+    int inconsistent = 0;
+    int unordered = 0;
+    while (!done || snapshots == 0)
+    {
+        ring.Snapshot(records);
+        snapshots++;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            // Every record was copied whole: its size matches its ID
+            inconsistent += (records[i].size == (records[i].id - 1) % 1000 + 1) ? 0 : 1;
+            unordered += (i > 0 && records[i].id <= records[i - 1].id) ? 1 : 0;
+        }
+        EXPECT_LE(records.size(), 64u);
+    }
+    producer.join();
+    writer.join();
+
+    EXPECT_EQ(inconsistent, 0);
+    EXPECT_EQ(unordered, 0);
+    ring.Snapshot(records);
+    ASSERT_EQ(records.size(), 64u);
+    EXPECT_EQ(records.back().id, kRecords);
+    for (const sISBridgeTraceRecord& record : records)
+    {
+        EXPECT_NE(record.stageNs[BRIDGE_TRACE_ZMQ_RECEIVED], 0u);
+        EXPECT_LE(record.stageNs[BRIDGE_TRACE_ZMQ_RECEIVED], record.stageNs[BRIDGE_TRACE_BATCHED]);
+        EXPECT_LE(record.stageNs[BRIDGE_TRACE_BATCHED], record.stageNs[BRIDGE_TRACE_FANOUT]);
+    }
+}
+
+TEST(Bridge, TraceRecordsNeedSampling)
+{
+    cISZmqTcpBridge bridge;
+    std::vector<sISBridgeTraceRecord> records(1);
+    EXPECT_EQ(bridge.GetTraceRecords(records), -1);
+    EXPECT_TRUE(records.empty());
+}
+
+TEST_F(BridgeTest, TraceStagesAreMonotonic)
+{
+    sISZmqTcpBridgeOptions options;
+    options.traceSampleEvery = 1;
+    options.traceRecords = 1024;
+    ASSERT_EQ(0, StartBridge(options));
+    ASSERT_TRUE(JoinBridgePublisher());
+    is_socket_t client = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(client));
+
+    // Publish until the bridge subscription is up and a message reaches the client
+    const uint8_t published[8] = { 't', 'r', 'a', 'c', 'e', 'z', 't', 't' };
+    uint8_t in[sizeof(published)];
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub, published, sizeof(published), 0);
+        joined = ReadClient(client, in, sizeof(in), 50);
+    }
+    ASSERT_TRUE(joined);
+
+    // Then both directions, one message at a time so each completes every stage
+    const int kMessages = 20;
+    const uint8_t written[6] = { 't', 'r', 'a', 'c', 'e', 'r' };
+    for (int i = 0; i < kMessages; i++)
+    {
+        ASSERT_EQ(zmq_send(m_pub, published, sizeof(published), 0), static_cast<int>(sizeof(published)));
+        ASSERT_TRUE(ReadClient(client, in, sizeof(in), BRIDGE_TEST_TIMEOUT_MS));
+        ASSERT_EQ(send(client, reinterpret_cast<const char*>(written), sizeof(written), MSG_NOSIGNAL), static_cast<int>(sizeof(written)));
+        ASSERT_EQ(Receive(1).size(), 1u);
+    }
+
+    // A stage is stamped just after the peer can see the message, so read the records
+    // once the bridge has stopped; they stay available until the next start
+    std::vector<sISBridgeTraceRecord> running;
+    ASSERT_EQ(m_bridge.GetTraceRecords(running), 0);
+    bridgeSocketClose(client);
+    m_bridge.Stop();
+    std::vector<sISBridgeTraceRecord> records;
+    ASSERT_EQ(m_bridge.GetTraceRecords(records), 0);
+    EXPECT_EQ(records.size(), running.size());
+
+    int zmqToTcp = 0;
+    int tcpToZmq = 0;
+    int complete = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const sISBridgeTraceRecord& record = records[i];
+        EXPECT_TRUE(stagesMonotonic(record)) << "record " << record.id;
+        if (i > 0)
+        {
+            EXPECT_GT(record.id, records[i - 1].id);
+        }
+        if (record.tcpToZmq)
+        {
+            tcpToZmq++;
+            continue;
+        }
+        zmqToTcp++;
+
+        // Only messages that reached the client have write stages
+        if (record.size == sizeof(published) && record.stageNs[BRIDGE_TRACE_TCP_LAST_WRITE] != 0)
+        {
+            complete++;
+            for (eISBridgeTraceStage stage : stagesInOrder(false))
+            {
+                EXPECT_NE(record.stageNs[stage], 0u) << cISBridgeTraceRing::StageName(stage);
+            }
+        }
+    }
+    EXPECT_GE(zmqToTcp, kMessages);
+    EXPECT_GE(tcpToZmq, kMessages);
+    EXPECT_GE(complete, kMessages);
+    for (const sISBridgeTraceRecord& record : records)
+    {
+        if (record.tcpToZmq && record.size == sizeof(written))
+        {
+            EXPECT_NE(record.stageNs[BRIDGE_TRACE_ZMQ_PUBLISHED], 0u);
+        }
+    }
+}
@@ -0,0 +1,220 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISBridgeTxScheduler.h"
+#include <gtest/gtest.h>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TX_TEST_MS      1000000ULL      // Nanoseconds per millisecond for the test clock
+
+namespace
+{
+
+/**
+ * An accepted loopback TCP connection, for the scheduler to read TCP_INFO from and size
+ */
+class cLoopbackConnection
+{
+public:
+    cLoopbackConnection()
+    {
+        int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (listener >= 0 && bind(listener, (const sockaddr*)&address, sizeof(address)) == 0 && listen(listener, 1) == 0 &&
+            getsockname(listener, (sockaddr*)&address, &length) == 0)
+        {
+            peer = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (connect(peer, (const sockaddr*)&address, sizeof(address)) == 0)
+            {
+                socket = accept(listener, NULL, NULL);
+            }
+        }
+        if (listener >= 0)
+        {
+            close(listener);
+        }
+    }
+
+    ~cLoopbackConnection()
+    {
+        if (socket >= 0)
+        {
+            close(socket);
+        }
+        if (peer >= 0)
+        {
+            close(peer);
+        }
+    }
+
+    int KernelSndbuf() const
+    {
+        int size = 0;
+        socklen_t length = sizeof(size);
+        getsockopt(socket, SOL_SOCKET, SO_SNDBUF, &size, &length);
+        return size;
+    }
+
+    int socket = -1;
+    int peer = -1;
+};
+
+sISBridgeTxOptions adaptiveOptions()
+{
+    sISBridgeTxOptions options;
+    options.adaptive = true;
+    options.coalesceRate = 1000;
+    options.sampleMs = 100;
+    options.flushUs = 2000;
+    options.flushBytes = 4096;
+    return options;
+}
+
+/**
+ * Queue messages over one sample period of the test clock and sample at its end
+ * @return the test clock after the sample
+ */
+uint64_t runPeriod(cISBridgeTxScheduler& scheduler, int socket, uint64_t nowNs, int messages, size_t messageBytes, bool writeBlocked = false)
+{
+    for (int i = 0; i < messages; i++)
+    {
+        scheduler.OnQueued(1, messageBytes, 0, nowNs);
+        scheduler.OnFlushed();
+    }
+    nowNs += 100 * TX_TEST_MS;
+    EXPECT_TRUE(scheduler.SampleDue(nowNs));
+    scheduler.Sample(socket, writeBlocked, nowNs);
+    return nowNs;
+}
+
+}  // namespace
+
+TEST(TxScheduler, StaysImmediateUnlessAdaptive)
+{
+    cISBridgeTxScheduler scheduler;
+    scheduler.SetOptions(sISBridgeTxOptions());
+    EXPECT_FALSE(scheduler.SampleDue(1000 * TX_TEST_MS));
+    EXPECT_TRUE(scheduler.OnQueued(1, 100, 100, 1 * TX_TEST_MS));
+    EXPECT_EQ(scheduler.Mode(), BRIDGE_TX_IMMEDIATE);
+    EXPECT_EQ(scheduler.SendFlags(true), 0);
+}
+
+TEST(TxScheduler, SwitchesModeWithHysteresis)
+{
+    cLoopbackConnection connection;
+    ASSERT_GE(connection.socket, 0);
+    cISBridgeTxScheduler scheduler;
+    scheduler.SetOptions(adaptiveOptions());
+    uint64_t now = 1000 * TX_TEST_MS;
+    ASSERT_TRUE(scheduler.SampleDue(now));
+    scheduler.Sample(connection.socket, false, now);
+
+    // 200 messages in 100 ms is the coalescing rate
+    now = runPeriod(scheduler, connection.socket, now, 200, 50);
+    EXPECT_EQ(scheduler.Mode(), BRIDGE_TX_COALESCE);
+    EXPECT_NEAR(scheduler.Stats().messageRate, 2000.0, 1.0);
+    EXPECT_EQ(scheduler.SendFlags(true), MSG_MORE);
+    EXPECT_EQ(scheduler.SendFlags(false), 0);
+
+    // Between half the rate and the rate nothing changes
+    now = runPeriod(scheduler, connection.socket, now, 70, 50);
+    EXPECT_EQ(scheduler.Mode(), BRIDGE_TX_COALESCE);
+
+    // Below half, with nothing unsent, back to immediate
+    now = runPeriod(scheduler, connection.socket, now, 40, 50);
+    EXPECT_EQ(scheduler.Mode(), BRIDGE_TX_IMMEDIATE);
+    EXPECT_EQ(scheduler.Stats().modeSwitches, 2u);
+
+    // A blocked write means the kernel is already holding data back
+    runPeriod(scheduler, connection.socket, now, 1, 50, true);
+    EXPECT_EQ(scheduler.Mode(), BRIDGE_TX_COALESCE);
+    EXPECT_EQ(scheduler.Stats().modeSwitches, 3u);
+}
+
+TEST(TxScheduler, CoalescingHoldsUntilBytesOrDeadline)
+{
+    cLoopbackConnection connection;
+    ASSERT_GE(connection.socket, 0);
+    cISBridgeTxScheduler scheduler;
+    scheduler.SetOptions(adaptiveOptions());
+    uint64_t now = 1000 * TX_TEST_MS;
+    scheduler.Sample(connection.socket, false, now);
+    now = runPeriod(scheduler, connection.socket, now, 200, 50);
+    ASSERT_EQ(scheduler.Mode(), BRIDGE_TX_COALESCE);
+
+    // Held until flushUs after the first message
+    EXPECT_FALSE(scheduler.OnQueued(1, 100, 100, now));
+    EXPECT_EQ(scheduler.DeadlineNs(), now + 2 * TX_TEST_MS);
+    EXPECT_FALSE(scheduler.OnQueued(1, 100, 200, now + TX_TEST_MS));
+    EXPECT_EQ(scheduler.DeadlineNs(), now + 2 * TX_TEST_MS);
+    EXPECT_TRUE(scheduler.OnQueued(1, 100, 300, now + 2 * TX_TEST_MS));
+    scheduler.OnFlushed();
+    EXPECT_EQ(scheduler.DeadlineNs(), 0u);
+
+    // Or until flushBytes are queued
+    EXPECT_FALSE(scheduler.OnQueued(1, 2000, 2000, now + 3 * TX_TEST_MS));
+    EXPECT_TRUE(scheduler.OnQueued(1, 2096, 4096, now + 3 * TX_TEST_MS));
+}
+
+TEST(TxScheduler, SizesSndbufToTheBandwidthDelayProduct)
+{
+    cLoopbackConnection connection;
+    ASSERT_GE(connection.socket, 0);
+    sISBridgeTxOptions options = adaptiveOptions();
+    options.minSndbuf = 16384;
+    options.maxSndbuf = 256 * 1024;
+    cISBridgeTxScheduler scheduler;
+    scheduler.SetOptions(options);
+    uint64_t now = 1000 * TX_TEST_MS;
+    scheduler.Sample(connection.socket, false, now);
+
+    // A slow client gets the smallest buffer
+    now = runPeriod(scheduler, connection.socket, now, 10, 100);
+    EXPECT_EQ(scheduler.Stats().sndbuf, options.minSndbuf);
+    int small = connection.KernelSndbuf();
+    EXPECT_GE(small, options.minSndbuf);
+
+    // 100 MB/s with a 2 ms flush deadline asks for more than the cap
+    now = runPeriod(scheduler, connection.socket, now, 1000, 10000);
+    EXPECT_EQ(scheduler.Stats().sndbuf, options.maxSndbuf);
+    EXPECT_GT(connection.KernelSndbuf(), small);
+
+    // 1 MB/s: twice 1 MB/s times (RTT + 2 ms) is about 4 KB, below the minimum
+    runPeriod(scheduler, connection.socket, now, 100, 1000);
+    EXPECT_EQ(scheduler.Stats().sndbuf, options.minSndbuf);
+}
+
+TEST(TxScheduler, MaxSndbufZeroLeavesTheKernelDefault)
+{
+    cLoopbackConnection connection;
+    ASSERT_GE(connection.socket, 0);
+    int initial = connection.KernelSndbuf();
+    sISBridgeTxOptions options = adaptiveOptions();
+    options.maxSndbuf = 0;
+    cISBridgeTxScheduler scheduler;
+    scheduler.SetOptions(options);
+    uint64_t now = 1000 * TX_TEST_MS;
+    scheduler.Sample(connection.socket, false, now);
+    runPeriod(scheduler, connection.socket, now, 1000, 10000);
+    EXPECT_EQ(scheduler.Stats().sndbuf, 0);
+    EXPECT_EQ(connection.KernelSndbuf(), initial);
+}
+
+#endif
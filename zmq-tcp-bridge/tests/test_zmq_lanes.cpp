@@ -0,0 +1,210 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2025 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "bridge_test_fixture.h"
+#include "ISComm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LANE_TEST_TICK_US           100000                     // Long enough that a command clearly overtakes paced bulk
+#define LANE_TEST_BULK_BYTES        400
+#define LANE_TEST_BULK_COUNT        10
+#define LANE_TEST_COMMAND_LATENCY_MS 250                       // Loose: the publisher shares the CPU
+
+namespace
+{
+
+/**
+ * A running bridge with a control lane and bulk paced to two messages per tick
+ */
+class LaneTest : public BridgeTest
+{
+protected:
+    void SetUp() override
+    {
+        BridgeTest::SetUp();
+        sISZmqTcpBridgeOptions options;
+        options.zmqControlLane = true;
+        options.bulkBytesPerTick = 2 * LANE_TEST_BULK_BYTES;
+        options.bulkTickUs = LANE_TEST_TICK_US;
+        ASSERT_EQ(0, StartBridge(options));
+        ASSERT_TRUE(JoinBridgePublisher(BRIDGE_ZMQ_LANE_CONTROL));
+
+        // Start the measurement on a fresh tick
+        std::this_thread::sleep_for(std::chrono::microseconds(2 * LANE_TEST_TICK_US));
+    }
+};
+
+/**
+ * @return position of the first message equal to wanted, -1 if none
+ */
+int indexOf(const std::vector<std::string>& messages, const std::string& wanted)
+{
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+        if (messages[i] == wanted)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+TEST_F(LaneTest, ControlOvertakesPacedBulk)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> bulk;
+    for (int i = 0; i < LANE_TEST_BULK_COUNT; i++)
+    {
+        bulk.push_back(std::string(LANE_TEST_BULK_BYTES, static_cast<char>('a' + i)));
+        ASSERT_EQ(0, m_bridge.Inject(reinterpret_cast<const uint8_t*>(bulk.back().data()), bulk.back().size()));
+    }
+    const std::string command = "command";
+    ASSERT_EQ(0, m_bridge.Inject(reinterpret_cast<const uint8_t*>(command.data()), command.size(), BRIDGE_ZMQ_LANE_CONTROL));
+
+    std::vector<std::string> messages = Receive(LANE_TEST_BULK_COUNT + 1);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(messages.size(), static_cast<size_t>(LANE_TEST_BULK_COUNT + 1));
+
+    // The command waits for at most the tick it was queued in, not for the bulk backlog
+    int position = indexOf(messages, command);
+    ASSERT_GE(position, 0);
+    EXPECT_LE(position, 4);
+
+    // Bulk keeps its order and is held to two messages per tick
+    messages.erase(messages.begin() + position);
+    EXPECT_EQ(messages, bulk);
+    EXPECT_GE(elapsed, std::chrono::microseconds((LANE_TEST_BULK_COUNT / 2 - 1) * LANE_TEST_TICK_US));
+
+    sISZmqTcpBridgeStats stats;
+    m_bridge.GetStats(stats);
+    EXPECT_GT(stats.zmqBulkDeferred, 0u);
+    EXPECT_GE(stats.controlLatency.count, 1u);
+    EXPECT_EQ(stats.zmqControlQueue.dropped, 0u);
+}
+
+TEST_F(LaneTest, ClientCommandsOvertakeClientData)
+{
+    is_socket_t client = ConnectClient();
+    ASSERT_TRUE(bridgeSocketValid(client));
+
+    // Whole ISB packets encoded by the SDK, all in one write; DATA is bulk, GET_DATA is
+    // a command
+    is_comm_instance_t comm = {};
+    std::vector<uint8_t> stream;
+    uint8_t packet[1024];
+    uint8_t payload[LANE_TEST_BULK_BYTES - 8] = {};
+    for (int i = 0; i < LANE_TEST_BULK_COUNT; i++)
+    {
+        payload[0] = static_cast<uint8_t>(i);
+        int size = is_comm_write_to_buf(packet, sizeof(packet), &comm, PKT_TYPE_DATA, DID_INS_1, sizeof(payload), 0, payload);
+        ASSERT_GT(size, 0);
+        stream.insert(stream.end(), packet, packet + size);
+    }
+    int size = is_comm_get_data_to_buf(packet, sizeof(packet), &comm, DID_GPS1_POS, 0, 0, 1);
+    ASSERT_GT(size, 0);
+    stream.insert(stream.end(), packet, packet + size);
+    ASSERT_EQ(send(client, reinterpret_cast<const char*>(stream.data()), stream.size(), MSG_NOSIGNAL), static_cast<int>(stream.size()));
+
+    // One ZMQ message per packet, the command among the first
+    std::vector<std::string> messages = Receive(LANE_TEST_BULK_COUNT + 1);
+    ASSERT_EQ(messages.size(), static_cast<size_t>(LANE_TEST_BULK_COUNT + 1));
+    int position = -1;
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+        ASSERT_GT(messages[i].size(), 2u);
+        if ((messages[i][2] & BRIDGE_ISB_PKT_TYPE_MASK) == BRIDGE_ISB_PKT_TYPE_GET_DATA)
+        {
+            position = static_cast<int>(i);
+        }
+    }
+    ASSERT_GE(position, 0);
+    EXPECT_LE(position, 4);
+    EXPECT_EQ(static_cast<uint8_t>(messages.back()[2] & BRIDGE_ISB_PKT_TYPE_MASK), BRIDGE_ISB_PKT_TYPE_DATA);
+
+    bridgeSocketClose(client);
+}
+
+TEST_F(LaneTest, CommandsGetThroughASaturatingPublisher)
+{
+    ASSERT_TRUE(StartFlood(LANE_TEST_BULK_BYTES));
+    sISZmqTcpBridgeStats before;
+    m_bridge.GetStats(before);
+
+    // Each command goes out between receive batches rather than after the flood
+    std::chrono::steady_clock::duration worst(0);
+    for (int i = 0; i < 20; i++)
+    {
+        const std::string command = "command" + std::to_string(i);
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(0, m_bridge.Inject(reinterpret_cast<const uint8_t*>(command.data()), command.size(), BRIDGE_ZMQ_LANE_CONTROL));
+        std::vector<std::string> messages = Receive(1);
+        worst = std::max(worst, std::chrono::steady_clock::now() - start);
+        ASSERT_EQ(messages.size(), 1u);
+        ASSERT_EQ(messages[0], command);
+    }
+    EXPECT_LT(worst, std::chrono::milliseconds(LANE_TEST_COMMAND_LATENCY_MS));
+
+    sISZmqTcpBridgeStats after;
+    m_bridge.GetStats(after);
+    EXPECT_GT(after.zmqRxMessages, before.zmqRxMessages);
+    EXPECT_EQ(after.zmqControlQueue.dropped, 0u);
+}
+
+TEST_F(BridgeTest, EmptyMessagesUseUpTheReceiveBudget)
+{
+    sISZmqTcpBridgeOptions options;
+    options.maxBatchMessages = 4;
+    options.zmqRecvBudget = 8;
+    m_bridge.SetOptions(options);
+    ASSERT_EQ(0, m_bridge.Open(m_pubEndpoint, m_subEndpoint, 0));
+
+    // Publish probes until the SUB socket has joined
+    const uint8_t probe[1] = { 0 };
+    bool joined = false;
+    for (int i = 0; i < 100 && !joined; i++)
+    {
+        zmq_send(m_pub, probe, sizeof(probe), 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        joined = m_bridge.ServiceZmq() > 0;
+    }
+    ASSERT_TRUE(joined);
+    while (m_bridge.ServiceZmq() > 0)
+    {
+    }
+
+    // A pass stops at the budget however many of the messages are empty, and asks to
+    // be called again right away
+    const int kEmpty = 20;
+    for (int i = 0; i < kEmpty; i++)
+    {
+        ASSERT_EQ(zmq_send(m_pub, NULL, 0, 0), 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    int received = m_bridge.ServiceZmq();
+    EXPECT_EQ(received, options.zmqRecvBudget);
+    EXPECT_EQ(m_bridge.ZmqTimeoutMs(), 0);
+    for (int i = 0; i < 10 && received < kEmpty; i++)
+    {
+        int n = m_bridge.ServiceZmq();
+        EXPECT_LE(n, options.zmqRecvBudget);
+        received += n;
+    }
+    EXPECT_EQ(received, kEmpty);
+    EXPECT_EQ(m_bridge.ZmqTimeoutMs(), -1);
+}